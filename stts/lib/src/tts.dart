@@ -70,6 +70,9 @@ class Tts extends TtsPlatformInterface {
   @override
   Stream<TtsState> get onStateChanged => _tts.onStateChanged;
 
+  @override
+  TtsWindows? get windows => _tts.windows;
+
   Future<T> _safeCall<T>(Future<T> Function() fn) async {
     await _semaphore.acquire();
     try {
@@ -0,0 +1,107 @@
+#include "audio_level_meter.h"
+#include "level_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stts {
+
+    // Frame energy above the noise floor required to detect voice.
+    static const float kVoiceMarginDb = 10.0f;
+    // Frames quieter than this are never voice.
+    static const float kVoiceMinimumDb = -50.0f;
+    static const float kInitialNoiseFloorDb = -60.0f;
+    static const int kHangoverFrames = 8;
+
+    AudioLevelMeter::AudioLevelMeter(uint32_t sampleRate, uint16_t channels, std::chrono::milliseconds frameDuration) :
+        m_sampleRate(0),
+        m_channels(0),
+        m_frameDuration(frameDuration),
+        m_noiseFloorDb(kInitialNoiseFloorDb)
+    {
+        SetFormat(sampleRate, channels);
+    }
+
+    void AudioLevelMeter::SetFormat(uint32_t sampleRate, uint16_t channels)
+    {
+        if (sampleRate == m_sampleRate && channels == m_channels) return;
+
+        m_sampleRate = sampleRate;
+        m_channels = channels;
+        m_frameSize = std::max<size_t>(1, static_cast<size_t>(sampleRate) * channels * static_cast<size_t>(m_frameDuration.count()) / 1000);
+
+        Reset();
+    }
+
+    void AudioLevelMeter::Process(const int16_t* samples, size_t count)
+    {
+        while (count > 0)
+        {
+            auto size = std::min(count, m_frameSize - m_count);
+
+            auto stats = ComputePcmStats(samples, size);
+            m_sumSquares += stats.sumSquares;
+            m_peak = std::max(m_peak, stats.peak);
+            m_count += size;
+
+            samples += size;
+            count -= size;
+
+            if (m_count == m_frameSize)
+            {
+                EndFrame();
+            }
+        }
+    }
+
+    bool AudioLevelMeter::TakeLevel(AudioLevel& level)
+    {
+        if (!m_hasLevel) return false;
+
+        level = m_level;
+        m_level = AudioLevel();
+        m_hasLevel = false;
+        return true;
+    }
+
+    void AudioLevelMeter::Reset()
+    {
+        m_sumSquares = 0;
+        m_peak = 0;
+        m_count = 0;
+        m_level = AudioLevel();
+        m_hasLevel = false;
+        m_noiseFloorDb = kInitialNoiseFloorDb;
+        m_hangoverFrames = 0;
+    }
+
+    void AudioLevelMeter::EndFrame()
+    {
+        auto rms = static_cast<float>(std::sqrt(static_cast<double>(m_sumSquares) / static_cast<double>(m_count)) / 32768.0);
+        auto peak = static_cast<float>(m_peak) / 32768.0f;
+        auto db = rms > 0 ? 20.0f * std::log10(rms) : -100.0f;
+
+        // Floor follows quiet frames quickly and loud ones slowly.
+        auto rate = db < m_noiseFloorDb ? 0.5f : 0.01f;
+        m_noiseFloorDb = std::max(-90.0f, m_noiseFloorDb + (db - m_noiseFloorDb) * rate);
+
+        if (db > kVoiceMinimumDb && db > m_noiseFloorDb + kVoiceMarginDb)
+        {
+            m_hangoverFrames = kHangoverFrames;
+        }
+        else if (m_hangoverFrames > 0)
+        {
+            m_hangoverFrames--;
+        }
+
+        m_level.rms = std::max(m_level.rms, rms);
+        m_level.peak = std::max(m_level.peak, peak);
+        m_level.voice = m_level.voice || m_hangoverFrames > 0;
+        m_hasLevel = true;
+
+        m_sumSquares = 0;
+        m_peak = 0;
+        m_count = 0;
+    }
+
+}
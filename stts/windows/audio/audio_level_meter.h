@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace stts {
+
+	struct AudioLevel {
+		// Root mean square of the loudest frame, from 0 to 1.
+		float rms = 0;
+		// Absolute peak, from 0 to 1.
+		float peak = 0;
+		// Whether voice was detected in any frame.
+		bool voice = false;
+	};
+
+	// Splits 16-bit PCM into fixed frames and detects voice from frame energy.
+	//
+	// Voice is detected when a frame is louder than the tracked noise floor by a margin.
+	// Detection is held for a few frames to bridge short pauses between words.
+	class AudioLevelMeter {
+	public:
+		explicit AudioLevelMeter(
+			uint32_t sampleRate = 16000,
+			uint16_t channels = 1,
+			std::chrono::milliseconds frameDuration = std::chrono::milliseconds(20));
+
+		// Resets the meter if the format changed.
+		void SetFormat(uint32_t sampleRate, uint16_t channels);
+
+		void Process(const int16_t* samples, size_t count);
+
+		// Returns the level aggregated from the frames completed since the last call, if any.
+		bool TakeLevel(AudioLevel& level);
+
+		void Reset();
+
+	private:
+		uint32_t m_sampleRate;
+		uint16_t m_channels;
+		std::chrono::milliseconds m_frameDuration;
+		size_t m_frameSize = 0;
+
+		// Current frame.
+		uint64_t m_sumSquares = 0;
+		int32_t m_peak = 0;
+		size_t m_count = 0;
+
+		// Frames since last TakeLevel.
+		AudioLevel m_level;
+		bool m_hasLevel = false;
+
+		float m_noiseFloorDb;
+		int m_hangoverFrames = 0;
+
+		void EndFrame();
+	};
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "spsc_ring.h"
+
+namespace stts {
+
+	// PCM fed to the recognizer, written by the audio thread and read by the engine worker.
+	struct AudioTap {
+		explicit AudioTap(size_t capacity) : ring(capacity) {}
+
+		SpscRing<int16_t> ring;
+
+		// Format of the samples, zero when the stream is not 16-bit PCM.
+		std::atomic<uint32_t> sampleRate{ 0 };
+		std::atomic<uint16_t> channels{ 0 };
+
+		// Samples are only written while enabled.
+		std::atomic<bool> enabled{ false };
+	};
+
+}
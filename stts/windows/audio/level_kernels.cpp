@@ -0,0 +1,179 @@
+#include "level_kernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STTS_PCM_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STTS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define STTS_TARGET(isa)
+#endif
+
+namespace stts {
+
+    PcmStats ComputePcmStatsScalar(const int16_t* samples, size_t count)
+    {
+        PcmStats stats;
+        stats.count = count;
+
+        int32_t min = 0;
+        int32_t max = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t sample = samples[i];
+            stats.sumSquares += static_cast<uint64_t>(sample * sample);
+            if (sample < min) min = sample;
+            if (sample > max) max = sample;
+        }
+
+        stats.peak = -min > max ? -min : max;
+        return stats;
+    }
+
+#ifdef STTS_PCM_KERNELS_X86
+
+    static void MergeTail(PcmStats& stats, const int16_t* samples, size_t count)
+    {
+        auto tail = ComputePcmStatsScalar(samples, count);
+        stats.sumSquares += tail.sumSquares;
+        if (tail.peak > stats.peak) stats.peak = tail.peak;
+    }
+
+    // Squares of two samples may reach 2^31, madd results are taken as unsigned.
+    STTS_TARGET("sse2")
+    static PcmStats ComputePcmStatsSse2(const int16_t* samples, size_t count)
+    {
+        PcmStats stats;
+        stats.count = count;
+
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        __m128i min = zero;
+        __m128i max = zero;
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+            __m128i squares = _mm_madd_epi16(x, x);
+            sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+            sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+            min = _mm_min_epi16(min, x);
+            max = _mm_max_epi16(max, x);
+        }
+
+        alignas(16) uint64_t sums[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums), sum);
+        alignas(16) int16_t mins[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(mins), min);
+        alignas(16) int16_t maxs[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(maxs), max);
+
+        stats.sumSquares = sums[0] + sums[1];
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (-mins[lane] > stats.peak) stats.peak = -mins[lane];
+            if (maxs[lane] > stats.peak) stats.peak = maxs[lane];
+        }
+
+        MergeTail(stats, samples + i, count - i);
+        return stats;
+    }
+
+    STTS_TARGET("avx2")
+    static PcmStats ComputePcmStatsAvx2(const int16_t* samples, size_t count)
+    {
+        PcmStats stats;
+        stats.count = count;
+
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i sum = zero;
+        __m256i min = zero;
+        __m256i max = zero;
+
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+            __m256i squares = _mm256_madd_epi16(x, x);
+            sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+            sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+            min = _mm256_min_epi16(min, x);
+            max = _mm256_max_epi16(max, x);
+        }
+
+        alignas(32) uint64_t sums[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+        alignas(32) int16_t mins[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+        alignas(32) int16_t maxs[16];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+
+        stats.sumSquares = sums[0] + sums[1] + sums[2] + sums[3];
+        for (int lane = 0; lane < 16; lane++)
+        {
+            if (-mins[lane] > stats.peak) stats.peak = -mins[lane];
+            if (maxs[lane] > stats.peak) stats.peak = maxs[lane];
+        }
+
+        MergeTail(stats, samples + i, count - i);
+        return stats;
+    }
+
+    static bool IsAvx2Supported()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        // OSXSAVE and AVX, then YMM state enabled by the OS.
+        __cpuid(info, 1);
+        if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0) return false;
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif
+
+    PcmKernelIsa GetPcmKernelIsa()
+    {
+#ifdef STTS_PCM_KERNELS_X86
+        static const PcmKernelIsa isa = IsAvx2Supported() ? PcmKernelIsa::avx2 : PcmKernelIsa::sse2;
+        return isa;
+#else
+        return PcmKernelIsa::scalar;
+#endif
+    }
+
+    PcmStats ComputePcmStats(PcmKernelIsa isa, const int16_t* samples, size_t count)
+    {
+        switch (isa)
+        {
+#ifdef STTS_PCM_KERNELS_X86
+        case PcmKernelIsa::avx2:
+            return ComputePcmStatsAvx2(samples, count);
+        case PcmKernelIsa::sse2:
+            return ComputePcmStatsSse2(samples, count);
+#endif
+        default:
+            return ComputePcmStatsScalar(samples, count);
+        }
+    }
+
+    PcmStats ComputePcmStats(const int16_t* samples, size_t count)
+    {
+        return ComputePcmStats(GetPcmKernelIsa(), samples, count);
+    }
+
+}
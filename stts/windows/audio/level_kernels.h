@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stts {
+
+	// Statistics of 16-bit PCM samples.
+	struct PcmStats {
+		uint64_t sumSquares = 0;
+		// Absolute peak, up to 32768.
+		int32_t peak = 0;
+		size_t count = 0;
+	};
+
+	enum class PcmKernelIsa {
+		scalar,
+		sse2,
+		avx2,
+	};
+
+	// Instruction set used by ComputePcmStats, detected once.
+	PcmKernelIsa GetPcmKernelIsa();
+
+	PcmStats ComputePcmStats(const int16_t* samples, size_t count);
+
+	// Kernels, exposed to compare them. Calling a kernel not supported by the CPU is undefined.
+	PcmStats ComputePcmStatsScalar(const int16_t* samples, size_t count);
+	PcmStats ComputePcmStats(PcmKernelIsa isa, const int16_t* samples, size_t count);
+
+}
@@ -0,0 +1,48 @@
+#include "pcm_buffer.h"
+#include "wav_writer.h"
+
+namespace stts {
+
+    PcmBuffer::PcmBuffer(const PcmFormat& format, size_t maxSize) :
+        m_format(format),
+        m_maxSize(maxSize)
+    {
+    }
+
+    bool PcmBuffer::Write(const uint8_t* data, size_t size)
+    {
+        if (size > m_maxSize - m_samples.size()) return false;
+
+        m_samples.insert(m_samples.end(), data, data + size);
+        return true;
+    }
+
+    void PcmBuffer::Reserve(std::chrono::milliseconds duration)
+    {
+        auto size = static_cast<uint64_t>(duration.count()) * m_format.GetByteRate() / 1000;
+        if (size > m_maxSize) size = m_maxSize;
+
+        m_samples.reserve(static_cast<size_t>(size));
+    }
+
+    std::chrono::milliseconds PcmBuffer::GetDuration() const
+    {
+        auto byteRate = m_format.GetByteRate();
+        if (byteRate == 0) return std::chrono::milliseconds(0);
+
+        return std::chrono::milliseconds(static_cast<uint64_t>(m_samples.size()) * 1000 / byteRate);
+    }
+
+    std::vector<uint8_t> PcmBuffer::TakeSamples()
+    {
+        std::vector<uint8_t> samples;
+        samples.swap(m_samples);
+        return samples;
+    }
+
+    std::vector<uint8_t> PcmBuffer::ToWav() const
+    {
+        return EncodeWav(m_format, m_samples.data(), m_samples.size());
+    }
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pcm_sink.h"
+#include "wav_reader.h"
+
+namespace stts {
+
+	// PCM samples rendered in memory.
+	class PcmBuffer : public PcmSink {
+	public:
+		explicit PcmBuffer(const PcmFormat& format, size_t maxSize = SIZE_MAX);
+
+		bool Write(const uint8_t* data, size_t size) override;
+
+		// Preallocates room for the given duration of audio.
+		void Reserve(std::chrono::milliseconds duration);
+
+		const PcmFormat& GetFormat() const { return m_format; }
+		const uint8_t* GetData() const { return m_samples.data(); }
+		size_t GetSize() const { return m_samples.size(); }
+		std::chrono::milliseconds GetDuration() const;
+
+		// Moves the samples out, the buffer is then empty.
+		std::vector<uint8_t> TakeSamples();
+
+		// Copy of the samples with a WAV header.
+		std::vector<uint8_t> ToWav() const;
+
+		void Clear() { m_samples.clear(); }
+
+	private:
+		PcmFormat m_format;
+		size_t m_maxSize;
+		std::vector<uint8_t> m_samples;
+	};
+
+}
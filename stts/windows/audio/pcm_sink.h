@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stts {
+
+	// Destination of rendered PCM samples.
+	class PcmSink {
+	public:
+		virtual ~PcmSink() = default;
+
+		// Returns false when the samples cannot be stored (e.g. disk full), rendering should then stop.
+		virtual bool Write(const uint8_t* data, size_t size) = 0;
+	};
+
+}
@@ -0,0 +1,127 @@
+#include "pcm_sink_stream.h"
+
+namespace stts {
+
+    // static
+    HRESULT PcmSinkStream::Create(PcmSink* sink, IStream** ppStream)
+    {
+        if (!sink || !ppStream) return E_POINTER;
+
+        *ppStream = new PcmSinkStream(sink);
+        return S_OK;
+    }
+
+    PcmSinkStream::PcmSinkStream(PcmSink* sink) :
+        m_sink(sink)
+    {
+    }
+
+    STDMETHODIMP PcmSinkStream::QueryInterface(REFIID riid, void** ppv)
+    {
+        if (!ppv) return E_POINTER;
+
+        if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream)
+        {
+            *ppv = static_cast<IStream*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) PcmSinkStream::AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    STDMETHODIMP_(ULONG) PcmSinkStream::Release()
+    {
+        auto count = --m_refCount;
+        if (count == 0)
+        {
+            delete this;
+        }
+        return count;
+    }
+
+    STDMETHODIMP PcmSinkStream::Read(void*, ULONG, ULONG*)
+    {
+        return STG_E_ACCESSDENIED;
+    }
+
+    STDMETHODIMP PcmSinkStream::Write(const void* pv, ULONG cb, ULONG* pcbWritten)
+    {
+        if (!pv) return STG_E_INVALIDPOINTER;
+
+        if (!m_sink->Write(static_cast<const uint8_t*>(pv), cb))
+        {
+            if (pcbWritten) *pcbWritten = 0;
+            return STG_E_MEDIUMFULL;
+        }
+
+        m_position += cb;
+        if (pcbWritten) *pcbWritten = cb;
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSinkStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition)
+    {
+        // Position queries only, the end is the current position.
+        bool isCurrent = (dwOrigin == STREAM_SEEK_CUR || dwOrigin == STREAM_SEEK_END) && dlibMove.QuadPart == 0;
+        bool isSame = dwOrigin == STREAM_SEEK_SET && static_cast<ULONGLONG>(dlibMove.QuadPart) == m_position;
+
+        if (!isCurrent && !isSame) return STG_E_INVALIDFUNCTION;
+
+        if (plibNewPosition) plibNewPosition->QuadPart = m_position;
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSinkStream::SetSize(ULARGE_INTEGER)
+    {
+        return STG_E_INVALIDFUNCTION;
+    }
+
+    STDMETHODIMP PcmSinkStream::CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*)
+    {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP PcmSinkStream::Commit(DWORD)
+    {
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSinkStream::Revert()
+    {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP PcmSinkStream::LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return STG_E_INVALIDFUNCTION;
+    }
+
+    STDMETHODIMP PcmSinkStream::UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return STG_E_INVALIDFUNCTION;
+    }
+
+    STDMETHODIMP PcmSinkStream::Stat(STATSTG* pstatstg, DWORD)
+    {
+        if (!pstatstg) return STG_E_INVALIDPOINTER;
+
+        ZeroMemory(pstatstg, sizeof(STATSTG));
+        pstatstg->type = STGTY_STREAM;
+        pstatstg->cbSize.QuadPart = m_position;
+        pstatstg->grfMode = STGM_WRITE;
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSinkStream::Clone(IStream**)
+    {
+        return E_NOTIMPL;
+    }
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include "pcm_sink.h"
+
+#include <objidl.h>
+
+namespace stts {
+
+	// Write-only COM stream forwarding samples to a sink, used as base stream of an ISpStream.
+	// Only forward writes are supported, seeking is limited to the current position.
+	class PcmSinkStream : public IStream
+	{
+	public:
+		// Returned object has a reference count of 1. The sink must outlive the writes.
+		static HRESULT Create(PcmSink* sink, IStream** ppStream);
+
+		// IUnknown
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override;
+		STDMETHODIMP_(ULONG) AddRef() override;
+		STDMETHODIMP_(ULONG) Release() override;
+
+		// ISequentialStream
+		STDMETHODIMP Read(void* pv, ULONG cb, ULONG* pcbRead) override;
+		STDMETHODIMP Write(const void* pv, ULONG cb, ULONG* pcbWritten) override;
+
+		// IStream
+		STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition) override;
+		STDMETHODIMP SetSize(ULARGE_INTEGER libNewSize) override;
+		STDMETHODIMP CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead, ULARGE_INTEGER* pcbWritten) override;
+		STDMETHODIMP Commit(DWORD grfCommitFlags) override;
+		STDMETHODIMP Revert() override;
+		STDMETHODIMP LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP Stat(STATSTG* pstatstg, DWORD grfStatFlag) override;
+		STDMETHODIMP Clone(IStream** ppstm) override;
+
+	private:
+		explicit PcmSinkStream(PcmSink* sink);
+		virtual ~PcmSinkStream() = default;
+
+		std::atomic<ULONG> m_refCount{ 1 };
+		PcmSink* m_sink;
+		ULONGLONG m_position = 0;
+	};
+
+}
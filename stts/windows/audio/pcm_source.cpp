@@ -0,0 +1,98 @@
+#include "pcm_source.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace stts {
+
+    PcmSource::PcmSource(std::vector<uint8_t> samples, const PcmFormat& format) :
+        m_format(format),
+        m_offset(0)
+    {
+        // Whole blocks only.
+        auto blockAlign = std::max<size_t>(1, format.GetBlockAlign());
+        samples.resize(samples.size() - samples.size() % blockAlign);
+
+        m_size = samples.size();
+        auto bytes = std::make_shared<const std::vector<uint8_t>>(std::move(samples));
+        m_bytes = std::shared_ptr<const uint8_t>(bytes, bytes->data());
+    }
+
+    PcmSource::PcmSource(std::shared_ptr<const std::vector<uint8_t>> samples, const PcmFormat& format) :
+        PcmSource(std::shared_ptr<const uint8_t>(samples, samples->data()), samples->size(), format)
+    {
+    }
+
+    PcmSource::PcmSource(std::shared_ptr<const uint8_t> samples, size_t size, const PcmFormat& format) :
+        m_bytes(std::move(samples)),
+        m_format(format),
+        m_offset(0)
+    {
+        // Whole blocks only.
+        auto blockAlign = std::max<size_t>(1, format.GetBlockAlign());
+        m_size = size - size % blockAlign;
+    }
+
+    PcmSource::PcmSource(std::vector<uint8_t> bytes, const PcmFormat& format, size_t offset, size_t size) :
+        m_format(format),
+        m_offset(offset),
+        m_size(size)
+    {
+        auto samples = std::make_shared<const std::vector<uint8_t>>(std::move(bytes));
+        m_bytes = std::shared_ptr<const uint8_t>(samples, samples->data());
+    }
+
+    // static
+    WavError PcmSource::FromWav(std::vector<uint8_t> bytes, std::unique_ptr<PcmSource>& source)
+    {
+        WavInfo info;
+        auto error = ParseWav(bytes.data(), bytes.size(), info);
+        if (error != WavError::none) return error;
+
+        // WAV header is kept, samples are read in place.
+        source.reset(new PcmSource(std::move(bytes), info.format, info.dataOffset, info.dataSize));
+        return WavError::none;
+    }
+
+    // static
+    bool PcmSource::ReadFile(const std::string& utf8Path, std::vector<uint8_t>& bytes)
+    {
+        std::ifstream file(std::filesystem::u8path(utf8Path), std::ios::binary | std::ios::ate);
+        if (!file) return false;
+
+        auto size = static_cast<std::streamoff>(file.tellg());
+        if (size < 0) return false;
+
+        bytes.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), size));
+    }
+
+    bool PcmSource::Seek(uint64_t position)
+    {
+        if (position > m_size) return false;
+
+        m_position = static_cast<size_t>(position);
+        return true;
+    }
+
+    size_t PcmSource::Read(void* buffer, size_t size)
+    {
+        auto count = std::min(size, m_size - m_position);
+        std::memcpy(buffer, m_bytes.get() + m_offset + m_position, count);
+        m_position += count;
+
+        return count;
+    }
+
+    std::chrono::milliseconds PcmSource::GetTime(uint64_t offset) const
+    {
+        auto byteRate = m_format.GetByteRate();
+        if (byteRate == 0) return std::chrono::milliseconds(0);
+
+        return std::chrono::milliseconds(offset * 1000 / byteRate);
+    }
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "wav_reader.h"
+
+namespace stts {
+
+	// Seekable PCM samples held in memory, fed to a recognizer as an audio stream.
+	class PcmSource {
+	public:
+		// Raw samples.
+		PcmSource(std::vector<uint8_t> samples, const PcmFormat& format);
+
+		// Raw samples shared with other sources, each one reading at its own position.
+		PcmSource(std::shared_ptr<const std::vector<uint8_t>> samples, const PcmFormat& format);
+
+		// Same, for samples owned elsewhere, e.g. a file mapping.
+		PcmSource(std::shared_ptr<const uint8_t> samples, size_t size, const PcmFormat& format);
+
+		// Samples of a WAV file content.
+		static WavError FromWav(std::vector<uint8_t> bytes, std::unique_ptr<PcmSource>& source);
+
+		// Returns false when the file cannot be read.
+		static bool ReadFile(const std::string& utf8Path, std::vector<uint8_t>& bytes);
+
+		const PcmFormat& GetFormat() const { return m_format; }
+
+		// Size and position in bytes.
+		uint64_t GetSize() const { return m_size; }
+		uint64_t GetPosition() const { return m_position; }
+		bool Seek(uint64_t position);
+
+		size_t Read(void* buffer, size_t size);
+
+		// Time position of a byte offset in the samples.
+		std::chrono::milliseconds GetTime(uint64_t offset) const;
+
+	private:
+		PcmSource(std::vector<uint8_t> bytes, const PcmFormat& format, size_t offset, size_t size);
+
+		std::shared_ptr<const uint8_t> m_bytes;
+		PcmFormat m_format;
+		size_t m_offset;
+		size_t m_size;
+		size_t m_position = 0;
+	};
+
+}
@@ -0,0 +1,163 @@
+#include "pcm_source_stream.h"
+
+namespace stts {
+
+    // static
+    HRESULT PcmSourceStream::Create(std::shared_ptr<PcmSource> source, IStream** ppStream)
+    {
+        if (!source || !ppStream) return E_POINTER;
+
+        *ppStream = new PcmSourceStream(std::move(source));
+        return S_OK;
+    }
+
+    // static
+    HRESULT PcmSourceStream::CreateSpStream(std::shared_ptr<PcmSource> source, ISpStream** ppStream)
+    {
+        const auto& format = source->GetFormat();
+
+        WAVEFORMATEX waveFormat{};
+        waveFormat.wFormatTag = WAVE_FORMAT_PCM;
+        waveFormat.nChannels = format.channels;
+        waveFormat.nSamplesPerSec = format.sampleRate;
+        waveFormat.wBitsPerSample = format.bitsPerSample;
+        waveFormat.nBlockAlign = format.GetBlockAlign();
+        waveFormat.nAvgBytesPerSec = format.GetByteRate();
+
+        IStream* pBaseStream = NULL;
+        HRESULT hr = Create(source, &pBaseStream);
+        if (FAILED(hr)) return hr;
+
+        hr = CoCreateInstance(CLSID_SpStream, NULL, CLSCTX_ALL, IID_ISpStream, (void**)ppStream);
+        if (SUCCEEDED(hr))
+        {
+            hr = (*ppStream)->SetBaseStream(pBaseStream, SPDFID_WaveFormatEx, &waveFormat);
+            if (FAILED(hr))
+            {
+                (*ppStream)->Release();
+                *ppStream = NULL;
+            }
+        }
+
+        pBaseStream->Release();
+        return hr;
+    }
+
+    PcmSourceStream::PcmSourceStream(std::shared_ptr<PcmSource> source) :
+        m_source(std::move(source))
+    {
+    }
+
+    STDMETHODIMP PcmSourceStream::QueryInterface(REFIID riid, void** ppv)
+    {
+        if (!ppv) return E_POINTER;
+
+        if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream)
+        {
+            *ppv = static_cast<IStream*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) PcmSourceStream::AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    STDMETHODIMP_(ULONG) PcmSourceStream::Release()
+    {
+        auto count = --m_refCount;
+        if (count == 0)
+        {
+            delete this;
+        }
+        return count;
+    }
+
+    STDMETHODIMP PcmSourceStream::Read(void* pv, ULONG cb, ULONG* pcbRead)
+    {
+        if (!pv) return STG_E_INVALIDPOINTER;
+
+        auto read = static_cast<ULONG>(m_source->Read(pv, cb));
+        if (pcbRead) *pcbRead = read;
+
+        return read == cb ? S_OK : S_FALSE;
+    }
+
+    STDMETHODIMP PcmSourceStream::Write(const void*, ULONG, ULONG*)
+    {
+        return STG_E_ACCESSDENIED;
+    }
+
+    STDMETHODIMP PcmSourceStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition)
+    {
+        LONGLONG origin;
+        switch (dwOrigin)
+        {
+        case STREAM_SEEK_SET: origin = 0; break;
+        case STREAM_SEEK_CUR: origin = static_cast<LONGLONG>(m_source->GetPosition()); break;
+        case STREAM_SEEK_END: origin = static_cast<LONGLONG>(m_source->GetSize()); break;
+        default: return STG_E_INVALIDFUNCTION;
+        }
+
+        auto position = origin + dlibMove.QuadPart;
+        if (position < 0 || !m_source->Seek(static_cast<uint64_t>(position)))
+        {
+            return STG_E_INVALIDFUNCTION;
+        }
+
+        if (plibNewPosition) plibNewPosition->QuadPart = static_cast<ULONGLONG>(position);
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSourceStream::SetSize(ULARGE_INTEGER)
+    {
+        return STG_E_ACCESSDENIED;
+    }
+
+    STDMETHODIMP PcmSourceStream::CopyTo(IStream*, ULARGE_INTEGER, ULARGE_INTEGER*, ULARGE_INTEGER*)
+    {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP PcmSourceStream::Commit(DWORD)
+    {
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSourceStream::Revert()
+    {
+        return E_NOTIMPL;
+    }
+
+    STDMETHODIMP PcmSourceStream::LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return STG_E_INVALIDFUNCTION;
+    }
+
+    STDMETHODIMP PcmSourceStream::UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD)
+    {
+        return STG_E_INVALIDFUNCTION;
+    }
+
+    STDMETHODIMP PcmSourceStream::Stat(STATSTG* pstatstg, DWORD)
+    {
+        if (!pstatstg) return STG_E_INVALIDPOINTER;
+
+        ZeroMemory(pstatstg, sizeof(STATSTG));
+        pstatstg->type = STGTY_STREAM;
+        pstatstg->cbSize.QuadPart = m_source->GetSize();
+        pstatstg->grfMode = STGM_READ;
+        return S_OK;
+    }
+
+    STDMETHODIMP PcmSourceStream::Clone(IStream**)
+    {
+        return E_NOTIMPL;
+    }
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "pcm_source.h"
+
+#include <objidl.h>
+#include <sapi.h>
+
+namespace stts {
+
+	// Read-only COM stream over PCM samples, used as base stream of an ISpStream.
+	class PcmSourceStream : public IStream
+	{
+	public:
+		// Returned object has a reference count of 1.
+		static HRESULT Create(std::shared_ptr<PcmSource> source, IStream** ppStream);
+
+		// Same, wrapped in a SAPI stream declaring the source format.
+		static HRESULT CreateSpStream(std::shared_ptr<PcmSource> source, ISpStream** ppStream);
+
+		// IUnknown
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override;
+		STDMETHODIMP_(ULONG) AddRef() override;
+		STDMETHODIMP_(ULONG) Release() override;
+
+		// ISequentialStream
+		STDMETHODIMP Read(void* pv, ULONG cb, ULONG* pcbRead) override;
+		STDMETHODIMP Write(const void* pv, ULONG cb, ULONG* pcbWritten) override;
+
+		// IStream
+		STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition) override;
+		STDMETHODIMP SetSize(ULARGE_INTEGER libNewSize) override;
+		STDMETHODIMP CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead, ULARGE_INTEGER* pcbWritten) override;
+		STDMETHODIMP Commit(DWORD grfCommitFlags) override;
+		STDMETHODIMP Revert() override;
+		STDMETHODIMP LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP Stat(STATSTG* pstatstg, DWORD grfStatFlag) override;
+		STDMETHODIMP Clone(IStream** ppstm) override;
+
+	private:
+		explicit PcmSourceStream(std::shared_ptr<PcmSource> source);
+		virtual ~PcmSourceStream() = default;
+
+		std::atomic<ULONG> m_refCount{ 1 };
+		std::shared_ptr<PcmSource> m_source;
+	};
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace stts {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+// Structure padded due to alignment specifier, this is the point.
+#pragma warning(disable: 4324)
+#endif
+
+	// Lock-free ring buffer for one producer thread and one consumer thread.
+	// Write must only be called by the producer, Read and Skip by the consumer.
+	template <typename T>
+	class SpscRing {
+	public:
+		// Capacity is rounded up to a power of two.
+		explicit SpscRing(size_t capacity)
+		{
+			size_t size = 1;
+			while (size < capacity) size <<= 1;
+
+			m_buffer.resize(size);
+			m_mask = size - 1;
+		}
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		// Returns the number of items written. Items that do not fit are dropped.
+		size_t Write(const T* data, size_t count)
+		{
+			auto head = m_head.load(std::memory_order_relaxed);
+			auto tail = m_tail.load(std::memory_order_acquire);
+
+			auto free = m_buffer.size() - (head - tail);
+			auto written = count < free ? count : free;
+			if (written < count)
+			{
+				m_dropped.fetch_add(count - written, std::memory_order_relaxed);
+			}
+
+			Copy(data, head, written);
+
+			m_head.store(head + written, std::memory_order_release);
+			return written;
+		}
+
+		// Returns the number of items read.
+		size_t Read(T* data, size_t count)
+		{
+			auto tail = m_tail.load(std::memory_order_relaxed);
+			auto head = m_head.load(std::memory_order_acquire);
+
+			auto available = head - tail;
+			auto read = count < available ? count : available;
+
+			auto index = tail & m_mask;
+			auto first = read < m_buffer.size() - index ? read : m_buffer.size() - index;
+			std::memcpy(data, m_buffer.data() + index, first * sizeof(T));
+			std::memcpy(data + first, m_buffer.data(), (read - first) * sizeof(T));
+
+			m_tail.store(tail + read, std::memory_order_release);
+			return read;
+		}
+
+		// Discards everything available to the consumer.
+		size_t Skip()
+		{
+			auto tail = m_tail.load(std::memory_order_relaxed);
+			auto head = m_head.load(std::memory_order_acquire);
+
+			m_tail.store(head, std::memory_order_release);
+			return head - tail;
+		}
+
+		size_t GetReadAvailable() const
+		{
+			return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+		}
+
+		size_t GetCapacity() const { return m_buffer.size(); }
+
+		uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+	private:
+		std::vector<T> m_buffer;
+		size_t m_mask = 0;
+
+		// Positions only grow, indexes are taken modulo the capacity.
+		// Kept on separate cache lines to avoid false sharing between threads.
+		alignas(64) std::atomic<size_t> m_head{ 0 };
+		alignas(64) std::atomic<size_t> m_tail{ 0 };
+		alignas(64) std::atomic<uint64_t> m_dropped{ 0 };
+
+		void Copy(const T* data, size_t head, size_t count)
+		{
+			auto index = head & m_mask;
+			auto first = count < m_buffer.size() - index ? count : m_buffer.size() - index;
+			std::memcpy(m_buffer.data() + index, data, first * sizeof(T));
+			std::memcpy(m_buffer.data(), data + first, (count - first) * sizeof(T));
+		}
+	};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}
@@ -0,0 +1,206 @@
+#include "tapped_audio_input.h"
+
+namespace stts {
+
+    // static
+    HRESULT TappedAudioInput::Create(ISpAudio* pInner, std::shared_ptr<AudioTap> tap, ISpAudio** ppAudio)
+    {
+        if (!pInner || !ppAudio) return E_POINTER;
+
+        auto pAudio = new TappedAudioInput(pInner, std::move(tap));
+
+        // Format may already be set on the device.
+        GUID formatId;
+        WAVEFORMATEX* pFormat = NULL;
+        if (SUCCEEDED(pInner->GetFormat(&formatId, &pFormat)))
+        {
+            pAudio->UpdateTapFormat(pFormat);
+            CoTaskMemFree(pFormat);
+        }
+
+        *ppAudio = pAudio;
+        return S_OK;
+    }
+
+    TappedAudioInput::TappedAudioInput(ISpAudio* pInner, std::shared_ptr<AudioTap> tap) :
+        m_pInner(pInner),
+        m_tap(std::move(tap))
+    {
+        m_pInner->AddRef();
+    }
+
+    TappedAudioInput::~TappedAudioInput()
+    {
+        m_pInner->Release();
+    }
+
+    STDMETHODIMP TappedAudioInput::QueryInterface(REFIID riid, void** ppv)
+    {
+        if (!ppv) return E_POINTER;
+
+        if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream ||
+            riid == IID_ISpStreamFormat || riid == IID_ISpAudio)
+        {
+            *ppv = static_cast<ISpAudio*>(this);
+            AddRef();
+            return S_OK;
+        }
+
+        *ppv = NULL;
+        return E_NOINTERFACE;
+    }
+
+    STDMETHODIMP_(ULONG) TappedAudioInput::AddRef()
+    {
+        return ++m_refCount;
+    }
+
+    STDMETHODIMP_(ULONG) TappedAudioInput::Release()
+    {
+        auto count = --m_refCount;
+        if (count == 0)
+        {
+            delete this;
+        }
+        return count;
+    }
+
+    STDMETHODIMP TappedAudioInput::Read(void* pv, ULONG cb, ULONG* pcbRead)
+    {
+        ULONG read = 0;
+        HRESULT hr = m_pInner->Read(pv, cb, &read);
+        if (pcbRead) *pcbRead = read;
+
+        if (SUCCEEDED(hr) && read >= sizeof(int16_t) &&
+            m_tap->enabled.load(std::memory_order_relaxed) && m_tap->sampleRate.load(std::memory_order_relaxed) != 0)
+        {
+            m_tap->ring.Write(static_cast<const int16_t*>(pv), read / sizeof(int16_t));
+        }
+
+        return hr;
+    }
+
+    STDMETHODIMP TappedAudioInput::Write(const void* pv, ULONG cb, ULONG* pcbWritten)
+    {
+        return m_pInner->Write(pv, cb, pcbWritten);
+    }
+
+    STDMETHODIMP TappedAudioInput::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition)
+    {
+        return m_pInner->Seek(dlibMove, dwOrigin, plibNewPosition);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetSize(ULARGE_INTEGER libNewSize)
+    {
+        return m_pInner->SetSize(libNewSize);
+    }
+
+    STDMETHODIMP TappedAudioInput::CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead, ULARGE_INTEGER* pcbWritten)
+    {
+        return m_pInner->CopyTo(pstm, cb, pcbRead, pcbWritten);
+    }
+
+    STDMETHODIMP TappedAudioInput::Commit(DWORD grfCommitFlags)
+    {
+        return m_pInner->Commit(grfCommitFlags);
+    }
+
+    STDMETHODIMP TappedAudioInput::Revert()
+    {
+        return m_pInner->Revert();
+    }
+
+    STDMETHODIMP TappedAudioInput::LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType)
+    {
+        return m_pInner->LockRegion(libOffset, cb, dwLockType);
+    }
+
+    STDMETHODIMP TappedAudioInput::UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType)
+    {
+        return m_pInner->UnlockRegion(libOffset, cb, dwLockType);
+    }
+
+    STDMETHODIMP TappedAudioInput::Stat(STATSTG* pstatstg, DWORD grfStatFlag)
+    {
+        return m_pInner->Stat(pstatstg, grfStatFlag);
+    }
+
+    STDMETHODIMP TappedAudioInput::Clone(IStream** ppstm)
+    {
+        return m_pInner->Clone(ppstm);
+    }
+
+    STDMETHODIMP TappedAudioInput::GetFormat(GUID* pguidFormatId, WAVEFORMATEX** ppCoMemWaveFormatEx)
+    {
+        return m_pInner->GetFormat(pguidFormatId, ppCoMemWaveFormatEx);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetState(SPAUDIOSTATE NewState, ULONGLONG ullReserved)
+    {
+        return m_pInner->SetState(NewState, ullReserved);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetFormat(REFGUID rguidFmtId, const WAVEFORMATEX* pWaveFormatEx)
+    {
+        HRESULT hr = m_pInner->SetFormat(rguidFmtId, pWaveFormatEx);
+        if (SUCCEEDED(hr))
+        {
+            UpdateTapFormat(rguidFmtId == SPDFID_WaveFormatEx ? pWaveFormatEx : NULL);
+        }
+        return hr;
+    }
+
+    STDMETHODIMP TappedAudioInput::GetStatus(SPAUDIOSTATUS* pStatus)
+    {
+        return m_pInner->GetStatus(pStatus);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetBufferInfo(const SPAUDIOBUFFERINFO* pBuffInfo)
+    {
+        return m_pInner->SetBufferInfo(pBuffInfo);
+    }
+
+    STDMETHODIMP TappedAudioInput::GetBufferInfo(SPAUDIOBUFFERINFO* pBuffInfo)
+    {
+        return m_pInner->GetBufferInfo(pBuffInfo);
+    }
+
+    STDMETHODIMP TappedAudioInput::GetDefaultFormat(GUID* pFormatId, WAVEFORMATEX** ppCoMemWaveFormatEx)
+    {
+        return m_pInner->GetDefaultFormat(pFormatId, ppCoMemWaveFormatEx);
+    }
+
+    STDMETHODIMP_(HANDLE) TappedAudioInput::EventHandle()
+    {
+        return m_pInner->EventHandle();
+    }
+
+    STDMETHODIMP TappedAudioInput::GetVolumeLevel(ULONG* pLevel)
+    {
+        return m_pInner->GetVolumeLevel(pLevel);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetVolumeLevel(ULONG Level)
+    {
+        return m_pInner->SetVolumeLevel(Level);
+    }
+
+    STDMETHODIMP TappedAudioInput::GetBufferNotifySize(ULONG* pcbSize)
+    {
+        return m_pInner->GetBufferNotifySize(pcbSize);
+    }
+
+    STDMETHODIMP TappedAudioInput::SetBufferNotifySize(ULONG cbSize)
+    {
+        return m_pInner->SetBufferNotifySize(cbSize);
+    }
+
+    void TappedAudioInput::UpdateTapFormat(const WAVEFORMATEX* pFormat)
+    {
+        bool isPcm16 = pFormat && pFormat->wFormatTag == WAVE_FORMAT_PCM && pFormat->wBitsPerSample == 16;
+
+        m_tap->channels.store(static_cast<uint16_t>(isPcm16 ? pFormat->nChannels : 0), std::memory_order_relaxed);
+        m_tap->sampleRate.store(isPcm16 ? static_cast<uint32_t>(pFormat->nSamplesPerSec) : 0, std::memory_order_relaxed);
+    }
+
+}
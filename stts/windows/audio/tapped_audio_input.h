@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "audio_tap.h"
+
+#include <sapi.h>
+
+namespace stts {
+
+	// Audio input forwarding everything to the wrapped device, copying the PCM read by the recognizer to a tap.
+	class TappedAudioInput : public ISpAudio
+	{
+	public:
+		// Returned object has a reference count of 1.
+		static HRESULT Create(ISpAudio* pInner, std::shared_ptr<AudioTap> tap, ISpAudio** ppAudio);
+
+		// IUnknown
+		STDMETHODIMP QueryInterface(REFIID riid, void** ppv) override;
+		STDMETHODIMP_(ULONG) AddRef() override;
+		STDMETHODIMP_(ULONG) Release() override;
+
+		// ISequentialStream
+		STDMETHODIMP Read(void* pv, ULONG cb, ULONG* pcbRead) override;
+		STDMETHODIMP Write(const void* pv, ULONG cb, ULONG* pcbWritten) override;
+
+		// IStream
+		STDMETHODIMP Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER* plibNewPosition) override;
+		STDMETHODIMP SetSize(ULARGE_INTEGER libNewSize) override;
+		STDMETHODIMP CopyTo(IStream* pstm, ULARGE_INTEGER cb, ULARGE_INTEGER* pcbRead, ULARGE_INTEGER* pcbWritten) override;
+		STDMETHODIMP Commit(DWORD grfCommitFlags) override;
+		STDMETHODIMP Revert() override;
+		STDMETHODIMP LockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP UnlockRegion(ULARGE_INTEGER libOffset, ULARGE_INTEGER cb, DWORD dwLockType) override;
+		STDMETHODIMP Stat(STATSTG* pstatstg, DWORD grfStatFlag) override;
+		STDMETHODIMP Clone(IStream** ppstm) override;
+
+		// ISpStreamFormat
+		STDMETHODIMP GetFormat(GUID* pguidFormatId, WAVEFORMATEX** ppCoMemWaveFormatEx) override;
+
+		// ISpAudio
+		STDMETHODIMP SetState(SPAUDIOSTATE NewState, ULONGLONG ullReserved) override;
+		STDMETHODIMP SetFormat(REFGUID rguidFmtId, const WAVEFORMATEX* pWaveFormatEx) override;
+		STDMETHODIMP GetStatus(SPAUDIOSTATUS* pStatus) override;
+		STDMETHODIMP SetBufferInfo(const SPAUDIOBUFFERINFO* pBuffInfo) override;
+		STDMETHODIMP GetBufferInfo(SPAUDIOBUFFERINFO* pBuffInfo) override;
+		STDMETHODIMP GetDefaultFormat(GUID* pFormatId, WAVEFORMATEX** ppCoMemWaveFormatEx) override;
+		STDMETHODIMP_(HANDLE) EventHandle() override;
+		STDMETHODIMP GetVolumeLevel(ULONG* pLevel) override;
+		STDMETHODIMP SetVolumeLevel(ULONG Level) override;
+		STDMETHODIMP GetBufferNotifySize(ULONG* pcbSize) override;
+		STDMETHODIMP SetBufferNotifySize(ULONG cbSize) override;
+
+	private:
+		TappedAudioInput(ISpAudio* pInner, std::shared_ptr<AudioTap> tap);
+		virtual ~TappedAudioInput();
+
+		std::atomic<ULONG> m_refCount{ 1 };
+		ISpAudio* m_pInner;
+		std::shared_ptr<AudioTap> m_tap;
+
+		void UpdateTapFormat(const WAVEFORMATEX* pFormat);
+	};
+
+}
@@ -0,0 +1,105 @@
+#include "wav_reader.h"
+
+#include <cstring>
+
+namespace stts {
+
+    static const uint16_t kWaveFormatPcm = 0x0001;
+    static const uint16_t kWaveFormatExtensible = 0xFFFE;
+
+    // KSDATAFORMAT_SUBTYPE_PCM, without the leading format tag.
+    static const uint8_t kPcmSubFormatTail[14] = {
+        0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+    };
+
+    static uint16_t ReadUint16(const uint8_t* data)
+    {
+        return static_cast<uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    static uint32_t ReadUint32(const uint8_t* data)
+    {
+        return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+    }
+
+    bool PcmFormat::IsValid() const
+    {
+        return channels > 0 && sampleRate > 0 && (bitsPerSample == 8 || bitsPerSample == 16);
+    }
+
+    static WavError ReadFormat(const uint8_t* chunk, size_t size, PcmFormat& format)
+    {
+        if (size < 16) return WavError::truncated;
+
+        auto formatTag = ReadUint16(chunk);
+        format.channels = ReadUint16(chunk + 2);
+        format.sampleRate = ReadUint32(chunk + 4);
+        format.bitsPerSample = ReadUint16(chunk + 14);
+
+        if (formatTag == kWaveFormatExtensible)
+        {
+            // cbSize, valid bits, channel mask then sub format GUID.
+            if (size < 40) return WavError::truncated;
+
+            if (ReadUint16(chunk + 24) != kWaveFormatPcm ||
+                std::memcmp(chunk + 26, kPcmSubFormatTail, sizeof(kPcmSubFormatTail)) != 0)
+            {
+                return WavError::unsupportedFormat;
+            }
+        }
+        else if (formatTag != kWaveFormatPcm)
+        {
+            return WavError::unsupportedFormat;
+        }
+
+        return format.IsValid() ? WavError::none : WavError::unsupportedFormat;
+    }
+
+    WavError ParseWav(const uint8_t* data, size_t size, WavInfo& info)
+    {
+        if (size < 12) return WavError::truncated;
+
+        if (std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0)
+        {
+            return WavError::notRiff;
+        }
+
+        bool hasFormat = false;
+        size_t offset = 12;
+
+        while (size - offset >= 8)
+        {
+            auto chunkSize = static_cast<size_t>(ReadUint32(data + offset + 4));
+            auto chunkData = offset + 8;
+            auto available = size - chunkData;
+
+            if (std::memcmp(data + offset, "fmt ", 4) == 0)
+            {
+                auto error = ReadFormat(data + chunkData, chunkSize < available ? chunkSize : available, info.format);
+                if (error != WavError::none) return error;
+
+                hasFormat = true;
+            }
+            else if (std::memcmp(data + offset, "data", 4) == 0)
+            {
+                if (!hasFormat) return WavError::missingFormat;
+
+                info.dataOffset = chunkData;
+                info.dataSize = chunkSize < available ? chunkSize : available;
+
+                // Whole blocks only.
+                info.dataSize -= info.dataSize % info.format.GetBlockAlign();
+                return WavError::none;
+            }
+
+            if (chunkSize >= available) break;
+
+            // Chunks are word aligned.
+            offset = chunkData + chunkSize + (chunkSize & 1);
+        }
+
+        return hasFormat ? WavError::missingData : WavError::missingFormat;
+    }
+
+}
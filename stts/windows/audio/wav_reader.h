@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stts {
+
+	struct PcmFormat {
+		uint16_t channels = 1;
+		uint32_t sampleRate = 16000;
+		uint16_t bitsPerSample = 16;
+
+		uint16_t GetBlockAlign() const { return static_cast<uint16_t>(channels * bitsPerSample / 8); }
+		uint32_t GetByteRate() const { return sampleRate * GetBlockAlign(); }
+		bool IsValid() const;
+	};
+
+	enum class WavError {
+		none,
+		truncated,
+		notRiff,
+		missingFormat,
+		missingData,
+		// Only integer PCM with 8 or 16 bits per sample is supported.
+		unsupportedFormat,
+	};
+
+	struct WavInfo {
+		PcmFormat format;
+		size_t dataOffset = 0;
+		size_t dataSize = 0;
+	};
+
+	// Reads the format and locates the samples of a RIFF/WAVE file in memory.
+	// Unknown chunks are skipped. A data chunk shorter than declared is clamped to the available bytes.
+	WavError ParseWav(const uint8_t* data, size_t size, WavInfo& info);
+
+}
@@ -0,0 +1,101 @@
+#include "wav_writer.h"
+
+#include <cstring>
+#include <filesystem>
+
+namespace stts {
+
+    static void WriteUint16(uint8_t* data, uint16_t value)
+    {
+        data[0] = static_cast<uint8_t>(value);
+        data[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    static void WriteUint32(uint8_t* data, uint32_t value)
+    {
+        data[0] = static_cast<uint8_t>(value);
+        data[1] = static_cast<uint8_t>(value >> 8);
+        data[2] = static_cast<uint8_t>(value >> 16);
+        data[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    void WriteWavHeader(const PcmFormat& format, uint32_t dataSize, uint8_t* header)
+    {
+        if (dataSize > kWavMaxDataSize) dataSize = kWavMaxDataSize;
+
+        std::memcpy(header, "RIFF", 4);
+        WriteUint32(header + 4, static_cast<uint32_t>(kWavHeaderSize - 8) + dataSize + (dataSize & 1));
+        std::memcpy(header + 8, "WAVE", 4);
+
+        std::memcpy(header + 12, "fmt ", 4);
+        WriteUint32(header + 16, 16);
+        WriteUint16(header + 20, 1);
+        WriteUint16(header + 22, format.channels);
+        WriteUint32(header + 24, format.sampleRate);
+        WriteUint32(header + 28, format.GetByteRate());
+        WriteUint16(header + 32, format.GetBlockAlign());
+        WriteUint16(header + 34, format.bitsPerSample);
+
+        std::memcpy(header + 36, "data", 4);
+        WriteUint32(header + 40, dataSize);
+    }
+
+    std::vector<uint8_t> EncodeWav(const PcmFormat& format, const uint8_t* samples, size_t size)
+    {
+        if (size > kWavMaxDataSize) size = kWavMaxDataSize;
+
+        std::vector<uint8_t> bytes(kWavHeaderSize + size + (size & 1));
+        WriteWavHeader(format, static_cast<uint32_t>(size), bytes.data());
+        if (size > 0) std::memcpy(bytes.data() + kWavHeaderSize, samples, size);
+
+        return bytes;
+    }
+
+    WavFileWriter::~WavFileWriter()
+    {
+        Finish();
+    }
+
+    bool WavFileWriter::Open(const std::string& utf8Path, const PcmFormat& format)
+    {
+        if (m_file.is_open() || !format.IsValid()) return false;
+
+        m_file.open(std::filesystem::u8path(utf8Path), std::ios::binary | std::ios::trunc);
+        if (!m_file) return false;
+
+        m_format = format;
+        m_dataSize = 0;
+
+        // Largest size until Finish, so a reader of an unfinished file takes everything written so far.
+        uint8_t header[kWavHeaderSize];
+        WriteWavHeader(format, kWavMaxDataSize, header);
+        return static_cast<bool>(m_file.write(reinterpret_cast<const char*>(header), sizeof(header)));
+    }
+
+    bool WavFileWriter::Write(const uint8_t* data, size_t size)
+    {
+        if (!m_file.is_open() || size > kWavMaxDataSize - m_dataSize) return false;
+
+        if (!m_file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size))) return false;
+
+        m_dataSize += static_cast<uint32_t>(size);
+        return true;
+    }
+
+    bool WavFileWriter::Finish()
+    {
+        if (!m_file.is_open()) return false;
+
+        if (m_dataSize & 1) m_file.put(0);
+
+        uint8_t header[kWavHeaderSize];
+        WriteWavHeader(m_format, m_dataSize, header);
+
+        m_file.seekp(0);
+        bool written = static_cast<bool>(m_file.write(reinterpret_cast<const char*>(header), sizeof(header)));
+        m_file.close();
+
+        return written && !m_file.fail();
+    }
+
+}
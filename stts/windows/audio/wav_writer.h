@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "pcm_sink.h"
+#include "wav_reader.h"
+
+namespace stts {
+
+	// Canonical RIFF/WAVE header: fmt chunk with PCM format tag, then data chunk.
+	static const size_t kWavHeaderSize = 44;
+
+	// Largest data chunk size a RIFF file can declare, with room for the pad byte.
+	static const uint32_t kWavMaxDataSize = 0xFFFFFFFF - kWavHeaderSize;
+
+	void WriteWavHeader(const PcmFormat& format, uint32_t dataSize, uint8_t* header);
+
+	// Whole WAV file content in memory. Odd sized data is followed by a pad byte, as RIFF requires.
+	std::vector<uint8_t> EncodeWav(const PcmFormat& format, const uint8_t* samples, size_t size);
+
+	// Streams samples to a WAV file as they are rendered.
+	//
+	// Chunk sizes are written as the largest allowed first and updated by Finish.
+	// A file left unfinished is still read by ParseWav, which clamps the data chunk to the file size.
+	class WavFileWriter : public PcmSink {
+	public:
+		~WavFileWriter() override;
+
+		bool Open(const std::string& utf8Path, const PcmFormat& format);
+		bool Write(const uint8_t* data, size_t size) override;
+
+		// Writes the final sizes and closes the file.
+		bool Finish();
+
+		bool IsOpen() const { return m_file.is_open(); }
+		uint32_t GetDataSize() const { return m_dataSize; }
+
+	private:
+		std::ofstream m_file;
+		PcmFormat m_format;
+		uint32_t m_dataSize = 0;
+	};
+
+}
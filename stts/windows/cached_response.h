@@ -0,0 +1,35 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace stts {
+
+	// Encoded response of a query which only changes when engines are installed or removed.
+	// Keyed by the generation of the engine catalog, see EngineCatalog::GetGeneration.
+	//
+	// Not thread safe: used on the engine worker, like the catalogs.
+	class CachedResponse {
+	public:
+		// Builds the value again when generation changed. Generation 0 is never cached.
+		// The value is shared with replies not sent yet, it is never modified once built.
+		template <typename Build>
+		std::shared_ptr<const flutter::EncodableValue> Get(uint64_t generation, Build build)
+		{
+			if (generation == 0 || generation != m_generation)
+			{
+				m_value = std::make_shared<const flutter::EncodableValue>(build());
+				m_generation = generation;
+			}
+
+			return m_value;
+		}
+
+	private:
+		uint64_t m_generation = 0;
+		std::shared_ptr<const flutter::EncodableValue> m_value;
+	};
+
+}
@@ -0,0 +1,165 @@
+#include "engine_catalog.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace stts {
+
+    EngineCatalog::EngineCatalog(std::unique_ptr<EngineTokenSource> source) :
+        m_source(std::move(source))
+    {
+    }
+
+    const std::vector<EngineToken>& EngineCatalog::GetTokens()
+    {
+        Refresh();
+        return m_tokens;
+    }
+
+    const std::vector<std::string>& EngineCatalog::GetLanguages()
+    {
+        Refresh();
+        return m_languages;
+    }
+
+    const EngineToken* EngineCatalog::FindById(const std::string& id)
+    {
+        Refresh();
+
+        auto it = m_byId.find(id);
+        return it != m_byId.end() ? &m_tokens[it->second] : nullptr;
+    }
+
+    const EngineToken* EngineCatalog::FindByTokenId(const std::wstring& tokenId)
+    {
+        Refresh();
+
+        auto it = m_byTokenId.find(tokenId);
+        return it != m_byTokenId.end() ? &m_tokens[it->second] : nullptr;
+    }
+
+    const EngineToken* EngineCatalog::FindByLanguage(const std::string& language)
+    {
+        Refresh();
+
+        auto normalized = NormalizeLanguage(language);
+
+        auto it = m_byLanguage.find(normalized);
+        if (it != m_byLanguage.end())
+        {
+            return &m_tokens[it->second.front()];
+        }
+
+        auto prefixIt = m_byLanguagePrefix.find(GetLanguagePrefix(normalized));
+        return prefixIt != m_byLanguagePrefix.end() ? &m_tokens[prefixIt->second] : nullptr;
+    }
+
+    std::vector<const EngineToken*> EngineCatalog::GetByLanguage(const std::string& language)
+    {
+        Refresh();
+
+        std::vector<const EngineToken*> tokens;
+
+        auto it = m_byLanguage.find(NormalizeLanguage(language));
+        if (it != m_byLanguage.end())
+        {
+            tokens.reserve(it->second.size());
+            for (auto index : it->second)
+            {
+                tokens.push_back(&m_tokens[index]);
+            }
+        }
+
+        return tokens;
+    }
+
+    uint64_t EngineCatalog::GetGeneration()
+    {
+        Refresh();
+        return m_generation;
+    }
+
+    void EngineCatalog::Invalidate()
+    {
+        m_isStale = true;
+    }
+
+    void EngineCatalog::Refresh()
+    {
+        // Always query the source so its change tracking is re-armed.
+        if (m_source->HasChanged() || m_isStale)
+        {
+            Rebuild();
+        }
+    }
+
+    void EngineCatalog::Rebuild()
+    {
+        m_tokens = m_source->Enumerate();
+        m_isStale = false;
+        m_generation++;
+
+        m_languages.clear();
+        m_byId.clear();
+        m_byTokenId.clear();
+        m_byLanguage.clear();
+        m_byLanguagePrefix.clear();
+
+        std::unordered_set<std::string> languages;
+
+        m_byId.reserve(m_tokens.size());
+        m_byTokenId.reserve(m_tokens.size());
+
+        for (size_t i = 0; i < m_tokens.size(); i++)
+        {
+            const auto& token = m_tokens[i];
+
+            // First token wins for duplicated identifiers.
+            m_byId.emplace(token.id, i);
+            m_byTokenId.emplace(token.tokenId, i);
+
+            if (token.language.empty()) continue;
+
+            if (languages.insert(NormalizeLanguage(token.language)).second)
+            {
+                m_languages.push_back(token.language);
+            }
+
+            Index(token.language, i);
+
+            for (const auto& language : token.additionalLanguages)
+            {
+                Index(language, i);
+            }
+        }
+    }
+
+    void EngineCatalog::Index(const std::string& language, size_t tokenIndex)
+    {
+        auto normalized = NormalizeLanguage(language);
+
+        auto& languageTokens = m_byLanguage[normalized];
+        if (languageTokens.empty() || languageTokens.back() != tokenIndex)
+        {
+            languageTokens.push_back(tokenIndex);
+        }
+
+        m_byLanguagePrefix.emplace(GetLanguagePrefix(normalized), tokenIndex);
+    }
+
+    std::string EngineCatalog::NormalizeLanguage(const std::string& language)
+    {
+        std::string normalized(language);
+        std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) {
+            return c == '_' ? '-' : static_cast<char>(std::tolower(c));
+        });
+        return normalized;
+    }
+
+    std::string EngineCatalog::GetLanguagePrefix(const std::string& normalizedLanguage)
+    {
+        return normalizedLanguage.substr(0, normalizedLanguage.find('-'));
+    }
+
+}
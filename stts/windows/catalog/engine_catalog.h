@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace stts {
+
+	// Engine token (voice or recognizer) as described by its registry attributes.
+	struct EngineToken {
+		// Object token ID, used to re-open the token when selecting it.
+		std::wstring tokenId;
+		// Public identifier (CLSID).
+		std::string id;
+		std::string name;
+		// BCP-47 language code (e.g. fr-FR).
+		std::string language;
+		// Other declared languages, if any (e.g. en for 409;9).
+		std::vector<std::string> additionalLanguages;
+		// Raw gender attribute (e.g. Male, Female), may be empty.
+		std::string gender;
+	};
+
+	// Provides engine tokens to the catalog.
+	// Implementations must not depend on the catalog itself so the index can be fed with any source.
+	class EngineTokenSource {
+	public:
+		virtual ~EngineTokenSource() = default;
+
+		// Returns all tokens of the category, in enumeration order.
+		virtual std::vector<EngineToken> Enumerate() = 0;
+
+		// Returns true if tokens may have changed since the last call to Enumerate.
+		virtual bool HasChanged() = 0;
+	};
+
+	// In-memory index of engine tokens.
+	// The index is built once from the source and rebuilt only when the source reports a change.
+	// Returned pointers and references are valid until the next call to a non-const method.
+	class EngineCatalog {
+	public:
+		explicit EngineCatalog(std::unique_ptr<EngineTokenSource> source);
+
+		// Returns all tokens in enumeration order.
+		const std::vector<EngineToken>& GetTokens();
+
+		// Returns distinct main languages in enumeration order.
+		const std::vector<std::string>& GetLanguages();
+
+		// Finds the first token with the given public identifier.
+		const EngineToken* FindById(const std::string& id);
+
+		// Finds the token with the given object token ID.
+		const EngineToken* FindByTokenId(const std::wstring& tokenId);
+
+		// Finds the first token matching the language (case insensitive).
+		// Falls back to the first token sharing the same primary language subtag (e.g. fr for fr-CA).
+		const EngineToken* FindByLanguage(const std::string& language);
+
+		// Returns all tokens matching exactly the language (case insensitive), including additional languages.
+		std::vector<const EngineToken*> GetByLanguage(const std::string& language);
+
+		// Incremented each time the index is rebuilt.
+		uint64_t GetGeneration();
+
+		// Forces a rebuild on next access.
+		void Invalidate();
+
+	private:
+		std::unique_ptr<EngineTokenSource> m_source;
+		bool m_isStale = true;
+		uint64_t m_generation = 0;
+
+		std::vector<EngineToken> m_tokens;
+		std::vector<std::string> m_languages;
+		std::unordered_map<std::string, size_t> m_byId;
+		std::unordered_map<std::wstring, size_t> m_byTokenId;
+		std::unordered_map<std::string, std::vector<size_t>> m_byLanguage;
+		std::unordered_map<std::string, size_t> m_byLanguagePrefix;
+
+		void Refresh();
+		void Rebuild();
+		void Index(const std::string& language, size_t tokenIndex);
+
+		static std::string NormalizeLanguage(const std::string& language);
+		static std::string GetLanguagePrefix(const std::string& normalizedLanguage);
+	};
+
+}
@@ -0,0 +1,195 @@
+#include "sapi_token_source.h"
+#include "../utils.h"
+#include "../locale/lcid_table.h"
+
+namespace stts {
+
+    SapiTokenSource::SapiTokenSource(const WCHAR* categoryId) :
+        m_categoryId(categoryId)
+    {
+        // Category IDs are registry paths (e.g. HKEY_LOCAL_MACHINE\SOFTWARE\Microsoft\Speech\Voices).
+        // Tokens can be registered either machine wide or per user, so both hives are watched.
+        const std::wstring hklm = L"HKEY_LOCAL_MACHINE\\";
+        if (m_categoryId.compare(0, hklm.size(), hklm) == 0)
+        {
+            auto subKey = m_categoryId.substr(hklm.size());
+            Watch(HKEY_LOCAL_MACHINE, subKey);
+            Watch(HKEY_CURRENT_USER, subKey);
+        }
+    }
+
+    SapiTokenSource::~SapiTokenSource()
+    {
+        for (auto& watch : m_watches)
+        {
+            RegCloseKey(watch.key);
+            CloseHandle(watch.event);
+        }
+    }
+
+    std::vector<EngineToken> SapiTokenSource::Enumerate()
+    {
+        std::vector<EngineToken> tokens;
+
+        IEnumSpObjectTokens* cpEnum = NULL;
+        ThrowIfFailed(SpEnumTokens(m_categoryId.c_str(), NULL, NULL, &cpEnum));
+
+        ULONG count = 0;
+        if (SUCCEEDED(cpEnum->GetCount(&count)))
+        {
+            tokens.reserve(count);
+        }
+
+        ISpObjectToken* pToken = NULL;
+        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
+        {
+            EngineToken token;
+
+            LPWSTR wValue;
+            if (SUCCEEDED(pToken->GetId(&wValue)))
+            {
+                token.tokenId = wValue;
+                CoTaskMemFree(wValue);
+            }
+
+            token.id = GetStringValue(pToken, L"CLSID");
+
+            ISpDataKey* cpAttribKey;
+            if (SUCCEEDED(pToken->OpenKey(L"Attributes", &cpAttribKey)))
+            {
+                ReadLanguages(cpAttribKey, token);
+                token.name = GetStringValue(cpAttribKey, L"Name");
+                token.gender = GetStringValue(cpAttribKey, L"Gender");
+
+                cpAttribKey->Release();
+            }
+
+            pToken->Release();
+
+            tokens.push_back(std::move(token));
+        }
+
+        cpEnum->Release();
+
+        return tokens;
+    }
+
+    bool SapiTokenSource::HasChanged()
+    {
+        bool changed = false;
+
+        for (auto& watch : m_watches)
+        {
+            if (WaitForSingleObject(watch.event, 0) == WAIT_OBJECT_0)
+            {
+                changed = true;
+                // Notifications are one-shot.
+                Arm(watch);
+            }
+        }
+
+        return changed;
+    }
+
+    void SapiTokenSource::Watch(HKEY root, const std::wstring& subKey)
+    {
+        RegistryWatch watch{};
+        if (RegOpenKeyExW(root, subKey.c_str(), 0, KEY_NOTIFY, &watch.key) != ERROR_SUCCESS)
+        {
+            return;
+        }
+
+        // Manual reset, so a change is kept until it is consumed by HasChanged.
+        watch.event = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (watch.event == NULL)
+        {
+            RegCloseKey(watch.key);
+            return;
+        }
+
+        if (!Arm(watch))
+        {
+            CloseHandle(watch.event);
+            RegCloseKey(watch.key);
+            return;
+        }
+
+        m_watches.push_back(watch);
+    }
+
+    // static
+    bool SapiTokenSource::Arm(const RegistryWatch& watch)
+    {
+        ResetEvent(watch.event);
+
+        return RegNotifyChangeKeyValue(
+            watch.key,
+            TRUE,
+            REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+            watch.event,
+            TRUE
+        ) == ERROR_SUCCESS;
+    }
+
+    // static
+    void SapiTokenSource::ReadLanguages(ISpDataKey* pAttribKey, EngineToken& token)
+    {
+        LPWSTR wValue;
+        if (FAILED(pAttribKey->GetStringValue(L"Language", &wValue)))
+        {
+            return;
+        }
+
+        // We get value as locale identifiers (e.g. 0x40C as String, or "409;9" for multiple languages).
+        // We need to convert them to ISO codes.
+        ForEachLcidLocale(std::wstring_view(wValue), [&token](uint32_t lcid, std::string_view localeName) {
+            std::string language;
+
+            if (!localeName.empty())
+            {
+                language = localeName;
+            }
+            else
+            {
+                // Not in the static table, ask the system.
+                wchar_t locale[LOCALE_NAME_MAX_LENGTH];
+                if (LCIDToLocaleName((LCID)lcid, locale, LOCALE_NAME_MAX_LENGTH, 0) > 0)
+                {
+                    language = Utf8FromUtf16(locale);
+                }
+            }
+
+            if (language.empty()) return;
+
+            if (token.language.empty()) token.language = std::move(language);
+            else token.additionalLanguages.push_back(std::move(language));
+        });
+
+        CoTaskMemFree(wValue);
+    }
+
+    // static
+    std::string SapiTokenSource::GetStringValue(ISpDataKey* pKey, LPCWSTR valueName)
+    {
+        LPWSTR wValue;
+        if (FAILED(pKey->GetStringValue(valueName, &wValue)))
+        {
+            return "";
+        }
+
+        auto value = Utf8FromUtf16(wValue);
+        CoTaskMemFree(wValue);
+
+        return value;
+    }
+
+    // static
+    void SapiTokenSource::ThrowIfFailed(HRESULT code)
+    {
+        if (FAILED(code))
+        {
+            throw code;
+        }
+    }
+
+}
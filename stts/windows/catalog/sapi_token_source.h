@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "engine_catalog.h"
+
+#include <sapi.h>
+#pragma warning(disable:4996)
+#include <sphelper.h>
+#pragma warning(default: 4996)
+
+namespace stts {
+
+	// Enumerates SAPI object tokens of a category (e.g. SPCAT_VOICES).
+	// Changes are detected by watching the category registry keys, so enumeration only happens
+	// when a token is installed, removed or updated.
+	class SapiTokenSource : public EngineTokenSource {
+	public:
+		explicit SapiTokenSource(const WCHAR* categoryId);
+		~SapiTokenSource();
+
+		// Disallow copy and assign.
+		SapiTokenSource(const SapiTokenSource&) = delete;
+		SapiTokenSource& operator=(const SapiTokenSource&) = delete;
+
+		std::vector<EngineToken> Enumerate() override;
+		bool HasChanged() override;
+
+	private:
+		struct RegistryWatch {
+			HKEY key;
+			HANDLE event;
+		};
+
+		std::wstring m_categoryId;
+		std::vector<RegistryWatch> m_watches;
+
+		void Watch(HKEY root, const std::wstring& subKey);
+		static bool Arm(const RegistryWatch& watch);
+		static void ReadLanguages(ISpDataKey* pAttribKey, EngineToken& token);
+		static std::string GetStringValue(ISpDataKey* pKey, LPCWSTR valueName);
+		static void ThrowIfFailed(HRESULT code);
+	};
+
+}
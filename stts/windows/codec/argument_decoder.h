@@ -0,0 +1,189 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "method_table.h"
+
+namespace stts {
+
+	// Map key of a method call argument and the member it is decoded to.
+	template <typename Owner, typename T>
+	struct ArgumentField {
+		std::string_view name;
+		uint32_t hash;
+		T Owner::* member;
+	};
+
+	template <typename Owner, typename T>
+	constexpr ArgumentField<Owner, T> Field(std::string_view name, T Owner::* member)
+	{
+		return { name, HashName(name), member };
+	}
+
+	// Arguments of methods taking none.
+	struct NoArguments {
+		static constexpr std::tuple<> GetFields() { return {}; }
+	};
+
+	// Decoders of a single value, false if its type does not match.
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, bool& out)
+	{
+		const auto* decoded = std::get_if<bool>(&value);
+		if (!decoded) return false;
+
+		out = *decoded;
+		return true;
+	}
+
+	// Dart integers are encoded either as int32 or int64 depending on their value.
+	inline bool DecodeArgument(const flutter::EncodableValue& value, int32_t& out)
+	{
+		if (const auto* decoded = std::get_if<int32_t>(&value))
+		{
+			out = *decoded;
+			return true;
+		}
+
+		const auto* decoded = std::get_if<int64_t>(&value);
+		if (!decoded || *decoded < (std::numeric_limits<int32_t>::min)() || *decoded > (std::numeric_limits<int32_t>::max)()) return false;
+
+		out = static_cast<int32_t>(*decoded);
+		return true;
+	}
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, int64_t& out)
+	{
+		if (!std::holds_alternative<int32_t>(value) && !std::holds_alternative<int64_t>(value)) return false;
+
+		out = value.LongValue();
+		return true;
+	}
+
+	// Integers are accepted as well.
+	inline bool DecodeArgument(const flutter::EncodableValue& value, double& out)
+	{
+		if (const auto* decoded = std::get_if<double>(&value))
+		{
+			out = *decoded;
+			return true;
+		}
+
+		int64_t integer;
+		if (!DecodeArgument(value, integer)) return false;
+
+		out = static_cast<double>(integer);
+		return true;
+	}
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, std::string& out)
+	{
+		const auto* decoded = std::get_if<std::string>(&value);
+		if (!decoded) return false;
+
+		out = *decoded;
+		return true;
+	}
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, std::vector<uint8_t>& out)
+	{
+		const auto* decoded = std::get_if<std::vector<uint8_t>>(&value);
+		if (!decoded) return false;
+
+		out = *decoded;
+		return true;
+	}
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, std::vector<std::string>& out)
+	{
+		const auto* list = std::get_if<flutter::EncodableList>(&value);
+		if (!list) return false;
+
+		out.clear();
+		out.reserve(list->size());
+		for (const auto& item : *list)
+		{
+			const auto* decoded = std::get_if<std::string>(&item);
+			if (!decoded) return false;
+
+			out.push_back(*decoded);
+		}
+		return true;
+	}
+
+	inline bool DecodeArgument(const flutter::EncodableValue& value, flutter::EncodableMap& out)
+	{
+		const auto* decoded = std::get_if<flutter::EncodableMap>(&value);
+		if (!decoded) return false;
+
+		out = *decoded;
+		return true;
+	}
+
+	template <typename Args>
+	bool DecodeArguments(const flutter::EncodableValue* arguments, Args& args);
+
+	// Present or not.
+	template <typename T>
+	bool DecodeArgument(const flutter::EncodableValue& value, std::optional<T>& out)
+	{
+		T decoded{};
+		if (!DecodeArgument(value, decoded)) return false;
+
+		out = std::move(decoded);
+		return true;
+	}
+
+	// Nested map of arguments.
+	template <typename T, typename = decltype(T::GetFields())>
+	bool DecodeArgument(const flutter::EncodableValue& value, T& out)
+	{
+		return DecodeArguments(&value, out);
+	}
+
+	// Decodes a map of arguments to the fields listed by Args::GetFields() in a single pass over the map.
+	// Unknown keys and null values are ignored, members keep their defaults.
+	// Returns false if arguments are not a map or one of them has another type.
+	template <typename Args>
+	bool DecodeArguments(const flutter::EncodableValue* arguments, Args& args)
+	{
+		if (!arguments || arguments->IsNull()) return true;
+
+		const auto* map = std::get_if<flutter::EncodableMap>(arguments);
+		if (!map) return false;
+
+		constexpr auto fields = Args::GetFields();
+		if constexpr (std::tuple_size_v<decltype(fields)> == 0)
+		{
+			return true;
+		}
+		else
+		{
+			for (const auto& [key, value] : *map)
+			{
+				const auto* name = std::get_if<std::string>(&key);
+				if (!name || value.IsNull()) continue;
+
+				auto hash = HashName(*name);
+				bool decoded = true;
+
+				// Stops at the matching field.
+				std::apply([&](const auto&... field) {
+					(void)((field.hash == hash && field.name == *name && (decoded = DecodeArgument(value, args.*(field.member)), true)) || ...);
+				}, fields);
+
+				if (!decoded) return false;
+			}
+
+			return true;
+		}
+	}
+
+}
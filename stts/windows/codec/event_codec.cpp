@@ -0,0 +1,99 @@
+#include "event_codec.h"
+
+#include <algorithm>
+
+namespace stts {
+
+    void EventEncoder::Write(const EventRecord& record)
+    {
+        auto offset = m_buffer.size();
+        m_buffer.resize(offset + kEventHeaderSize + record.payload.size());
+
+        m_buffer[offset] = static_cast<uint8_t>((static_cast<uint8_t>(record.type) & 0x0F) | ((record.flags & 0x0F) << 4));
+        m_buffer[offset + 1] = 0;
+        m_buffer[offset + 2] = 0;
+        m_buffer[offset + 3] = 0;
+        WriteUint32(offset + 4, record.sequence);
+        WriteInt64(offset + 8, record.timestamp);
+        WriteUint32(offset + 16, record.arg0);
+        WriteUint32(offset + 20, record.arg1);
+        WriteUint32(offset + 24, static_cast<uint32_t>(record.payload.size()));
+
+        std::copy(record.payload.begin(), record.payload.end(), m_buffer.begin() + offset + kEventHeaderSize);
+
+        m_count++;
+    }
+
+    void EventEncoder::Clear()
+    {
+        m_buffer.clear();
+        m_count = 0;
+    }
+
+    void EventEncoder::WriteUint32(size_t offset, uint32_t value)
+    {
+        for (size_t i = 0; i < 4; i++)
+        {
+            m_buffer[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+    }
+
+    void EventEncoder::WriteInt64(size_t offset, int64_t value)
+    {
+        auto bits = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < 8; i++)
+        {
+            m_buffer[offset + i] = static_cast<uint8_t>(bits >> (i * 8));
+        }
+    }
+
+    bool EventDecoder::Next(EventRecord& record)
+    {
+        if (m_offset >= m_size) return false;
+
+        if (m_size - m_offset < kEventHeaderSize)
+        {
+            m_corrupted = true;
+            return false;
+        }
+
+        auto length = ReadUint32(m_offset + 24);
+        if (m_size - m_offset - kEventHeaderSize < length)
+        {
+            m_corrupted = true;
+            return false;
+        }
+
+        record.type = static_cast<EventType>(m_data[m_offset] & 0x0F);
+        record.flags = static_cast<uint8_t>(m_data[m_offset] >> 4);
+        record.sequence = ReadUint32(m_offset + 4);
+        record.timestamp = ReadInt64(m_offset + 8);
+        record.arg0 = ReadUint32(m_offset + 16);
+        record.arg1 = ReadUint32(m_offset + 20);
+        record.payload = std::string_view(reinterpret_cast<const char*>(m_data + m_offset + kEventHeaderSize), length);
+
+        m_offset += kEventHeaderSize + length;
+        return true;
+    }
+
+    uint32_t EventDecoder::ReadUint32(size_t offset) const
+    {
+        uint32_t value = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            value |= static_cast<uint32_t>(m_data[offset + i]) << (i * 8);
+        }
+        return value;
+    }
+
+    int64_t EventDecoder::ReadInt64(size_t offset) const
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < 8; i++)
+        {
+            value |= static_cast<uint64_t>(m_data[offset + i]) << (i * 8);
+        }
+        return static_cast<int64_t>(value);
+    }
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace stts {
+
+	// Compact encoding of high frequency events, sent as a single byte array instead of one map per event.
+	//
+	// A message is a sequence of records. All integers are little endian.
+	//   offset  size  field
+	//   0       1     type (low 4 bits) | flags (high 4 bits)
+	//   1       3     reserved, zero
+	//   4       4     sequence
+	//   8       8     timestamp
+	//   16      4     arg0
+	//   20      4     arg1
+	//   24      4     payload length in bytes
+	//   28      n     payload, UTF-8
+	enum class EventType : uint8_t {
+		// sequence: revision, arg0: stable length, payload: unstable suffix.
+		hypothesis = 1,
+		// sequence: phrase sequence, arg0: offset ms, arg1: duration ms, payload: text.
+		result = 2,
+		// sequence: utterance, arg0: text offset, arg1: text length, payload: bookmark name.
+		// Offsets are in UTF-16 code units. Words unless flagged as sentence or bookmark.
+		progress = 3,
+	};
+
+	enum EventFlags : uint8_t {
+		eventFlagFinal = 0x1,
+		// arg0 and arg1 are set.
+		eventFlagHasTimes = 0x2,
+		eventFlagSentence = 0x4,
+		eventFlagBookmark = 0x8,
+	};
+
+	struct EventRecord {
+		EventType type = EventType::result;
+		uint8_t flags = 0;
+		uint32_t sequence = 0;
+		int64_t timestamp = 0;
+		uint32_t arg0 = 0;
+		uint32_t arg1 = 0;
+		std::string_view payload;
+	};
+
+	constexpr size_t kEventHeaderSize = 28;
+
+	class EventEncoder {
+	public:
+		void Write(const EventRecord& record);
+
+		bool IsEmpty() const { return m_buffer.empty(); }
+		size_t GetCount() const { return m_count; }
+		const std::vector<uint8_t>& GetBuffer() const { return m_buffer; }
+
+		// Keeps the allocated capacity for the next message.
+		void Clear();
+
+	private:
+		std::vector<uint8_t> m_buffer;
+		size_t m_count = 0;
+
+		void WriteUint32(size_t offset, uint32_t value);
+		void WriteInt64(size_t offset, int64_t value);
+	};
+
+	class EventDecoder {
+	public:
+		EventDecoder(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+		// Reads the next record. The payload points into the decoded data.
+		// Returns false at the end of data or on a truncated record.
+		bool Next(EventRecord& record);
+
+		bool IsCorrupted() const { return m_corrupted; }
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+		size_t m_offset = 0;
+		bool m_corrupted = false;
+
+		uint32_t ReadUint32(size_t offset) const;
+		int64_t ReadInt64(size_t offset) const;
+	};
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace stts {
+
+	// FNV-1a of a method or argument name.
+	constexpr uint32_t HashName(std::string_view name)
+	{
+		uint32_t hash = 2166136261u;
+		for (auto c : name)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	template <typename Handler>
+	struct MethodEntry {
+		std::string_view name;
+		Handler handler = nullptr;
+	};
+
+	// Method names mapped to handlers by a perfect hash built at compile time.
+	//
+	// A seed giving each name its own slot is searched when the table is built, a lookup is then
+	// one hash and one name comparison whatever the number of methods. Names must be unique, see IsValid.
+	template <typename Handler, size_t N>
+	class MethodTable {
+	public:
+		constexpr explicit MethodTable(const MethodEntry<Handler>(&entries)[N]) :
+			m_entries(),
+			m_hashes(),
+			m_slots()
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				m_entries[i] = entries[i];
+				m_hashes[i] = HashName(entries[i].name);
+			}
+
+			for (uint32_t seed = 1; seed <= kMaxSeed; seed++)
+			{
+				if (TryBuild(seed))
+				{
+					m_seed = seed;
+					return;
+				}
+			}
+		}
+
+		// False if no perfect hash was found, e.g. for duplicated names.
+		constexpr bool IsValid() const { return m_seed != 0; }
+
+		// Null if the name is unknown.
+		const MethodEntry<Handler>* Find(std::string_view name) const
+		{
+			auto index = m_slots[GetSlot(HashName(name), m_seed)];
+			if (index == 0) return nullptr;
+
+			const auto& entry = m_entries[index - 1];
+			return entry.name == name ? &entry : nullptr;
+		}
+
+	private:
+		// At least 8 slots per name, a seed is found within a few tries.
+		static constexpr size_t GetSlotBits()
+		{
+			size_t bits = 3;
+			while ((size_t(1) << bits) < N * 8) bits++;
+			return bits;
+		}
+
+		static constexpr size_t kSlotBits = GetSlotBits();
+		static constexpr uint32_t kMaxSeed = 4096;
+
+		std::array<MethodEntry<Handler>, N> m_entries;
+		std::array<uint32_t, N> m_hashes;
+		// Entry index plus one, 0 for free slots.
+		std::array<uint16_t, size_t(1) << kSlotBits> m_slots;
+		uint32_t m_seed = 0;
+
+		static constexpr size_t GetSlot(uint32_t hash, uint32_t seed)
+		{
+			// Multiplicative hashing, top bits are the best mixed.
+			uint32_t mixed = (hash ^ (seed * 0x9E3779B9u)) * 0x85EBCA6Bu;
+			mixed ^= mixed >> 15;
+			mixed *= 0xC2B2AE35u;
+			return static_cast<size_t>(mixed >> (32 - kSlotBits));
+		}
+
+		constexpr bool TryBuild(uint32_t seed)
+		{
+			for (size_t slot = 0; slot < m_slots.size(); slot++) m_slots[slot] = 0;
+
+			for (size_t i = 0; i < N; i++)
+			{
+				auto slot = GetSlot(m_hashes[i], seed);
+				if (m_slots[slot] != 0) return false;
+
+				m_slots[slot] = static_cast<uint16_t>(i + 1);
+			}
+
+			return true;
+		}
+	};
+
+	template <typename Handler, size_t N>
+	constexpr MethodTable<Handler, N> MakeMethodTable(const MethodEntry<Handler>(&entries)[N])
+	{
+		return MethodTable<Handler, N>(entries);
+	}
+
+}
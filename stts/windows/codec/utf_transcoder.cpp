@@ -0,0 +1,431 @@
+#include "utf_transcoder.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STTS_UTF_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define STTS_TARGET_AVX2
+#else
+#define STTS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace stts {
+
+    enum class UtfPath {
+        scalar,
+        sse2,
+        avx2,
+    };
+
+#ifdef STTS_UTF_X86
+    static bool HasAvx2()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+
+        // OS must save the AVX registers.
+        __cpuid(info, 1);
+        bool hasOsxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        if (!hasOsxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    static UtfPath SelectPath()
+    {
+        return HasAvx2() ? UtfPath::avx2 : UtfPath::sse2;
+    }
+#else
+    static UtfPath SelectPath()
+    {
+        return UtfPath::scalar;
+    }
+#endif
+
+    static const UtfPath kPath = SelectPath();
+
+    //////////////////////////////////////////////////////////////////////////
+    //  ASCII runs
+    //////////////////////////////////////////////////////////////////////////
+
+    // Each function converts whole blocks from the start of the input while they are ASCII,
+    // and returns the number of code units converted.
+
+#ifdef STTS_UTF_X86
+    static size_t WidenAsciiSse2(const uint8_t* in, size_t size, char16_t* out)
+    {
+        size_t i = 0;
+        auto zero = _mm_setzero_si128();
+
+        for (; i + 16 <= size; i += 16)
+        {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            if (_mm_movemask_epi8(bytes) != 0) break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(bytes, zero));
+        }
+
+        return i;
+    }
+
+    STTS_TARGET_AVX2 static size_t WidenAsciiAvx2(const uint8_t* in, size_t size, char16_t* out)
+    {
+        size_t i = 0;
+
+        for (; i + 32 <= size; i += 32)
+        {
+            auto bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            if (_mm256_movemask_epi8(bytes) != 0) break;
+
+            auto low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes));
+            auto high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 16), high);
+        }
+
+        return i + WidenAsciiSse2(in + i, size - i, out + i);
+    }
+
+    static size_t NarrowAsciiSse2(const char16_t* in, size_t size, uint8_t* out)
+    {
+        size_t i = 0;
+        auto nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+
+        for (; i + 16 <= size; i += 16)
+        {
+            auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+            auto mask = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(mask, _mm_setzero_si128())) != 0xFFFF) break;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(low, high));
+        }
+
+        return i;
+    }
+
+    STTS_TARGET_AVX2 static size_t NarrowAsciiAvx2(const char16_t* in, size_t size, uint8_t* out)
+    {
+        size_t i = 0;
+        auto nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+
+        for (; i + 32 <= size; i += 32)
+        {
+            auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+            if (!_mm256_testz_si256(_mm256_or_si256(low, high), nonAscii)) break;
+
+            // Packing works per 128-bit lane, quarters are put back in order.
+            auto packed = _mm256_packus_epi16(low, high);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+
+        return i + NarrowAsciiSse2(in + i, size - i, out + i);
+    }
+
+    // Adds the UTF-16 length of whole 16-byte blocks: continuation bytes count 0, leads of 4-byte sequences 2
+    // and other bytes 1. Returns the number of bytes counted.
+    static size_t CountUtf16UnitsSse2(const uint8_t* in, size_t size, size_t& length)
+    {
+        size_t i = 0;
+        auto zero = _mm_setzero_si128();
+        auto one = _mm_set1_epi8(1);
+        // As signed bytes, continuations are below -64 and 4-byte leads from -16 to -1.
+        auto continuationLimit = _mm_set1_epi8(-64);
+        auto fourByteLimit = _mm_set1_epi8(-17);
+
+        for (; i + 16 <= size; i += 16)
+        {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            if (_mm_movemask_epi8(bytes) == 0)
+            {
+                length += 16;
+                continue;
+            }
+
+            auto leads = _mm_andnot_si128(_mm_cmplt_epi8(bytes, continuationLimit), one);
+            auto fourByteLeads = _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(bytes, fourByteLimit), _mm_cmplt_epi8(bytes, zero)), one);
+
+            // Units of each half summed into its low 16 bits.
+            auto sums = _mm_sad_epu8(_mm_add_epi8(leads, fourByteLeads), zero);
+            length += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+        }
+
+        return i;
+    }
+
+    static size_t CountAscii16Sse2(const char16_t* in, size_t size)
+    {
+        size_t i = 0;
+        auto nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+        for (; i + 8 <= size; i += 8)
+        {
+            auto units = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(units, _mm_setzero_si128())) != 0xFFFF) break;
+        }
+        return i;
+    }
+
+    STTS_TARGET_AVX2 static size_t CountAscii16Avx2(const char16_t* in, size_t size)
+    {
+        size_t i = 0;
+        auto nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+        for (; i + 16 <= size; i += 16)
+        {
+            if (!_mm256_testz_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)), nonAscii)) break;
+        }
+        return i + CountAscii16Sse2(in + i, size - i);
+    }
+#endif
+
+    static inline size_t WidenAscii(const uint8_t* in, size_t size, char16_t* out)
+    {
+        switch (kPath)
+        {
+#ifdef STTS_UTF_X86
+        case UtfPath::avx2: return WidenAsciiAvx2(in, size, out);
+        case UtfPath::sse2: return WidenAsciiSse2(in, size, out);
+#endif
+        default: return 0;
+        }
+    }
+
+    static inline size_t NarrowAscii(const char16_t* in, size_t size, uint8_t* out)
+    {
+        switch (kPath)
+        {
+#ifdef STTS_UTF_X86
+        case UtfPath::avx2: return NarrowAsciiAvx2(in, size, out);
+        case UtfPath::sse2: return NarrowAsciiSse2(in, size, out);
+#endif
+        default: return 0;
+        }
+    }
+
+    static inline size_t CountUtf16Units(const uint8_t* in, size_t size, size_t& length)
+    {
+#ifdef STTS_UTF_X86
+        if (kPath != UtfPath::scalar) return CountUtf16UnitsSse2(in, size, length);
+#endif
+        return 0;
+    }
+
+    static inline size_t CountAscii16(const char16_t* in, size_t size)
+    {
+        switch (kPath)
+        {
+#ifdef STTS_UTF_X86
+        case UtfPath::avx2: return CountAscii16Avx2(in, size);
+        case UtfPath::sse2: return CountAscii16Sse2(in, size);
+#endif
+        default: return 0;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //  Transcoding
+    //////////////////////////////////////////////////////////////////////////
+
+    // static
+    size_t UtfTranscoder::GetUtf16Length(const char* utf8, size_t size)
+    {
+        auto in = reinterpret_cast<const uint8_t*>(utf8);
+        size_t length = 0;
+
+        // Mixed text is counted by blocks as well, no need to find ASCII runs.
+        auto i = CountUtf16Units(in, size, length);
+        for (; i < size; i++)
+        {
+            auto c = in[i];
+            // Continuation bytes add nothing, 4 byte sequences give a surrogate pair.
+            if ((c & 0xC0) != 0x80) length++;
+            if (c >= 0xF0) length++;
+        }
+
+        return length;
+    }
+
+    // static
+    size_t UtfTranscoder::GetUtf8Length(const char16_t* utf16, size_t size)
+    {
+        size_t length = 0;
+        size_t i = 0;
+
+        while (i < size)
+        {
+            auto ascii = CountAscii16(utf16 + i, size - i);
+            length += ascii;
+            i += ascii;
+
+            auto end = i + 32 < size ? i + 32 : size;
+            for (; i < end; i++)
+            {
+                auto c = utf16[i];
+                // Each half of a surrogate pair counts for 2 of its 4 bytes.
+                if (c < 0x80) length += 1;
+                else if (c < 0x800 || (c >= 0xD800 && c <= 0xDFFF)) length += 2;
+                else length += 3;
+            }
+        }
+
+        return length;
+    }
+
+    static inline bool IsContinuation(uint8_t c)
+    {
+        return (c & 0xC0) == 0x80;
+    }
+
+    // Returns the length of the sequence, or 0 if invalid.
+    // Each length has its own branch, a loop over the continuation bytes is mispredicted on mixed text.
+    static inline size_t DecodeUtf8(const uint8_t* in, size_t size, char16_t*& out)
+    {
+        auto c = in[0];
+        if (c < 0x80)
+        {
+            *out++ = c;
+            return 1;
+        }
+
+        if (c < 0xE0)
+        {
+            // Below 0xC2, continuation bytes and overlong forms.
+            if (c < 0xC2 || size < 2 || !IsContinuation(in[1])) return 0;
+
+            *out++ = static_cast<char16_t>(((c & 0x1F) << 6) | (in[1] & 0x3F));
+            return 2;
+        }
+
+        if (c < 0xF0)
+        {
+            if (size < 3 || !IsContinuation(in[1]) || !IsContinuation(in[2])) return 0;
+
+            uint32_t codePoint = ((c & 0x0F) << 12) | ((in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+            // Overlong forms and surrogates.
+            if (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) return 0;
+
+            *out++ = static_cast<char16_t>(codePoint);
+            return 3;
+        }
+
+        if (c > 0xF4 || size < 4 || !IsContinuation(in[1]) || !IsContinuation(in[2]) || !IsContinuation(in[3])) return 0;
+
+        uint32_t codePoint = ((c & 0x07) << 18) | ((in[1] & 0x3F) << 12) | ((in[2] & 0x3F) << 6) | (in[3] & 0x3F);
+        // Overlong forms and out of range values.
+        if (codePoint < 0x10000 || codePoint > 0x10FFFF) return 0;
+
+        codePoint -= 0x10000;
+        *out++ = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+        *out++ = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        return 4;
+    }
+
+    // Returns the number of units read, or 0 if invalid.
+    static inline size_t EncodeUtf8(const char16_t* in, size_t size, uint8_t*& out)
+    {
+        uint32_t c = in[0];
+        if (c < 0x80)
+        {
+            *out++ = static_cast<uint8_t>(c);
+            return 1;
+        }
+
+        if (c < 0x800)
+        {
+            *out++ = static_cast<uint8_t>(0xC0 | (c >> 6));
+            *out++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+            return 1;
+        }
+
+        if (c < 0xD800 || c > 0xDFFF)
+        {
+            *out++ = static_cast<uint8_t>(0xE0 | (c >> 12));
+            *out++ = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+            *out++ = static_cast<uint8_t>(0x80 | (c & 0x3F));
+            return 1;
+        }
+
+        // High surrogate followed by a low one.
+        if (c > 0xDBFF || size < 2 || in[1] < 0xDC00 || in[1] > 0xDFFF) return 0;
+
+        auto codePoint = 0x10000 + ((c - 0xD800) << 10) + (in[1] - 0xDC00);
+        *out++ = static_cast<uint8_t>(0xF0 | (codePoint >> 18));
+        *out++ = static_cast<uint8_t>(0x80 | ((codePoint >> 12) & 0x3F));
+        *out++ = static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F));
+        *out++ = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+        return 2;
+    }
+
+    // static
+    size_t UtfTranscoder::Utf8ToUtf16(const char* utf8, size_t size, char16_t* utf16)
+    {
+        auto in = reinterpret_cast<const uint8_t*>(utf8);
+        auto out = utf16;
+        size_t i = 0;
+
+        while (i < size)
+        {
+            auto ascii = WidenAscii(in + i, size - i, out);
+            i += ascii;
+            out += ascii;
+
+            // Rest of the block is converted one character at a time, vectors would fail again on mixed text.
+            auto end = i + 32 < size ? i + 32 : size;
+            while (i < end)
+            {
+                auto length = DecodeUtf8(in + i, size - i, out);
+                if (length == 0) return kInvalidUtf;
+                i += length;
+            }
+        }
+
+        return static_cast<size_t>(out - utf16);
+    }
+
+    // static
+    size_t UtfTranscoder::Utf16ToUtf8(const char16_t* utf16, size_t size, char* utf8)
+    {
+        auto out = reinterpret_cast<uint8_t*>(utf8);
+        size_t i = 0;
+
+        while (i < size)
+        {
+            auto ascii = NarrowAscii(utf16 + i, size - i, out);
+            i += ascii;
+            out += ascii;
+
+            auto end = i + 32 < size ? i + 32 : size;
+            while (i < end)
+            {
+                auto length = EncodeUtf8(utf16 + i, size - i, out);
+                if (length == 0) return kInvalidUtf;
+                i += length;
+            }
+        }
+
+        return static_cast<size_t>(out - reinterpret_cast<uint8_t*>(utf8));
+    }
+
+    // static
+    const char* UtfTranscoder::GetImplementation()
+    {
+        switch (kPath)
+        {
+        case UtfPath::avx2: return "avx2";
+        case UtfPath::sse2: return "sse2";
+        default: return "scalar";
+        }
+    }
+
+}
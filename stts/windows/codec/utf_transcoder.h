@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace stts {
+
+	// Returned when the input is not well formed, e.g. truncated sequence, overlong form or lone surrogate.
+	constexpr size_t kInvalidUtf = SIZE_MAX;
+
+	// Validating UTF-8 <-> UTF-16 transcoding.
+	//
+	// ASCII runs are converted 16 or 32 code units at a time with SSE2 or AVX2 (selected at run time),
+	// other characters one by one. Other CPUs use the scalar path only.
+	// Buffer variants let hot paths reuse their storage. The length functions return the exact output size
+	// of valid input, and a size never exceeded for invalid input.
+	class UtfTranscoder {
+	public:
+		static size_t GetUtf16Length(const char* utf8, size_t size);
+		static size_t GetUtf8Length(const char16_t* utf16, size_t size);
+
+		// Output must have room for GetUtf16Length units. Returns the units written, or kInvalidUtf.
+		static size_t Utf8ToUtf16(const char* utf8, size_t size, char16_t* utf16);
+		// Output must have room for GetUtf8Length bytes. Returns the bytes written, or kInvalidUtf.
+		static size_t Utf16ToUtf8(const char16_t* utf16, size_t size, char* utf8);
+
+		// Replace the output content, reusing its capacity. Output is empty on failure.
+		// Any string of 16-bit code units is accepted, e.g. std::wstring on Windows.
+		template <typename String>
+		static bool Utf8ToUtf16(const char* utf8, size_t size, String& utf16);
+		template <typename Char>
+		static bool Utf16ToUtf8(const Char* utf16, size_t size, std::string& utf8);
+
+		// Name of the selected implementation, e.g. "avx2".
+		static const char* GetImplementation();
+	};
+
+	template <typename String>
+	bool UtfTranscoder::Utf8ToUtf16(const char* utf8, size_t size, String& utf16)
+	{
+		static_assert(sizeof(typename String::value_type) == sizeof(char16_t), "UTF-16 code units expected");
+
+		utf16.resize(GetUtf16Length(utf8, size));
+
+		auto length = Utf8ToUtf16(utf8, size, reinterpret_cast<char16_t*>(&utf16[0]));
+		if (length == kInvalidUtf)
+		{
+			utf16.clear();
+			return false;
+		}
+
+		utf16.resize(length);
+		return true;
+	}
+
+	template <typename Char>
+	bool UtfTranscoder::Utf16ToUtf8(const Char* utf16, size_t size, std::string& utf8)
+	{
+		static_assert(sizeof(Char) == sizeof(char16_t), "UTF-16 code units expected");
+
+		auto units = reinterpret_cast<const char16_t*>(utf16);
+		utf8.resize(GetUtf8Length(units, size));
+
+		auto length = Utf16ToUtf8(units, size, &utf8[0]);
+		if (length == kInvalidUtf)
+		{
+			utf8.clear();
+			return false;
+		}
+
+		utf8.resize(length);
+		return true;
+	}
+
+}
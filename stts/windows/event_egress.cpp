@@ -0,0 +1,114 @@
+#include "event_egress.h"
+
+#include "event_stream_handler.h"
+#include "trace/trace_recorder.h"
+
+namespace stts {
+
+    EventEgress::EventEgress(PlatformDispatcher* dispatcher, size_t capacity) :
+        m_dispatcher(dispatcher),
+        m_queue(capacity)
+    {
+    }
+
+    bool EventEgress::Post(EventStreamHandler* handler, flutter::EncodableValue value, EventPriority priority)
+    {
+        QueuedEvent event;
+        event.handler = handler;
+        event.value = std::move(value);
+
+        return Push(event, priority);
+    }
+
+    bool EventEgress::PostError(EventStreamHandler* handler, std::string code, std::string message)
+    {
+        QueuedEvent event;
+        event.handler = handler;
+        event.isError = true;
+        event.errorCode = std::move(code);
+        event.errorMessage = std::move(message);
+
+        return Push(event, EventPriority::normal);
+    }
+
+    EventEgressStats EventEgress::GetStats() const
+    {
+        EventEgressStats stats;
+        stats.posted = m_posted.load(std::memory_order_relaxed);
+        stats.delivered = m_delivered.load(std::memory_order_relaxed);
+        stats.dropped = m_dropped.load(std::memory_order_relaxed);
+        stats.overflowed = m_overflowed.load(std::memory_order_relaxed);
+        stats.depth = m_queue.GetSize();
+        stats.maxDepth = m_maxDepth.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    bool EventEgress::Push(QueuedEvent& event, EventPriority priority)
+    {
+        // Hypotheses and levels are refused first so that finals and state changes still fit.
+        if (priority == EventPriority::low && m_queue.GetSize() >= m_queue.GetCapacity() - m_queue.GetCapacity() / 4)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (!m_queue.TryPush(event))
+        {
+            (priority == EventPriority::low ? m_dropped : m_overflowed).fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_posted.fetch_add(1, std::memory_order_relaxed);
+        RequestDrain();
+        return true;
+    }
+
+    void EventEgress::RequestDrain()
+    {
+        // One pending task drains everything posted until it runs.
+        if (!m_isDrainPosted.exchange(true))
+        {
+            m_dispatcher->Post([this]() { Drain(); });
+        }
+    }
+
+    void EventEgress::Drain()
+    {
+        TraceSpan span("event", "EventEgress::Drain");
+
+        // Cleared first: events pushed from now on post another drain.
+        m_isDrainPosted.store(false);
+
+        auto depth = m_queue.GetSize();
+        if (depth > m_maxDepth.load(std::memory_order_relaxed))
+        {
+            m_maxDepth.store(depth, std::memory_order_relaxed);
+        }
+
+        // Bounded so that a flood of events doesn't hold the message loop.
+        auto capacity = m_queue.GetCapacity();
+        size_t count = 0;
+        QueuedEvent event;
+
+        while (count < capacity && m_queue.TryPop(event))
+        {
+            if (event.isError)
+            {
+                event.handler->DeliverError(event.errorCode, event.errorMessage);
+            }
+            else
+            {
+                event.handler->Deliver(event.value);
+            }
+            count++;
+        }
+
+        m_delivered.fetch_add(count, std::memory_order_relaxed);
+
+        if (count == capacity)
+        {
+            RequestDrain();
+        }
+    }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <flutter/encodable_value.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "platform_dispatcher.h"
+#include "worker/mpsc_queue.h"
+
+namespace stts {
+
+	class EventStreamHandler;
+
+	// Order in which events are dropped when the platform thread falls behind.
+	enum class EventPriority {
+		// Superseded by a later event, like hypotheses or audio levels.
+		low,
+		normal,
+	};
+
+	struct EventEgressStats {
+		uint64_t posted = 0;
+		uint64_t delivered = 0;
+		// Low priority events refused while the queue was filling up.
+		uint64_t dropped = 0;
+		// Normal events refused because the queue was full.
+		uint64_t overflowed = 0;
+		// Events waiting for the platform thread.
+		size_t depth = 0;
+		size_t maxDepth = 0;
+	};
+
+	// Events of all channels on their way to the platform thread.
+	//
+	// Any thread may post. Events are queued without locking and delivered in batches by a single dispatcher task,
+	// in posting order for each thread. The last quarter of the queue is kept for normal events.
+	class EventEgress {
+	public:
+		EventEgress(PlatformDispatcher* dispatcher, size_t capacity);
+
+		// Disallow copy and assign.
+		EventEgress(const EventEgress&) = delete;
+		EventEgress& operator=(const EventEgress&) = delete;
+
+		// Return false if the event was dropped.
+		bool Post(EventStreamHandler* handler, flutter::EncodableValue value, EventPriority priority);
+		bool PostError(EventStreamHandler* handler, std::string code, std::string message);
+
+		// May be called from any thread.
+		EventEgressStats GetStats() const;
+
+	private:
+		struct QueuedEvent {
+			EventStreamHandler* handler = nullptr;
+			flutter::EncodableValue value;
+			bool isError = false;
+			std::string errorCode;
+			std::string errorMessage;
+		};
+
+		PlatformDispatcher* m_dispatcher;
+		MpscQueue<QueuedEvent> m_queue;
+		std::atomic<bool> m_isDrainPosted{ false };
+
+		std::atomic<uint64_t> m_posted{ 0 };
+		std::atomic<uint64_t> m_delivered{ 0 };
+		std::atomic<uint64_t> m_dropped{ 0 };
+		std::atomic<uint64_t> m_overflowed{ 0 };
+		std::atomic<size_t> m_maxDepth{ 0 };
+
+		bool Push(QueuedEvent& event, EventPriority priority);
+		void RequestDrain();
+		void Drain();
+	};
+
+}
@@ -3,23 +3,41 @@
 
 #include <flutter/event_channel.h>
 
+#include "event_egress.h"
+#include "trace/trace_recorder.h"
+
 namespace stts {
 
     using namespace flutter;
 
     class EventStreamHandler : public StreamHandler<EncodableValue> {
     public:
-        EventStreamHandler() = default;
+        // Events are queued to egress and delivered on the platform thread, whatever the emitting thread.
+        // Name of the channel is used in traces, a string literal.
+        EventStreamHandler(EventEgress* egress, const char* name) : m_egress(egress), m_name(name) {}
 
         virtual ~EventStreamHandler() = default;
 
-        void Success(const EncodableValue& data) {
-            if (m_sink.get()) m_sink.get()->Success(data);
+        // Returns false if egress dropped the event.
+        bool Success(EncodableValue data, EventPriority priority = EventPriority::normal) {
+            TraceSpan span("event", m_name);
+            return m_egress->Post(this, std::move(data), priority);
         }
 
         void Error(const std::string& error_code, const std::string& error_message) {
-            if (m_sink.get())
-                m_sink.get()->Error(error_code, error_message);
+            TraceSpan span("event", m_name);
+            m_egress->PostError(this, error_code, error_message);
+        }
+
+        // Called by egress on the platform thread, like OnListen and OnCancel.
+        void Deliver(const EncodableValue& data) {
+            TraceSpan span("sink", m_name);
+            if (m_sink) m_sink->Success(data);
+        }
+
+        void DeliverError(const std::string& error_code, const std::string& error_message) {
+            TraceSpan span("sink", m_name);
+            if (m_sink) m_sink->Error(error_code, error_message);
         }
 
     protected:
@@ -29,14 +47,16 @@ namespace stts {
         }
 
         std::unique_ptr<StreamHandlerError<EncodableValue>> OnCancelInternal(const EncodableValue* arguments) override {
-            m_sink.release();
+            m_sink.reset();
             return nullptr;
         }
 
     private:
+        EventEgress* m_egress;
+        const char* m_name;
         std::unique_ptr<EventSink<EncodableValue>> m_sink;
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,90 @@
+#include "platform_dispatcher.h"
+
+namespace stts {
+
+    static const wchar_t* kWindowClassName = L"SttsPlatformDispatcher";
+
+    PlatformDispatcher::PlatformDispatcher() :
+        m_window(NULL),
+        m_threadId(GetCurrentThreadId())
+    {
+        auto instance = GetModuleHandleW(NULL);
+
+        WNDCLASSW windowClass{};
+        windowClass.lpfnWndProc = PlatformDispatcher::WindowProc;
+        windowClass.hInstance = instance;
+        windowClass.lpszClassName = kWindowClassName;
+        // Fails harmlessly if already registered by another instance.
+        RegisterClassW(&windowClass);
+
+        m_window = CreateWindowExW(0, kWindowClassName, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, instance, NULL);
+        if (m_window)
+        {
+            SetWindowLongPtrW(m_window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+        }
+    }
+
+    PlatformDispatcher::~PlatformDispatcher()
+    {
+        if (m_window)
+        {
+            SetWindowLongPtrW(m_window, GWLP_USERDATA, 0);
+            DestroyWindow(m_window);
+        }
+    }
+
+    void PlatformDispatcher::Post(std::function<void()> task)
+    {
+        bool shouldPost;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+
+            // One message is enough to drain all tasks queued until it is handled.
+            shouldPost = !m_isPosted;
+            m_isPosted = true;
+        }
+
+        if (shouldPost && m_window)
+        {
+            PostMessageW(m_window, kDispatchMessage, 0, 0);
+        }
+    }
+
+    bool PlatformDispatcher::IsPlatformThread() const
+    {
+        return GetCurrentThreadId() == m_threadId;
+    }
+
+    void PlatformDispatcher::Drain()
+    {
+        std::deque<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            tasks.swap(m_tasks);
+            m_isPosted = false;
+        }
+
+        for (auto& task : tasks)
+        {
+            task();
+        }
+    }
+
+    // static
+    LRESULT CALLBACK PlatformDispatcher::WindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam)
+    {
+        if (message == kDispatchMessage)
+        {
+            auto pThis = reinterpret_cast<PlatformDispatcher*>(GetWindowLongPtrW(hwnd, GWLP_USERDATA));
+            if (pThis)
+            {
+                pThis->Drain();
+            }
+            return 0;
+        }
+
+        return DefWindowProcW(hwnd, message, wparam, lparam);
+    }
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include <windows.h>
+
+namespace stts {
+
+	// Runs tasks on the Flutter platform thread.
+	// Method results and event sinks must only be used from this thread.
+	//
+	// Must be created on the platform thread. Tasks are dispatched by a message-only window,
+	// so they run from the application message loop.
+	class PlatformDispatcher {
+	public:
+		PlatformDispatcher();
+		~PlatformDispatcher();
+
+		// Disallow copy and assign.
+		PlatformDispatcher(const PlatformDispatcher&) = delete;
+		PlatformDispatcher& operator=(const PlatformDispatcher&) = delete;
+
+		// Queues a task. May be called from any thread.
+		void Post(std::function<void()> task);
+
+		bool IsPlatformThread() const;
+
+	private:
+		static constexpr UINT kDispatchMessage = WM_APP + 1;
+
+		HWND m_window;
+		DWORD m_threadId;
+
+		std::mutex m_mutex;
+		std::deque<std::function<void()>> m_tasks;
+		bool m_isPosted = false;
+
+		void Drain();
+
+		static LRESULT CALLBACK WindowProc(HWND hwnd, UINT message, WPARAM wparam, LPARAM lparam);
+	};
+
+}
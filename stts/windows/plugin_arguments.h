@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "codec/argument_decoder.h"
+
+namespace stts {
+
+	// Typed arguments of the method channel calls, decoded by DecodeArguments.
+
+	struct LanguageArgs {
+		std::string language;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("language", &LanguageArgs::language));
+		}
+	};
+
+	struct PathArgs {
+		std::string path;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("path", &PathArgs::path));
+		}
+	};
+
+	struct PcmFormatArgs {
+		int32_t sampleRate = 0;
+		int32_t channels = 0;
+		int32_t bitsPerSample = 0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("sampleRate", &PcmFormatArgs::sampleRate),
+				Field("channels", &PcmFormatArgs::channels),
+				Field("bitsPerSample", &PcmFormatArgs::bitsPerSample));
+		}
+	};
+
+	struct TracingArgs {
+		bool enabled = false;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("enabled", &TracingArgs::enabled));
+		}
+	};
+
+	// STT
+
+	// Durations in milliseconds, absent ones keep the session defaults.
+	struct SttWindowsOptionsArgs {
+		std::optional<int64_t> idleTimeout;
+		std::optional<int64_t> memoryBudget;
+		std::optional<bool> continuous;
+		std::optional<int64_t> maxDuration;
+		std::optional<int64_t> silenceTimeout;
+		std::optional<int64_t> hypothesisInterval;
+		std::optional<bool> compactEvents;
+		std::optional<int64_t> levelInterval;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("idleTimeout", &SttWindowsOptionsArgs::idleTimeout),
+				Field("memoryBudget", &SttWindowsOptionsArgs::memoryBudget),
+				Field("continuous", &SttWindowsOptionsArgs::continuous),
+				Field("maxDuration", &SttWindowsOptionsArgs::maxDuration),
+				Field("silenceTimeout", &SttWindowsOptionsArgs::silenceTimeout),
+				Field("hypothesisInterval", &SttWindowsOptionsArgs::hypothesisInterval),
+				Field("compactEvents", &SttWindowsOptionsArgs::compactEvents),
+				Field("levelInterval", &SttWindowsOptionsArgs::levelInterval));
+		}
+	};
+
+	struct SttRecognitionOptionsArgs {
+		SttWindowsOptionsArgs windows;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("windows", &SttRecognitionOptionsArgs::windows));
+		}
+	};
+
+	struct SttStartArgs {
+		SttRecognitionOptionsArgs options;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("options", &SttStartArgs::options));
+		}
+	};
+
+	struct TrainingArgs {
+		std::vector<std::string> trainingTexts;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("trainingTexts", &TrainingArgs::trainingTexts));
+		}
+	};
+
+	struct TranscribeBufferArgs {
+		std::vector<uint8_t> bytes;
+		// Raw samples when present, WAV file otherwise.
+		std::optional<PcmFormatArgs> format;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("bytes", &TranscribeBufferArgs::bytes),
+				Field("format", &TranscribeBufferArgs::format));
+		}
+	};
+
+	struct CancelTranscriptionArgs {
+		int64_t jobId = 0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("jobId", &CancelTranscriptionArgs::jobId));
+		}
+	};
+
+	// TTS
+
+	struct TtsVoiceSettingsArgs {
+		std::optional<std::string> voiceId;
+		std::optional<double> pitch;
+		std::optional<double> rate;
+		std::optional<double> volume;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("voiceId", &TtsVoiceSettingsArgs::voiceId),
+				Field("pitch", &TtsVoiceSettingsArgs::pitch),
+				Field("rate", &TtsVoiceSettingsArgs::rate),
+				Field("volume", &TtsVoiceSettingsArgs::volume));
+		}
+	};
+
+	// Voice settings are overrides of the utterance.
+	struct TtsOptionsArgs : TtsVoiceSettingsArgs {
+		std::string mode;
+		int32_t preSilence = 0;
+		int32_t postSilence = 0;
+		int32_t priority = 0;
+		int32_t deadline = 0;
+		// Text offset to name.
+		flutter::EncodableMap bookmarks;
+
+		static constexpr auto GetFields() {
+			return std::tuple_cat(TtsVoiceSettingsArgs::GetFields(), std::make_tuple(
+				Field("mode", &TtsOptionsArgs::mode),
+				Field("preSilence", &TtsOptionsArgs::preSilence),
+				Field("postSilence", &TtsOptionsArgs::postSilence),
+				Field("priority", &TtsOptionsArgs::priority),
+				Field("deadline", &TtsOptionsArgs::deadline),
+				Field("bookmarks", &TtsOptionsArgs::bookmarks)));
+		}
+	};
+
+	struct TtsStartArgs : TtsOptionsArgs {
+		std::string text;
+
+		static constexpr auto GetFields() {
+			return std::tuple_cat(TtsOptionsArgs::GetFields(), std::make_tuple(Field("text", &TtsStartArgs::text)));
+		}
+	};
+
+	struct SynthesizeArgs : TtsOptionsArgs {
+		std::string text;
+		// File target only.
+		std::string path;
+		std::optional<PcmFormatArgs> format;
+
+		static constexpr auto GetFields() {
+			return std::tuple_cat(TtsOptionsArgs::GetFields(), std::make_tuple(
+				Field("text", &SynthesizeArgs::text),
+				Field("path", &SynthesizeArgs::path),
+				Field("format", &SynthesizeArgs::format)));
+		}
+	};
+
+	struct TtsCancelArgs {
+		int64_t id = 0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("id", &TtsCancelArgs::id));
+		}
+	};
+
+	struct VoiceArgs {
+		std::string voiceId;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("voiceId", &VoiceArgs::voiceId));
+		}
+	};
+
+	struct PitchArgs {
+		double pitch = 1.0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("pitch", &PitchArgs::pitch));
+		}
+	};
+
+	struct RateArgs {
+		double rate = 1.0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("rate", &RateArgs::rate));
+		}
+	};
+
+	struct VolumeArgs {
+		double volume = 1.0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("volume", &VolumeArgs::volume));
+		}
+	};
+
+	struct CacheBudgetArgs {
+		int64_t budget = 0;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(Field("budget", &CacheBudgetArgs::budget));
+		}
+	};
+
+	struct OpenStoreArgs {
+		std::string path;
+		int64_t maxBytes = 256LL << 20;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("path", &OpenStoreArgs::path),
+				Field("maxBytes", &OpenStoreArgs::maxBytes));
+		}
+	};
+
+	struct PipelineArgs {
+		int64_t lookahead = 0;
+		int64_t maxBytes = 32LL << 20;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("lookahead", &PipelineArgs::lookahead),
+				Field("maxBytes", &PipelineArgs::maxBytes));
+		}
+	};
+
+	struct ProgressEventsArgs {
+		bool words = false;
+		bool sentences = false;
+		bool bookmarks = false;
+
+		static constexpr auto GetFields() {
+			return std::make_tuple(
+				Field("words", &ProgressEventsArgs::words),
+				Field("sentences", &ProgressEventsArgs::sentences),
+				Field("bookmarks", &ProgressEventsArgs::bookmarks));
+		}
+	};
+
+}
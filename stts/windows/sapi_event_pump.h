@@ -0,0 +1,29 @@
+#pragma once
+
+#include <sapi.h>
+#pragma warning(disable:4996)
+#include <sphelper.h>
+#pragma warning(default: 4996)
+
+namespace stts {
+
+	// Reads all events queued in the source, in order.
+	// SAPI may notify once for several queued events, so reading a single event per notification
+	// leaves the others behind until the next one.
+	template <typename Fn>
+	size_t PumpEvents(ISpEventSource* pSource, Fn&& onEvent)
+	{
+		size_t count = 0;
+
+		CSpEvent event;
+		while (event.GetFrom(pSource) == S_OK)
+		{
+			onEvent(event);
+			event.Clear();
+			count++;
+		}
+
+		return count;
+	}
+
+}
@@ -0,0 +1,112 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stts {
+
+#ifdef _WIN32
+
+    // static
+    std::unique_ptr<MappedFile> MappedFile::Open(const std::string& utf8Path, uint64_t minSize)
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+
+        // Delete sharing lets stale generations be removed while still mapped.
+        auto handle = CreateFileW(std::filesystem::u8path(utf8Path).c_str(), GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (handle == INVALID_HANDLE_VALUE) return nullptr;
+        file->m_file = handle;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(handle, &fileSize)) return nullptr;
+
+        auto size = (std::max)(static_cast<uint64_t>(fileSize.QuadPart), minSize);
+        if (size == 0) return nullptr;
+
+        // A mapping larger than the file extends it.
+        file->m_mapping = CreateFileMappingW(handle, NULL, PAGE_READWRITE,
+            static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), NULL);
+        if (!file->m_mapping) return nullptr;
+
+        file->m_data = static_cast<uint8_t*>(MapViewOfFile(file->m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (!file->m_data) return nullptr;
+
+        file->m_size = size;
+        return file;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file) CloseHandle(m_file);
+    }
+
+    bool MappedFile::Flush(uint64_t offset, uint64_t size) const
+    {
+        if (offset + size > m_size) return false;
+        // A size of 0 would flush the whole view.
+        if (size == 0) return true;
+
+        return FlushViewOfFile(m_data + offset, static_cast<SIZE_T>(size)) && FlushFileBuffers(m_file);
+    }
+
+#else
+
+    // static
+    std::unique_ptr<MappedFile> MappedFile::Open(const std::string& utf8Path, uint64_t minSize)
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+
+        file->m_file = open(utf8Path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (file->m_file < 0) return nullptr;
+
+        struct stat info;
+        if (fstat(file->m_file, &info) != 0) return nullptr;
+
+        auto size = static_cast<uint64_t>(info.st_size) > minSize ? static_cast<uint64_t>(info.st_size) : minSize;
+        if (size == 0) return nullptr;
+
+        if (static_cast<uint64_t>(info.st_size) < size && ftruncate(file->m_file, static_cast<off_t>(size)) != 0)
+        {
+            return nullptr;
+        }
+
+        auto data = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, file->m_file, 0);
+        if (data == MAP_FAILED) return nullptr;
+
+        file->m_data = static_cast<uint8_t*>(data);
+        file->m_size = size;
+        return file;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_data) munmap(m_data, static_cast<size_t>(m_size));
+        if (m_file >= 0) close(m_file);
+    }
+
+    bool MappedFile::Flush(uint64_t offset, uint64_t size) const
+    {
+        if (offset + size > m_size) return false;
+
+        // msync needs a page aligned address.
+        auto pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        auto start = offset - offset % pageSize;
+
+        return msync(m_data + start, static_cast<size_t>(offset + size - start), MS_SYNC) == 0;
+    }
+
+#endif
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace stts {
+
+	// Read-write shared mapping of a whole file.
+	//
+	// The same file may be mapped several times, e.g. a larger view published while readers still use the previous one.
+	// Writes through any view are visible to all of them.
+	class MappedFile {
+	public:
+		// Opens or creates the file and maps it. The file is extended with zeros to minSize if shorter.
+		// Returns null on failure.
+		static std::unique_ptr<MappedFile> Open(const std::string& utf8Path, uint64_t minSize);
+
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		uint8_t* GetData() const { return m_data; }
+		uint64_t GetSize() const { return m_size; }
+
+		// Writes the range to disk before returning.
+		bool Flush(uint64_t offset, uint64_t size) const;
+
+	private:
+		MappedFile() = default;
+
+		uint8_t* m_data = nullptr;
+		uint64_t m_size = 0;
+
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+	};
+
+}
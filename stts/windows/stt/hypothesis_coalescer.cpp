@@ -0,0 +1,75 @@
+#include "hypothesis_coalescer.h"
+
+#include <algorithm>
+
+namespace stts {
+
+    HypothesisCoalescer::HypothesisCoalescer(std::chrono::milliseconds interval) :
+        m_interval(interval)
+    {
+    }
+
+    bool HypothesisCoalescer::Push(std::wstring_view text, Clock::time_point now, HypothesisDelta& delta)
+    {
+        auto commonLength = GetCommonPrefixLength(m_emitted, text);
+        m_stableLength = m_hasPending ? std::min(m_stableLength, commonLength) : commonLength;
+
+        m_pending.assign(text);
+        m_hasPending = true;
+
+        if (m_sequence != 0 && now < GetNextEmitTime())
+        {
+            return false;
+        }
+
+        Emit(now, delta);
+        return true;
+    }
+
+    bool HypothesisCoalescer::Flush(HypothesisDelta& delta)
+    {
+        if (!m_hasPending) return false;
+
+        Emit(Clock::now(), delta);
+        return true;
+    }
+
+    void HypothesisCoalescer::Reset()
+    {
+        m_emitted.clear();
+        m_pending.clear();
+        m_hasPending = false;
+        m_stableLength = 0;
+    }
+
+    void HypothesisCoalescer::Emit(Clock::time_point now, HypothesisDelta& delta)
+    {
+        auto stableLength = m_mustSendWholeText ? 0 : m_stableLength;
+        m_mustSendWholeText = false;
+
+        // Never split a surrogate pair.
+        if (stableLength > 0 && stableLength < m_pending.size())
+        {
+            auto c = m_pending[stableLength - 1];
+            if (c >= 0xD800 && c <= 0xDBFF) stableLength--;
+        }
+
+        delta.sequence = ++m_sequence;
+        delta.stableLength = stableLength;
+        delta.unstableSuffix.assign(m_pending, stableLength, std::wstring::npos);
+
+        m_emitted.swap(m_pending);
+        m_pending.clear();
+        m_hasPending = false;
+        m_lastEmitTime = now;
+    }
+
+    // static
+    size_t HypothesisCoalescer::GetCommonPrefixLength(std::wstring_view a, std::wstring_view b)
+    {
+        auto length = std::min(a.size(), b.size());
+        auto mismatch = std::mismatch(a.begin(), a.begin() + length, b.begin());
+        return static_cast<size_t>(mismatch.first - a.begin());
+    }
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace stts {
+
+	// Change between the last emitted hypothesis and the current one.
+	// The current text is previous.substr(0, stableLength) + unstableSuffix.
+	// Lengths are in wchar_t units, which are UTF-16 code units on Windows like Dart string indices.
+	struct HypothesisDelta {
+		uint64_t sequence = 0;
+		size_t stableLength = 0;
+		std::wstring unstableSuffix;
+	};
+
+	// Rate limits hypotheses and encodes them as deltas from the last emitted one.
+	//
+	// The stable prefix is the longest prefix shared by the last emitted hypothesis and all hypotheses
+	// received since, so text the recognizer keeps rewriting is sent again only once it settles.
+	class HypothesisCoalescer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit HypothesisCoalescer(std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
+		void SetInterval(std::chrono::milliseconds interval) { m_interval = interval; }
+		std::chrono::milliseconds GetInterval() const { return m_interval; }
+
+		// Adds a hypothesis. Returns true and fills delta if it must be emitted now.
+		// Otherwise, the hypothesis is kept pending until Flush or the next Push.
+		bool Push(std::wstring_view text, Clock::time_point now, HypothesisDelta& delta);
+
+		// Emits the pending hypothesis, if any.
+		bool Flush(HypothesisDelta& delta);
+
+		bool HasPending() const { return m_hasPending; }
+
+		// Time at which the pending hypothesis is allowed to be emitted.
+		Clock::time_point GetNextEmitTime() const { return m_lastEmitTime + m_interval; }
+
+		// Starts a new utterance, next emission will contain the whole text.
+		void Reset();
+
+		// The last emitted delta was not delivered, next emission will contain the whole text.
+		void ResendWholeText() { m_mustSendWholeText = true; }
+
+	private:
+		std::chrono::milliseconds m_interval;
+		uint64_t m_sequence = 0;
+
+		std::wstring m_emitted;
+		Clock::time_point m_lastEmitTime;
+
+		std::wstring m_pending;
+		bool m_hasPending = false;
+		size_t m_stableLength = 0;
+		bool m_mustSendWholeText = false;
+
+		void Emit(Clock::time_point now, HypothesisDelta& delta);
+
+		static size_t GetCommonPrefixLength(std::wstring_view a, std::wstring_view b);
+	};
+
+}
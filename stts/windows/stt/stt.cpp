@@ -1,14 +1,29 @@
 #include "stt.h"
 #include "../utils.h"
+#include "../catalog/sapi_token_source.h"
+#include "../sapi_event_pump.h"
+#include "../audio/tapped_audio_input.h"
+#include "../trace/trace_recorder.h"
+
+#include <psapi.h>
 
 namespace stts {
 
-    Stt::Stt(EventStreamHandler* stateEventHandler, EventStreamHandler* resultEventHandler) :
+    // Samples kept for the level meter, about 4 seconds at 16kHz.
+    static const size_t kAudioTapCapacity = 1 << 16;
+    static const size_t kLevelBufferSize = 4096;
+
+    Stt::Stt(EventStreamHandler* stateEventHandler, EventStreamHandler* resultEventHandler, EventStreamHandler* levelEventHandler, TaskScheduler* scheduler) :
         m_stateEventHandler(stateEventHandler),
         m_resultEventHandler(resultEventHandler),
+        m_levelEventHandler(levelEventHandler),
+        m_scheduler(scheduler),
         m_pRecognizer(NULL),
         m_pRecoContext(NULL),
-        m_pRecoGrammar(NULL)
+        m_pRecoGrammar(NULL),
+        m_recognizerCatalog(std::make_unique<SapiTokenSource>(SPCAT_RECOGNIZERS)),
+        m_audioTap(std::make_shared<AudioTap>(kAudioTapCapacity)),
+        m_levelBuffer(kLevelBufferSize)
     {
     }
 
@@ -20,169 +35,305 @@ namespace stts {
     void __stdcall Stt::RecoEventCallback(WPARAM wParam, LPARAM lParam)
     {
         auto pThis = (Stt*)wParam;
+        TraceSpan span("sapi", "Stt::RecoEventCallback");
 
-        CSpEvent event;
-        if (event.GetFrom(pThis->m_pRecoContext) == S_OK)
-        {
-            if (SPEI_HYPOTHESIS == event.eEventId || SPEI_RECOGNITION == event.eEventId)
-            {
-                LPWSTR dstrText;
-                HRESULT hr = event.RecoResult()->GetText((ULONG)SP_GETWHOLEPHRASE, (ULONG)SP_GETWHOLEPHRASE, TRUE, &dstrText, NULL);
-                if (FAILED(hr))
-                {
-                    _com_error err(hr);
-                    std::string msg = Utf8FromUtf16(err.ErrorMessage());
-                    pThis->m_stateEventHandler->Error(std::to_string(hr), msg);
-                }
-                else
-                {
-                    auto text = Utf8FromUtf16(dstrText);
-                    pThis->m_resultEventHandler->Success(flutter::EncodableMap({
-                        {flutter::EncodableValue("text"), flutter::EncodableValue(text)},
-                        {flutter::EncodableValue("isFinal"), flutter::EncodableValue(SPEI_RECOGNITION == event.eEventId)}
-                    }));
+        bool stop = false;
+        PumpEvents(pThis->m_pRecoContext, [pThis, &stop](CSpEvent& event) {
+            // Events queued before the session stopped.
+            if (!pThis->m_isListening || stop) return;
 
-                    CoTaskMemFree(dstrText);
-                }
-            }
+            pThis->OnRecoEvent(event);
 
-            if (SPEI_RECOGNITION == event.eEventId) {
-                pThis->Stop();
+            if (SPEI_RECOGNITION == event.eEventId && !pThis->m_session.GetOptions().continuous)
+            {
+                stop = true;
             }
+        });
 
-            event.Clear();
+        // One message for all events of this notification.
+        pThis->FlushResults();
+
+        if (stop)
+        {
+            pThis->Stop();
         }
     }
 
-    bool Stt::IsSupported()
+    void Stt::OnRecoEvent(CSpEvent& event)
     {
-        return CreateRecognizer() == S_OK;
+        if (SPEI_HYPOTHESIS != event.eEventId && SPEI_RECOGNITION != event.eEventId) return;
+
+        ResetSilenceTimer();
+
+        LPWSTR dstrText;
+        HRESULT hr = event.RecoResult()->GetText((ULONG)SP_GETWHOLEPHRASE, (ULONG)SP_GETWHOLEPHRASE, TRUE, &dstrText, NULL);
+        if (FAILED(hr))
+        {
+            _com_error err(hr);
+            std::string msg = Utf8FromUtf16(err.ErrorMessage());
+            m_stateEventHandler->Error(std::to_string(hr), msg);
+            return;
+        }
+
+        if (SPEI_HYPOTHESIS == event.eEventId)
+        {
+            OnHypothesis(dstrText, event.ullAudioStreamOffset);
+        }
+        else
+        {
+            // Final phrase replaces any pending hypothesis.
+            CancelHypothesisFlush();
+            m_hypotheses.Reset();
+
+            QueueResult(Utf8FromUtf16(dstrText, wcslen(dstrText)), event.ullAudioStreamOffset, event.RecoResult());
+        }
+
+        CoTaskMemFree(dstrText);
     }
 
-    std::string Stt::getLanguage()
+    void Stt::FlushResults()
     {
-        std::string language = "";
+        auto priority = m_hasFinalResult ? EventPriority::normal : EventPriority::low;
+        m_hasFinalResult = false;
 
-        ThrowIfFailed(CreateRecognizer());
+        auto isDelivered = true;
+        if (!m_resultEncoder.IsEmpty())
+        {
+            isDelivered = m_resultEventHandler->Success(flutter::EncodableValue(m_resultEncoder.GetBuffer()), priority);
+            m_resultEncoder.Clear();
+        }
 
-        ISpObjectToken* pToken = NULL;
-        ThrowIfFailed(m_pRecognizer->GetRecognizer(&pToken));
+        if (!m_resultBatch.empty())
+        {
+            isDelivered = m_resultEventHandler->Success(flutter::EncodableValue(std::move(m_resultBatch)), priority) && isDelivered;
+            m_resultBatch = flutter::EncodableList();
+        }
 
-        ISpDataKey* cpAttribKey;
-        ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
+        // A dropped hypothesis breaks the chain of deltas, the next one must not depend on it.
+        if (!isDelivered) m_hypotheses.ResendWholeText();
+    }
 
-        LPWSTR wValue;
-        ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
+    bool Stt::IsSupported()
+    {
+        try
+        {
+            return !m_recognizerCatalog.GetTokens().empty();
+        }
+        catch (HRESULT)
+        {
+            return false;
+        }
+    }
+
+    uint64_t Stt::GetEnginesGeneration()
+    {
+        try
+        {
+            return m_recognizerCatalog.GetGeneration();
+        }
+        catch (HRESULT)
+        {
+            return 0;
+        }
+    }
 
-        // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-        wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-        LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-        CoTaskMemFree(wValue);
+    std::string Stt::getLanguage()
+    {
+        ThrowIfFailed(CreateRecognizer());
 
-        language = (std::string)CW2A(locale);
+        ISpObjectToken* pToken = NULL;
+        ThrowIfFailed(m_pRecognizer->GetRecognizer(&pToken));
 
-        cpAttribKey->Release();
+        LPWSTR wTokenId;
+        HRESULT hr = pToken->GetId(&wTokenId);
         pToken->Release();
+        ThrowIfFailed(hr);
+
+        auto recognizer = m_recognizerCatalog.FindByTokenId(wTokenId);
+        CoTaskMemFree(wTokenId);
 
-        return language;
+        return recognizer ? recognizer->language : "";
     }
 
     void Stt::SetLanguage(std::string language)
     {
         ThrowIfFailed(CreateRecognizer());
 
-        IEnumSpObjectTokens* cpEnum = NULL;
-        ThrowIfFailed(SpEnumTokens(SPCAT_RECOGNIZERS, NULL, NULL, &cpEnum));
+        auto recognizer = m_recognizerCatalog.FindByLanguage(language);
+        if (!recognizer) return;
 
         ISpObjectToken* pToken = NULL;
+        ThrowIfFailed(SpGetTokenFromId(recognizer->tokenId.c_str(), &pToken));
 
-        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
+        // Loaded dictation belongs to the previous engine.
+        if (m_isDictationLoaded)
         {
-            ISpDataKey* cpAttribKey;
-            ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
-
-            LPWSTR wValue;
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
-
-            // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-            wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-            LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-            CoTaskMemFree(wValue);
-
-            if ((std::string)CW2A(locale) == language)
-            {
-                cpAttribKey->Release();
-                cpEnum->Release();
-
-                ThrowIfFailed(m_pRecognizer->SetRecognizer(pToken));
-                pToken->Release();
-                return;
-            }
-
-            cpAttribKey->Release();
-            pToken->Release();
+            m_pRecoGrammar->UnloadDictation();
+            m_isDictationLoaded = false;
+            m_session.OnEngineReleased();
         }
 
-        cpEnum->Release();
+        HRESULT hr;
+        {
+            TraceSpan span("sapi", "ISpRecognizer::SetRecognizer");
+            hr = m_pRecognizer->SetRecognizer(pToken);
+        }
+        pToken->Release();
+        ThrowIfFailed(hr);
     }
 
     // https://learn.microsoft.com/en-us/previous-versions/windows/desktop/ee431801(v=vs.85)#62-category-recognizers
     std::vector<std::string> Stt::GetLanguages()
     {
-        std::vector<std::string> languages;
+        return m_recognizerCatalog.GetLanguages();
+    }
 
-        IEnumSpObjectTokens* cpEnum = NULL;
-        ThrowIfFailed(SpEnumTokens(SPCAT_RECOGNIZERS, NULL, NULL, &cpEnum));
+    void Stt::Start(const SttSessionOptions& options) {
+        auto startedAt = SttSession::Clock::now();
 
-        ISpObjectToken* pToken = NULL;
-        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
+        CancelIdleRelease();
+        m_session.SetOptions(options);
+
+        bool warm = m_session.IsWarm();
+        if (!warm)
         {
-            ISpDataKey* cpAttribKey;
-            ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
+            auto privateBytes = GetPrivateBytes();
 
-            LPWSTR wValue;
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
+            ThrowIfFailed(PrepareSession());
 
-            // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-            wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-            LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-            CoTaskMemFree(wValue);
+            auto newPrivateBytes = GetPrivateBytes();
+            m_session.OnEngineCreated(newPrivateBytes > privateBytes ? newPrivateBytes - privateBytes : 0);
+        }
 
-            languages.push_back((std::string)CW2A(locale));
+        // Offsets of phrases are reported relative to the session start.
+        SPRECOGNIZERSTATUS status;
+        m_streamTimeOrigin = SUCCEEDED(m_pRecognizer->GetStatus(&status)) ? status.ullRecognitionStreamTime : 0;
+        m_phraseSequence = 0;
 
-            cpAttribKey->Release();
-            pToken->Release();
+        m_hypotheses.SetInterval(options.hypothesisInterval);
+        m_hypotheses.Reset();
+
+        // Warm path: engine, audio input and dictation are already there.
+        {
+            TraceSpan span("sapi", "ISpRecoGrammar::SetDictationState");
+            ThrowIfFailed(m_pRecoGrammar->SetDictationState(SPRS_ACTIVE));
         }
+        m_isListening = true;
 
-        cpEnum->Release();
+        ScheduleSessionTimers();
+        StartAudioLevels();
 
-        return languages;
+        m_session.OnStarted(startedAt, warm);
+
+        m_stateEventHandler->Success(flutter::EncodableValue(1));
     }
 
-    void Stt::Start() {
-        ThrowIfFailed(CreateRecognizer());
+    void Stt::Stop()
+    {
+        CancelSessionTimers();
+        CancelHypothesisFlush();
+        StopAudioLevels();
+
+        if (m_isListening)
+        {
+            TraceSpan span("sapi", "ISpRecoGrammar::SetDictationState");
+            m_pRecoGrammar->SetDictationState(SPRS_INACTIVE);
+            m_isListening = false;
+
+            m_stateEventHandler->Success(flutter::EncodableValue(0));
+        }
+
+        if (m_session.ShouldKeepWarm())
+        {
+            ScheduleIdleRelease();
+        }
+        else
+        {
+            Release();
+        }
+    }
+
+    void Stt::Dispose()
+    {
+        Stop();
+        Release();
+    }
+
+    const SttSessionStats& Stt::GetSessionStats() const
+    {
+        return m_session.GetStats();
+    }
+
+    HRESULT Stt::PrepareSession()
+    {
+        HRESULT hr = CreateRecognizer();
+        if (FAILED(hr)) return hr;
 
-        ThrowIfFailed(m_pRecoContext->SetNotifyCallbackFunction((SPNOTIFYCALLBACK*)Stt::RecoEventCallback, (WPARAM)this, 0));
+        hr = m_pRecoContext->SetNotifyCallbackFunction((SPNOTIFYCALLBACK*)Stt::RecoEventCallback, (WPARAM)this, 0);
+        if (FAILED(hr)) return hr;
 
         auto interests = SPFEI(SPEI_RECOGNITION) | SPFEI(SPEI_HYPOTHESIS);
-        ThrowIfFailed(m_pRecoContext->SetInterest(interests, interests));
+        hr = m_pRecoContext->SetInterest(interests, interests);
+        if (FAILED(hr)) return hr;
+
+        hr = SetTappedInput();
+        if (FAILED(hr)) return hr;
+
+        if (!m_isDictationLoaded)
+        {
+            TraceSpan span("sapi", "ISpRecoGrammar::LoadDictation");
+            hr = m_pRecoGrammar->LoadDictation(NULL, SPLO_STATIC);
+            if (FAILED(hr)) return hr;
+
+            m_isDictationLoaded = true;
+        }
+
+        return hr;
+    }
+
+    // Default audio input, wrapped to measure what the recognizer hears.
+    HRESULT Stt::SetTappedInput()
+    {
+        TraceSpan span("sapi", "ISpRecognizer::SetInput");
 
         ISpObjectToken* token;
-        ThrowIfFailed(SpGetDefaultTokenFromCategoryId(SPCAT_AUDIOIN, &token));
+        HRESULT hr = SpGetDefaultTokenFromCategoryId(SPCAT_AUDIOIN, &token);
+        if (FAILED(hr)) return hr;
 
-        ThrowIfFailed(m_pRecognizer->SetInput(token, TRUE));
-        ThrowIfFailed(m_pRecoGrammar->LoadDictation(NULL, SPLO_STATIC));
-        ThrowIfFailed(m_pRecoGrammar->SetDictationState(SPRS_ACTIVE));
+        ISpAudio* pDevice = NULL;
+        hr = SpCreateObjectFromToken(token, &pDevice);
+        token->Release();
+        if (FAILED(hr)) return hr;
 
-        m_stateEventHandler->Success(flutter::EncodableValue(1));
+        ISpAudio* pAudio = NULL;
+        hr = TappedAudioInput::Create(pDevice, m_audioTap, &pAudio);
+        pDevice->Release();
+        if (FAILED(hr)) return hr;
+
+        hr = m_pRecognizer->SetInput(pAudio, TRUE);
+        pAudio->Release();
+        return hr;
     }
 
-    void Stt::Stop()
+    void Stt::Release()
     {
+        TraceSpan span("sapi", "Stt::Release");
+
+        CancelIdleRelease();
+        CancelSessionTimers();
+        CancelHypothesisFlush();
+        StopAudioLevels();
+
         if (m_pRecoGrammar)
         {
-            m_pRecoGrammar->SetDictationState(SPRS_INACTIVE);
-            m_pRecoGrammar->UnloadDictation();
+            if (m_isListening)
+            {
+                m_pRecoGrammar->SetDictationState(SPRS_INACTIVE);
+            }
+            if (m_isDictationLoaded)
+            {
+                m_pRecoGrammar->UnloadDictation();
+            }
         }
 
         if (m_pRecognizer)
@@ -201,14 +352,274 @@ namespace stts {
         {
             m_pRecoGrammar->Release();
             m_pRecoGrammar = NULL;
+        }
 
+        if (m_isListening)
+        {
+            m_isListening = false;
             m_stateEventHandler->Success(flutter::EncodableValue(0));
         }
+
+        m_isDictationLoaded = false;
+        m_session.OnEngineReleased();
     }
 
-    void Stt::Dispose()
+    void Stt::ScheduleIdleRelease()
     {
-        Stop();
+        CancelIdleRelease();
+
+        m_idleReleaseTaskId = m_scheduler->Schedule(m_session.GetOptions().idleTimeout, [this]() {
+            m_idleReleaseTaskId = 0;
+
+            if (!m_isListening)
+            {
+                Release();
+            }
+        });
+    }
+
+    void Stt::CancelIdleRelease()
+    {
+        if (m_idleReleaseTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_idleReleaseTaskId);
+            m_idleReleaseTaskId = 0;
+        }
+    }
+
+    void Stt::ScheduleSessionTimers()
+    {
+        CancelSessionTimers();
+
+        const auto& options = m_session.GetOptions();
+
+        if (options.maxDuration.count() > 0)
+        {
+            m_maxDurationTaskId = m_scheduler->Schedule(options.maxDuration, [this]() {
+                m_maxDurationTaskId = 0;
+                Stop();
+            });
+        }
+
+        ResetSilenceTimer();
+    }
+
+    void Stt::ResetSilenceTimer()
+    {
+        const auto& options = m_session.GetOptions();
+        if (options.silenceTimeout.count() <= 0) return;
+
+        if (m_silenceTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_silenceTaskId);
+        }
+
+        m_silenceTaskId = m_scheduler->Schedule(options.silenceTimeout, [this]() {
+            m_silenceTaskId = 0;
+            Stop();
+        });
+    }
+
+    void Stt::CancelSessionTimers()
+    {
+        if (m_maxDurationTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_maxDurationTaskId);
+            m_maxDurationTaskId = 0;
+        }
+
+        if (m_silenceTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_silenceTaskId);
+            m_silenceTaskId = 0;
+        }
+    }
+
+    void Stt::OnHypothesis(const WCHAR* text, ULONGLONG position)
+    {
+        m_hypothesisPosition = position;
+
+        HypothesisDelta delta;
+        if (m_hypotheses.Push(text, HypothesisCoalescer::Clock::now(), delta))
+        {
+            CancelHypothesisFlush();
+            SendHypothesis(delta);
+        }
+        else if (m_hypothesisFlushTaskId == 0)
+        {
+            ScheduleHypothesisFlush();
+        }
+    }
+
+    void Stt::ScheduleHypothesisFlush()
+    {
+        auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+            m_hypotheses.GetNextEmitTime() - HypothesisCoalescer::Clock::now());
+        if (delay.count() < 0) delay = std::chrono::milliseconds(0);
+
+        m_hypothesisFlushTaskId = m_scheduler->Schedule(delay, [this]() {
+            m_hypothesisFlushTaskId = 0;
+
+            HypothesisDelta delta;
+            if (m_isListening && m_hypotheses.Flush(delta))
+            {
+                SendHypothesis(delta);
+                FlushResults();
+            }
+        });
+    }
+
+    void Stt::CancelHypothesisFlush()
+    {
+        if (m_hypothesisFlushTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_hypothesisFlushTaskId);
+            m_hypothesisFlushTaskId = 0;
+        }
+    }
+
+    // Hypotheses only carry what changed since the previous one:
+    // text = previous.substring(0, stable) + suffix.
+    void Stt::SendHypothesis(const HypothesisDelta& delta)
+    {
+        auto suffix = Utf8FromUtf16(delta.unstableSuffix);
+
+        if (m_session.GetOptions().compactEvents)
+        {
+            EventRecord record;
+            record.type = EventType::hypothesis;
+            record.sequence = static_cast<uint32_t>(delta.sequence);
+            record.timestamp = static_cast<int64_t>(m_hypothesisPosition);
+            record.arg0 = static_cast<uint32_t>(delta.stableLength);
+            record.payload = suffix;
+
+            m_resultEncoder.Write(record);
+            return;
+        }
+
+        flutter::EncodableMap result({
+            {flutter::EncodableValue("isFinal"), flutter::EncodableValue(false)},
+            {flutter::EncodableValue("revision"), flutter::EncodableValue(static_cast<int64_t>(delta.sequence))},
+            {flutter::EncodableValue("stable"), flutter::EncodableValue(static_cast<int64_t>(delta.stableLength))},
+            {flutter::EncodableValue("suffix"), flutter::EncodableValue(suffix)},
+            {flutter::EncodableValue("position"), flutter::EncodableValue(static_cast<int64_t>(m_hypothesisPosition))}
+        });
+
+        m_resultBatch.push_back(flutter::EncodableValue(result));
+    }
+
+    void Stt::StartAudioLevels()
+    {
+        StopAudioLevels();
+
+        if (m_session.GetOptions().levelInterval.count() <= 0) return;
+
+        // Audio from a previous session.
+        m_audioTap->ring.Skip();
+        m_levelMeter.Reset();
+
+        m_audioTap->enabled.store(true);
+        ScheduleAudioLevel();
+    }
+
+    void Stt::ScheduleAudioLevel()
+    {
+        m_levelTaskId = m_scheduler->Schedule(m_session.GetOptions().levelInterval, [this]() {
+            m_levelTaskId = 0;
+
+            if (!m_isListening) return;
+
+            SendAudioLevel();
+            ScheduleAudioLevel();
+        });
+    }
+
+    void Stt::SendAudioLevel()
+    {
+        auto sampleRate = m_audioTap->sampleRate.load();
+        if (sampleRate == 0) return;
+
+        m_levelMeter.SetFormat(sampleRate, m_audioTap->channels.load());
+
+        size_t read;
+        while ((read = m_audioTap->ring.Read(m_levelBuffer.data(), m_levelBuffer.size())) > 0)
+        {
+            m_levelMeter.Process(m_levelBuffer.data(), read);
+        }
+
+        AudioLevel level;
+        if (!m_levelMeter.TakeLevel(level)) return;
+
+        m_levelEventHandler->Success(flutter::EncodableValue(flutter::EncodableMap({
+            {flutter::EncodableValue("rms"), flutter::EncodableValue(static_cast<double>(level.rms))},
+            {flutter::EncodableValue("peak"), flutter::EncodableValue(static_cast<double>(level.peak))},
+            {flutter::EncodableValue("voice"), flutter::EncodableValue(level.voice)}
+        })), EventPriority::low);
+    }
+
+    void Stt::StopAudioLevels()
+    {
+        m_audioTap->enabled.store(false);
+
+        if (m_levelTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_levelTaskId);
+            m_levelTaskId = 0;
+        }
+    }
+
+    void Stt::QueueResult(const std::string& text, ULONGLONG position, ISpRecoResult* pResult)
+    {
+        auto sequence = m_phraseSequence++;
+        m_hasFinalResult = true;
+
+        // 100ns units.
+        SPRECORESULTTIMES times;
+        bool hasTimes = SUCCEEDED(pResult->GetResultTimes(&times));
+        auto offsetMs = hasTimes && times.ullStart > m_streamTimeOrigin ? (times.ullStart - m_streamTimeOrigin) / 10000 : 0;
+        auto durationMs = hasTimes ? times.ullLength / 10000 : 0;
+
+        if (m_session.GetOptions().compactEvents)
+        {
+            EventRecord record;
+            record.type = EventType::result;
+            record.flags = static_cast<uint8_t>(eventFlagFinal | (hasTimes ? eventFlagHasTimes : 0));
+            record.sequence = static_cast<uint32_t>(sequence);
+            record.timestamp = static_cast<int64_t>(position);
+            record.arg0 = static_cast<uint32_t>(offsetMs);
+            record.arg1 = static_cast<uint32_t>(durationMs);
+            record.payload = text;
+
+            m_resultEncoder.Write(record);
+            return;
+        }
+
+        flutter::EncodableMap result({
+            {flutter::EncodableValue("text"), flutter::EncodableValue(text)},
+            {flutter::EncodableValue("isFinal"), flutter::EncodableValue(true)},
+            {flutter::EncodableValue("position"), flutter::EncodableValue(static_cast<int64_t>(position))},
+            {flutter::EncodableValue("sequence"), flutter::EncodableValue(static_cast<int64_t>(sequence))}
+        });
+
+        if (hasTimes)
+        {
+            result[flutter::EncodableValue("offset")] = flutter::EncodableValue(static_cast<int64_t>(offsetMs));
+            result[flutter::EncodableValue("duration")] = flutter::EncodableValue(static_cast<int64_t>(durationMs));
+        }
+
+        m_resultBatch.push_back(flutter::EncodableValue(result));
+    }
+
+    // static
+    size_t Stt::GetPrivateBytes()
+    {
+        PROCESS_MEMORY_COUNTERS_EX counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+        {
+            return 0;
+        }
+
+        return counters.PrivateUsage;
     }
 
     HRESULT Stt::CreateRecognizer()
@@ -217,16 +628,19 @@ namespace stts {
 
         if (m_pRecognizer == NULL)
         {
+            TraceSpan span("sapi", "CoCreateInstance(SpInprocRecognizer)");
             hr = CoCreateInstance(CLSID_SpInprocRecognizer, NULL, CLSCTX_ALL, IID_ISpRecognizer, (void**)&m_pRecognizer);
             if (FAILED(hr)) return hr;
         }
         if (m_pRecoContext == NULL)
         {
+            TraceSpan span("sapi", "ISpRecognizer::CreateRecoContext");
             hr = m_pRecognizer->CreateRecoContext(&m_pRecoContext);
             if (FAILED(hr)) return hr;
         }
         if (m_pRecoGrammar == NULL)
         {
+            TraceSpan span("sapi", "ISpRecoContext::CreateGrammar");
             hr = m_pRecoContext->CreateGrammar(0, &m_pRecoGrammar); // ID = 0
             if (FAILED(hr)) return hr;
         }
@@ -234,6 +648,25 @@ namespace stts {
         return hr;
     }
 
+    std::wstring Stt::GetRecognizerTokenId()
+    {
+        if (!m_pRecognizer) return L"";
+
+        ISpObjectToken* pToken = NULL;
+        if (FAILED(m_pRecognizer->GetRecognizer(&pToken)) || !pToken) return L"";
+
+        std::wstring tokenId;
+        LPWSTR wTokenId;
+        if (SUCCEEDED(pToken->GetId(&wTokenId)))
+        {
+            tokenId = wTokenId;
+            CoTaskMemFree(wTokenId);
+        }
+        pToken->Release();
+
+        return tokenId;
+    }
+
     // Display the engine's training window
     void Stt::ShowTrainingUI(std::vector<std::wstring>& trainingTexts)
     {
@@ -2,6 +2,13 @@
 #include <string>
 #include <vector>
 #include "../event_stream_handler.h"
+#include "../catalog/engine_catalog.h"
+#include "../worker/engine_worker.h"
+#include "stt_session.h"
+#include "hypothesis_coalescer.h"
+#include "../codec/event_codec.h"
+#include "../audio/audio_level_meter.h"
+#include "../audio/audio_tap.h"
 
 #include <sapi.h>
 #pragma warning(disable:4996)
@@ -13,18 +20,25 @@ namespace stts {
 	class Stt
 	{
 	public:
-		Stt(EventStreamHandler* stateEventHandler, EventStreamHandler* resultEventHandler);
+		Stt(EventStreamHandler* stateEventHandler, EventStreamHandler* resultEventHandler, EventStreamHandler* levelEventHandler, TaskScheduler* scheduler);
 		~Stt();
 
+		// Checks that a recognizer is registered, no engine is created.
 		bool IsSupported();
+		// Changes when recognizers are installed or removed, 0 if they cannot be enumerated.
+		uint64_t GetEnginesGeneration();
 		std::string getLanguage();
 		void SetLanguage(std::string language);
 		std::vector<std::string> GetLanguages();
-		void Start();
+		void Start(const SttSessionOptions& options);
 		void Stop();
 		void ShowTrainingUI(std::vector<std::wstring>& trainingTexts);
+		// Empty if no engine is selected yet.
+		std::wstring GetRecognizerTokenId();
 		void Dispose();
 
+		const SttSessionStats& GetSessionStats() const;
+
 		static void RecoEventCallback(WPARAM wParam, LPARAM lParam);
 
 	private:
@@ -32,10 +46,70 @@ namespace stts {
 		ISpRecoContext* m_pRecoContext;
 		ISpRecoGrammar* m_pRecoGrammar;
 
+		EngineCatalog m_recognizerCatalog;
+
 		EventStreamHandler* m_stateEventHandler;
 		EventStreamHandler* m_resultEventHandler;
+		EventStreamHandler* m_levelEventHandler;
+
+		TaskScheduler* m_scheduler;
+		SttSession m_session;
+		bool m_isListening = false;
+		bool m_isDictationLoaded = false;
+
+		uint64_t m_idleReleaseTaskId = 0;
+		uint64_t m_maxDurationTaskId = 0;
+		uint64_t m_silenceTaskId = 0;
+
+		HypothesisCoalescer m_hypotheses;
+		uint64_t m_hypothesisFlushTaskId = 0;
+		// Audio stream offset of the last hypothesis, in bytes.
+		ULONGLONG m_hypothesisPosition = 0;
+
+		// Results of the current event pump cycle, sent as a single message.
+		flutter::EncodableList m_resultBatch;
+		// Same, when compact events are enabled.
+		EventEncoder m_resultEncoder;
+		// Batches of hypotheses only may be dropped when events pile up.
+		bool m_hasFinalResult = false;
+
+		// Copy of the audio read by the recognizer, measured on this thread.
+		std::shared_ptr<AudioTap> m_audioTap;
+		AudioLevelMeter m_levelMeter;
+		std::vector<int16_t> m_levelBuffer;
+		uint64_t m_levelTaskId = 0;
+
+		// Recognizer stream time at session start, in 100ns units.
+		ULONGLONG m_streamTimeOrigin = 0;
+		uint64_t m_phraseSequence = 0;
 
 		HRESULT CreateRecognizer();
+		HRESULT PrepareSession();
+		void Release();
+
+		void ScheduleIdleRelease();
+		void CancelIdleRelease();
+		void ScheduleSessionTimers();
+		void ResetSilenceTimer();
+		void CancelSessionTimers();
+
+		void OnRecoEvent(CSpEvent& event);
+		void FlushResults();
+
+		void OnHypothesis(const WCHAR* text, ULONGLONG position);
+		void ScheduleHypothesisFlush();
+		void CancelHypothesisFlush();
+		void SendHypothesis(const HypothesisDelta& delta);
+
+		HRESULT SetTappedInput();
+		void StartAudioLevels();
+		void ScheduleAudioLevel();
+		void SendAudioLevel();
+		void StopAudioLevels();
+
+		void QueueResult(const std::string& text, ULONGLONG position, ISpRecoResult* pResult);
+
+		static size_t GetPrivateBytes();
 
 		void ThrowIfFailed(HRESULT code);
 	};
@@ -0,0 +1,32 @@
+#include "stt_session.h"
+
+namespace stts {
+
+    void SttSession::OnEngineCreated(size_t footprint)
+    {
+        m_isWarm = true;
+        m_stats.engineFootprint = footprint;
+    }
+
+    void SttSession::OnEngineReleased()
+    {
+        m_isWarm = false;
+    }
+
+    void SttSession::OnStarted(Clock::time_point startedAt, bool warm)
+    {
+        m_stats.starts++;
+        if (warm) m_stats.warmStarts++;
+
+        m_stats.lastStartWarm = warm;
+        m_stats.lastStartLatency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startedAt);
+    }
+
+    bool SttSession::ShouldKeepWarm() const
+    {
+        if (m_options.idleTimeout.count() <= 0) return false;
+
+        return m_options.memoryBudget == 0 || m_stats.engineFootprint <= m_options.memoryBudget;
+    }
+
+}
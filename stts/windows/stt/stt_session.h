@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace stts {
+
+	struct SttSessionOptions {
+		// Delay before releasing an unused engine. Zero releases the engine on stop.
+		std::chrono::milliseconds idleTimeout{ 60000 };
+		// Maximum memory footprint allowed to keep the engine warm, in bytes. Zero means no limit.
+		size_t memoryBudget = 0;
+
+		// Keeps listening after each final phrase until stopped.
+		bool continuous = false;
+		// Stops the session after this duration. Zero means no limit.
+		std::chrono::milliseconds maxDuration{ 0 };
+		// Stops the session when nothing is heard for this duration. Zero means no limit.
+		std::chrono::milliseconds silenceTimeout{ 0 };
+
+		// Minimum delay between two hypotheses. Zero sends every hypothesis.
+		std::chrono::milliseconds hypothesisInterval{ 100 };
+		// Sends results as packed records (see EventEncoder) instead of maps.
+		bool compactEvents = false;
+
+		// Interval of audio level events. Zero disables them.
+		std::chrono::milliseconds levelInterval{ 0 };
+	};
+
+	struct SttSessionStats {
+		uint64_t starts = 0;
+		uint64_t warmStarts = 0;
+		// Time from start request to listening for the last session.
+		std::chrono::microseconds lastStartLatency{ 0 };
+		bool lastStartWarm = false;
+		// Memory allocated by the engine when it was created, in bytes.
+		size_t engineFootprint = 0;
+	};
+
+	// Lifecycle policy of the recognition engine between sessions.
+	//
+	// Keeps track of whether the engine is warm (created with dictation loaded)
+	// and decides when it should be released.
+	class SttSession {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		void SetOptions(const SttSessionOptions& options) { m_options = options; }
+		const SttSessionOptions& GetOptions() const { return m_options; }
+
+		const SttSessionStats& GetStats() const { return m_stats; }
+
+		bool IsWarm() const { return m_isWarm; }
+
+		// Engine is fully prepared, footprint is the memory allocated to prepare it.
+		void OnEngineCreated(size_t footprint);
+		void OnEngineReleased();
+
+		// Records a session start which began at startedAt and is now listening.
+		void OnStarted(Clock::time_point startedAt, bool warm);
+
+		// Whether the engine should be kept alive after a session ends.
+		bool ShouldKeepWarm() const;
+
+	private:
+		SttSessionOptions m_options;
+		SttSessionStats m_stats;
+		bool m_isWarm = false;
+	};
+
+}
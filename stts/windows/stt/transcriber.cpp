@@ -0,0 +1,223 @@
+#include "transcriber.h"
+#include "../utils.h"
+#include "../sapi_event_pump.h"
+#include "../audio/pcm_source_stream.h"
+
+namespace stts {
+
+    // Cancellation and progress are checked at least at this interval.
+    static const DWORD kWaitIntervalMs = 100;
+
+    Transcriber::~Transcriber()
+    {
+        Release();
+    }
+
+    std::vector<TranscribedPhrase> Transcriber::Transcribe(
+        std::shared_ptr<PcmSource> source,
+        const std::wstring& recognizerTokenId,
+        const CancellationToken& cancellationToken,
+        ProgressCallback onProgress)
+    {
+        std::vector<TranscribedPhrase> phrases;
+
+        HRESULT hr = PrepareEngine(recognizerTokenId);
+        if (SUCCEEDED(hr))
+        {
+            hr = Run(source, cancellationToken, onProgress, phrases);
+        }
+
+        if (FAILED(hr))
+        {
+            // Engine state is unknown, start over next time.
+            Release();
+            throw hr;
+        }
+
+        return phrases;
+    }
+
+    void Transcriber::Release()
+    {
+        if (m_pRecoGrammar)
+        {
+            m_pRecoGrammar->Release();
+            m_pRecoGrammar = NULL;
+        }
+
+        if (m_pRecoContext)
+        {
+            m_pRecoContext->Release();
+            m_pRecoContext = NULL;
+        }
+
+        if (m_pRecognizer)
+        {
+            m_pRecognizer->Release();
+            m_pRecognizer = NULL;
+        }
+
+        m_recognizerTokenId.clear();
+    }
+
+    // static
+    HRESULT Transcriber::GetWavError(WavError error)
+    {
+        switch (error)
+        {
+        case WavError::none:
+            return S_OK;
+        case WavError::unsupportedFormat:
+            return SPERR_UNSUPPORTED_FORMAT;
+        default:
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+    }
+
+    HRESULT Transcriber::PrepareEngine(const std::wstring& recognizerTokenId)
+    {
+        if (m_pRecognizer && m_recognizerTokenId == recognizerTokenId) return S_OK;
+
+        Release();
+
+        HRESULT hr = CoCreateInstance(CLSID_SpInprocRecognizer, NULL, CLSCTX_ALL, IID_ISpRecognizer, (void**)&m_pRecognizer);
+        if (FAILED(hr)) return hr;
+
+        if (!recognizerTokenId.empty())
+        {
+            ISpObjectToken* pToken = NULL;
+            hr = SpGetTokenFromId(recognizerTokenId.c_str(), &pToken);
+            if (FAILED(hr)) return hr;
+
+            hr = m_pRecognizer->SetRecognizer(pToken);
+            pToken->Release();
+            if (FAILED(hr)) return hr;
+        }
+
+        hr = m_pRecognizer->CreateRecoContext(&m_pRecoContext);
+        if (FAILED(hr)) return hr;
+
+        hr = m_pRecoContext->SetNotifyWin32Event();
+        if (FAILED(hr)) return hr;
+
+        auto interests = SPFEI(SPEI_RECOGNITION) | SPFEI(SPEI_END_SR_STREAM);
+        hr = m_pRecoContext->SetInterest(interests, interests);
+        if (FAILED(hr)) return hr;
+
+        hr = m_pRecoContext->CreateGrammar(0, &m_pRecoGrammar);
+        if (FAILED(hr)) return hr;
+
+        hr = m_pRecoGrammar->LoadDictation(NULL, SPLO_STATIC);
+        if (FAILED(hr)) return hr;
+
+        m_recognizerTokenId = recognizerTokenId;
+        return S_OK;
+    }
+
+    HRESULT Transcriber::Run(
+        std::shared_ptr<PcmSource> source,
+        const CancellationToken& cancellationToken,
+        const ProgressCallback& onProgress,
+        std::vector<TranscribedPhrase>& phrases)
+    {
+        ISpStream* pStream = NULL;
+        HRESULT hr = PcmSourceStream::CreateSpStream(source, &pStream);
+        if (FAILED(hr)) return hr;
+
+        hr = m_pRecognizer->SetInput(pStream, TRUE);
+
+        // Offsets are reported relative to the start of this stream.
+        SPRECOGNIZERSTATUS status;
+        ULONGLONG streamTimeOrigin = 0;
+        ULONGLONG streamPosOrigin = 0;
+        if (SUCCEEDED(hr) && SUCCEEDED(m_pRecognizer->GetStatus(&status)))
+        {
+            streamTimeOrigin = status.ullRecognitionStreamTime;
+            streamPosOrigin = status.ullRecognitionStreamPos;
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            hr = m_pRecoGrammar->SetDictationState(SPRS_ACTIVE);
+        }
+
+        auto size = source->GetSize();
+        double progress = 0;
+
+        bool ended = false;
+        while (SUCCEEDED(hr) && !ended)
+        {
+            if (cancellationToken.ShouldStop())
+            {
+                hr = E_ABORT;
+                break;
+            }
+
+            if (m_pRecoContext->WaitForNotifyEvent(kWaitIntervalMs) == S_OK)
+            {
+                PumpEvents(m_pRecoContext, [&phrases, &ended, streamTimeOrigin](CSpEvent& event) {
+                    if (SPEI_RECOGNITION == event.eEventId)
+                    {
+                        AddPhrase(event.RecoResult(), streamTimeOrigin, phrases);
+                    }
+                    else if (SPEI_END_SR_STREAM == event.eEventId)
+                    {
+                        ended = true;
+                    }
+                });
+            }
+
+            if (onProgress && size > 0 && !ended && SUCCEEDED(m_pRecognizer->GetStatus(&status)))
+            {
+                auto position = status.ullRecognitionStreamPos > streamPosOrigin ? status.ullRecognitionStreamPos - streamPosOrigin : 0;
+                auto current = min(1.0, static_cast<double>(position) / static_cast<double>(size));
+
+                // Percent steps.
+                if (current - progress >= 0.01)
+                {
+                    progress = current;
+                    onProgress(progress);
+                }
+            }
+        }
+
+        m_pRecoGrammar->SetDictationState(SPRS_INACTIVE);
+        m_pRecognizer->SetInput(NULL, FALSE);
+
+        pStream->Close();
+        pStream->Release();
+
+        if (SUCCEEDED(hr) && onProgress)
+        {
+            onProgress(1.0);
+        }
+
+        return hr;
+    }
+
+    // static
+    void Transcriber::AddPhrase(ISpRecoResult* pResult, ULONGLONG streamTimeOrigin, std::vector<TranscribedPhrase>& phrases)
+    {
+        LPWSTR dstrText;
+        if (FAILED(pResult->GetText((ULONG)SP_GETWHOLEPHRASE, (ULONG)SP_GETWHOLEPHRASE, TRUE, &dstrText, NULL)))
+        {
+            return;
+        }
+
+        TranscribedPhrase phrase;
+        phrase.text = Utf8FromUtf16(dstrText, wcslen(dstrText));
+        CoTaskMemFree(dstrText);
+
+        // 100ns units.
+        SPRECORESULTTIMES times;
+        if (SUCCEEDED(pResult->GetResultTimes(&times)))
+        {
+            auto offset = times.ullStart > streamTimeOrigin ? times.ullStart - streamTimeOrigin : 0;
+            phrase.offset = std::chrono::milliseconds(offset / 10000);
+            phrase.duration = std::chrono::milliseconds(times.ullLength / 10000);
+        }
+
+        phrases.push_back(std::move(phrase));
+    }
+
+}
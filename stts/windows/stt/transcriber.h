@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../audio/pcm_source.h"
+#include "../worker/engine_worker.h"
+
+#include <sapi.h>
+#pragma warning(disable:4996)
+#include <sphelper.h>
+#pragma warning(default: 4996)
+
+namespace stts {
+
+	struct TranscribedPhrase {
+		std::string text;
+		// From the start of the audio.
+		std::chrono::milliseconds offset{ 0 };
+		std::chrono::milliseconds duration{ 0 };
+	};
+
+	// Recognizes recorded audio with a dedicated in-process recognizer.
+	// Audio is consumed as fast as the engine can process it, not in real time.
+	// The engine is kept between transcriptions, it must be used and released on the same thread.
+	class Transcriber
+	{
+	public:
+		// Processed part of the audio, from 0 to 1.
+		using ProgressCallback = std::function<void(double progress)>;
+
+		// Result types of TranscriptionScheduler.
+		using Status = HRESULT;
+		using Phrase = TranscribedPhrase;
+		static constexpr HRESULT succeeded = S_OK;
+		static constexpr HRESULT cancelled = E_ABORT;
+
+		~Transcriber();
+
+		// Blocks until the end of the audio. Empty recognizer token ID selects the default engine.
+		// Throws E_ABORT if the cancellation token stops first.
+		std::vector<TranscribedPhrase> Transcribe(
+			std::shared_ptr<PcmSource> source,
+			const std::wstring& recognizerTokenId,
+			const CancellationToken& cancellationToken,
+			ProgressCallback onProgress = nullptr);
+
+		void Release();
+
+		static HRESULT GetWavError(WavError error);
+
+	private:
+		ISpRecognizer* m_pRecognizer = NULL;
+		ISpRecoContext* m_pRecoContext = NULL;
+		ISpRecoGrammar* m_pRecoGrammar = NULL;
+		std::wstring m_recognizerTokenId;
+
+		HRESULT PrepareEngine(const std::wstring& recognizerTokenId);
+
+		HRESULT Run(
+			std::shared_ptr<PcmSource> source,
+			const CancellationToken& cancellationToken,
+			const ProgressCallback& onProgress,
+			std::vector<TranscribedPhrase>& phrases);
+
+		static void AddPhrase(ISpRecoResult* pResult, ULONGLONG streamTimeOrigin, std::vector<TranscribedPhrase>& phrases);
+	};
+
+}
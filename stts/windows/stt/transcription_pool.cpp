@@ -0,0 +1,50 @@
+#include "transcription_pool.h"
+
+#include <objbase.h>
+
+namespace stts {
+
+    TranscriptionPool::TranscriptionPool(size_t workerCount, ProgressCallback onProgress, CompletionCallback onComplete)
+        : TranscriptionScheduler(workerCount, std::move(onProgress), std::move(onComplete))
+    {
+        Start();
+    }
+
+    TranscriptionPool::~TranscriptionPool()
+    {
+        // Workers use members of this class.
+        Stop();
+    }
+
+    uint64_t TranscriptionPool::Queue(const std::string& path, const std::wstring& recognizerTokenId)
+    {
+        // Files are read by the worker so queueing never blocks the caller.
+        return Queue([path](std::unique_ptr<PcmSource>& source) { return LoadWavFile(path, source); }, recognizerTokenId);
+    }
+
+    // static
+    HRESULT TranscriptionPool::LoadWavFile(const std::string& path, std::unique_ptr<PcmSource>& source)
+    {
+        std::vector<uint8_t> bytes;
+        if (!PcmSource::ReadFile(path, bytes))
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        return Transcriber::GetWavError(PcmSource::FromWav(std::move(bytes), source));
+    }
+
+    void TranscriptionPool::OnWorkerStart(size_t workerIndex)
+    {
+        // Recognizers are free threaded, no message pump needed.
+        CoInitializeEx(NULL, COINIT_MULTITHREADED);
+        TranscriptionScheduler::OnWorkerStart(workerIndex);
+    }
+
+    void TranscriptionPool::OnWorkerStop(size_t workerIndex)
+    {
+        TranscriptionScheduler::OnWorkerStop(workerIndex);
+        CoUninitialize();
+    }
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "transcriber.h"
+#include "transcription_scheduler.h"
+
+namespace stts {
+
+	// Transcribes queued WAV files in parallel, one in-process recognizer per worker thread.
+	// Statuses are HRESULTs, E_ABORT means cancelled.
+	class TranscriptionPool : public TranscriptionScheduler<Transcriber>
+	{
+	public:
+		TranscriptionPool(size_t workerCount, ProgressCallback onProgress, CompletionCallback onComplete);
+		~TranscriptionPool() override;
+
+		using TranscriptionScheduler::Queue;
+
+		// Reports to the pool callbacks. Empty recognizer token ID selects the default engine.
+		// Returns the job ID, or 0 if the pool is stopped.
+		uint64_t Queue(const std::string& path, const std::wstring& recognizerTokenId);
+
+		static HRESULT LoadWavFile(const std::string& path, std::unique_ptr<PcmSource>& source);
+
+	protected:
+		void OnWorkerStart(size_t workerIndex) override;
+		void OnWorkerStop(size_t workerIndex) override;
+	};
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../audio/pcm_source.h"
+#include "../worker/work_stealing_pool.h"
+
+namespace stts {
+
+	// Transcribes queued audio in parallel, one recognizer per worker thread.
+	// Callbacks are invoked from the worker threads.
+	//
+	// Recognizer is created and destroyed on its worker thread and must provide:
+	//   Status, Phrase: result types, with the static constants succeeded and cancelled of type Status.
+	//   std::vector<Phrase> Transcribe(std::shared_ptr<PcmSource> source, const std::wstring& recognizerTokenId,
+	//       const CancellationToken& cancellationToken, std::function<void(double progress)> onProgress);
+	//     which blocks until the end of the audio and throws a Status on failure.
+	// Derived classes must call Start once constructed and Stop in their destructor.
+	template <typename Recognizer>
+	class TranscriptionScheduler : public WorkStealingPool
+	{
+	public:
+		using Status = typename Recognizer::Status;
+		using Phrase = typename Recognizer::Phrase;
+		using ProgressCallback = std::function<void(uint64_t jobId, double progress)>;
+		// Phrases are empty on failure.
+		using CompletionCallback = std::function<void(uint64_t jobId, Status status, const std::vector<Phrase>& phrases)>;
+		// Provides the audio of a job, called on the worker thread.
+		using SourceLoader = std::function<Status(std::unique_ptr<PcmSource>& source)>;
+
+		TranscriptionScheduler(size_t workerCount, ProgressCallback onProgress, CompletionCallback onComplete) :
+			WorkStealingPool(workerCount),
+			m_onProgress(std::move(onProgress)),
+			m_onComplete(std::move(onComplete))
+		{
+			m_recognizers.resize(GetWorkerCount());
+		}
+
+		// Reports to the pool callbacks. Empty recognizer token ID selects the default engine.
+		// Returns the job ID, or 0 if the pool is stopped.
+		uint64_t Queue(SourceLoader load, const std::wstring& recognizerTokenId)
+		{
+			return QueueJob(std::move(load), recognizerTokenId, m_onProgress, [this](uint64_t jobId, Status status, const std::vector<Phrase>& phrases) {
+				if (jobId != 0) m_onComplete(jobId, status, phrases);
+			});
+		}
+
+		// Same, reporting only the completion to onComplete instead of the pool callbacks.
+		// onComplete is called with the cancelled status and job ID 0 if the pool is stopped.
+		uint64_t Queue(SourceLoader load, const std::wstring& recognizerTokenId, CompletionCallback onComplete)
+		{
+			return QueueJob(std::move(load), recognizerTokenId, nullptr, std::move(onComplete));
+		}
+
+	protected:
+		void OnWorkerStart(size_t workerIndex) override
+		{
+			m_recognizers[workerIndex] = std::make_unique<Recognizer>();
+		}
+
+		void OnWorkerStop(size_t workerIndex) override
+		{
+			m_recognizers[workerIndex].reset();
+		}
+
+	private:
+		ProgressCallback m_onProgress;
+		CompletionCallback m_onComplete;
+
+		// Engines are kept per worker between jobs, accessed only by their own thread.
+		std::vector<std::unique_ptr<Recognizer>> m_recognizers;
+
+		uint64_t QueueJob(SourceLoader load, const std::wstring& recognizerTokenId, ProgressCallback onProgress, CompletionCallback onComplete)
+		{
+			PoolJob job;
+			job.run = [this, load, recognizerTokenId, onProgress, onComplete](uint64_t id, const CancellationToken& token, size_t workerIndex) mutable {
+				Transcribe(id, load, recognizerTokenId, onProgress, onComplete, token, workerIndex);
+			};
+			job.cancel = [onComplete](uint64_t id) {
+				onComplete(id, Recognizer::cancelled, {});
+			};
+
+			return Submit(std::move(job));
+		}
+
+		void Transcribe(uint64_t jobId, SourceLoader& load, const std::wstring& recognizerTokenId,
+			const ProgressCallback& onProgress, const CompletionCallback& onComplete,
+			const CancellationToken& cancellationToken, size_t workerIndex)
+		{
+			std::unique_ptr<PcmSource> source;
+			auto status = load(source);
+			if (status != Recognizer::succeeded)
+			{
+				onComplete(jobId, status, {});
+				return;
+			}
+
+			std::function<void(double progress)> onSourceProgress;
+			if (onProgress)
+			{
+				onSourceProgress = [&onProgress, jobId](double progress) { onProgress(jobId, progress); };
+			}
+
+			std::vector<Phrase> phrases;
+			try
+			{
+				phrases = m_recognizers[workerIndex]->Transcribe(std::move(source), recognizerTokenId, cancellationToken, onSourceProgress);
+			}
+			catch (Status error)
+			{
+				onComplete(jobId, error, {});
+				return;
+			}
+
+			onComplete(jobId, Recognizer::succeeded, phrases);
+		}
+	};
+
+}
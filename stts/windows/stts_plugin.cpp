@@ -9,12 +9,30 @@
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/standard_method_codec.h>
 #include "event_stream_handler.h"
+#include "audio/pcm_buffer.h"
+#include "audio/wav_writer.h"
+#include "trace/trace_recorder.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <memory>
 #include <sstream>
+#include <thread>
 
 namespace stts {
 
+	static const std::string kSttGroup = "stt";
+	static const std::string kTtsGroup = "tts";
+	// Starts are superseded by a later stop, settings and queries are not.
+	static const std::string kSttStartGroup = "stt.start";
+	static const std::string kTtsStartGroup = "tts.start";
+	static const std::string kSynthesisGroup = "synthesis";
+
+	// Capacity of pending engine commands.
+	static const size_t kEngineQueueCapacity = 64;
+	// Events of all channels waiting for the platform thread.
+	static const size_t kEventQueueCapacity = 1024;
+
 	// static
 	void SttsPlugin::RegisterWithRegistrar(flutter::PluginRegistrarWindows* registrar) {
 		auto plugin = std::make_unique<SttsPlugin>(registrar);
@@ -43,12 +61,16 @@ namespace stts {
 	}
 
 	SttsPlugin::SttsPlugin(flutter::PluginRegistrarWindows* registrar) {
+		mDispatcher = std::make_unique<PlatformDispatcher>();
+		mEventEgress = std::make_unique<EventEgress>(mDispatcher.get(), kEventQueueCapacity);
+		TraceRecorder::SetThreadName("platform");
+
 		// STT
 		auto sttStateEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
 			registrar->messenger(), "com.llfbandit.stt/states",
 			&StandardMethodCodec::GetInstance());
 
-		auto sttStateEventHandler = new EventStreamHandler();
+		auto sttStateEventHandler = new EventStreamHandler(mEventEgress.get(), "stt/states");
 		std::unique_ptr<StreamHandler<EncodableValue>> pSttStateEventHandler{ static_cast<StreamHandler<EncodableValue>*>(sttStateEventHandler) };
 		sttStateEventChannel->SetStreamHandler(std::move(pSttStateEventHandler));
 
@@ -56,328 +78,804 @@ namespace stts {
 			registrar->messenger(), "com.llfbandit.stt/results",
 			&StandardMethodCodec::GetInstance());
 
-		auto sttResultEventHandler = new EventStreamHandler();
+		auto sttResultEventHandler = new EventStreamHandler(mEventEgress.get(), "stt/results");
 		std::unique_ptr<StreamHandler<EncodableValue>> pSttResultEventHandler{ static_cast<StreamHandler<EncodableValue>*>(sttResultEventHandler) };
 		sttResultEventChannel->SetStreamHandler(std::move(pSttResultEventHandler));
 
-		mStt = std::make_unique<Stt>(sttStateEventHandler, sttResultEventHandler);
+		auto sttLevelEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+			registrar->messenger(), "com.llfbandit.stt/levels",
+			&StandardMethodCodec::GetInstance());
+
+		auto sttLevelEventHandler = new EventStreamHandler(mEventEgress.get(), "stt/levels");
+		std::unique_ptr<StreamHandler<EncodableValue>> pSttLevelEventHandler{ static_cast<StreamHandler<EncodableValue>*>(sttLevelEventHandler) };
+		sttLevelEventChannel->SetStreamHandler(std::move(pSttLevelEventHandler));
+
+		auto sttTranscriptionEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+			registrar->messenger(), "com.llfbandit.stt/transcriptions",
+			&StandardMethodCodec::GetInstance());
+
+		mTranscriptionEventHandler = new EventStreamHandler(mEventEgress.get(), "stt/transcriptions");
+		std::unique_ptr<StreamHandler<EncodableValue>> pSttTranscriptionEventHandler{ static_cast<StreamHandler<EncodableValue>*>(mTranscriptionEventHandler) };
+		sttTranscriptionEventChannel->SetStreamHandler(std::move(pSttTranscriptionEventHandler));
 
 		// TTS
 		auto ttsStateEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
 			registrar->messenger(), "com.llfbandit.tts/states",
 			&StandardMethodCodec::GetInstance());
 
-		auto ttsStateEventHandler = new EventStreamHandler();
+		auto ttsStateEventHandler = new EventStreamHandler(mEventEgress.get(), "tts/states");
 		std::unique_ptr<StreamHandler<EncodableValue>> pTtsStateEventHandler{ static_cast<StreamHandler<EncodableValue>*>(ttsStateEventHandler) };
 		ttsStateEventChannel->SetStreamHandler(std::move(pTtsStateEventHandler));
 
-		mTts = std::make_unique<Tts>(ttsStateEventHandler);
+		auto ttsProgressEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+			registrar->messenger(), "com.llfbandit.tts/progress",
+			&StandardMethodCodec::GetInstance());
+
+		auto ttsProgressEventHandler = new EventStreamHandler(mEventEgress.get(), "tts/progress");
+		std::unique_ptr<StreamHandler<EncodableValue>> pTtsProgressEventHandler{ static_cast<StreamHandler<EncodableValue>*>(ttsProgressEventHandler) };
+		ttsProgressEventChannel->SetStreamHandler(std::move(pTtsProgressEventHandler));
+
+		auto ttsUtteranceEventChannel = std::make_unique<flutter::EventChannel<flutter::EncodableValue>>(
+			registrar->messenger(), "com.llfbandit.tts/utterances",
+			&StandardMethodCodec::GetInstance());
+
+		auto ttsUtteranceEventHandler = new EventStreamHandler(mEventEgress.get(), "tts/utterances");
+		std::unique_ptr<StreamHandler<EncodableValue>> pTtsUtteranceEventHandler{ static_cast<StreamHandler<EncodableValue>*>(ttsUtteranceEventHandler) };
+		ttsUtteranceEventChannel->SetStreamHandler(std::move(pTtsUtteranceEventHandler));
+
+		// Engines live in the worker COM apartment.
+		mWorker = std::make_unique<ComEngineWorker>(kEngineQueueCapacity);
+		mWorker->Start();
+
+		mSynthesisWorker = std::make_unique<ComEngineWorker>(kEngineQueueCapacity);
+		mSynthesisWorker->Start();
+
+		EngineCommand synthesisInit;
+		synthesisInit.run = [](const CancellationToken&) {
+			TraceRecorder::SetThreadName("synthesis worker");
+		};
+		mSynthesisWorker->Post(std::move(synthesisInit));
+
+		EngineCommand init;
+		init.run = [this, sttStateEventHandler, sttResultEventHandler, sttLevelEventHandler, ttsStateEventHandler, ttsProgressEventHandler, ttsUtteranceEventHandler](const CancellationToken&) {
+			mStt = std::make_unique<Stt>(sttStateEventHandler, sttResultEventHandler, sttLevelEventHandler, mWorker.get());
+			mTts = std::make_unique<Tts>(ttsStateEventHandler, ttsProgressEventHandler, ttsUtteranceEventHandler, mWorker.get());
+		};
+		mWorker->Post(std::move(init));
 	}
 
 	SttsPlugin::~SttsPlugin() {
+		// Renderings may be long, don't wait for them. Transcriptions are cancelled with the pool.
+		mWorker->Cancel(kSynthesisGroup);
+		mSynthesisWorker->Cancel(kSynthesisGroup);
+
+		mWorker->Stop([this]() {
+			mTranscriptionPool.reset();
+			mStt.reset();
+			mTts.reset();
+		});
+
+		// Last, the engine worker may still have posted renderings.
+		mSynthesisWorker->Stop([this]() {
+			mRenderer.Release();
+		});
+	}
+
+	// static
+	template <typename Args, void (SttsPlugin::*Method)(Args& args, SttsPlugin::MethodResultPtr result)>
+	void SttsPlugin::Invoke(SttsPlugin& plugin, const flutter::EncodableValue* arguments, MethodResultPtr result) {
+		Args args;
+		if (!DecodeArguments(arguments, args)) {
+			plugin.ReplyError(std::move(result), E_INVALIDARG);
+			return;
+		}
+
+		(plugin.*Method)(args, std::move(result));
 	}
 
 	void SttsPlugin::SttHandleMethodCall(
 		const flutter::MethodCall<flutter::EncodableValue>& method_call,
 		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
 
-		auto method = method_call.method_name();
-
-		if (method.compare("isSupported") == 0) {
-			result->Success(flutter::EncodableValue(mStt->IsSupported()));
+		static constexpr MethodEntry<MethodHandler> kEntries[] = {
+			{ "isSupported", &Invoke<NoArguments, &SttsPlugin::SttIsSupported> },
+			{ "hasPermission", &Invoke<NoArguments, &SttsPlugin::SttHasPermission> },
+			{ "getLanguage", &Invoke<NoArguments, &SttsPlugin::SttGetLanguage> },
+			{ "setLanguage", &Invoke<LanguageArgs, &SttsPlugin::SttSetLanguage> },
+			{ "getLanguages", &Invoke<NoArguments, &SttsPlugin::SttGetLanguages> },
+			{ "start", &Invoke<SttStartArgs, &SttsPlugin::SttStart> },
+			{ "stop", &Invoke<NoArguments, &SttsPlugin::SttStop> },
+			{ "windows.showTrainingUI", &Invoke<TrainingArgs, &SttsPlugin::SttShowTrainingUI> },
+			{ "windows.getSessionStats", &Invoke<NoArguments, &SttsPlugin::SttGetSessionStats> },
+			{ "windows.transcribeFile", &Invoke<PathArgs, &SttsPlugin::SttTranscribeFile> },
+			{ "windows.transcribeBuffer", &Invoke<TranscribeBufferArgs, &SttsPlugin::SttTranscribeBuffer> },
+			{ "windows.queueTranscription", &Invoke<PathArgs, &SttsPlugin::SttQueueTranscription> },
+			{ "windows.cancelTranscription", &Invoke<CancelTranscriptionArgs, &SttsPlugin::SttCancelTranscription> },
+			{ "windows.setTracing", &Invoke<TracingArgs, &SttsPlugin::SetTracing> },
+			{ "windows.getTrace", &Invoke<NoArguments, &SttsPlugin::GetTrace> },
+			{ "dispose", &Invoke<NoArguments, &SttsPlugin::SttDispose> },
+		};
+		static constexpr auto kMethods = MakeMethodTable(kEntries);
+		static_assert(kMethods.IsValid(), "STT method names must be unique");
+
+		auto entry = kMethods.Find(method_call.method_name());
+		if (entry) {
+			// Names of the table are string literals.
+			TraceSpan span("method.stt", entry->name.data());
+			entry->handler(*this, method_call.arguments(), std::move(result));
 		}
-		else if (method.compare("hasPermission") == 0) {
-			result->Success(flutter::EncodableValue(true));
-		}
-		else if (method.compare("getLanguage") == 0) {
-			try
-			{
-				result->Success(flutter::EncodableValue(mStt->getLanguage()));
-			} catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
+		else {
+			result->NotImplemented();
 		}
-		else if (method.compare("setLanguage") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			std::string language;
-			GetValueFromEncodableMap(mapArgs, "language", language);
+	}
 
-			try
-			{
-				mStt->SetLanguage(language);
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("getLanguages") == 0) {
-			try
-			{
-				auto languages = mStt->GetLanguages();
+	void SttsPlugin::SttIsSupported(NoArguments&, MethodResultPtr result) {
+		RunSharedOnEngine(kSttGroup, std::move(result), [this](const CancellationToken&) {
+			return mSttSupported.Get(mStt->GetEnginesGeneration(), [this]() {
+				return flutter::EncodableValue(mStt->IsSupported());
+			});
+		});
+	}
 
-				flutter::EncodableList encodableLanguages;
-				for (int i = 0; i < languages.size(); ++i)
-				{
-					encodableLanguages.push_back(EncodableValue(languages[i]));
-				}
+	void SttsPlugin::SttHasPermission(NoArguments&, MethodResultPtr result) {
+		result->Success(flutter::EncodableValue(true));
+	}
 
-				result->Success(encodableLanguages);
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("start") == 0) {
-			try
-			{
-				mStt->Start();
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("stop") == 0) {
+	void SttsPlugin::SttGetLanguage(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kSttGroup, std::move(result), [this]() {
+			return flutter::EncodableValue(mStt->getLanguage());
+		});
+	}
+
+	void SttsPlugin::SttSetLanguage(LanguageArgs& args, MethodResultPtr result) {
+		RunOnEngine(kSttGroup, std::move(result), [this, language = std::move(args.language)]() {
+			mStt->SetLanguage(language);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::SttGetLanguages(NoArguments&, MethodResultPtr result) {
+		RunSharedOnEngine(kSttGroup, std::move(result), [this](const CancellationToken&) {
+			return mSttLanguages.Get(mStt->GetEnginesGeneration(), [this]() {
+				return flutter::EncodableValue(ToEncodableLanguages(mStt->GetLanguages()));
+			});
+		});
+	}
+
+	void SttsPlugin::SttStart(SttStartArgs& args, MethodResultPtr result) {
+		auto options = GetSttSessionOptions(args);
+
+		RunOnEngine(kSttStartGroup, std::move(result), [this, options]() {
+			mStt->Start(options);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::SttStop(NoArguments&, MethodResultPtr result) {
+		// Pending starts would be obsolete.
+		mWorker->Cancel(kSttStartGroup);
+
+		RunOnEngine(kSttGroup, std::move(result), [this]() {
 			mStt->Stop();
-			result->Success(flutter::EncodableValue(NULL));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::SttShowTrainingUI(TrainingArgs& args, MethodResultPtr result) {
+		std::vector<std::wstring> texts;
+		for (const auto& trainingText : args.trainingTexts) {
+			texts.push_back(Utf16FromUtf8(trainingText));
 		}
-		else if (method.compare("windows.showTrainingUI") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
 
-			flutter::EncodableList trainingTexts;
-			GetValueFromEncodableMap(mapArgs, "trainingTexts", trainingTexts);
+		// Modal dialog, no timeout.
+		RunOnEngine(kSttGroup, std::move(result), [this, texts]() mutable {
+			mStt->ShowTrainingUI(texts);
+			return flutter::EncodableValue(NULL);
+		}, std::chrono::milliseconds(0));
+	}
 
-			std::vector<std::wstring> texts;
-			for (flutter::EncodableValue trainingText : trainingTexts) {
-				texts.push_back(Utf16FromUtf8(std::get<std::string>(trainingText)));
-			}
+	void SttsPlugin::SttGetSessionStats(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kSttGroup, std::move(result), [this]() {
+			const auto& stats = mStt->GetSessionStats();
+			auto eventStats = mEventEgress->GetStats();
+
+			return flutter::EncodableValue(flutter::EncodableMap({
+				{EncodableValue("starts"), EncodableValue(static_cast<int64_t>(stats.starts))},
+				{EncodableValue("warmStarts"), EncodableValue(static_cast<int64_t>(stats.warmStarts))},
+				{EncodableValue("lastStartLatencyUs"), EncodableValue(static_cast<int64_t>(stats.lastStartLatency.count()))},
+				{EncodableValue("lastStartWarm"), EncodableValue(stats.lastStartWarm)},
+				{EncodableValue("engineFootprint"), EncodableValue(static_cast<int64_t>(stats.engineFootprint))},
+				{EncodableValue("eventsPosted"), EncodableValue(static_cast<int64_t>(eventStats.posted))},
+				{EncodableValue("eventsDelivered"), EncodableValue(static_cast<int64_t>(eventStats.delivered))},
+				{EncodableValue("eventsDropped"), EncodableValue(static_cast<int64_t>(eventStats.dropped))},
+				{EncodableValue("eventsOverflowed"), EncodableValue(static_cast<int64_t>(eventStats.overflowed))},
+				{EncodableValue("eventQueueDepth"), EncodableValue(static_cast<int64_t>(eventStats.depth))},
+				{EncodableValue("eventQueueMaxDepth"), EncodableValue(static_cast<int64_t>(eventStats.maxDepth))}
+			}));
+		});
+	}
 
-			try
-			{
-				mStt->ShowTrainingUI(texts);
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+	void SttsPlugin::SttTranscribeFile(PathArgs& args, MethodResultPtr result) {
+		RunTranscription(std::move(result), [path = std::move(args.path)](std::unique_ptr<PcmSource>& source) {
+			return TranscriptionPool::LoadWavFile(path, source);
+		});
+	}
+
+	void SttsPlugin::SttTranscribeBuffer(TranscribeBufferArgs& args, MethodResultPtr result) {
+		PcmFormat format;
+		bool isRaw = GetPcmFormat(args.format, format);
+
+		RunTranscription(std::move(result), [bytes = std::move(args.bytes), isRaw, format](std::unique_ptr<PcmSource>& source) mutable {
+			if (!isRaw) {
+				return Transcriber::GetWavError(PcmSource::FromWav(std::move(bytes), source));
 			}
-		}
-		else if (method.compare("dispose") == 0) {
+
+			if (!format.IsValid()) return static_cast<HRESULT>(SPERR_UNSUPPORTED_FORMAT);
+			source = std::make_unique<PcmSource>(std::move(bytes), format);
+			return S_OK;
+		});
+	}
+
+	void SttsPlugin::SttQueueTranscription(PathArgs& args, MethodResultPtr result) {
+		RunOnEngine(kSttGroup, std::move(result), [this, path = std::move(args.path)]() {
+			// Same engine as live recognition.
+			auto jobId = GetTranscriptionPool().Queue(path, mStt->GetRecognizerTokenId());
+			return flutter::EncodableValue(static_cast<int64_t>(jobId));
+		});
+	}
+
+	void SttsPlugin::SttCancelTranscription(CancelTranscriptionArgs& args, MethodResultPtr result) {
+		RunOnEngine(kSttGroup, std::move(result), [this, jobId = args.jobId]() {
+			bool cancelled = mTranscriptionPool && mTranscriptionPool->Cancel(static_cast<uint64_t>(jobId));
+			return flutter::EncodableValue(cancelled);
+		});
+	}
+
+	void SttsPlugin::SttDispose(NoArguments&, MethodResultPtr result) {
+		mWorker->Cancel(kSttGroup);
+		mWorker->Cancel(kSttStartGroup);
+
+		RunOnEngine(kSttGroup, std::move(result), [this]() {
+			// Cancels queued transcriptions.
+			mTranscriptionPool.reset();
 			mStt->Dispose();
-			result->Success(flutter::EncodableValue(NULL));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsHandleMethodCall(
+		const flutter::MethodCall<flutter::EncodableValue>& method_call,
+		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+
+		static constexpr MethodEntry<MethodHandler> kEntries[] = {
+			{ "isSupported", &Invoke<NoArguments, &SttsPlugin::TtsIsSupported> },
+			{ "start", &Invoke<TtsStartArgs, &SttsPlugin::TtsStart> },
+			{ "windows.cancel", &Invoke<TtsCancelArgs, &SttsPlugin::TtsCancel> },
+			{ "stop", &Invoke<NoArguments, &SttsPlugin::TtsStop> },
+			{ "pause", &Invoke<NoArguments, &SttsPlugin::TtsPause> },
+			{ "resume", &Invoke<NoArguments, &SttsPlugin::TtsResume> },
+			{ "getLanguage", &Invoke<NoArguments, &SttsPlugin::TtsGetLanguage> },
+			{ "setLanguage", &Invoke<LanguageArgs, &SttsPlugin::TtsSetLanguage> },
+			{ "getLanguages", &Invoke<NoArguments, &SttsPlugin::TtsGetLanguages> },
+			{ "setVoice", &Invoke<VoiceArgs, &SttsPlugin::TtsSetVoice> },
+			{ "getVoices", &Invoke<NoArguments, &SttsPlugin::TtsGetVoices> },
+			{ "getVoicesByLanguage", &Invoke<LanguageArgs, &SttsPlugin::TtsGetVoicesByLanguage> },
+			{ "setPitch", &Invoke<PitchArgs, &SttsPlugin::TtsSetPitch> },
+			{ "setRate", &Invoke<RateArgs, &SttsPlugin::TtsSetRate> },
+			{ "setVolume", &Invoke<VolumeArgs, &SttsPlugin::TtsSetVolume> },
+			{ "windows.configure", &Invoke<TtsVoiceSettingsArgs, &SttsPlugin::TtsConfigure> },
+			{ "windows.setCacheBudget", &Invoke<CacheBudgetArgs, &SttsPlugin::TtsSetCacheBudget> },
+			{ "windows.getCacheStats", &Invoke<NoArguments, &SttsPlugin::TtsGetCacheStats> },
+			{ "windows.openStore", &Invoke<OpenStoreArgs, &SttsPlugin::TtsOpenStore> },
+			{ "windows.closeStore", &Invoke<NoArguments, &SttsPlugin::TtsCloseStore> },
+			{ "windows.getStoreStats", &Invoke<NoArguments, &SttsPlugin::TtsGetStoreStats> },
+			{ "windows.setPipeline", &Invoke<PipelineArgs, &SttsPlugin::TtsSetPipeline> },
+			{ "windows.getPipelineStats", &Invoke<NoArguments, &SttsPlugin::TtsGetPipelineStats> },
+			{ "windows.setProgressEvents", &Invoke<ProgressEventsArgs, &SttsPlugin::TtsSetProgressEvents> },
+			{ "windows.synthesizeToBuffer", &Invoke<SynthesizeArgs, &SttsPlugin::TtsSynthesizeToBuffer> },
+			{ "windows.synthesizeToFile", &Invoke<SynthesizeArgs, &SttsPlugin::TtsSynthesizeToFile> },
+			{ "windows.setTracing", &Invoke<TracingArgs, &SttsPlugin::SetTracing> },
+			{ "windows.getTrace", &Invoke<NoArguments, &SttsPlugin::GetTrace> },
+			{ "dispose", &Invoke<NoArguments, &SttsPlugin::TtsDispose> },
+		};
+		static constexpr auto kMethods = MakeMethodTable(kEntries);
+		static_assert(kMethods.IsValid(), "TTS method names must be unique");
+
+		auto entry = kMethods.Find(method_call.method_name());
+		if (entry) {
+			// Names of the table are string literals.
+			TraceSpan span("method.tts", entry->name.data());
+			entry->handler(*this, method_call.arguments(), std::move(result));
 		}
 		else {
 			result->NotImplemented();
 		}
 	}
 
-	void SttsPlugin::TtsHandleMethodCall(
-		const flutter::MethodCall<flutter::EncodableValue>& method_call,
-		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+	void SttsPlugin::SetTracing(TracingArgs& args, MethodResultPtr result) {
+		TraceRecorder::SetEnabled(args.enabled);
+		result->Success();
+	}
 
-		auto method = method_call.method_name();
+	void SttsPlugin::GetTrace(NoArguments&, MethodResultPtr result) {
+		result->Success(flutter::EncodableValue(TraceRecorder::Dump()));
+	}
 
-		if (method.compare("isSupported") == 0) {
-			result->Success(flutter::EncodableValue(mTts->IsSupported()));
-		}
-		else if (method.compare("start") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			std::string text;
-			GetValueFromEncodableMap(mapArgs, "text", text);
+	void SttsPlugin::TtsIsSupported(NoArguments&, MethodResultPtr result) {
+		RunSharedOnEngine(kTtsGroup, std::move(result), [this](const CancellationToken&) {
+			return mTtsSupported.Get(mTts->GetEnginesGeneration(), [this]() {
+				return flutter::EncodableValue(mTts->IsSupported());
+			});
+		});
+	}
 
-			auto options = GetTtsOptions(mapArgs);
+	void SttsPlugin::TtsStart(TtsStartArgs& args, MethodResultPtr result) {
+		std::shared_ptr<TtsOptions> options = GetTtsOptions(args);
 
-			try
-			{
-				mTts->Start(text, std::move(options));
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}			
-		}
-		else if (method.compare("stop") == 0) {
+		RunOnEngine(kTtsStartGroup, std::move(result), [this, text = std::move(args.text), options]() {
+			auto id = mTts->Start(text, std::make_unique<TtsOptions>(*options));
+			return flutter::EncodableValue(static_cast<int64_t>(id));
+		});
+	}
+
+	void SttsPlugin::TtsCancel(TtsCancelArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, id = args.id]() {
+			return flutter::EncodableValue(mTts->Cancel(static_cast<uint64_t>(id)));
+		});
+	}
+
+	void SttsPlugin::TtsStop(NoArguments&, MethodResultPtr result) {
+		// Pending starts would be obsolete.
+		mWorker->Cancel(kTtsStartGroup);
+
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
 			mTts->Stop();
-			result->Success(flutter::EncodableValue(NULL));
-		}
-		else if (method.compare("pause") == 0) {
-			try
-			{
-				mTts->Pause();
-				result->Success(flutter::EncodableValue(NULL));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsPause(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			mTts->Pause();
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsResume(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			mTts->Resume();
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetLanguage(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			return flutter::EncodableValue(mTts->GetLanguage());
+		});
+	}
+
+	void SttsPlugin::TtsSetLanguage(LanguageArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, language = std::move(args.language)]() {
+			mTts->SetLanguage(language);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetLanguages(NoArguments&, MethodResultPtr result) {
+		RunSharedOnEngine(kTtsGroup, std::move(result), [this](const CancellationToken&) {
+			return mTtsLanguages.Get(mTts->GetEnginesGeneration(), [this]() {
+				return flutter::EncodableValue(ToEncodableLanguages(mTts->GetLanguages()));
+			});
+		});
+	}
+
+	void SttsPlugin::TtsSetVoice(VoiceArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, voiceId = std::move(args.voiceId)]() {
+			mTts->SetVoice(voiceId);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetVoices(NoArguments&, MethodResultPtr result) {
+		RunSharedOnEngine(kTtsGroup, std::move(result), [this](const CancellationToken&) {
+			return mTtsVoices.Get(mTts->GetEnginesGeneration(), [this]() {
+				return flutter::EncodableValue(ToEncodableVoices(mTts->GetVoices()));
+			});
+		});
+	}
+
+	void SttsPlugin::TtsGetVoicesByLanguage(LanguageArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, language = std::move(args.language)]() {
+			return flutter::EncodableValue(ToEncodableVoices(mTts->GetVoicesByLanguage(language)));
+		});
+	}
+
+	void SttsPlugin::TtsSetPitch(PitchArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, pitch = args.pitch]() {
+			mTts->SetPitch(pitch);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsSetRate(RateArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, rate = args.rate]() {
+			mTts->SetRate(rate);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsSetVolume(VolumeArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, volume = args.volume]() {
+			mTts->SetVolume(volume);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsConfigure(TtsVoiceSettingsArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, settings = GetVoiceSettings(args)]() {
+			mTts->Configure(settings);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsSetCacheBudget(CacheBudgetArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, budget = args.budget]() {
+			mTts->SetCacheBudget(static_cast<size_t>(max(budget, 0)));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetCacheStats(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			const auto& stats = mTts->GetCacheStats();
+
+			return flutter::EncodableValue(flutter::EncodableMap({
+				{EncodableValue("hits"), EncodableValue(static_cast<int64_t>(stats.hits))},
+				{EncodableValue("misses"), EncodableValue(static_cast<int64_t>(stats.misses))},
+				{EncodableValue("insertions"), EncodableValue(static_cast<int64_t>(stats.insertions))},
+				{EncodableValue("evictions"), EncodableValue(static_cast<int64_t>(stats.evictions))},
+				{EncodableValue("entries"), EncodableValue(static_cast<int64_t>(stats.entries))},
+				{EncodableValue("bytes"), EncodableValue(static_cast<int64_t>(stats.bytes))}
+			}));
+		});
+	}
+
+	void SttsPlugin::TtsOpenStore(OpenStoreArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, path = std::move(args.path), maxBytes = args.maxBytes]() {
+			mTts->OpenStore(path, static_cast<uint64_t>(max(maxBytes, 0)));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsCloseStore(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			mTts->CloseStore();
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetStoreStats(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			auto stats = mTts->GetStoreStats();
+
+			return flutter::EncodableValue(flutter::EncodableMap({
+				{EncodableValue("hits"), EncodableValue(static_cast<int64_t>(stats.hits))},
+				{EncodableValue("misses"), EncodableValue(static_cast<int64_t>(stats.misses))},
+				{EncodableValue("puts"), EncodableValue(static_cast<int64_t>(stats.puts))},
+				{EncodableValue("rejected"), EncodableValue(static_cast<int64_t>(stats.rejected))},
+				{EncodableValue("corrupted"), EncodableValue(static_cast<int64_t>(stats.corrupted))},
+				{EncodableValue("compactions"), EncodableValue(static_cast<int64_t>(stats.compactions))},
+				{EncodableValue("entries"), EncodableValue(static_cast<int64_t>(stats.entries))},
+				{EncodableValue("bytes"), EncodableValue(static_cast<int64_t>(stats.bytes))}
+			}));
+		});
+	}
+
+	void SttsPlugin::TtsSetPipeline(PipelineArgs& args, MethodResultPtr result) {
+		SynthesisPipelineOptions options;
+		options.lookahead = static_cast<size_t>(max(args.lookahead, 0));
+		options.maxBytes = static_cast<size_t>(max(args.maxBytes, 0));
+
+		RunOnEngine(kTtsGroup, std::move(result), [this, options]() {
+			mTts->SetPipelineOptions(options);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsGetPipelineStats(NoArguments&, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			auto stats = mTts->GetPipelineStats();
+
+			return flutter::EncodableValue(flutter::EncodableMap({
+				{EncodableValue("submitted"), EncodableValue(static_cast<int64_t>(stats.submitted))},
+				{EncodableValue("rendered"), EncodableValue(static_cast<int64_t>(stats.rendered))},
+				{EncodableValue("failed"), EncodableValue(static_cast<int64_t>(stats.failed))},
+				{EncodableValue("cancelled"), EncodableValue(static_cast<int64_t>(stats.cancelled))}
+			}));
+		});
+	}
+
+	void SttsPlugin::TtsSetProgressEvents(ProgressEventsArgs& args, MethodResultPtr result) {
+		RunOnEngine(kTtsGroup, std::move(result), [this, args]() {
+			mTts->SetProgressEvents(args.words, args.sentences, args.bookmarks);
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsSynthesizeToBuffer(SynthesizeArgs& args, MethodResultPtr result) {
+		PcmFormat format;
+		GetPcmFormat(args.format, format);
+
+		std::shared_ptr<TtsOptions> options = GetTtsOptions(args);
+
+		RunSynthesis(std::move(result), std::move(args.text), options, [this, format](const SynthesisRequest& request, const CancellationToken& token) {
+			if (!format.IsValid()) throw static_cast<HRESULT>(SPERR_UNSUPPORTED_FORMAT);
+
+			PcmBuffer buffer(format);
+			Render(request, format, buffer, token);
+
+			return flutter::EncodableValue(buffer.TakeSamples());
+		});
+	}
+
+	void SttsPlugin::TtsSynthesizeToFile(SynthesizeArgs& args, MethodResultPtr result) {
+		PcmFormat format;
+		GetPcmFormat(args.format, format);
+
+		std::shared_ptr<TtsOptions> options = GetTtsOptions(args);
+
+		RunSynthesis(std::move(result), std::move(args.text), options, [this, path = std::move(args.path), format](const SynthesisRequest& request, const CancellationToken& token) {
+			WavFileWriter writer;
+			if (!writer.Open(path, format)) {
+				throw static_cast<HRESULT>(format.IsValid() ? HRESULT_FROM_WIN32(ERROR_OPEN_FAILED) : SPERR_UNSUPPORTED_FORMAT);
 			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+
+			try {
+				Render(request, format, writer, token);
 			}
-		}
-		else if (method.compare("resume") == 0) {
+			catch (HRESULT) {
+				// No partial file.
+				writer.Finish();
+				std::error_code error;
+				std::filesystem::remove(std::filesystem::u8path(path), error);
+				throw;
+			}
+
+			if (!writer.Finish()) throw static_cast<HRESULT>(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT));
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::TtsDispose(NoArguments&, MethodResultPtr result) {
+		mWorker->Cancel(kTtsGroup);
+		mWorker->Cancel(kTtsStartGroup);
+		mWorker->Cancel(kSynthesisGroup);
+		mSynthesisWorker->Cancel(kSynthesisGroup);
+
+		RunOnEngine(kTtsGroup, std::move(result), [this]() {
+			mTts->Dispose();
+			return flutter::EncodableValue(NULL);
+		});
+	}
+
+	void SttsPlugin::RunOnEngine(
+		const std::string& group,
+		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+		std::function<flutter::EncodableValue()> task,
+		std::chrono::milliseconds timeout) {
+
+		RunOnEngine(group, std::move(result), [task](const CancellationToken&) { return task(); }, timeout);
+	}
+
+	void SttsPlugin::RunOnEngine(
+		const std::string& group,
+		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+		std::function<flutter::EncodableValue(const CancellationToken&)> task,
+		std::chrono::milliseconds timeout) {
+
+		RunSharedOnEngine(group, std::move(result), [task](const CancellationToken& token) {
+			return std::make_shared<const flutter::EncodableValue>(task(token));
+		}, timeout);
+	}
+
+	void SttsPlugin::RunSharedOnEngine(
+		const std::string& group,
+		std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+		std::function<std::shared_ptr<const flutter::EncodableValue>(const CancellationToken&)> task,
+		std::chrono::milliseconds timeout) {
+
+		std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> sharedResult = std::move(result);
+
+		EngineCommand command;
+		command.group = group;
+		command.timeout = timeout;
+		command.run = [this, sharedResult, task](const CancellationToken& token) {
 			try
 			{
-				mTts->Resume();
-				result->Success(flutter::EncodableValue(NULL));
+				auto value = task(token);
+				mDispatcher->Post([sharedResult, value = std::move(value)]() {
+					sharedResult->Success(*value);
+				});
 			}
 			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+				ReplyError(sharedResult, hr);
 			}
-		}
-		else if (method.compare("getLanguage") == 0) {
-			try
-			{
-				result->Success(flutter::EncodableValue(mTts->GetLanguage()));
+			catch (const std::exception&) {
+				ReplyError(sharedResult, E_FAIL);
 			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+			catch (...) {
+				ReplyError(sharedResult, E_FAIL);
 			}
-		}
-		else if (method.compare("setLanguage") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			std::string language;
-			GetValueFromEncodableMap(mapArgs, "language", language);
+		};
+		command.reject = [this, sharedResult](CommandRejection rejection) {
+			ReplyError(sharedResult, GetRejectionError(rejection));
+		};
+
+		mWorker->Post(std::move(command));
+	}
+
+	void SttsPlugin::RunTranscription(MethodResultPtr result, TranscriptionPool::SourceLoader load) {
+		std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> sharedResult = std::move(result);
+
+		// The engine worker only selects the engine, recognition runs on the pool so other commands are not held up.
+		EngineCommand command;
+		command.group = kSttGroup;
+		command.timeout = std::chrono::seconds(10);
+		command.run = [this, sharedResult, load = std::move(load)](const CancellationToken&) {
+			auto onComplete = [this, sharedResult](uint64_t, HRESULT hr, const std::vector<TranscribedPhrase>& phrases) {
+				if (FAILED(hr)) {
+					ReplyError(sharedResult, hr);
+					return;
+				}
+
+				mDispatcher->Post([sharedResult, value = flutter::EncodableValue(ToEncodablePhrases(phrases))]() {
+					sharedResult->Success(value);
+				});
+			};
 
 			try
 			{
-				mTts->SetLanguage(language);
-				result->Success(flutter::EncodableValue(NULL));
+				// Same engine as live recognition.
+				GetTranscriptionPool().Queue(load, mStt->GetRecognizerTokenId(), onComplete);
 			}
 			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+				ReplyError(sharedResult, hr);
 			}
-		}
-		else if (method.compare("getLanguages") == 0) {
-			try
-			{
-				auto languages = mTts->GetLanguages();
+			catch (...) {
+				ReplyError(sharedResult, E_FAIL);
+			}
+		};
+		command.reject = [this, sharedResult](CommandRejection rejection) {
+			ReplyError(sharedResult, GetRejectionError(rejection));
+		};
 
-				flutter::EncodableList encodableLanguages;
-				for (int i = 0; i < languages.size(); ++i)
-				{
-					encodableLanguages.push_back(EncodableValue(languages[i]));
-				}
+		mWorker->Post(std::move(command));
+	}
 
-				result->Success(encodableLanguages);
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("setVoice") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			std::string voiceId;
-			GetValueFromEncodableMap(mapArgs, "voiceId", voiceId);
+	void SttsPlugin::RunSynthesis(MethodResultPtr result, std::string text, std::shared_ptr<TtsOptions> options,
+		std::function<flutter::EncodableValue(const SynthesisRequest& request, const CancellationToken& token)> render) {
+		std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> sharedResult = std::move(result);
 
+		// The engine worker only reads the voice settings, rendering runs on the synthesis worker so other commands are not held up.
+		EngineCommand command;
+		command.group = kSynthesisGroup;
+		command.timeout = std::chrono::seconds(10);
+		command.run = [this, sharedResult, text = std::move(text), options, render = std::move(render)](const CancellationToken&) {
+			SynthesisRequest request;
 			try
 			{
-				mTts->SetVoice(voiceId);
-				result->Success(flutter::EncodableValue(NULL));
+				request = mTts->GetSynthesisRequest(text, *options);
 			}
 			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
+				ReplyError(sharedResult, hr);
+				return;
+			}
+			catch (...) {
+				ReplyError(sharedResult, E_FAIL);
+				return;
 			}
-		}
-		else if (method.compare("getVoices") == 0) {
-			try
-			{
-				auto voices = mTts->GetVoices();
 
-				flutter::EncodableList encodableVoices;
-				for (TtsVoice voice : voices)
+			EngineCommand renderCommand;
+			renderCommand.group = kSynthesisGroup;
+			// Long texts render for a while, no timeout.
+			renderCommand.timeout = std::chrono::milliseconds(0);
+			renderCommand.run = [this, sharedResult, request = std::move(request), render](const CancellationToken& token) {
+				try
 				{
-					encodableVoices.push_back(EncodableMap({
-						{EncodableValue("id"), EncodableValue(voice.id)},
-						{EncodableValue("language"), EncodableValue(voice.language)},
-						{EncodableValue("languageInstalled"), EncodableValue(voice.languageInstalled)},
-						{EncodableValue("name"), EncodableValue(voice.name)},
-						{EncodableValue("networkRequired"), EncodableValue(voice.networkRequired)},
-						{EncodableValue("gender"), EncodableValue(ttsVoiceGenderToString(voice.gender))}
-						}));
+					auto value = render(request, token);
+					mDispatcher->Post([sharedResult, value = std::move(value)]() {
+						sharedResult->Success(value);
+					});
+				}
+				catch (HRESULT hr) {
+					ReplyError(sharedResult, hr);
 				}
+				catch (...) {
+					ReplyError(sharedResult, E_FAIL);
+				}
+			};
+			renderCommand.reject = [this, sharedResult](CommandRejection rejection) {
+				ReplyError(sharedResult, GetRejectionError(rejection));
+			};
+
+			mSynthesisWorker->Post(std::move(renderCommand));
+		};
+		command.reject = [this, sharedResult](CommandRejection rejection) {
+			ReplyError(sharedResult, GetRejectionError(rejection));
+		};
+
+		mWorker->Post(std::move(command));
+	}
 
-				result->Success(encodableVoices);
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
+	void SttsPlugin::Render(const SynthesisRequest& request, const PcmFormat& format, PcmSink& sink, const CancellationToken& token) {
+		TraceSpan span("sapi", "UtteranceRenderer::Render");
+
+		auto hr = mRenderer.Render(request, format, sink, token);
+		if (FAILED(hr)) throw hr;
+	}
+
+	TranscriptionPool& SttsPlugin::GetTranscriptionPool() {
+		if (!mTranscriptionPool) {
+			mTranscriptionPool = std::make_unique<TranscriptionPool>(
+				std::thread::hardware_concurrency(),
+				[this](uint64_t jobId, double progress) {
+					SendTranscriptionEvent(jobId, "progress", {
+						{EncodableValue("progress"), EncodableValue(progress)}
+					});
+				},
+				[this](uint64_t jobId, HRESULT hr, const std::vector<TranscribedPhrase>& phrases) {
+					if (SUCCEEDED(hr)) {
+						SendTranscriptionEvent(jobId, "done", {
+							{EncodableValue("phrases"), EncodableValue(ToEncodablePhrases(phrases))}
+						});
+					}
+					else if (hr == E_ABORT) {
+						SendTranscriptionEvent(jobId, "cancelled", {});
+					}
+					else {
+						SendTranscriptionEvent(jobId, "error", {
+							{EncodableValue("code"), EncodableValue(std::to_string(hr))},
+							{EncodableValue("message"), EncodableValue(GetErrorMessage(hr))}
+						});
+					}
+				});
 		}
-		else if (method.compare("getVoicesByLanguage") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			std::string language;
-			GetValueFromEncodableMap(mapArgs, "language", language);
 
-			try
-			{
-				auto voices = mTts->GetVoicesByLanguage(language);
+		return *mTranscriptionPool;
+	}
 
-				flutter::EncodableList encodableVoices;
-				for (TtsVoice voice : voices)
-				{
-					encodableVoices.push_back(EncodableMap({
-						{EncodableValue("id"), EncodableValue(voice.id)},
-						{EncodableValue("language"), EncodableValue(voice.language)},
-						{EncodableValue("languageInstalled"), EncodableValue(voice.languageInstalled)},
-						{EncodableValue("name"), EncodableValue(voice.name)},
-						{EncodableValue("networkRequired"), EncodableValue(voice.networkRequired)},
-						{EncodableValue("gender"), EncodableValue(ttsVoiceGenderToString(voice.gender))}
-						}));
-				}
+	void SttsPlugin::ReplyError(std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result, HRESULT hr) {
+		auto code = std::to_string(hr);
+		auto message = GetErrorMessage(hr);
 
-				result->Success(encodableVoices);
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("setPitch") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			double pitch;
-			GetValueFromEncodableMap(mapArgs, "pitch", pitch);
+		mDispatcher->Post([result, code, message]() {
+			result->Error(code, message);
+		});
+	}
 
-			mTts->SetPitch(pitch);
-			result->Success(flutter::EncodableValue(NULL));
-		}
-		else if (method.compare("setRate") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			double rate;
-			GetValueFromEncodableMap(mapArgs, "rate", rate);
+	flutter::EncodableList SttsPlugin::ToEncodablePhrases(const std::vector<TranscribedPhrase>& phrases) {
+		flutter::EncodableList list;
 
-			try
-			{
-				mTts->SetRate(rate);
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("setVolume") == 0) {
-			const auto args = method_call.arguments();
-			const auto* mapArgs = std::get_if<flutter::EncodableMap>(args);
-			double volume;
-			GetValueFromEncodableMap(mapArgs, "volume", volume);
+		for (size_t i = 0; i < phrases.size(); i++) {
+			const auto& phrase = phrases[i];
 
-			try
-			{
-				mTts->SetVolume(volume);
-				result->Success(flutter::EncodableValue(NULL));
-			}
-			catch (HRESULT hr) {
-				result->Error(std::to_string(hr), GetErrorMessage(hr));
-			}
-		}
-		else if (method.compare("dispose") == 0) {
-			mTts->Dispose();
-			result->Success(flutter::EncodableValue(NULL));
-		}
-		else {
-			result->NotImplemented();
+			list.push_back(flutter::EncodableValue(flutter::EncodableMap({
+				{EncodableValue("text"), EncodableValue(phrase.text)},
+				{EncodableValue("isFinal"), EncodableValue(true)},
+				{EncodableValue("sequence"), EncodableValue(static_cast<int64_t>(i))},
+				{EncodableValue("offset"), EncodableValue(static_cast<int64_t>(phrase.offset.count()))},
+				{EncodableValue("duration"), EncodableValue(static_cast<int64_t>(phrase.duration.count()))}
+			})));
 		}
+
+		return list;
+	}
+
+	void SttsPlugin::SendTranscriptionEvent(uint64_t jobId, const std::string& state, flutter::EncodableMap event) {
+		event[EncodableValue("jobId")] = EncodableValue(static_cast<int64_t>(jobId));
+		event[EncodableValue("state")] = EncodableValue(state);
+
+		mTranscriptionEventHandler->Success(EncodableValue(std::move(event)));
 	}
 
 	std::string SttsPlugin::ttsVoiceGenderToString(TtsVoiceGender gender) {
@@ -388,28 +886,135 @@ namespace stts {
 		}
 	}
 
+	flutter::EncodableList SttsPlugin::ToEncodableLanguages(std::vector<std::string> languages) {
+		flutter::EncodableList encodableLanguages;
+		encodableLanguages.reserve(languages.size());
+
+		for (auto& language : languages)
+		{
+			encodableLanguages.push_back(EncodableValue(std::move(language)));
+		}
+
+		return encodableLanguages;
+	}
+
+	flutter::EncodableList SttsPlugin::ToEncodableVoices(std::vector<TtsVoice> voices) {
+		flutter::EncodableList encodableVoices;
+		encodableVoices.reserve(voices.size());
+
+		for (TtsVoice& voice : voices)
+		{
+			encodableVoices.push_back(EncodableMap({
+				{EncodableValue("id"), EncodableValue(std::move(voice.id))},
+				{EncodableValue("language"), EncodableValue(std::move(voice.language))},
+				{EncodableValue("languageInstalled"), EncodableValue(voice.languageInstalled)},
+				{EncodableValue("name"), EncodableValue(std::move(voice.name))},
+				{EncodableValue("networkRequired"), EncodableValue(voice.networkRequired)},
+				{EncodableValue("gender"), EncodableValue(ttsVoiceGenderToString(voice.gender))}
+				}));
+		}
+
+		return encodableVoices;
+	}
+
+	// static
+	HRESULT SttsPlugin::GetRejectionError(CommandRejection rejection)
+	{
+		switch (rejection) {
+		case CommandRejection::queueFull:	return HRESULT_FROM_WIN32(ERROR_BUSY);
+		case CommandRejection::timeout:		return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
+		case CommandRejection::cancelled:	return E_ABORT;
+		default:							return HRESULT_FROM_WIN32(ERROR_SHUTDOWN_IN_PROGRESS);
+		}
+	}
+
+	// static
 	std::string SttsPlugin::GetErrorMessage(HRESULT hr)
 	{
 		_com_error err(hr);
 		return Utf8FromUtf16(err.ErrorMessage());
 	}
 
-	std::unique_ptr<TtsOptions> SttsPlugin::GetTtsOptions(const EncodableMap* args)
+	SttSessionOptions SttsPlugin::GetSttSessionOptions(const SttStartArgs& args)
+	{
+		SttSessionOptions options;
+		const auto& windowsOptions = args.options.windows;
+
+		if (windowsOptions.idleTimeout) {
+			options.idleTimeout = std::chrono::milliseconds(max(*windowsOptions.idleTimeout, 0LL));
+		}
+		if (windowsOptions.memoryBudget) {
+			options.memoryBudget = static_cast<size_t>(max(*windowsOptions.memoryBudget, 0LL));
+		}
+		if (windowsOptions.continuous) {
+			options.continuous = *windowsOptions.continuous;
+		}
+		if (windowsOptions.maxDuration) {
+			options.maxDuration = std::chrono::milliseconds(max(*windowsOptions.maxDuration, 0LL));
+		}
+		if (windowsOptions.silenceTimeout) {
+			options.silenceTimeout = std::chrono::milliseconds(max(*windowsOptions.silenceTimeout, 0LL));
+		}
+		if (windowsOptions.hypothesisInterval) {
+			options.hypothesisInterval = std::chrono::milliseconds(max(*windowsOptions.hypothesisInterval, 0LL));
+		}
+		if (windowsOptions.compactEvents) {
+			options.compactEvents = *windowsOptions.compactEvents;
+		}
+		if (windowsOptions.levelInterval) {
+			options.levelInterval = std::chrono::milliseconds(max(*windowsOptions.levelInterval, 0LL));
+		}
+
+		return options;
+	}
+
+	bool SttsPlugin::GetPcmFormat(const std::optional<PcmFormatArgs>& args, PcmFormat& format)
 	{
-		std::string mode;
-		GetValueFromEncodableMap(args, "mode", mode);
-		int preSilenceMs;
-		GetValueFromEncodableMap(args, "preSilence", preSilenceMs);
-		int postSilenceMs;
-		GetValueFromEncodableMap(args, "postSilence", postSilenceMs);
+		if (!args) return false;
+
+		format.sampleRate = static_cast<uint32_t>(max(args->sampleRate, 0));
+		format.channels = static_cast<uint16_t>(max(args->channels, 0));
+		format.bitsPerSample = static_cast<uint16_t>(max(args->bitsPerSample, 0));
 
+		return true;
+	}
+
+	std::unique_ptr<TtsOptions> SttsPlugin::GetTtsOptions(const TtsOptionsArgs& args)
+	{
 		auto options = std::make_unique<TtsOptions>(
-			mode,
-			preSilenceMs,
-			postSilenceMs
+			args.mode,
+			args.preSilence,
+			args.postSilence
 		);
 
+		options->priority = args.priority;
+		options->deadlineMs = args.deadline;
+		options->voice = GetVoiceSettings(args);
+
+		// Text offset to name.
+		for (const auto& [key, value] : args.bookmarks) {
+			const auto* name = std::get_if<std::string>(&value);
+			if (!name || !(std::holds_alternative<int32_t>(key) || std::holds_alternative<int64_t>(key))) continue;
+
+			options->bookmarks.push_back({ static_cast<size_t>(max(key.LongValue(), 0)), *name });
+		}
+
+		std::stable_sort(options->bookmarks.begin(), options->bookmarks.end(),
+			[](const TtsBookmark& a, const TtsBookmark& b) { return a.offset < b.offset; });
+
 		return options;
 	}
 
+	// static
+	TtsVoiceSettings SttsPlugin::GetVoiceSettings(const TtsVoiceSettingsArgs& args)
+	{
+		TtsVoiceSettings settings;
+		settings.voiceId = args.voiceId;
+		settings.pitch = args.pitch;
+		settings.rate = args.rate;
+		settings.volume = args.volume;
+
+		return settings;
+	}
+
 }  // namespace stts
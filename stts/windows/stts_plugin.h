@@ -5,10 +5,20 @@
 #include <flutter/plugin_registrar_windows.h>
 #include <flutter/encodable_value.h>
 
+#include <chrono>
+#include <functional>
 #include <memory>
+#include "cached_response.h"
+#include "event_egress.h"
+#include "event_stream_handler.h"
+#include "platform_dispatcher.h"
+#include "plugin_arguments.h"
 #include "stt/stt.h"
+#include "stt/transcription_pool.h"
 #include "tts/tts.h"
 #include "tts/tts_options.h"
+#include "tts/utterance_renderer.h"
+#include "worker/com_engine_worker.h"
 
 namespace stts {
 
@@ -35,13 +45,135 @@ class SttsPlugin : public flutter::Plugin {
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
 private:
+    using MethodResultPtr = std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>>;
+    // Entry of the method tables, see Invoke.
+    using MethodHandler = void (*)(SttsPlugin& plugin, const flutter::EncodableValue* arguments, MethodResultPtr result);
+
+    // Declaration order matters: the worker must be stopped before the egress and the dispatcher are destroyed.
+    std::unique_ptr<PlatformDispatcher> mDispatcher;
+    std::unique_ptr<EventEgress> mEventEgress;
+    std::unique_ptr<ComEngineWorker> mWorker;
+    // Renders synthesize calls so they don't hold up the engine worker.
+    std::unique_ptr<ComEngineWorker> mSynthesisWorker;
+
+    // Engines are created, used and destroyed on the worker thread only.
     std::unique_ptr<Stt> mStt;
     std::unique_ptr<Tts> mTts;
+    // Voice bound to the synthesis output, used on the synthesis worker thread only.
+    UtteranceRenderer mRenderer;
+
+    // Queued file transcriptions, created on first use. Owned by the worker thread.
+    std::unique_ptr<TranscriptionPool> mTranscriptionPool;
+    EventStreamHandler* mTranscriptionEventHandler = nullptr;
+
+    // Queries answered from the engine catalogs. Owned by the worker thread.
+    CachedResponse mSttSupported;
+    CachedResponse mSttLanguages;
+    CachedResponse mTtsSupported;
+    CachedResponse mTtsLanguages;
+    CachedResponse mTtsVoices;
+
+    // Executes task on the engine worker and completes result on the platform thread.
+    void RunOnEngine(
+        const std::string& group,
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+        std::function<flutter::EncodableValue()> task,
+        std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+    // Same, for long tasks checking the command cancellation.
+    void RunOnEngine(
+        const std::string& group,
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+        std::function<flutter::EncodableValue(const CancellationToken&)> task,
+        std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+    // Same, for values shared with a cached response: they are encoded on the platform thread without being copied.
+    void RunSharedOnEngine(
+        const std::string& group,
+        std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result,
+        std::function<std::shared_ptr<const flutter::EncodableValue>(const CancellationToken&)> task,
+        std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+    // Transcribes the loaded audio on the transcription pool and completes result with the phrases.
+    void RunTranscription(MethodResultPtr result, TranscriptionPool::SourceLoader load);
+    // Created on first use, on the engine worker.
+    TranscriptionPool& GetTranscriptionPool();
+
+    // Reads the voice settings for text on the engine worker, then calls render on the synthesis worker
+    // and completes result with the value returned.
+    void RunSynthesis(MethodResultPtr result, std::string text, std::shared_ptr<TtsOptions> options,
+        std::function<flutter::EncodableValue(const SynthesisRequest& request, const CancellationToken& token)> render);
+    // Throws E_ABORT if the cancellation token stops first. Called on the synthesis worker.
+    void Render(const SynthesisRequest& request, const PcmFormat& format, PcmSink& sink, const CancellationToken& token);
+
+    // Decodes the arguments to Args and calls Method, mistyped arguments are replied with E_INVALIDARG.
+    template <typename Args, void (SttsPlugin::*Method)(Args& args, MethodResultPtr result)>
+    static void Invoke(SttsPlugin& plugin, const flutter::EncodableValue* arguments, MethodResultPtr result);
+
+    // STT methods
+    void SttIsSupported(NoArguments& args, MethodResultPtr result);
+    void SttHasPermission(NoArguments& args, MethodResultPtr result);
+    void SttGetLanguage(NoArguments& args, MethodResultPtr result);
+    void SttSetLanguage(LanguageArgs& args, MethodResultPtr result);
+    void SttGetLanguages(NoArguments& args, MethodResultPtr result);
+    void SttStart(SttStartArgs& args, MethodResultPtr result);
+    void SttStop(NoArguments& args, MethodResultPtr result);
+    void SttShowTrainingUI(TrainingArgs& args, MethodResultPtr result);
+    void SttGetSessionStats(NoArguments& args, MethodResultPtr result);
+    void SttTranscribeFile(PathArgs& args, MethodResultPtr result);
+    void SttTranscribeBuffer(TranscribeBufferArgs& args, MethodResultPtr result);
+    void SttQueueTranscription(PathArgs& args, MethodResultPtr result);
+    void SttCancelTranscription(CancelTranscriptionArgs& args, MethodResultPtr result);
+    void SttDispose(NoArguments& args, MethodResultPtr result);
+
+    // TTS methods
+    void TtsIsSupported(NoArguments& args, MethodResultPtr result);
+    void TtsStart(TtsStartArgs& args, MethodResultPtr result);
+    void TtsCancel(TtsCancelArgs& args, MethodResultPtr result);
+    void TtsStop(NoArguments& args, MethodResultPtr result);
+    void TtsPause(NoArguments& args, MethodResultPtr result);
+    void TtsResume(NoArguments& args, MethodResultPtr result);
+    void TtsGetLanguage(NoArguments& args, MethodResultPtr result);
+    void TtsSetLanguage(LanguageArgs& args, MethodResultPtr result);
+    void TtsGetLanguages(NoArguments& args, MethodResultPtr result);
+    void TtsSetVoice(VoiceArgs& args, MethodResultPtr result);
+    void TtsGetVoices(NoArguments& args, MethodResultPtr result);
+    void TtsGetVoicesByLanguage(LanguageArgs& args, MethodResultPtr result);
+    void TtsSetPitch(PitchArgs& args, MethodResultPtr result);
+    void TtsSetRate(RateArgs& args, MethodResultPtr result);
+    void TtsSetVolume(VolumeArgs& args, MethodResultPtr result);
+    void TtsConfigure(TtsVoiceSettingsArgs& args, MethodResultPtr result);
+    void TtsSetCacheBudget(CacheBudgetArgs& args, MethodResultPtr result);
+    void TtsGetCacheStats(NoArguments& args, MethodResultPtr result);
+    void TtsOpenStore(OpenStoreArgs& args, MethodResultPtr result);
+    void TtsCloseStore(NoArguments& args, MethodResultPtr result);
+    void TtsGetStoreStats(NoArguments& args, MethodResultPtr result);
+    void TtsSetPipeline(PipelineArgs& args, MethodResultPtr result);
+    void TtsGetPipelineStats(NoArguments& args, MethodResultPtr result);
+    void TtsSetProgressEvents(ProgressEventsArgs& args, MethodResultPtr result);
+    void TtsSynthesizeToBuffer(SynthesizeArgs& args, MethodResultPtr result);
+    void TtsSynthesizeToFile(SynthesizeArgs& args, MethodResultPtr result);
+    void TtsDispose(NoArguments& args, MethodResultPtr result);
+
+    // Shared by both channels.
+    void SetTracing(TracingArgs& args, MethodResultPtr result);
+    void GetTrace(NoArguments& args, MethodResultPtr result);
+
+    void ReplyError(std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>> result, HRESULT hr);
 
     std::string ttsVoiceGenderToString(TtsVoiceGender gender);
-    std::unique_ptr<TtsOptions> GetTtsOptions(const EncodableMap* args);
+    flutter::EncodableList ToEncodableLanguages(std::vector<std::string> languages);
+    flutter::EncodableList ToEncodableVoices(std::vector<TtsVoice> voices);
+    flutter::EncodableList ToEncodablePhrases(const std::vector<TranscribedPhrase>& phrases);
+    void SendTranscriptionEvent(uint64_t jobId, const std::string& state, flutter::EncodableMap event);
+    std::unique_ptr<TtsOptions> GetTtsOptions(const TtsOptionsArgs& args);
+    static TtsVoiceSettings GetVoiceSettings(const TtsVoiceSettingsArgs& args);
+    SttSessionOptions GetSttSessionOptions(const SttStartArgs& args);
+    // Returns false if no format was given, format is then left untouched.
+    static bool GetPcmFormat(const std::optional<PcmFormatArgs>& args, PcmFormat& format);
 
-    std::string GetErrorMessage(HRESULT hr);
+    static HRESULT GetRejectionError(CommandRejection rejection);
+    static std::string GetErrorMessage(HRESULT hr);
 };
 
 }  // namespace stts
@@ -0,0 +1,78 @@
+#include "audio/audio_level_meter.h"
+#include "audio/level_kernels.h"
+#include "audio/spsc_ring.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "pcm_fixtures.h"
+
+namespace stts {
+namespace {
+
+    void BM_PcmStats(benchmark::State& state)
+    {
+        auto isa = static_cast<PcmKernelIsa>(state.range(0));
+        if (isa > GetPcmKernelIsa())
+        {
+            state.SkipWithError("not supported by the CPU");
+            return;
+        }
+
+        // Ten seconds at 16 kHz.
+        auto samples = MakeSpeechPcm(16000, 10);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(ComputePcmStats(isa, samples.data(), samples.size()));
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * samples.size() * sizeof(int16_t)));
+    }
+    BENCHMARK(BM_PcmStats)
+        ->Arg(static_cast<int>(PcmKernelIsa::scalar))
+        ->Arg(static_cast<int>(PcmKernelIsa::sse2))
+        ->Arg(static_cast<int>(PcmKernelIsa::avx2));
+
+    // Cost of metering a 10 ms capture buffer, as the audio thread does.
+    void BM_AudioLevelMeter(benchmark::State& state)
+    {
+        auto samples = MakeSpeechPcm(16000, 10);
+        AudioLevelMeter meter;
+        size_t offset = 0;
+
+        for (auto _ : state)
+        {
+            meter.Process(samples.data() + offset, 160);
+            AudioLevel level;
+            benchmark::DoNotOptimize(meter.TakeLevel(level));
+
+            offset += 160;
+            if (offset + 160 > samples.size()) offset = 0;
+        }
+    }
+    BENCHMARK(BM_AudioLevelMeter);
+
+    // Capture buffer written by the audio thread then read by the engine worker.
+    void BM_SpscRingWriteRead(benchmark::State& state)
+    {
+        auto chunk = static_cast<size_t>(state.range(0));
+        auto samples = MakeSpeechPcm(16000, 1);
+        std::vector<int16_t> data(chunk);
+        SpscRing<int16_t> ring(16384);
+        size_t offset = 0;
+
+        for (auto _ : state)
+        {
+            ring.Write(samples.data() + offset, chunk);
+            benchmark::DoNotOptimize(ring.Read(data.data(), chunk));
+            offset = (offset + chunk) % (samples.size() - chunk);
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * chunk));
+    }
+    BENCHMARK(BM_SpscRingWriteRead)->Arg(160)->Arg(1600);
+
+}
+}
@@ -0,0 +1,106 @@
+#include "audio/audio_level_meter.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "pcm_fixtures.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    // Feeds samples in chunks as the audio thread would and collects one level per chunk.
+    std::vector<AudioLevel> Measure(AudioLevelMeter& meter, const std::vector<int16_t>& samples, size_t chunk)
+    {
+        std::vector<AudioLevel> levels;
+        for (size_t offset = 0; offset < samples.size(); offset += chunk)
+        {
+            meter.Process(samples.data() + offset, std::min(chunk, samples.size() - offset));
+
+            AudioLevel level;
+            if (meter.TakeLevel(level)) levels.push_back(level);
+        }
+        return levels;
+    }
+
+    TEST(AudioLevelMeterTest, ReportsLevelOncePerCompletedFrames)
+    {
+        AudioLevelMeter meter(16000, 1, 20ms);
+        std::vector<int16_t> frame(319, 1000);
+        AudioLevel level;
+
+        meter.Process(frame.data(), frame.size());
+        EXPECT_FALSE(meter.TakeLevel(level));
+
+        meter.Process(frame.data(), 1);
+        ASSERT_TRUE(meter.TakeLevel(level));
+        EXPECT_NEAR(level.rms, 1000 / 32768.0f, 1e-6f);
+        EXPECT_NEAR(level.peak, 1000 / 32768.0f, 1e-6f);
+        EXPECT_FALSE(meter.TakeLevel(level));
+    }
+
+    TEST(AudioLevelMeterTest, SilenceIsNotVoice)
+    {
+        AudioLevelMeter meter;
+        std::vector<int16_t> silence(16000, 0);
+        NoiseGenerator noise;
+        std::vector<int16_t> roomNoise;
+        AppendNoise(roomNoise, 16000, 30, noise);
+
+        for (const auto& level : Measure(meter, silence, 320))
+        {
+            EXPECT_EQ(level.rms, 0);
+            EXPECT_FALSE(level.voice);
+        }
+        for (const auto& level : Measure(meter, roomNoise, 320))
+        {
+            EXPECT_FALSE(level.voice);
+        }
+    }
+
+    TEST(AudioLevelMeterTest, DetectsWordsAndBridgesShortPauses)
+    {
+        AudioLevelMeter meter;
+        auto samples = MakeSpeechPcm(16000, 2.5);
+        auto levels = Measure(meter, samples, 320);
+        ASSERT_EQ(levels.size(), 125u);
+
+        // 500 ms of noise.
+        for (size_t i = 0; i < 25; i++) EXPECT_FALSE(levels[i].voice) << i;
+        // Words, then pauses shorter than the hangover.
+        for (size_t i = 26; i < levels.size(); i++) EXPECT_TRUE(levels[i].voice) << i;
+        EXPECT_GT(levels[30].rms, 0.1f);
+    }
+
+    TEST(AudioLevelMeterTest, AggregatesFramesBetweenTakes)
+    {
+        AudioLevelMeter meter;
+        auto samples = MakeSpeechPcm(16000, 1);
+
+        // One level per 100 ms, the loudest frame wins.
+        auto levels = Measure(meter, samples, 1600);
+        ASSERT_EQ(levels.size(), 10u);
+        EXPECT_FALSE(levels[0].voice);
+        EXPECT_TRUE(levels[6].voice);
+        EXPECT_GT(levels[6].peak, levels[6].rms);
+    }
+
+    TEST(AudioLevelMeterTest, FormatChangeResetsFrame)
+    {
+        AudioLevelMeter meter(16000, 1, 20ms);
+        std::vector<int16_t> samples(640, 1000);
+        AudioLevel level;
+
+        meter.Process(samples.data(), 100);
+        meter.SetFormat(16000, 2);
+        meter.Process(samples.data(), 320);
+        EXPECT_FALSE(meter.TakeLevel(level));
+        meter.Process(samples.data(), 320);
+        EXPECT_TRUE(meter.TakeLevel(level));
+    }
+
+}
+}
@@ -0,0 +1,83 @@
+#include "audio/level_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "pcm_fixtures.h"
+
+namespace stts {
+namespace {
+
+    std::vector<PcmKernelIsa> GetSupportedIsas()
+    {
+        std::vector<PcmKernelIsa> isas;
+        for (auto isa : { PcmKernelIsa::scalar, PcmKernelIsa::sse2, PcmKernelIsa::avx2 })
+        {
+            if (isa <= GetPcmKernelIsa()) isas.push_back(isa);
+        }
+        return isas;
+    }
+
+    void ExpectSameStats(const PcmStats& actual, const PcmStats& expected)
+    {
+        EXPECT_EQ(actual.sumSquares, expected.sumSquares);
+        EXPECT_EQ(actual.peak, expected.peak);
+        EXPECT_EQ(actual.count, expected.count);
+    }
+
+    TEST(LevelKernelsTest, ComputesScalarStats)
+    {
+        const int16_t samples[] = { 3, -4, 0, 2 };
+        auto stats = ComputePcmStatsScalar(samples, 4);
+
+        EXPECT_EQ(stats.sumSquares, 29u);
+        EXPECT_EQ(stats.peak, 4);
+        EXPECT_EQ(stats.count, 4u);
+
+        ExpectSameStats(ComputePcmStatsScalar(samples, 0), PcmStats());
+    }
+
+    TEST(LevelKernelsTest, KernelsMatchScalarForEveryLengthAndAlignment)
+    {
+        NoiseGenerator noise;
+        std::vector<int16_t> samples;
+        AppendNoise(samples, 300, 32767, noise);
+
+        for (auto isa : GetSupportedIsas())
+        {
+            for (size_t offset = 0; offset < 16; offset++)
+            {
+                for (size_t count = 0; offset + count <= samples.size(); count += 1 + count / 16)
+                {
+                    SCOPED_TRACE(testing::Message() << "isa " << static_cast<int>(isa) << " offset " << offset << " count " << count);
+                    ExpectSameStats(ComputePcmStats(isa, samples.data() + offset, count),
+                        ComputePcmStatsScalar(samples.data() + offset, count));
+                }
+            }
+        }
+    }
+
+    TEST(LevelKernelsTest, KernelsHandleFullScaleSamples)
+    {
+        // Squares of -32768 pairs overflow a signed 32-bit madd result.
+        for (int16_t value : { int16_t(-32768), int16_t(32767) })
+        {
+            std::vector<int16_t> samples(4099, value);
+            for (auto isa : GetSupportedIsas())
+            {
+                auto stats = ComputePcmStats(isa, samples.data(), samples.size());
+                EXPECT_EQ(stats.sumSquares, static_cast<uint64_t>(int64_t(value) * value) * samples.size());
+                EXPECT_EQ(stats.peak, value < 0 ? 32768 : 32767);
+            }
+        }
+    }
+
+    TEST(LevelKernelsTest, DispatchedKernelMatchesScalar)
+    {
+        auto samples = MakeSpeechPcm(16000, 1);
+        ExpectSameStats(ComputePcmStats(samples.data(), samples.size()), ComputePcmStatsScalar(samples.data(), samples.size()));
+    }
+
+}
+}
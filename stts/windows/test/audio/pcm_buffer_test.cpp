@@ -0,0 +1,87 @@
+#include "audio/pcm_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include "audio/wav_writer.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    TEST(PcmBufferTest, AccumulatesWrites)
+    {
+        PcmFormat format;
+        PcmBuffer buffer(format);
+        const uint8_t first[] = { 1, 2 };
+        const uint8_t second[] = { 3, 4, 5, 6 };
+
+        EXPECT_TRUE(buffer.Write(first, sizeof(first)));
+        EXPECT_TRUE(buffer.Write(second, sizeof(second)));
+        ASSERT_EQ(buffer.GetSize(), 6u);
+        EXPECT_EQ(buffer.GetData()[2], 3);
+    }
+
+    TEST(PcmBufferTest, RejectsWritesOverMaximumSize)
+    {
+        PcmFormat format;
+        PcmBuffer buffer(format, 4);
+        const uint8_t samples[] = { 1, 2, 3 };
+
+        EXPECT_TRUE(buffer.Write(samples, 3));
+        EXPECT_FALSE(buffer.Write(samples, 2));
+        EXPECT_TRUE(buffer.Write(samples, 1));
+        EXPECT_EQ(buffer.GetSize(), 4u);
+    }
+
+    TEST(PcmBufferTest, ComputesDuration)
+    {
+        PcmFormat format;
+        format.sampleRate = 16000;
+        PcmBuffer buffer(format);
+        std::vector<uint8_t> second(32000);
+
+        buffer.Write(second.data(), second.size());
+        buffer.Write(second.data(), second.size() / 2);
+        EXPECT_EQ(buffer.GetDuration(), 1500ms);
+
+        PcmFormat invalid;
+        invalid.channels = 0;
+        EXPECT_EQ(PcmBuffer(invalid).GetDuration(), 0ms);
+    }
+
+    TEST(PcmBufferTest, ReservesUpToMaximumSize)
+    {
+        PcmFormat format;
+        format.sampleRate = 16000;
+        PcmBuffer buffer(format);
+        buffer.Reserve(2000ms);
+        const uint8_t* data = buffer.GetData();
+
+        std::vector<uint8_t> samples(64000);
+        buffer.Write(samples.data(), samples.size());
+        // No reallocation.
+        EXPECT_EQ(buffer.GetData(), data);
+
+        PcmBuffer small(format, 100);
+        small.Reserve(2000ms);
+        EXPECT_EQ(small.GetSize(), 0u);
+    }
+
+    TEST(PcmBufferTest, TakesSamplesAndConvertsToWav)
+    {
+        PcmFormat format;
+        PcmBuffer buffer(format);
+        const uint8_t samples[] = { 1, 0, 2, 0 };
+        buffer.Write(samples, sizeof(samples));
+
+        EXPECT_EQ(buffer.ToWav(), EncodeWav(format, samples, sizeof(samples)));
+
+        auto taken = buffer.TakeSamples();
+        EXPECT_EQ(taken, std::vector<uint8_t>(samples, samples + 4));
+        EXPECT_EQ(buffer.GetSize(), 0u);
+        EXPECT_EQ(buffer.ToWav().size(), kWavHeaderSize);
+    }
+
+}
+}
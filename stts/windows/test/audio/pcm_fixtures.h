@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stts {
+
+	// Deterministic noise in [-amplitude, amplitude].
+	class NoiseGenerator {
+	public:
+		explicit NoiseGenerator(uint32_t seed = 1) : m_seed(seed) {}
+
+		int32_t Next(int32_t amplitude)
+		{
+			m_seed = m_seed * 1664525u + 1013904223u;
+			return static_cast<int32_t>((m_seed >> 8) % static_cast<uint32_t>(2 * amplitude + 1)) - amplitude;
+		}
+
+	private:
+		uint32_t m_seed;
+	};
+
+	inline int16_t ClampSample(double value)
+	{
+		if (value > 32767) return 32767;
+		if (value < -32768) return -32768;
+		return static_cast<int16_t>(value);
+	}
+
+	// Appends a voiced segment: a 150 Hz fundamental with harmonics over background noise.
+	inline void AppendVoice(std::vector<int16_t>& samples, uint32_t sampleRate, size_t count, double amplitude, NoiseGenerator& noise)
+	{
+		const double pi = 3.14159265358979323846;
+		for (size_t i = 0; i < count; i++)
+		{
+			double t = static_cast<double>(i) / sampleRate;
+			double value = std::sin(2 * pi * 150 * t) + 0.5 * std::sin(2 * pi * 300 * t) + 0.25 * std::sin(2 * pi * 450 * t);
+			samples.push_back(ClampSample(amplitude * value / 1.75 + noise.Next(30)));
+		}
+	}
+
+	inline void AppendNoise(std::vector<int16_t>& samples, size_t count, int32_t amplitude, NoiseGenerator& noise)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			samples.push_back(static_cast<int16_t>(noise.Next(amplitude)));
+		}
+	}
+
+	// Mono 16-bit speech-like recording: half a second of room noise, then 400 ms words separated
+	// by 120 ms pauses.
+	inline std::vector<int16_t> MakeSpeechPcm(uint32_t sampleRate, double seconds, uint32_t seed = 1)
+	{
+		NoiseGenerator noise(seed);
+		std::vector<int16_t> samples;
+		auto total = static_cast<size_t>(seconds * sampleRate);
+		samples.reserve(total);
+
+		AppendNoise(samples, sampleRate / 2, 30, noise);
+		while (samples.size() < total)
+		{
+			AppendVoice(samples, sampleRate, sampleRate * 2 / 5, 8000, noise);
+			AppendNoise(samples, sampleRate * 3 / 25, 30, noise);
+		}
+
+		samples.resize(total);
+		return samples;
+	}
+
+}
@@ -0,0 +1,124 @@
+#include "audio/pcm_source.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "pcm_fixtures.h"
+#include "wav_fixtures.h"
+#include "../stt/fake_recognizer.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    // Half a second of noise, then two 400 ms words separated by a second.
+    std::vector<int16_t> MakeTwoWords()
+    {
+        NoiseGenerator noise;
+        std::vector<int16_t> samples;
+        AppendNoise(samples, 8000, 30, noise);
+        AppendVoice(samples, 16000, 6400, 8000, noise);
+        AppendNoise(samples, 16000, 30, noise);
+        AppendVoice(samples, 16000, 6400, 8000, noise);
+        AppendNoise(samples, 8000, 30, noise);
+        return samples;
+    }
+
+    TEST(PcmSourceTest, ReadsAndSeeksWholeBlocks)
+    {
+        PcmFormat format;
+        format.channels = 2;
+        PcmSource source(std::vector<uint8_t>{ 1, 2, 3, 4, 5, 6, 7, 8, 9 }, format);
+
+        EXPECT_EQ(source.GetSize(), 8u);
+
+        uint8_t buffer[16];
+        EXPECT_EQ(source.Read(buffer, 3), 3u);
+        EXPECT_EQ(buffer[2], 3);
+        EXPECT_EQ(source.Read(buffer, 16), 5u);
+        EXPECT_EQ(buffer[4], 8);
+        EXPECT_EQ(source.Read(buffer, 16), 0u);
+
+        EXPECT_TRUE(source.Seek(4));
+        EXPECT_EQ(source.Read(buffer, 1), 1u);
+        EXPECT_EQ(buffer[0], 5);
+        EXPECT_FALSE(source.Seek(9));
+    }
+
+    TEST(PcmSourceTest, SharedSamplesHaveIndependentPositions)
+    {
+        auto samples = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{ 1, 2, 3, 4 });
+        PcmFormat format;
+        PcmSource first(samples, format);
+        PcmSource second(samples, format);
+
+        uint8_t buffer[4];
+        first.Read(buffer, 4);
+        EXPECT_EQ(second.GetPosition(), 0u);
+        EXPECT_EQ(second.Read(buffer, 2), 2u);
+        EXPECT_EQ(buffer[0], 1);
+    }
+
+    TEST(PcmSourceTest, ConvertsOffsetsToTime)
+    {
+        PcmFormat format;
+        format.sampleRate = 16000;
+        PcmSource source(std::vector<uint8_t>(64000), format);
+
+        EXPECT_EQ(source.GetTime(0), 0ms);
+        EXPECT_EQ(source.GetTime(32000), 1000ms);
+        EXPECT_EQ(source.GetTime(320), 10ms);
+    }
+
+    TEST(PcmSourceTest, ReadsSamplesOfWavContent)
+    {
+        std::unique_ptr<PcmSource> source;
+        ASSERT_EQ(PcmSource::FromWav(MakeWav({ 10, -10, 20 }), source), WavError::none);
+        ASSERT_EQ(source->GetSize(), 6u);
+
+        int16_t samples[3];
+        EXPECT_EQ(source->Read(samples, sizeof(samples)), 6u);
+        EXPECT_EQ(samples[1], -10);
+        EXPECT_EQ(samples[2], 20);
+
+        EXPECT_EQ(PcmSource::FromWav({ 'R', 'I', 'F', 'F' }, source), WavError::truncated);
+    }
+
+    TEST(PcmSourceTest, FeedsRecognizerWithPhraseOffsets)
+    {
+        std::unique_ptr<PcmSource> source;
+        ASSERT_EQ(PcmSource::FromWav(MakeWav(MakeTwoWords()), source), WavError::none);
+
+        auto phrases = RecognizeVoice(*source);
+        ASSERT_EQ(phrases.size(), 2u);
+        EXPECT_NEAR(static_cast<double>(phrases[0].offset.count()), 500, 40);
+        EXPECT_NEAR(static_cast<double>(phrases[1].offset.count()), 1900, 40);
+        // Voice detection hangs over a few frames after the word.
+        EXPECT_GE(phrases[0].duration, 400ms);
+        EXPECT_LE(phrases[0].duration, 600ms);
+        EXPECT_EQ(source->GetPosition(), source->GetSize());
+    }
+
+    TEST(PcmSourceTest, ReadsFiles)
+    {
+        auto path = std::filesystem::temp_directory_path() / "stts_pcm_source_test.wav";
+        auto wav = MakeWav(MakeTwoWords());
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(wav.data()), static_cast<std::streamsize>(wav.size()));
+        }
+
+        std::vector<uint8_t> bytes;
+        ASSERT_TRUE(PcmSource::ReadFile(path.u8string(), bytes));
+        EXPECT_EQ(bytes, wav);
+        std::filesystem::remove(path);
+
+        EXPECT_FALSE(PcmSource::ReadFile(path.u8string(), bytes));
+    }
+
+}
+}
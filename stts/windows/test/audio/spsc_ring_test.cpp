@@ -0,0 +1,113 @@
+#include "audio/spsc_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace stts {
+namespace {
+
+    TEST(SpscRingTest, RoundsCapacityToPowerOfTwo)
+    {
+        EXPECT_EQ(SpscRing<int16_t>(1).GetCapacity(), 1u);
+        EXPECT_EQ(SpscRing<int16_t>(5).GetCapacity(), 8u);
+        EXPECT_EQ(SpscRing<int16_t>(4096).GetCapacity(), 4096u);
+    }
+
+    TEST(SpscRingTest, ReadsAcrossTheWrapAround)
+    {
+        SpscRing<int16_t> ring(8);
+        int16_t data[8];
+        int16_t next = 0;
+        int16_t expected = 0;
+
+        // Offsets the positions so every read and write size wraps at some point.
+        for (int round = 0; round < 100; round++)
+        {
+            size_t count = 1 + round % 7;
+            for (size_t i = 0; i < count; i++) data[i] = next++;
+            ASSERT_EQ(ring.Write(data, count), count);
+            ASSERT_EQ(ring.GetReadAvailable(), count);
+
+            ASSERT_EQ(ring.Read(data, 8), count);
+            for (size_t i = 0; i < count; i++) ASSERT_EQ(data[i], expected++);
+        }
+        EXPECT_EQ(ring.GetDroppedCount(), 0u);
+    }
+
+    TEST(SpscRingTest, DropsWhatDoesNotFit)
+    {
+        SpscRing<int16_t> ring(4);
+        const int16_t data[] = { 1, 2, 3, 4, 5, 6 };
+
+        EXPECT_EQ(ring.Write(data, 3), 3u);
+        EXPECT_EQ(ring.Write(data + 3, 3), 1u);
+        EXPECT_EQ(ring.GetDroppedCount(), 2u);
+
+        int16_t read[4];
+        ASSERT_EQ(ring.Read(read, 4), 4u);
+        EXPECT_EQ(read[3], 4);
+    }
+
+    TEST(SpscRingTest, SkipDiscardsAvailableItems)
+    {
+        SpscRing<int16_t> ring(8);
+        const int16_t data[] = { 1, 2, 3 };
+        ring.Write(data, 3);
+
+        EXPECT_EQ(ring.Skip(), 3u);
+        EXPECT_EQ(ring.GetReadAvailable(), 0u);
+        EXPECT_EQ(ring.Write(data, 3), 3u);
+    }
+
+    TEST(SpscRingTest, TransfersInOrderBetweenThreads)
+    {
+        SpscRing<uint32_t> ring(256);
+        const uint32_t total = 1000000;
+
+        std::thread producer([&ring, total] {
+            uint32_t data[64];
+            uint32_t next = 0;
+            while (next < total)
+            {
+                uint32_t count = 0;
+                while (count < 64 && next + count < total)
+                {
+                    data[count] = next + count;
+                    count++;
+                }
+
+                // Retries instead of dropping, to check every item.
+                size_t written = 0;
+                while (written < count)
+                {
+                    auto free = ring.GetCapacity() - ring.GetReadAvailable();
+                    auto size = std::min<size_t>(free, count - written);
+                    written += ring.Write(data + written, size);
+                    if (written < count) std::this_thread::yield();
+                }
+                next += count;
+            }
+        });
+
+        uint32_t expected = 0;
+        bool inOrder = true;
+        uint32_t data[100];
+        while (expected < total)
+        {
+            auto read = ring.Read(data, 100);
+            for (size_t i = 0; i < read; i++)
+            {
+                inOrder = inOrder && data[i] == expected;
+                expected++;
+            }
+            if (read == 0) std::this_thread::yield();
+        }
+
+        producer.join();
+        EXPECT_TRUE(inOrder);
+        EXPECT_EQ(ring.GetDroppedCount(), 0u);
+    }
+
+}
+}
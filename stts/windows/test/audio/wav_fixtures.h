@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "audio/wav_reader.h"
+
+namespace stts {
+
+	// Builds RIFF/WAVE content chunk by chunk, including malformed ones.
+	class WavBuilder {
+	public:
+		WavBuilder& AddChunk(const char* id, const std::vector<uint8_t>& data, uint32_t declaredSize)
+		{
+			m_chunks.insert(m_chunks.end(), id, id + 4);
+			AppendUint32(m_chunks, declaredSize);
+			m_chunks.insert(m_chunks.end(), data.begin(), data.end());
+			if (data.size() % 2 != 0 && data.size() == declaredSize) m_chunks.push_back(0);
+			return *this;
+		}
+
+		WavBuilder& AddChunk(const char* id, const std::vector<uint8_t>& data)
+		{
+			return AddChunk(id, data, static_cast<uint32_t>(data.size()));
+		}
+
+		WavBuilder& AddFormat(const PcmFormat& format, uint16_t formatTag = 1)
+		{
+			std::vector<uint8_t> data;
+			AppendUint16(data, formatTag);
+			AppendUint16(data, format.channels);
+			AppendUint32(data, format.sampleRate);
+			AppendUint32(data, format.GetByteRate());
+			AppendUint16(data, format.GetBlockAlign());
+			AppendUint16(data, format.bitsPerSample);
+			return AddChunk("fmt ", data);
+		}
+
+		// WAVE_FORMAT_EXTENSIBLE with the given sub format tag.
+		WavBuilder& AddExtensibleFormat(const PcmFormat& format, uint16_t subFormatTag = 1)
+		{
+			static const uint8_t subFormatTail[14] = {
+				0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+			};
+
+			std::vector<uint8_t> data;
+			AppendUint16(data, 0xFFFE);
+			AppendUint16(data, format.channels);
+			AppendUint32(data, format.sampleRate);
+			AppendUint32(data, format.GetByteRate());
+			AppendUint16(data, format.GetBlockAlign());
+			AppendUint16(data, format.bitsPerSample);
+			AppendUint16(data, 22);
+			AppendUint16(data, format.bitsPerSample);
+			AppendUint32(data, 0);
+			AppendUint16(data, subFormatTag);
+			data.insert(data.end(), subFormatTail, subFormatTail + sizeof(subFormatTail));
+			return AddChunk("fmt ", data);
+		}
+
+		WavBuilder& AddSamples(const std::vector<int16_t>& samples)
+		{
+			std::vector<uint8_t> data;
+			for (auto sample : samples) AppendUint16(data, static_cast<uint16_t>(sample));
+			return AddChunk("data", data);
+		}
+
+		std::vector<uint8_t> Build() const
+		{
+			std::vector<uint8_t> bytes = { 'R', 'I', 'F', 'F' };
+			AppendUint32(bytes, static_cast<uint32_t>(4 + m_chunks.size()));
+			bytes.insert(bytes.end(), { 'W', 'A', 'V', 'E' });
+			bytes.insert(bytes.end(), m_chunks.begin(), m_chunks.end());
+			return bytes;
+		}
+
+		static void AppendUint16(std::vector<uint8_t>& bytes, uint16_t value)
+		{
+			bytes.push_back(static_cast<uint8_t>(value));
+			bytes.push_back(static_cast<uint8_t>(value >> 8));
+		}
+
+		static void AppendUint32(std::vector<uint8_t>& bytes, uint32_t value)
+		{
+			for (int i = 0; i < 4; i++) bytes.push_back(static_cast<uint8_t>(value >> (i * 8)));
+		}
+
+	private:
+		std::vector<uint8_t> m_chunks;
+	};
+
+	inline std::vector<uint8_t> MakeWav(const std::vector<int16_t>& samples, uint32_t sampleRate = 16000)
+	{
+		PcmFormat format;
+		format.sampleRate = sampleRate;
+		return WavBuilder().AddFormat(format).AddSamples(samples).Build();
+	}
+
+}
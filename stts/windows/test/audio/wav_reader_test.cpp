@@ -0,0 +1,116 @@
+#include "audio/wav_reader.h"
+
+#include <gtest/gtest.h>
+
+#include "wav_fixtures.h"
+
+namespace stts {
+namespace {
+
+    WavError Parse(const std::vector<uint8_t>& bytes, WavInfo& info)
+    {
+        return ParseWav(bytes.data(), bytes.size(), info);
+    }
+
+    TEST(WavReaderTest, ParsesCanonicalFile)
+    {
+        PcmFormat format;
+        format.channels = 2;
+        format.sampleRate = 44100;
+        auto bytes = WavBuilder().AddFormat(format).AddSamples({ 1, 2, 3, 4 }).Build();
+
+        WavInfo info;
+        ASSERT_EQ(Parse(bytes, info), WavError::none);
+        EXPECT_EQ(info.format.channels, 2);
+        EXPECT_EQ(info.format.sampleRate, 44100u);
+        EXPECT_EQ(info.format.bitsPerSample, 16);
+        EXPECT_EQ(info.dataOffset, 44u);
+        EXPECT_EQ(info.dataSize, 8u);
+    }
+
+    TEST(WavReaderTest, SkipsUnknownChunks)
+    {
+        PcmFormat format;
+        auto bytes = WavBuilder()
+            .AddChunk("LIST", { 'a', 'b', 'c' })
+            .AddFormat(format)
+            .AddChunk("fact", { 0, 0, 0, 0 })
+            .AddSamples({ 1, 2 })
+            .Build();
+
+        WavInfo info;
+        ASSERT_EQ(Parse(bytes, info), WavError::none);
+        // Odd sized chunk is padded.
+        EXPECT_EQ(info.dataOffset, 12u + 12u + 24u + 12u + 8u);
+        EXPECT_EQ(info.dataSize, 4u);
+    }
+
+    TEST(WavReaderTest, AcceptsExtensiblePcm)
+    {
+        PcmFormat format;
+        format.bitsPerSample = 8;
+
+        WavInfo info;
+        EXPECT_EQ(Parse(WavBuilder().AddExtensibleFormat(format).AddChunk("data", { 1, 2 }).Build(), info), WavError::none);
+        EXPECT_EQ(info.format.bitsPerSample, 8);
+
+        // IEEE float sub format.
+        EXPECT_EQ(Parse(WavBuilder().AddExtensibleFormat(format, 3).AddChunk("data", { 1, 2 }).Build(), info), WavError::unsupportedFormat);
+    }
+
+    TEST(WavReaderTest, RejectsUnsupportedFormats)
+    {
+        PcmFormat format;
+        WavInfo info;
+
+        EXPECT_EQ(Parse(WavBuilder().AddFormat(format, 3).AddSamples({ 1 }).Build(), info), WavError::unsupportedFormat);
+
+        format.bitsPerSample = 24;
+        EXPECT_EQ(Parse(WavBuilder().AddFormat(format).AddSamples({ 1 }).Build(), info), WavError::unsupportedFormat);
+
+        format.bitsPerSample = 16;
+        format.channels = 0;
+        EXPECT_EQ(Parse(WavBuilder().AddFormat(format).AddSamples({ 1 }).Build(), info), WavError::unsupportedFormat);
+    }
+
+    TEST(WavReaderTest, ReportsMalformedFiles)
+    {
+        PcmFormat format;
+        WavInfo info;
+        auto valid = WavBuilder().AddFormat(format).AddSamples({ 1, 2 }).Build();
+
+        EXPECT_EQ(Parse({ 'R', 'I', 'F', 'F' }, info), WavError::truncated);
+
+        auto notRiff = valid;
+        notRiff[8] = 'X';
+        EXPECT_EQ(Parse(notRiff, info), WavError::notRiff);
+
+        EXPECT_EQ(Parse(WavBuilder().AddSamples({ 1 }).Build(), info), WavError::missingFormat);
+        EXPECT_EQ(Parse(WavBuilder().AddFormat(format).Build(), info), WavError::missingData);
+        EXPECT_EQ(Parse(WavBuilder().AddChunk("fmt ", { 1, 0, 1, 0 }).AddSamples({ 1 }).Build(), info), WavError::truncated);
+
+        // Every truncation of a valid file is either rejected or yields whole blocks within the data.
+        for (size_t size = 0; size < valid.size(); size++)
+        {
+            auto error = ParseWav(valid.data(), size, info);
+            if (error == WavError::none)
+            {
+                EXPECT_LE(info.dataOffset + info.dataSize, size);
+                EXPECT_EQ(info.dataSize % 2, 0u);
+            }
+        }
+    }
+
+    TEST(WavReaderTest, ClampsUnfinishedDataChunk)
+    {
+        PcmFormat format;
+        // Written while streaming, sizes not updated yet.
+        auto bytes = WavBuilder().AddFormat(format).AddChunk("data", { 1, 0, 2, 0, 3 }, 0xFFFFFFFF).Build();
+
+        WavInfo info;
+        ASSERT_EQ(Parse(bytes, info), WavError::none);
+        EXPECT_EQ(info.dataSize, 4u);
+    }
+
+}
+}
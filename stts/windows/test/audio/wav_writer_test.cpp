@@ -0,0 +1,113 @@
+#include "audio/wav_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "audio/pcm_source.h"
+
+namespace stts {
+namespace {
+
+    class WavWriterTest : public testing::Test {
+    protected:
+        std::filesystem::path m_path = std::filesystem::temp_directory_path() / "stts_wav_writer_test.wav";
+
+        void TearDown() override { std::filesystem::remove(m_path); }
+
+        std::vector<uint8_t> ReadBack()
+        {
+            std::vector<uint8_t> bytes;
+            EXPECT_TRUE(PcmSource::ReadFile(m_path.u8string(), bytes));
+            return bytes;
+        }
+    };
+
+    TEST_F(WavWriterTest, EncodesCanonicalHeader)
+    {
+        PcmFormat format;
+        format.channels = 2;
+        format.sampleRate = 22050;
+        const uint8_t samples[] = { 1, 2, 3, 4 };
+        auto bytes = EncodeWav(format, samples, sizeof(samples));
+
+        ASSERT_EQ(bytes.size(), kWavHeaderSize + 4);
+        WavInfo info;
+        ASSERT_EQ(ParseWav(bytes.data(), bytes.size(), info), WavError::none);
+        EXPECT_EQ(info.format.channels, 2);
+        EXPECT_EQ(info.format.sampleRate, 22050u);
+        EXPECT_EQ(info.dataOffset, kWavHeaderSize);
+        EXPECT_EQ(info.dataSize, 4u);
+        // RIFF size.
+        EXPECT_EQ(bytes[4], 40);
+    }
+
+    TEST_F(WavWriterTest, PadsOddSizedData)
+    {
+        PcmFormat format;
+        format.bitsPerSample = 8;
+        const uint8_t samples[] = { 1, 2, 3 };
+        auto bytes = EncodeWav(format, samples, sizeof(samples));
+
+        ASSERT_EQ(bytes.size(), kWavHeaderSize + 4);
+        EXPECT_EQ(bytes.back(), 0);
+        EXPECT_EQ(bytes[4], 40);
+        EXPECT_EQ(bytes[40], 3);
+    }
+
+    TEST_F(WavWriterTest, StreamsFileMatchingEncodedContent)
+    {
+        PcmFormat format;
+        std::vector<uint8_t> samples(10000);
+        for (size_t i = 0; i < samples.size(); i++) samples[i] = static_cast<uint8_t>(i * 7);
+
+        WavFileWriter writer;
+        ASSERT_TRUE(writer.Open(m_path.u8string(), format));
+        EXPECT_FALSE(writer.Open(m_path.u8string(), format));
+        for (size_t offset = 0; offset < samples.size(); offset += 1000)
+        {
+            ASSERT_TRUE(writer.Write(samples.data() + offset, 1000));
+        }
+        EXPECT_EQ(writer.GetDataSize(), samples.size());
+        ASSERT_TRUE(writer.Finish());
+        EXPECT_FALSE(writer.IsOpen());
+
+        EXPECT_EQ(ReadBack(), EncodeWav(format, samples.data(), samples.size()));
+    }
+
+    TEST_F(WavWriterTest, UnfinishedFileIsReadable)
+    {
+        PcmFormat format;
+        std::vector<uint8_t> samples(1000, 1);
+
+        WavFileWriter writer;
+        ASSERT_TRUE(writer.Open(m_path.u8string(), format));
+        // More than the stream buffers, so most of it reaches the file as a crash would leave it.
+        for (int i = 0; i < 100; i++) ASSERT_TRUE(writer.Write(samples.data(), samples.size()));
+
+        auto bytes = ReadBack();
+        ASSERT_GT(bytes.size(), kWavHeaderSize);
+        std::unique_ptr<PcmSource> source;
+        ASSERT_EQ(PcmSource::FromWav(bytes, source), WavError::none);
+        EXPECT_GT(source->GetSize(), 0u);
+        EXPECT_EQ(source->GetSize(), (bytes.size() - kWavHeaderSize) / 2 * 2);
+
+        ASSERT_TRUE(writer.Finish());
+        ASSERT_EQ(PcmSource::FromWav(ReadBack(), source), WavError::none);
+        EXPECT_EQ(source->GetSize(), 100000u);
+    }
+
+    TEST_F(WavWriterTest, RejectsInvalidFormatsAndClosedWrites)
+    {
+        PcmFormat format;
+        format.bitsPerSample = 32;
+
+        WavFileWriter writer;
+        EXPECT_FALSE(writer.Open(m_path.u8string(), format));
+        const uint8_t sample = 0;
+        EXPECT_FALSE(writer.Write(&sample, 1));
+        EXPECT_FALSE(writer.Finish());
+    }
+
+}
+}
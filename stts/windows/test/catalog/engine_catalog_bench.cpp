@@ -0,0 +1,71 @@
+#include "catalog/engine_catalog.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+
+#include "fake_token_source.h"
+
+namespace stts {
+namespace {
+
+    EngineCatalog MakeCatalog(size_t count)
+    {
+        return EngineCatalog(std::make_unique<FakeTokenSource>(MakeSyntheticTokens(count)));
+    }
+
+    // Previous behavior: every lookup enumerated and scanned all tokens.
+    void BM_CatalogLinearScan(benchmark::State& state)
+    {
+        FakeTokenSource source(MakeSyntheticTokens(static_cast<size_t>(state.range(0))));
+        auto id = "voice-" + std::to_string(state.range(0) - 1);
+
+        for (auto _ : state)
+        {
+            auto tokens = source.Enumerate();
+            auto it = std::find_if(tokens.begin(), tokens.end(), [&id](const EngineToken& token) { return token.id == id; });
+            benchmark::DoNotOptimize(it);
+        }
+    }
+    BENCHMARK(BM_CatalogLinearScan)->Arg(100)->Arg(1000)->Arg(5000);
+
+    void BM_CatalogFindById(benchmark::State& state)
+    {
+        auto catalog = MakeCatalog(static_cast<size_t>(state.range(0)));
+        auto id = "voice-" + std::to_string(state.range(0) - 1);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(catalog.FindById(id));
+        }
+    }
+    BENCHMARK(BM_CatalogFindById)->Arg(100)->Arg(1000)->Arg(5000);
+
+    void BM_CatalogFindByLanguageFallback(benchmark::State& state)
+    {
+        auto catalog = MakeCatalog(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(catalog.FindByLanguage("ab-ZZ"));
+        }
+    }
+    BENCHMARK(BM_CatalogFindByLanguageFallback)->Arg(100)->Arg(1000)->Arg(5000);
+
+    void BM_CatalogRebuild(benchmark::State& state)
+    {
+        auto source = std::make_unique<FakeTokenSource>(MakeSyntheticTokens(static_cast<size_t>(state.range(0))));
+        auto pSource = source.get();
+        EngineCatalog catalog(std::move(source));
+
+        for (auto _ : state)
+        {
+            catalog.Invalidate();
+            benchmark::DoNotOptimize(catalog.GetTokens());
+        }
+        state.counters["enumerations"] = pSource->enumerations;
+    }
+    BENCHMARK(BM_CatalogRebuild)->Arg(100)->Arg(1000)->Arg(5000);
+
+}
+}
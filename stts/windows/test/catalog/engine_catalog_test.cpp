@@ -0,0 +1,127 @@
+#include "catalog/engine_catalog.h"
+
+#include <gtest/gtest.h>
+
+#include "fake_token_source.h"
+
+namespace stts {
+namespace {
+
+    struct CatalogFixture {
+        FakeTokenSource* source;
+        std::unique_ptr<EngineCatalog> catalog;
+    };
+
+    CatalogFixture MakeCatalog(std::vector<EngineToken> tokens)
+    {
+        auto source = std::make_unique<FakeTokenSource>(std::move(tokens));
+        auto pSource = source.get();
+        return { pSource, std::make_unique<EngineCatalog>(std::move(source)) };
+    }
+
+    TEST(EngineCatalogTest, FindsTokensById)
+    {
+        auto fixture = MakeCatalog({ MakeToken("david", "en-US"), MakeToken("hortense", "fr-FR") });
+
+        ASSERT_NE(fixture.catalog->FindById("hortense"), nullptr);
+        EXPECT_EQ(fixture.catalog->FindById("hortense")->language, "fr-FR");
+        EXPECT_EQ(fixture.catalog->FindById("unknown"), nullptr);
+
+        auto tokenId = fixture.catalog->FindById("david")->tokenId;
+        EXPECT_EQ(fixture.catalog->FindByTokenId(tokenId)->id, "david");
+    }
+
+    TEST(EngineCatalogTest, FirstTokenWinsForDuplicatedIds)
+    {
+        auto second = MakeToken("david", "en-GB");
+        second.tokenId += L"2";
+        auto fixture = MakeCatalog({ MakeToken("david", "en-US"), second });
+
+        EXPECT_EQ(fixture.catalog->FindById("david")->language, "en-US");
+        EXPECT_EQ(fixture.catalog->FindByTokenId(second.tokenId)->language, "en-GB");
+    }
+
+    TEST(EngineCatalogTest, FindsLanguagesCaseInsensitively)
+    {
+        auto fixture = MakeCatalog({ MakeToken("david", "en-US"), MakeToken("hortense", "fr-FR") });
+
+        EXPECT_EQ(fixture.catalog->FindByLanguage("FR-fr")->id, "hortense");
+        EXPECT_EQ(fixture.catalog->FindByLanguage("en_us")->id, "david");
+    }
+
+    TEST(EngineCatalogTest, FallsBackToPrimaryLanguage)
+    {
+        auto fixture = MakeCatalog({ MakeToken("david", "en-US"), MakeToken("hortense", "fr-FR"), MakeToken("julie", "fr-FR") });
+
+        EXPECT_EQ(fixture.catalog->FindByLanguage("fr-CA")->id, "hortense");
+        EXPECT_EQ(fixture.catalog->FindByLanguage("fr")->id, "hortense");
+        EXPECT_EQ(fixture.catalog->FindByLanguage("de-DE"), nullptr);
+    }
+
+    TEST(EngineCatalogTest, GetsAllTokensOfALanguage)
+    {
+        auto fixture = MakeCatalog({
+            MakeToken("david", "en-US"),
+            MakeToken("hortense", "fr-FR"),
+            MakeToken("zira", "en-US", { "en" }),
+            MakeToken("julie", "fr-FR"),
+        });
+
+        auto french = fixture.catalog->GetByLanguage("fr-fr");
+        ASSERT_EQ(french.size(), 2u);
+        EXPECT_EQ(french[0]->id, "hortense");
+        EXPECT_EQ(french[1]->id, "julie");
+
+        auto english = fixture.catalog->GetByLanguage("en");
+        ASSERT_EQ(english.size(), 1u);
+        EXPECT_EQ(english[0]->id, "zira");
+
+        EXPECT_TRUE(fixture.catalog->GetByLanguage("de-DE").empty());
+    }
+
+    TEST(EngineCatalogTest, ListsDistinctLanguagesInEnumerationOrder)
+    {
+        auto fixture = MakeCatalog({
+            MakeToken("hortense", "fr-FR"),
+            MakeToken("david", "en-US"),
+            MakeToken("julie", "FR-fr"),
+            MakeToken("unknown", ""),
+        });
+
+        EXPECT_EQ(fixture.catalog->GetLanguages(), (std::vector<std::string>{ "fr-FR", "en-US" }));
+    }
+
+    TEST(EngineCatalogTest, RebuildsOnlyWhenSourceChanges)
+    {
+        auto fixture = MakeCatalog({ MakeToken("david", "en-US") });
+
+        fixture.catalog->FindById("david");
+        fixture.catalog->GetLanguages();
+        fixture.catalog->FindByLanguage("en-US");
+        EXPECT_EQ(fixture.source->enumerations, 1);
+        auto generation = fixture.catalog->GetGeneration();
+
+        fixture.source->SetTokens({ MakeToken("hortense", "fr-FR") });
+        EXPECT_EQ(fixture.catalog->FindById("david"), nullptr);
+        EXPECT_NE(fixture.catalog->FindById("hortense"), nullptr);
+        EXPECT_EQ(fixture.source->enumerations, 2);
+        EXPECT_EQ(fixture.catalog->GetGeneration(), generation + 1);
+
+        fixture.catalog->Invalidate();
+        fixture.catalog->GetTokens();
+        EXPECT_EQ(fixture.source->enumerations, 3);
+    }
+
+    TEST(EngineCatalogTest, IndexesThousandsOfTokens)
+    {
+        auto fixture = MakeCatalog(MakeSyntheticTokens(5000));
+
+        EXPECT_EQ(fixture.catalog->GetTokens().size(), 5000u);
+        EXPECT_EQ(fixture.catalog->FindById("voice-4321")->id, "voice-4321");
+
+        auto language = fixture.catalog->FindById("voice-4321")->language;
+        EXPECT_EQ(fixture.catalog->FindByLanguage(language)->language, language);
+    }
+
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "catalog/engine_catalog.h"
+
+namespace stts {
+
+	// Token source fed by the test, reports a change when tokens are replaced.
+	class FakeTokenSource : public EngineTokenSource {
+	public:
+		explicit FakeTokenSource(std::vector<EngineToken> tokens) : m_tokens(std::move(tokens)) {}
+
+		std::vector<EngineToken> Enumerate() override
+		{
+			enumerations++;
+			return m_tokens;
+		}
+
+		bool HasChanged() override
+		{
+			auto hasChanged = m_hasChanged;
+			m_hasChanged = false;
+			return hasChanged;
+		}
+
+		void SetTokens(std::vector<EngineToken> tokens)
+		{
+			m_tokens = std::move(tokens);
+			m_hasChanged = true;
+		}
+
+		int enumerations = 0;
+
+	private:
+		std::vector<EngineToken> m_tokens;
+		bool m_hasChanged = false;
+	};
+
+	inline EngineToken MakeToken(const std::string& id, const std::string& language, std::vector<std::string> additionalLanguages = {})
+	{
+		EngineToken token;
+		token.tokenId = L"HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Speech\\Voices\\Tokens\\" + std::wstring(id.begin(), id.end());
+		token.id = id;
+		token.name = "Voice " + id;
+		token.language = language;
+		token.additionalLanguages = std::move(additionalLanguages);
+		return token;
+	}
+
+	// Thousands of voices over a few hundred languages, like a machine with many language packs.
+	inline std::vector<EngineToken> MakeSyntheticTokens(size_t count)
+	{
+		static const char* kRegions[] = { "US", "GB", "FR", "CA", "DE", "ES", "MX", "IT", "BR", "IN" };
+
+		std::vector<EngineToken> tokens;
+		tokens.reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			std::string language;
+			language += static_cast<char>('a' + (i / 26) % 26);
+			language += static_cast<char>('a' + i % 26);
+			language += '-';
+			language += kRegions[(i / 676) % 10];
+
+			tokens.push_back(MakeToken("voice-" + std::to_string(i), language));
+		}
+		return tokens;
+	}
+
+}
@@ -0,0 +1,137 @@
+#include "codec/event_codec.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+
+namespace stts {
+namespace {
+
+    // Stand-in for the EncodableMap path, which needs the Flutter engine: a map of boxed values per
+    // event, serialized type tag by type tag like the standard message codec.
+    using BoxedValue = std::variant<bool, int64_t, std::string>;
+    using BoxedMap = std::map<BoxedValue, BoxedValue>;
+
+    void WriteSize(std::vector<uint8_t>& buffer, size_t size)
+    {
+        if (size < 254)
+        {
+            buffer.push_back(static_cast<uint8_t>(size));
+        }
+        else
+        {
+            buffer.push_back(254);
+            buffer.push_back(static_cast<uint8_t>(size));
+            buffer.push_back(static_cast<uint8_t>(size >> 8));
+        }
+    }
+
+    void WriteValue(std::vector<uint8_t>& buffer, const BoxedValue& value)
+    {
+        if (auto boolean = std::get_if<bool>(&value))
+        {
+            buffer.push_back(*boolean ? 1 : 2);
+        }
+        else if (auto integer = std::get_if<int64_t>(&value))
+        {
+            buffer.push_back(4);
+            auto offset = buffer.size();
+            buffer.resize(offset + 8);
+            std::memcpy(buffer.data() + offset, integer, 8);
+        }
+        else
+        {
+            const auto& text = std::get<std::string>(value);
+            buffer.push_back(7);
+            WriteSize(buffer, text.size());
+            buffer.insert(buffer.end(), text.begin(), text.end());
+        }
+    }
+
+    std::vector<uint8_t> WriteMap(const BoxedMap& map)
+    {
+        std::vector<uint8_t> buffer;
+        buffer.push_back(13);
+        WriteSize(buffer, map.size());
+        for (const auto& entry : map)
+        {
+            WriteValue(buffer, entry.first);
+            WriteValue(buffer, entry.second);
+        }
+        return buffer;
+    }
+
+    // Previous behavior: one map and one message per result event.
+    void BM_EventsAsMaps(benchmark::State& state)
+    {
+        std::string text(static_cast<size_t>(state.range(0)), 'a');
+        size_t bytes = 0;
+
+        for (auto _ : state)
+        {
+            BoxedMap map;
+            map.emplace(std::string("text"), text);
+            map.emplace(std::string("isFinal"), true);
+            map.emplace(std::string("sequence"), int64_t(1));
+            map.emplace(std::string("timestamp"), int64_t(123456789));
+            auto message = WriteMap(map);
+            benchmark::DoNotOptimize(message.data());
+            bytes += message.size();
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    }
+    BENCHMARK(BM_EventsAsMaps)->Arg(16)->Arg(128)->Arg(1024);
+
+    void BM_EventsEncoded(benchmark::State& state)
+    {
+        std::string text(static_cast<size_t>(state.range(0)), 'a');
+        EventEncoder encoder;
+        size_t bytes = 0;
+
+        for (auto _ : state)
+        {
+            EventRecord record;
+            record.type = EventType::result;
+            record.flags = eventFlagFinal;
+            record.sequence = 1;
+            record.timestamp = 123456789;
+            record.payload = text;
+            encoder.Write(record);
+            // One event per message, the worst case for the compact encoding.
+            auto message = encoder.GetBuffer();
+            benchmark::DoNotOptimize(message.data());
+            bytes += message.size();
+            encoder.Clear();
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    }
+    BENCHMARK(BM_EventsEncoded)->Arg(16)->Arg(128)->Arg(1024);
+
+    void BM_EventsDecoded(benchmark::State& state)
+    {
+        std::string text(static_cast<size_t>(state.range(0)), 'a');
+        EventEncoder encoder;
+        EventRecord record;
+        record.payload = text;
+        for (int i = 0; i < 64; i++) encoder.Write(record);
+        const auto& buffer = encoder.GetBuffer();
+
+        for (auto _ : state)
+        {
+            EventDecoder decoder(buffer.data(), buffer.size());
+            EventRecord decoded;
+            while (decoder.Next(decoded)) benchmark::DoNotOptimize(decoded.payload.data());
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 64);
+    }
+    BENCHMARK(BM_EventsDecoded)->Arg(16)->Arg(1024);
+
+}
+}
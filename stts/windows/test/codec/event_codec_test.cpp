@@ -0,0 +1,117 @@
+#include "codec/event_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+
+namespace stts {
+namespace {
+
+    void ExpectEqual(const EventRecord& actual, const EventRecord& expected)
+    {
+        EXPECT_EQ(actual.type, expected.type);
+        EXPECT_EQ(actual.flags, expected.flags);
+        EXPECT_EQ(actual.sequence, expected.sequence);
+        EXPECT_EQ(actual.timestamp, expected.timestamp);
+        EXPECT_EQ(actual.arg0, expected.arg0);
+        EXPECT_EQ(actual.arg1, expected.arg1);
+        EXPECT_EQ(actual.payload, expected.payload);
+    }
+
+    TEST(EventCodecTest, WritesLittleEndianHeader)
+    {
+        EventEncoder encoder;
+        EventRecord record;
+        record.type = EventType::progress;
+        record.flags = eventFlagSentence;
+        record.sequence = 0x01020304;
+        record.timestamp = 0x0102030405060708;
+        record.arg0 = 0xA0B0C0D0;
+        record.arg1 = 7;
+        record.payload = "ab";
+        encoder.Write(record);
+
+        const std::vector<uint8_t> expected = {
+            0x43, 0, 0, 0,
+            0x04, 0x03, 0x02, 0x01,
+            0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+            0xD0, 0xC0, 0xB0, 0xA0,
+            7, 0, 0, 0,
+            2, 0, 0, 0,
+            'a', 'b',
+        };
+        EXPECT_EQ(encoder.GetBuffer(), expected);
+        EXPECT_EQ(encoder.GetCount(), 1u);
+    }
+
+    TEST(EventCodecTest, RoundTripsRecords)
+    {
+        std::string longPayload(70000, 'x');
+        const EventRecord records[] = {
+            { EventType::hypothesis, 0, 1, 0, 12, 0, "unstable \xC3\xA9t\xC3\xA9" },
+            { EventType::result, eventFlagFinal | eventFlagHasTimes, 2, -1, 1500, 800, "final text" },
+            { EventType::progress, eventFlagBookmark, std::numeric_limits<uint32_t>::max(),
+                std::numeric_limits<int64_t>::min(), 0, 0, "" },
+            { EventType::progress, eventFlagSentence, 3, std::numeric_limits<int64_t>::max(),
+                std::numeric_limits<uint32_t>::max(), 1, longPayload },
+        };
+
+        EventEncoder encoder;
+        for (const auto& record : records) encoder.Write(record);
+
+        EventDecoder decoder(encoder.GetBuffer().data(), encoder.GetBuffer().size());
+        EventRecord decoded;
+        for (const auto& record : records)
+        {
+            ASSERT_TRUE(decoder.Next(decoded));
+            ExpectEqual(decoded, record);
+        }
+        EXPECT_FALSE(decoder.Next(decoded));
+        EXPECT_FALSE(decoder.IsCorrupted());
+    }
+
+    TEST(EventCodecTest, ClearKeepsCapacity)
+    {
+        EventEncoder encoder;
+        EventRecord record;
+        record.payload = "some text";
+        encoder.Write(record);
+        auto capacity = encoder.GetBuffer().capacity();
+
+        encoder.Clear();
+        EXPECT_TRUE(encoder.IsEmpty());
+        EXPECT_EQ(encoder.GetCount(), 0u);
+        EXPECT_EQ(encoder.GetBuffer().capacity(), capacity);
+    }
+
+    TEST(EventCodecTest, DetectsTruncatedRecords)
+    {
+        EventEncoder encoder;
+        EventRecord record;
+        record.payload = "payload";
+        encoder.Write(record);
+        encoder.Write(record);
+        const auto& buffer = encoder.GetBuffer();
+        auto recordSize = kEventHeaderSize + record.payload.size();
+
+        for (size_t size = recordSize + 1; size < buffer.size(); size++)
+        {
+            EventDecoder decoder(buffer.data(), size);
+            EventRecord decoded;
+            ASSERT_TRUE(decoder.Next(decoded));
+            EXPECT_FALSE(decoder.Next(decoded)) << size;
+            EXPECT_TRUE(decoder.IsCorrupted()) << size;
+        }
+    }
+
+    TEST(EventCodecTest, DecodesEmptyMessage)
+    {
+        EventDecoder decoder(nullptr, 0);
+        EventRecord decoded;
+        EXPECT_FALSE(decoder.Next(decoded));
+        EXPECT_FALSE(decoder.IsCorrupted());
+    }
+
+}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string_view>
+
+namespace stts {
+
+	// Method names of the TTS channel, in the order of the previous compare chain.
+	constexpr std::string_view kTtsMethodNames[] = {
+		"isSupported", "start", "windows.cancel", "stop", "pause", "resume", "getLanguage", "setLanguage",
+		"getLanguages", "setVoice", "getVoices", "getVoicesByLanguage", "setPitch", "setRate", "setVolume",
+		"windows.configure", "windows.setCacheBudget", "windows.getCacheStats", "windows.openStore",
+		"windows.closeStore", "windows.getStoreStats", "windows.setPipeline", "windows.getPipelineStats",
+		"windows.setProgressEvents", "windows.synthesizeToBuffer", "windows.synthesizeToFile",
+		"windows.setTracing", "windows.getTrace", "dispose",
+	};
+
+	constexpr size_t kTtsMethodCount = sizeof(kTtsMethodNames) / sizeof(kTtsMethodNames[0]);
+
+}
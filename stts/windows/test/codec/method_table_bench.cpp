@@ -0,0 +1,66 @@
+#include "codec/method_table.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <utility>
+
+#include "method_names.h"
+
+namespace stts {
+namespace {
+
+    using Handler = size_t (*)();
+
+    template <size_t I>
+    size_t GetIndex()
+    {
+        return I;
+    }
+
+    template <size_t... I>
+    constexpr auto MakeTtsTable(std::index_sequence<I...>)
+    {
+        constexpr MethodEntry<Handler> entries[] = { { kTtsMethodNames[I], &GetIndex<I> }... };
+        return MakeMethodTable(entries);
+    }
+
+    constexpr auto kTtsTable = MakeTtsTable(std::make_index_sequence<kTtsMethodCount>());
+
+    // Previous dispatch: method.compare() down the else if chain.
+    size_t FindInChain(const std::string& method)
+    {
+        for (size_t i = 0; i < kTtsMethodCount; i++)
+        {
+            if (method.compare(kTtsMethodNames[i]) == 0) return i;
+        }
+        return kTtsMethodCount;
+    }
+
+    // range(0) is the method index: first, middle and last of the chain.
+    void BM_MethodDispatchChain(benchmark::State& state)
+    {
+        std::string method(kTtsMethodNames[state.range(0)]);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(method);
+            benchmark::DoNotOptimize(FindInChain(method));
+        }
+    }
+    BENCHMARK(BM_MethodDispatchChain)->Arg(0)->Arg(kTtsMethodCount / 2)->Arg(kTtsMethodCount - 1);
+
+    void BM_MethodDispatchTable(benchmark::State& state)
+    {
+        std::string method(kTtsMethodNames[state.range(0)]);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(method);
+            benchmark::DoNotOptimize(kTtsTable.Find(method)->handler());
+        }
+    }
+    BENCHMARK(BM_MethodDispatchTable)->Arg(0)->Arg(kTtsMethodCount / 2)->Arg(kTtsMethodCount - 1);
+
+}
+}
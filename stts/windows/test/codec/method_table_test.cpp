@@ -0,0 +1,119 @@
+#include "codec/method_table.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "method_names.h"
+
+namespace stts {
+namespace {
+
+    using Handler = size_t (*)();
+
+    template <size_t I>
+    size_t GetIndex()
+    {
+        return I;
+    }
+
+    template <size_t... I>
+    constexpr auto MakeTtsTable(std::index_sequence<I...>)
+    {
+        constexpr MethodEntry<Handler> entries[] = { { kTtsMethodNames[I], &GetIndex<I> }... };
+        return MakeMethodTable(entries);
+    }
+
+    constexpr auto kTtsTable = MakeTtsTable(std::make_index_sequence<kTtsMethodCount>());
+    static_assert(kTtsTable.IsValid(), "TTS method names must get a perfect hash");
+
+    constexpr MethodEntry<Handler> kDuplicatedEntries[] = { { "start", &GetIndex<0> }, { "stop", &GetIndex<1> }, { "start", &GetIndex<2> } };
+    static_assert(!MakeMethodTable(kDuplicatedEntries).IsValid(), "Duplicated names have no perfect hash");
+
+    TEST(MethodTableTest, HashesWithFnv1a)
+    {
+        static_assert(HashName("") == 2166136261u, "FNV offset basis");
+        EXPECT_EQ(HashName("a"), 0xE40C292Cu);
+        EXPECT_EQ(HashName("foobar"), 0xBF9CF968u);
+    }
+
+    TEST(MethodTableTest, FindsEveryMethod)
+    {
+        for (size_t i = 0; i < kTtsMethodCount; i++)
+        {
+            auto entry = kTtsTable.Find(kTtsMethodNames[i]);
+            ASSERT_NE(entry, nullptr) << kTtsMethodNames[i];
+            EXPECT_EQ(entry->name, kTtsMethodNames[i]);
+            EXPECT_EQ(entry->handler(), i);
+        }
+    }
+
+    TEST(MethodTableTest, FindsNamesNotFromTheTable)
+    {
+        // Names of method calls are decoded in their own string.
+        std::string name = "windows.synthesizeToFile";
+        auto entry = kTtsTable.Find(name);
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(entry->name, "windows.synthesizeToFile");
+    }
+
+    TEST(MethodTableTest, RejectsUnknownNames)
+    {
+        for (auto name : { "", "star", "start ", "Start", "starts", "windows.", "windows.cancelAll", "disposed", "getVoice", "stt.start" })
+        {
+            EXPECT_EQ(kTtsTable.Find(name), nullptr) << name;
+        }
+
+        // Sharing a slot with a method does not match it.
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> letters('a', 'z');
+        std::uniform_int_distribution<size_t> lengths(1, 24);
+        for (int i = 0; i < 100000; i++)
+        {
+            std::string name(lengths(random), ' ');
+            for (auto& c : name) c = static_cast<char>(letters(random));
+
+            auto entry = kTtsTable.Find(name);
+            if (entry)
+            {
+                EXPECT_EQ(entry->name, name);
+            }
+        }
+    }
+
+    TEST(MethodTableTest, BuildsSingleEntryTables)
+    {
+        static constexpr MethodEntry<Handler> kEntries[] = { { "only", &GetIndex<7> } };
+        constexpr auto kTable = MakeMethodTable(kEntries);
+        static_assert(kTable.IsValid(), "One name always fits");
+
+        ASSERT_NE(kTable.Find("only"), nullptr);
+        EXPECT_EQ(kTable.Find("only")->handler(), 7u);
+        EXPECT_EQ(kTable.Find("other"), nullptr);
+    }
+
+    TEST(MethodTableTest, BuildsLargerTablesAtRuntime)
+    {
+        const size_t kCount = 64;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < kCount; i++) names.push_back("windows.method" + std::to_string(i));
+
+        MethodEntry<Handler> entries[kCount];
+        for (size_t i = 0; i < kCount; i++) entries[i] = { names[i], &GetIndex<0> };
+
+        MethodTable<Handler, kCount> table(entries);
+        ASSERT_TRUE(table.IsValid());
+        for (const auto& name : names)
+        {
+            auto entry = table.Find(name);
+            ASSERT_NE(entry, nullptr) << name;
+            EXPECT_EQ(entry->name, name);
+        }
+        EXPECT_EQ(table.Find("windows.method64"), nullptr);
+    }
+
+}
+}
@@ -0,0 +1,110 @@
+#include "codec/utf_transcoder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace stts {
+namespace {
+
+    // About 64 KB of UTF-8 of each kind: 0 ASCII, 1 French, 2 Japanese, 3 chat with emoji.
+    std::string MakeText(int64_t kind)
+    {
+        static const char* sentences[] = {
+            "The quick brown fox jumps over the lazy dog. ",
+            "L'\xC3\xA9t\xC3\xA9 \xC3\xA0 No\xC3\xABl, le gar\xC3\xA7on a mang\xC3\xA9 une cr\xC3\xAApe br\xC3\xBBl\xC3\xA9""e. ",
+            "\xE4\xBB\x8A\xE6\x97\xA5\xE3\x81\xAF\xE8\x89\xAF\xE3\x81\x84\xE5\xA4\xA9\xE6\xB0\x97\xE3\x81\xA7\xE3\x81\x99\xE3\x80\x82",
+            "See you at 8 \xF0\x9F\x98\x80 bring snacks \xF0\x9F\x8D\x95\xF0\x9F\x8D\xBA ok? ",
+        };
+
+        std::string text;
+        while (text.size() < (64 << 10)) text += sentences[kind];
+        return text;
+    }
+
+    const char* GetLabel(int64_t kind)
+    {
+        static const char* labels[] = { "ascii", "french", "japanese", "emoji" };
+        return labels[kind];
+    }
+
+    void BM_Utf8ToUtf16(benchmark::State& state)
+    {
+        auto text = MakeText(state.range(0));
+        std::u16string utf16;
+
+        for (auto _ : state)
+        {
+            UtfTranscoder::Utf8ToUtf16(text.data(), text.size(), utf16);
+            benchmark::DoNotOptimize(utf16.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+        state.SetLabel(std::string(GetLabel(state.range(0))) + " " + UtfTranscoder::GetImplementation());
+    }
+    BENCHMARK(BM_Utf8ToUtf16)->DenseRange(0, 3);
+
+    void BM_Utf16ToUtf8(benchmark::State& state)
+    {
+        auto text = MakeText(state.range(0));
+        std::u16string utf16;
+        UtfTranscoder::Utf8ToUtf16(text.data(), text.size(), utf16);
+        std::string utf8;
+
+        for (auto _ : state)
+        {
+            UtfTranscoder::Utf16ToUtf8(utf16.data(), utf16.size(), utf8);
+            benchmark::DoNotOptimize(utf8.data());
+        }
+        // Of UTF-8, comparable with the other direction.
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+        state.SetLabel(std::string(GetLabel(state.range(0))) + " " + UtfTranscoder::GetImplementation());
+    }
+    BENCHMARK(BM_Utf16ToUtf8)->DenseRange(0, 3);
+
+    // Baseline: decoding one byte at a time, with a counting pass first like MultiByteToWideChar.
+    void BM_Utf8ToUtf16Bytewise(benchmark::State& state)
+    {
+        auto text = MakeText(state.range(0));
+        std::u16string utf16;
+
+        auto decode = [&text](char16_t* out) {
+            size_t count = 0;
+            for (size_t i = 0; i < text.size();)
+            {
+                auto c = static_cast<uint8_t>(text[i]);
+                size_t length = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+                uint32_t codePoint = length == 1 ? c : length == 2 ? c & 0x1F : length == 3 ? c & 0x0F : c & 0x07;
+                for (size_t j = 1; j < length; j++) codePoint = (codePoint << 6) | (text[i + j] & 0x3F);
+                i += length;
+
+                if (codePoint >= 0x10000)
+                {
+                    if (out)
+                    {
+                        out[count] = static_cast<char16_t>(0xD800 + ((codePoint - 0x10000) >> 10));
+                        out[count + 1] = static_cast<char16_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+                    }
+                    count += 2;
+                }
+                else
+                {
+                    if (out) out[count] = static_cast<char16_t>(codePoint);
+                    count++;
+                }
+            }
+            return count;
+        };
+
+        for (auto _ : state)
+        {
+            utf16.resize(decode(nullptr));
+            decode(&utf16[0]);
+            benchmark::DoNotOptimize(utf16.data());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+        state.SetLabel(GetLabel(state.range(0)));
+    }
+    BENCHMARK(BM_Utf8ToUtf16Bytewise)->DenseRange(0, 3);
+
+}
+}
@@ -0,0 +1,346 @@
+#include "codec/utf_transcoder.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    // Code points of well formed UTF-8, or false. Straightforward decoding per the Unicode table 3-7.
+    bool DecodeReference(const std::string& utf8, std::u32string& codePoints)
+    {
+        codePoints.clear();
+        for (size_t i = 0; i < utf8.size();)
+        {
+            auto c = static_cast<uint8_t>(utf8[i]);
+            size_t length;
+            uint32_t codePoint;
+            uint32_t minimum;
+            if (c < 0x80) { length = 1; codePoint = c; minimum = 0; }
+            else if ((c & 0xE0) == 0xC0) { length = 2; codePoint = c & 0x1F; minimum = 0x80; }
+            else if ((c & 0xF0) == 0xE0) { length = 3; codePoint = c & 0x0F; minimum = 0x800; }
+            else if ((c & 0xF8) == 0xF0) { length = 4; codePoint = c & 0x07; minimum = 0x10000; }
+            else return false;
+
+            if (i + length > utf8.size()) return false;
+            for (size_t j = 1; j < length; j++)
+            {
+                auto next = static_cast<uint8_t>(utf8[i + j]);
+                if ((next & 0xC0) != 0x80) return false;
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+            if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) return false;
+
+            codePoints.push_back(codePoint);
+            i += length;
+        }
+        return true;
+    }
+
+    std::u16string ToUtf16Reference(const std::u32string& codePoints)
+    {
+        std::u16string utf16;
+        for (auto codePoint : codePoints)
+        {
+            if (codePoint >= 0x10000)
+            {
+                utf16 += static_cast<char16_t>(0xD800 + ((codePoint - 0x10000) >> 10));
+                utf16 += static_cast<char16_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+            }
+            else
+            {
+                utf16 += static_cast<char16_t>(codePoint);
+            }
+        }
+        return utf16;
+    }
+
+    std::string ToUtf8Reference(const std::u32string& codePoints)
+    {
+        std::string utf8;
+        for (auto c : codePoints)
+        {
+            if (c < 0x80)
+            {
+                utf8 += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                utf8 += static_cast<char>(0xC0 | (c >> 6));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                utf8 += static_cast<char>(0xE0 | (c >> 12));
+                utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                utf8 += static_cast<char>(0xF0 | (c >> 18));
+                utf8 += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                utf8 += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                utf8 += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return utf8;
+    }
+
+    // Checks the transcoder against the reference, including the length bound on invalid input.
+    void ExpectUtf8Conversion(const std::string& utf8)
+    {
+        std::u32string codePoints;
+        auto isValid = DecodeReference(utf8, codePoints);
+
+        auto bound = UtfTranscoder::GetUtf16Length(utf8.data(), utf8.size());
+        std::vector<char16_t> buffer(bound + 1, u'\xFFFF');
+        auto length = UtfTranscoder::Utf8ToUtf16(utf8.data(), utf8.size(), buffer.data());
+        EXPECT_EQ(buffer[bound], u'\xFFFF') << "written past the length";
+
+        if (!isValid)
+        {
+            EXPECT_EQ(length, kInvalidUtf);
+            return;
+        }
+
+        auto expected = ToUtf16Reference(codePoints);
+        EXPECT_EQ(bound, expected.size());
+        ASSERT_EQ(length, expected.size());
+        EXPECT_EQ(std::u16string(buffer.data(), length), expected);
+    }
+
+    // Code points of well formed UTF-16, or false.
+    bool DecodeReference(const std::u16string& utf16, std::u32string& codePoints)
+    {
+        codePoints.clear();
+        for (size_t i = 0; i < utf16.size(); i++)
+        {
+            uint32_t c = utf16[i];
+            if (c >= 0xDC00 && c <= 0xDFFF) return false;
+            if (c >= 0xD800 && c <= 0xDBFF)
+            {
+                if (i + 1 == utf16.size() || utf16[i + 1] < 0xDC00 || utf16[i + 1] > 0xDFFF) return false;
+                c = 0x10000 + ((c - 0xD800) << 10) + (utf16[++i] - 0xDC00);
+            }
+            codePoints.push_back(c);
+        }
+        return true;
+    }
+
+    void ExpectUtf16Conversion(const std::u16string& utf16)
+    {
+        std::u32string codePoints;
+        auto isValid = DecodeReference(utf16, codePoints);
+
+        auto bound = UtfTranscoder::GetUtf8Length(utf16.data(), utf16.size());
+        std::vector<char> buffer(bound + 1, '\x7F');
+        auto length = UtfTranscoder::Utf16ToUtf8(utf16.data(), utf16.size(), buffer.data());
+        EXPECT_EQ(buffer[bound], '\x7F') << "written past the length";
+
+        if (!isValid)
+        {
+            EXPECT_EQ(length, kInvalidUtf);
+            return;
+        }
+
+        auto expected = ToUtf8Reference(codePoints);
+        EXPECT_EQ(bound, expected.size());
+        ASSERT_EQ(length, expected.size());
+        EXPECT_EQ(std::string(buffer.data(), length), expected);
+    }
+
+    TEST(UtfTranscoderTest, SelectsImplementation)
+    {
+        std::string implementation = UtfTranscoder::GetImplementation();
+        EXPECT_TRUE(implementation == "avx2" || implementation == "sse2" || implementation == "scalar") << implementation;
+    }
+
+    TEST(UtfTranscoderTest, ConvertsEmptyInput)
+    {
+        std::u16string utf16 = u"previous";
+        EXPECT_TRUE(UtfTranscoder::Utf8ToUtf16("", 0, utf16));
+        EXPECT_TRUE(utf16.empty());
+
+        std::string utf8 = "previous";
+        EXPECT_TRUE(UtfTranscoder::Utf16ToUtf8(u"", 0, utf8));
+        EXPECT_TRUE(utf8.empty());
+    }
+
+    TEST(UtfTranscoderTest, ConvertsIntoReusedStrings)
+    {
+        std::string text = "Caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80 and some ASCII after the characters";
+        std::u16string utf16;
+        utf16.reserve(256);
+        auto data = utf16.data();
+
+        ASSERT_TRUE(UtfTranscoder::Utf8ToUtf16(text.data(), text.size(), utf16));
+        EXPECT_EQ(utf16, u"Café € 😀 and some ASCII after the characters");
+        EXPECT_EQ(utf16.data(), data);
+
+        std::string utf8;
+        ASSERT_TRUE(UtfTranscoder::Utf16ToUtf8(utf16.data(), utf16.size(), utf8));
+        EXPECT_EQ(utf8, text);
+    }
+
+    TEST(UtfTranscoderTest, ClearsOutputOnFailure)
+    {
+        std::u16string utf16 = u"previous";
+        EXPECT_FALSE(UtfTranscoder::Utf8ToUtf16("a\xC3", 2, utf16));
+        EXPECT_TRUE(utf16.empty());
+
+        std::string utf8 = "previous";
+        const char16_t lone[] = { u'a', 0xD800 };
+        EXPECT_FALSE(UtfTranscoder::Utf16ToUtf8(lone, 2, utf8));
+        EXPECT_TRUE(utf8.empty());
+    }
+
+    TEST(UtfTranscoderTest, RoundTripsEveryCodePoint)
+    {
+        std::u32string codePoints;
+        for (uint32_t c = 0; c <= 0x10FFFF; c++)
+        {
+            if (c < 0xD800 || c > 0xDFFF) codePoints.push_back(c);
+        }
+
+        // Mixed widths keep the vector paths falling back all along.
+        auto utf8 = ToUtf8Reference(codePoints);
+        std::u16string utf16;
+        ASSERT_TRUE(UtfTranscoder::Utf8ToUtf16(utf8.data(), utf8.size(), utf16));
+        EXPECT_EQ(utf16, ToUtf16Reference(codePoints));
+
+        std::string back;
+        ASSERT_TRUE(UtfTranscoder::Utf16ToUtf8(utf16.data(), utf16.size(), back));
+        EXPECT_EQ(back, utf8);
+    }
+
+    TEST(UtfTranscoderTest, ValidatesEveryUtf8SequenceUpTo3Bytes)
+    {
+        std::string utf8(3, '\0');
+        for (uint32_t value = 0; value < (1u << 24); value++)
+        {
+            utf8[0] = static_cast<char>(value >> 16);
+            utf8[1] = static_cast<char>(value >> 8);
+            utf8[2] = static_cast<char>(value);
+
+            std::u32string codePoints;
+            auto isValid = DecodeReference(utf8, codePoints);
+
+            char16_t buffer[4];
+            auto length = UtfTranscoder::Utf8ToUtf16(utf8.data(), utf8.size(), buffer);
+            ASSERT_EQ(length != kInvalidUtf, isValid) << std::hex << value;
+            if (isValid)
+            {
+                ASSERT_EQ(std::u16string(buffer, length), ToUtf16Reference(codePoints)) << std::hex << value;
+            }
+        }
+    }
+
+    TEST(UtfTranscoderTest, ValidatesUtf8Sequences)
+    {
+        // Every lead and second byte, then boundary and broken continuations.
+        const uint8_t tails[] = { 0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xFF };
+        for (uint32_t lead = 0; lead < 0x100; lead++)
+        {
+            for (uint32_t second = 0; second < 0x100; second++)
+            {
+                for (auto third : tails)
+                {
+                    for (auto fourth : tails)
+                    {
+                        std::string utf8 = { static_cast<char>(lead), static_cast<char>(second), static_cast<char>(third), static_cast<char>(fourth) };
+                        ExpectUtf8Conversion(utf8);
+                        // Truncated.
+                        ExpectUtf8Conversion(utf8.substr(0, 2));
+                        ExpectUtf8Conversion(utf8.substr(0, 3));
+                    }
+                }
+            }
+            if (HasFailure()) return;
+        }
+    }
+
+    TEST(UtfTranscoderTest, ValidatesEveryUtf16Unit)
+    {
+        // Alone, before each kind of unit and after a high surrogate.
+        const char16_t neighbours[] = { u'a', 0x00E9, 0x20AC, 0xD83D, 0xDE00, 0xDBFF, 0xDC00, 0xFFFF };
+        for (uint32_t unit = 0; unit < 0x10000; unit++)
+        {
+            auto c = static_cast<char16_t>(unit);
+            ExpectUtf16Conversion(std::u16string(1, c));
+            for (auto neighbour : neighbours)
+            {
+                ExpectUtf16Conversion(std::u16string({ c, neighbour }));
+                ExpectUtf16Conversion(std::u16string({ neighbour, c }));
+            }
+            if (HasFailure()) return;
+        }
+    }
+
+    TEST(UtfTranscoderTest, ConvertsAtEveryVectorPosition)
+    {
+        // Before, across and after each 16 and 32 unit block, also breaking the input.
+        const std::string specials[] = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xC3", "\xF0\x9F\x98", "\xED\xA0\x80" };
+        for (const auto& special : specials)
+        {
+            for (size_t position = 0; position <= 96; position++)
+            {
+                std::string utf8(96, 'x');
+                utf8.insert(position, special);
+                ExpectUtf8Conversion(utf8);
+
+                std::u32string codePoints;
+                if (DecodeReference(utf8, codePoints)) ExpectUtf16Conversion(ToUtf16Reference(codePoints));
+            }
+        }
+
+        const char16_t units[] = { 0x00E9, 0x20AC, 0xD83D, 0xDE00, 0x0080, 0xFFFF };
+        for (auto unit : units)
+        {
+            for (size_t position = 0; position <= 96; position++)
+            {
+                std::u16string utf16(96, u'x');
+                utf16.insert(position, 1, unit);
+                ExpectUtf16Conversion(utf16);
+            }
+        }
+    }
+
+    TEST(UtfTranscoderTest, MatchesReferenceOnRandomText)
+    {
+        // Long ASCII runs with sparse characters of each width and occasional invalid bytes.
+        std::mt19937 random(7);
+        const std::string pieces[] = { "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF", "\xC3", "\xBF", "\xF4\x90\x80\x80" };
+        std::uniform_int_distribution<size_t> pick(0, sizeof(pieces) / sizeof(pieces[0]) - 1);
+
+        for (int round = 0; round < 3000; round++)
+        {
+            std::string utf8;
+            auto length = random() % 300;
+            auto density = 1 + random() % 40;
+            // Half of the rounds stay valid.
+            auto isValid = round % 2 == 0;
+            for (size_t i = 0; i < length; i++)
+            {
+                if (random() % density != 0)
+                {
+                    utf8 += static_cast<char>('a' + random() % 26);
+                    continue;
+                }
+
+                auto piece = pick(random);
+                if (isValid && piece >= 4) piece = 0;
+                utf8 += pieces[piece];
+            }
+
+            ExpectUtf8Conversion(utf8);
+            std::u32string codePoints;
+            if (DecodeReference(utf8, codePoints)) ExpectUtf16Conversion(ToUtf16Reference(codePoints));
+            if (HasFailure()) FAIL() << "round " << round;
+        }
+    }
+
+}
+}
@@ -0,0 +1,39 @@
+#include "locale/lcid_table.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace stts {
+namespace {
+
+    void BM_LcidToLocaleName(benchmark::State& state)
+    {
+        uint32_t lcids[] = { 0x0409, 0x040C, 0x0809, 0x0C0C, 0x0004, 0x580A, 0x0028 };
+        size_t i = 0;
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(LcidToLocaleName(lcids[i++ % 7]));
+        }
+    }
+    BENCHMARK(BM_LcidToLocaleName);
+
+    // Language attribute of a voice declaring a main and a neutral language.
+    void BM_ForEachLcidLocale(benchmark::State& state)
+    {
+        std::wstring attribute = L"409;9";
+
+        for (auto _ : state)
+        {
+            size_t length = 0;
+            ForEachLcidLocale(std::wstring_view(attribute), [&length](uint32_t, std::string_view name) {
+                length += name.size();
+            });
+            benchmark::DoNotOptimize(length);
+        }
+    }
+    BENCHMARK(BM_ForEachLcidLocale);
+
+}
+}
@@ -0,0 +1,117 @@
+#include "locale/lcid_table.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "windows_lcids.h"
+
+namespace stts {
+namespace {
+
+    // Sort-specific names (e.g. es-ES_tradnl) are mapped to their plain locale.
+    std::map<uint32_t, std::string> GetExpectedLocales()
+    {
+        std::map<uint32_t, std::string> locales;
+        for (const auto& windowsLcid : kWindowsLcids)
+        {
+            std::string name(windowsLcid.name);
+            locales[windowsLcid.lcid] = name.substr(0, name.find('_'));
+        }
+        return locales;
+    }
+
+    TEST(LcidTableTest, MatchesWindowsForEveryLcid)
+    {
+        auto expected = GetExpectedLocales();
+
+        for (uint32_t lcid = 0; lcid <= 0x1FFFF; lcid++)
+        {
+            auto it = expected.find(lcid);
+            auto name = LcidToLocaleName(lcid);
+
+            if (it == expected.end())
+            {
+                EXPECT_TRUE(name.empty()) << std::hex << lcid;
+            }
+            else
+            {
+                EXPECT_EQ(name, it->second) << std::hex << lcid;
+            }
+        }
+
+        EXPECT_TRUE(LcidToLocaleName(0xFFFFFFFF).empty());
+    }
+
+    TEST(LcidTableTest, IsUsableAtCompileTime)
+    {
+        static_assert(LcidToLocaleName(0x0409) == "en-US", "");
+        static_assert(LcidToLocaleName(0x7C04) == "zh-Hant", "");
+        static_assert(LcidToLocaleName(0x0028).empty(), "");
+
+        constexpr auto parsed = []() {
+            uint32_t lcid = 0;
+            return ParseLcid(std::string_view("0x40C"), lcid) ? lcid : 0;
+        }();
+        static_assert(parsed == 0x040C, "");
+    }
+
+    template <typename CharT>
+    std::basic_string<CharT> Widen(const std::string& value)
+    {
+        return std::basic_string<CharT>(value.begin(), value.end());
+    }
+
+    template <typename CharT>
+    void ExpectParsesEveryFormat()
+    {
+        char buffer[16];
+        const char* formats[] = { "%X", "%x", "%04X", "0x%X", "0X%x", " %X ", "%08X" };
+
+        for (uint32_t lcid = 0; lcid <= 0xFFFF; lcid++)
+        {
+            for (auto format : formats)
+            {
+                std::snprintf(buffer, sizeof(buffer), format, lcid);
+                auto value = Widen<CharT>(buffer);
+
+                uint32_t parsed = 0xFFFFFFFF;
+                ASSERT_TRUE(ParseLcid(std::basic_string_view<CharT>(value), parsed)) << buffer;
+                ASSERT_EQ(parsed, lcid) << buffer;
+            }
+        }
+    }
+
+    TEST(LcidTableTest, ParsesEveryLcidInEveryFormat)
+    {
+        ExpectParsesEveryFormat<char>();
+        ExpectParsesEveryFormat<wchar_t>();
+    }
+
+    TEST(LcidTableTest, RejectsInvalidLcids)
+    {
+        for (auto value : { "", " ", "0x", "40G", "-409", "4 09", "123456789", "0x123456789", "409;" })
+        {
+            uint32_t lcid = 0;
+            EXPECT_FALSE(ParseLcid(std::string_view(value), lcid)) << value;
+        }
+    }
+
+    TEST(LcidTableTest, EnumeratesMultiLcidValuesInOrder)
+    {
+        std::vector<std::pair<uint32_t, std::string>> locales;
+        auto count = ForEachLcidLocale(std::wstring_view(L"409;9; 809 ;zz;;FFFF"), [&locales](uint32_t lcid, std::string_view name) {
+            locales.emplace_back(lcid, std::string(name));
+        });
+
+        EXPECT_EQ(count, 4u);
+        EXPECT_EQ(locales, (std::vector<std::pair<uint32_t, std::string>>{
+            { 0x0409, "en-US" }, { 0x0009, "en" }, { 0x0809, "en-GB" }, { 0xFFFF, "" } }));
+    }
+
+}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "worker/engine_worker.h"
+#include "fake_recognizer.h"
+
+namespace stts {
+
+	// Stand-in for the in-process recognizer of TranscriptionScheduler: finds the voiced segments
+	// over a number of passes on the audio, so each file costs CPU time in proportion to its duration
+	// like an engine decoding at a fixed real time factor.
+	class FakeBatchRecognizer {
+	public:
+		using Status = int;
+		using Phrase = FakePhrase;
+		static constexpr int succeeded = 0;
+		static constexpr int cancelled = 1;
+		static constexpr int failed = 2;
+
+		static inline std::atomic<int> decodingPasses{ 1 };
+		static inline std::atomic<int> instanceCount{ 0 };
+
+		FakeBatchRecognizer() { instanceCount++; }
+		~FakeBatchRecognizer() { instanceCount--; }
+
+		std::vector<FakePhrase> Transcribe(std::shared_ptr<PcmSource> source, const std::wstring& recognizerTokenId,
+			const CancellationToken& cancellationToken, std::function<void(double progress)> onProgress)
+		{
+			if (recognizerTokenId == L"missing") throw failed;
+
+			std::vector<FakePhrase> phrases;
+			int passes = decodingPasses;
+			for (int pass = 0; pass < passes; pass++)
+			{
+				if (cancellationToken.ShouldStop()) throw cancelled;
+
+				source->Seek(0);
+				phrases = RecognizeVoice(*source);
+				if (onProgress) onProgress(static_cast<double>(pass + 1) / passes);
+			}
+
+			return phrases;
+		}
+	};
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include "audio/audio_level_meter.h"
+#include "audio/pcm_source.h"
+
+namespace stts {
+
+	struct FakePhrase {
+		std::chrono::milliseconds offset{ 0 };
+		std::chrono::milliseconds duration{ 0 };
+	};
+
+	// Stand-in for the in-process recognizer on 16-bit PCM: pulls the source frame by frame, as the
+	// engine reads the audio stream, and reports each voiced segment as a phrase.
+	inline std::vector<FakePhrase> RecognizeVoice(PcmSource& source)
+	{
+		const auto& format = source.GetFormat();
+		AudioLevelMeter meter(format.sampleRate, format.channels);
+
+		std::vector<FakePhrase> phrases;
+		std::vector<int16_t> frame(format.sampleRate * format.channels / 50);
+		bool inPhrase = false;
+		uint64_t phraseStart = 0;
+
+		while (true)
+		{
+			auto position = source.GetPosition();
+			auto read = source.Read(frame.data(), frame.size() * sizeof(int16_t));
+			auto ended = read < frame.size() * sizeof(int16_t);
+
+			meter.Process(frame.data(), read / sizeof(int16_t));
+			AudioLevel level;
+			bool voice = meter.TakeLevel(level) && level.voice;
+
+			if (voice && !inPhrase)
+			{
+				inPhrase = true;
+				phraseStart = position;
+			}
+			else if ((!voice || ended) && inPhrase)
+			{
+				inPhrase = false;
+				auto end = source.GetPosition();
+				phrases.push_back({ source.GetTime(phraseStart), source.GetTime(end) - source.GetTime(phraseStart) });
+			}
+
+			if (ended) return phrases;
+		}
+	}
+
+}
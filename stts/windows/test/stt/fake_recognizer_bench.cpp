@@ -0,0 +1,30 @@
+#include "audio/pcm_source.h"
+
+#include <benchmark/benchmark.h>
+
+#include "../audio/pcm_fixtures.h"
+#include "../audio/wav_fixtures.h"
+#include "fake_recognizer.h"
+
+namespace stts {
+namespace {
+
+    // Parsing and feeding recorded audio, with the stand-in engine, relative to its duration.
+    void BM_FeedWavToRecognizer(benchmark::State& state)
+    {
+        double seconds = static_cast<double>(state.range(0));
+        auto wav = std::make_shared<const std::vector<uint8_t>>(MakeWav(MakeSpeechPcm(16000, seconds)));
+
+        for (auto _ : state)
+        {
+            std::unique_ptr<PcmSource> source;
+            PcmSource::FromWav(*wav, source);
+            benchmark::DoNotOptimize(RecognizeVoice(*source));
+        }
+
+        state.counters["realtime"] = benchmark::Counter(seconds * static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_FeedWavToRecognizer)->Arg(10)->Arg(60);
+
+}
+}
@@ -0,0 +1,76 @@
+#include "stt/hypothesis_coalescer.h"
+
+#include <benchmark/benchmark.h>
+
+#include "hypothesis_sequences.h"
+
+namespace stts {
+namespace {
+
+    using Clock = HypothesisCoalescer::Clock;
+
+    // Previous behavior: every hypothesis is sent whole.
+    void BM_HypothesesWhole(benchmark::State& state)
+    {
+        auto sequence = MakeHypothesisSequence(static_cast<size_t>(state.range(0)));
+        size_t bytes = 0;
+        size_t events = 0;
+
+        for (auto _ : state)
+        {
+            bytes = 0;
+            events = 0;
+            for (const auto& hypothesis : sequence)
+            {
+                std::wstring text(hypothesis.text);
+                benchmark::DoNotOptimize(text.data());
+                // ASCII text, one byte per character once in UTF-8.
+                bytes += text.size();
+                events++;
+            }
+        }
+
+        auto duration = std::chrono::duration<double>(sequence.back().time).count();
+        state.counters["bytes"] = static_cast<double>(bytes);
+        state.counters["events/s"] = events / duration;
+    }
+    BENCHMARK(BM_HypothesesWhole)->Arg(20)->Arg(100)->Arg(500);
+
+    void BM_HypothesesCoalesced(benchmark::State& state)
+    {
+        auto sequence = MakeHypothesisSequence(static_cast<size_t>(state.range(0)));
+        std::chrono::milliseconds interval(state.range(1));
+        size_t bytes = 0;
+        size_t events = 0;
+
+        for (auto _ : state)
+        {
+            HypothesisCoalescer coalescer(interval);
+            HypothesisDelta delta;
+            bytes = 0;
+            events = 0;
+
+            for (const auto& hypothesis : sequence)
+            {
+                if (coalescer.Push(hypothesis.text, Clock::time_point(hypothesis.time), delta))
+                {
+                    // Sequence and stable length.
+                    bytes += 16 + delta.unstableSuffix.size();
+                    events++;
+                }
+            }
+            if (coalescer.Flush(delta))
+            {
+                bytes += 16 + delta.unstableSuffix.size();
+                events++;
+            }
+        }
+
+        auto duration = std::chrono::duration<double>(sequence.back().time).count();
+        state.counters["bytes"] = static_cast<double>(bytes);
+        state.counters["events/s"] = events / duration;
+    }
+    BENCHMARK(BM_HypothesesCoalesced)->ArgsProduct({ { 20, 100, 500 }, { 0, 100 } });
+
+}
+}
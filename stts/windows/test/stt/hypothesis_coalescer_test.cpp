@@ -0,0 +1,217 @@
+#include "stt/hypothesis_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include "hypothesis_sequences.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+    using Clock = HypothesisCoalescer::Clock;
+
+    // Rebuilds hypotheses like the Dart decoder: a delta following a missing one is skipped
+    // unless it carries the whole text.
+    struct HypothesisReceiver {
+        std::wstring text;
+        uint64_t sequence = 0;
+
+        // Returns false if the delta was skipped.
+        bool Receive(const HypothesisDelta& delta)
+        {
+            if (delta.sequence != sequence + 1 && delta.stableLength > 0) return false;
+
+            text = ApplyDelta(text, delta);
+            sequence = delta.sequence;
+            return true;
+        }
+    };
+
+    TEST(HypothesisCoalescerTest, EmitsFirstHypothesisWhole)
+    {
+        HypothesisCoalescer coalescer(100ms);
+        HypothesisDelta delta;
+
+        ASSERT_TRUE(coalescer.Push(L"hello", Clock::time_point(), delta));
+        EXPECT_EQ(delta.sequence, 1u);
+        EXPECT_EQ(delta.stableLength, 0u);
+        EXPECT_EQ(delta.unstableSuffix, L"hello");
+        EXPECT_FALSE(coalescer.HasPending());
+    }
+
+    TEST(HypothesisCoalescerTest, HoldsHypothesesWithinInterval)
+    {
+        HypothesisCoalescer coalescer(100ms);
+        HypothesisDelta delta;
+        Clock::time_point start;
+
+        coalescer.Push(L"hello", start, delta);
+        EXPECT_FALSE(coalescer.Push(L"hello wo", start + 40ms, delta));
+        EXPECT_FALSE(coalescer.Push(L"hello world", start + 80ms, delta));
+        EXPECT_TRUE(coalescer.HasPending());
+        EXPECT_EQ(coalescer.GetNextEmitTime(), start + 100ms);
+
+        ASSERT_TRUE(coalescer.Push(L"hello world!", start + 100ms, delta));
+        EXPECT_EQ(delta.sequence, 2u);
+        EXPECT_EQ(delta.stableLength, 5u);
+        EXPECT_EQ(delta.unstableSuffix, L" world!");
+    }
+
+    TEST(HypothesisCoalescerTest, FlushEmitsPendingHypothesis)
+    {
+        HypothesisCoalescer coalescer(100ms);
+        HypothesisDelta delta;
+
+        coalescer.Push(L"hello", Clock::time_point(), delta);
+        EXPECT_FALSE(coalescer.Push(L"hello there", Clock::time_point() + 10ms, delta));
+
+        ASSERT_TRUE(coalescer.Flush(delta));
+        EXPECT_EQ(delta.stableLength, 5u);
+        EXPECT_EQ(delta.unstableSuffix, L" there");
+        EXPECT_FALSE(coalescer.Flush(delta));
+    }
+
+    TEST(HypothesisCoalescerTest, StablePrefixCoversHeldHypotheses)
+    {
+        HypothesisCoalescer coalescer(100ms);
+        HypothesisDelta delta;
+        Clock::time_point start;
+
+        coalescer.Push(L"I scream", start, delta);
+        // Rewritten then restored while held: the rewritten part is not stable.
+        coalescer.Push(L"ice cream", start + 30ms, delta);
+        ASSERT_TRUE(coalescer.Push(L"I scream loud", start + 100ms, delta));
+
+        EXPECT_EQ(delta.stableLength, 0u);
+        EXPECT_EQ(delta.unstableSuffix, L"I scream loud");
+    }
+
+    TEST(HypothesisCoalescerTest, NeverSplitsSurrogatePairs)
+    {
+        HypothesisCoalescer coalescer(0ms);
+        HypothesisDelta delta;
+
+        std::wstring previous = L"a";
+        previous += static_cast<wchar_t>(0xD83D);
+        previous += static_cast<wchar_t>(0xDE00);
+        std::wstring current = L"a";
+        current += static_cast<wchar_t>(0xD83D);
+        current += static_cast<wchar_t>(0xDE01);
+
+        coalescer.Push(previous, Clock::time_point(), delta);
+        ASSERT_TRUE(coalescer.Push(current, Clock::time_point() + 1ms, delta));
+        EXPECT_EQ(delta.stableLength, 1u);
+        EXPECT_EQ(ApplyDelta(previous, delta), current);
+    }
+
+    TEST(HypothesisCoalescerTest, ResetSendsWholeText)
+    {
+        HypothesisCoalescer coalescer(0ms);
+        HypothesisDelta delta;
+
+        coalescer.Push(L"first utterance", Clock::time_point(), delta);
+        coalescer.Reset();
+        ASSERT_TRUE(coalescer.Push(L"first try", Clock::time_point() + 1ms, delta));
+
+        EXPECT_EQ(delta.sequence, 2u);
+        EXPECT_EQ(delta.stableLength, 0u);
+        EXPECT_EQ(delta.unstableSuffix, L"first try");
+    }
+
+    TEST(HypothesisCoalescerTest, DeltasReconstructEveryEmittedHypothesis)
+    {
+        for (auto interval : { 0ms, 50ms, 100ms, 250ms })
+        {
+            HypothesisCoalescer coalescer(interval);
+            HypothesisDelta delta;
+            std::wstring received;
+            uint64_t sequence = 0;
+
+            auto sequenceOfHypotheses = MakeHypothesisSequence(200, static_cast<uint32_t>(interval.count()) + 1);
+            for (const auto& hypothesis : sequenceOfHypotheses)
+            {
+                if (!coalescer.Push(hypothesis.text, Clock::time_point(hypothesis.time), delta)) continue;
+
+                EXPECT_EQ(delta.sequence, ++sequence);
+                received = ApplyDelta(received, delta);
+                ASSERT_EQ(received, hypothesis.text);
+            }
+
+            if (coalescer.Flush(delta)) received = ApplyDelta(received, delta);
+            EXPECT_EQ(received, sequenceOfHypotheses.back().text);
+        }
+    }
+
+    TEST(HypothesisCoalescerTest, ResendsWholeTextAfterDrop)
+    {
+        HypothesisCoalescer coalescer(0ms);
+        HypothesisDelta delta;
+
+        coalescer.Push(L"hello", Clock::time_point(), delta);
+        coalescer.Push(L"hello world", Clock::time_point() + 1ms, delta);
+        coalescer.ResendWholeText();
+
+        ASSERT_TRUE(coalescer.Push(L"hello world!", Clock::time_point() + 2ms, delta));
+        EXPECT_EQ(delta.sequence, 3u);
+        EXPECT_EQ(delta.stableLength, 0u);
+        EXPECT_EQ(delta.unstableSuffix, L"hello world!");
+
+        // Back to deltas.
+        ASSERT_TRUE(coalescer.Push(L"hello world!!", Clock::time_point() + 3ms, delta));
+        EXPECT_EQ(delta.stableLength, 12u);
+    }
+
+    // A delta dropped on its way to Dart must not corrupt the text rebuilt from the next ones.
+    TEST(HypothesisCoalescerTest, TextRecoversAfterDroppedDelta)
+    {
+        HypothesisCoalescer coalescer(0ms);
+        HypothesisDelta delta;
+        HypothesisReceiver receiver;
+        size_t dropCount = 0;
+
+        auto sequenceOfHypotheses = MakeHypothesisSequence(200);
+        for (size_t i = 0; i < sequenceOfHypotheses.size(); i++)
+        {
+            const auto& hypothesis = sequenceOfHypotheses[i];
+            ASSERT_TRUE(coalescer.Push(hypothesis.text, Clock::time_point(hypothesis.time), delta));
+
+            if (i % 7 == 3)
+            {
+                coalescer.ResendWholeText();
+                dropCount++;
+                continue;
+            }
+
+            ASSERT_TRUE(receiver.Receive(delta));
+            ASSERT_EQ(receiver.text, hypothesis.text);
+        }
+
+        EXPECT_GT(dropCount, 0u);
+        EXPECT_EQ(receiver.text, sequenceOfHypotheses.back().text);
+    }
+
+    // Without the whole text, the receiver skips deltas rather than splicing them onto stale text.
+    TEST(HypothesisCoalescerTest, ReceiverWaitsForWholeText)
+    {
+        HypothesisCoalescer coalescer(0ms);
+        HypothesisDelta delta;
+
+        coalescer.Push(L"hello", Clock::time_point(), delta);
+        coalescer.Push(L"hello world", Clock::time_point() + 1ms, delta);
+
+        // Listening started after the first deltas.
+        HypothesisReceiver receiver;
+        coalescer.Push(L"hello world again", Clock::time_point() + 2ms, delta);
+        EXPECT_FALSE(receiver.Receive(delta));
+        coalescer.Push(L"hello world again and", Clock::time_point() + 3ms, delta);
+        EXPECT_FALSE(receiver.Receive(delta));
+        EXPECT_TRUE(receiver.text.empty());
+
+        coalescer.Reset();
+        coalescer.Push(L"next", Clock::time_point() + 4ms, delta);
+        ASSERT_TRUE(receiver.Receive(delta));
+        EXPECT_EQ(receiver.text, L"next");
+    }
+
+}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stts {
+
+	struct TimedHypothesis {
+		std::chrono::milliseconds time;
+		std::wstring text;
+	};
+
+	// Hypotheses of a dictated utterance as SAPI reports them: a growing phrase where the last word
+	// is often revised, every 30 to 60 ms.
+	inline std::vector<TimedHypothesis> MakeHypothesisSequence(size_t wordCount, uint32_t seed = 1)
+	{
+		static const wchar_t* words[] = {
+			L"the", L"quick", L"brown", L"fox", L"jumps", L"over", L"lazy", L"dog", L"recognition",
+			L"speech", L"dictation", L"window", L"events", L"delta", L"encoding", L"prefix",
+		};
+		const size_t wordsCount = sizeof(words) / sizeof(words[0]);
+
+		auto next = [&seed]() {
+			seed = seed * 1664525u + 1013904223u;
+			return seed >> 8;
+		};
+
+		std::vector<TimedHypothesis> sequence;
+		std::wstring settled;
+		std::chrono::milliseconds time(0);
+
+		for (size_t i = 0; i < wordCount; i++)
+		{
+			auto separator = settled.empty() ? L"" : L" ";
+
+			// Guesses for the word being spoken before the right one.
+			auto guesses = next() % 3;
+			for (uint32_t guess = 0; guess <= guesses; guess++)
+			{
+				time += std::chrono::milliseconds(30 + next() % 31);
+				sequence.push_back({ time, settled + separator + words[next() % wordsCount] });
+			}
+
+			settled = sequence.back().text;
+		}
+
+		return sequence;
+	}
+
+	// Applies a delta to the previously reconstructed text.
+	template<typename Delta>
+	std::wstring ApplyDelta(const std::wstring& previous, const Delta& delta)
+	{
+		return previous.substr(0, delta.stableLength) + delta.unstableSuffix;
+	}
+
+}
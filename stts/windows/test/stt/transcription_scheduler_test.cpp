@@ -0,0 +1,171 @@
+#include "stt/transcription_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
+#include "../audio/pcm_fixtures.h"
+#include "../audio/wav_fixtures.h"
+#include "fake_batch_recognizer.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    struct Completion {
+        int status;
+        size_t phraseCount;
+    };
+
+    // Collects the completions reported by the workers.
+    class CompletionLog {
+    public:
+        void Add(uint64_t jobId, int status, const std::vector<FakePhrase>& phrases)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completions[jobId] = { status, phrases.size() };
+            m_condition.notify_all();
+        }
+
+        std::map<uint64_t, Completion> WaitFor(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, 10s, [this, count] { return m_completions.size() >= count; });
+            return m_completions;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::map<uint64_t, Completion> m_completions;
+    };
+
+    class FakeScheduler : public TranscriptionScheduler<FakeBatchRecognizer> {
+    public:
+        FakeScheduler(size_t workerCount, CompletionLog& log, std::atomic<int>* progressCount = nullptr) :
+            TranscriptionScheduler(workerCount,
+                [progressCount](uint64_t, double) { if (progressCount) (*progressCount)++; },
+                [&log](uint64_t jobId, int status, const std::vector<FakePhrase>& phrases) { log.Add(jobId, status, phrases); })
+        {
+            Start();
+        }
+
+        ~FakeScheduler() override { Stop(); }
+    };
+
+    FakeScheduler::SourceLoader LoadSpeech(double seconds)
+    {
+        auto wav = std::make_shared<const std::vector<uint8_t>>(MakeWav(MakeSpeechPcm(16000, seconds)));
+        return [wav](std::unique_ptr<PcmSource>& source) {
+            return PcmSource::FromWav(*wav, source) == WavError::none ? FakeBatchRecognizer::succeeded : FakeBatchRecognizer::failed;
+        };
+    }
+
+    class TranscriptionSchedulerTest : public testing::Test {
+    protected:
+        void SetUp() override { FakeBatchRecognizer::decodingPasses = 1; }
+    };
+
+    TEST_F(TranscriptionSchedulerTest, CompletesEveryJobWithItsPhrases)
+    {
+        CompletionLog log;
+        std::atomic<int> progressCount{ 0 };
+        {
+            FakeScheduler scheduler(3, log, &progressCount);
+
+            std::vector<uint64_t> ids;
+            for (int i = 0; i < 8; i++) ids.push_back(scheduler.Queue(LoadSpeech(2), L""));
+
+            auto completions = log.WaitFor(ids.size());
+            ASSERT_EQ(completions.size(), ids.size());
+            for (auto id : ids)
+            {
+                EXPECT_EQ(completions[id].status, FakeBatchRecognizer::succeeded);
+                EXPECT_GT(completions[id].phraseCount, 0u);
+            }
+
+            EXPECT_EQ(FakeBatchRecognizer::instanceCount, 3);
+            EXPECT_EQ(scheduler.GetStats().completed, ids.size());
+        }
+
+        EXPECT_GE(progressCount, 8);
+        EXPECT_EQ(FakeBatchRecognizer::instanceCount, 0);
+    }
+
+    TEST_F(TranscriptionSchedulerTest, ReportsLoaderAndRecognizerErrors)
+    {
+        CompletionLog log;
+        FakeScheduler scheduler(1, log);
+
+        auto unreadable = scheduler.Queue([](std::unique_ptr<PcmSource>&) { return FakeBatchRecognizer::failed; }, L"");
+        auto missingEngine = scheduler.Queue(LoadSpeech(1), L"missing");
+
+        auto completions = log.WaitFor(2);
+        EXPECT_EQ(completions[unreadable].status, FakeBatchRecognizer::failed);
+        EXPECT_EQ(completions[missingEngine].status, FakeBatchRecognizer::failed);
+        EXPECT_EQ(completions[missingEngine].phraseCount, 0u);
+    }
+
+    TEST_F(TranscriptionSchedulerTest, ReportsToJobCompletionOnly)
+    {
+        CompletionLog poolLog;
+        CompletionLog jobLog;
+        std::atomic<int> progressCount{ 0 };
+        FakeScheduler scheduler(1, poolLog, &progressCount);
+
+        auto id = scheduler.Queue(LoadSpeech(1), L"", [&jobLog](uint64_t jobId, int status, const std::vector<FakePhrase>& phrases) {
+            jobLog.Add(jobId, status, phrases);
+        });
+
+        EXPECT_EQ(jobLog.WaitFor(1)[id].status, FakeBatchRecognizer::succeeded);
+        EXPECT_TRUE(poolLog.WaitFor(0).empty());
+        EXPECT_EQ(progressCount, 0);
+    }
+
+    TEST_F(TranscriptionSchedulerTest, CancelsPendingAndRunningJobs)
+    {
+        // Far longer than the test.
+        FakeBatchRecognizer::decodingPasses = 1000000000;
+
+        CompletionLog log;
+        std::atomic<int> progressCount{ 0 };
+        FakeScheduler scheduler(1, log, &progressCount);
+
+        auto running = scheduler.Queue(LoadSpeech(1), L"");
+        auto pending = scheduler.Queue(LoadSpeech(1), L"");
+
+        EXPECT_TRUE(scheduler.Cancel(pending));
+        EXPECT_EQ(log.WaitFor(1)[pending].status, FakeBatchRecognizer::cancelled);
+
+        // Progress is reported once decoding started.
+        while (progressCount == 0) std::this_thread::sleep_for(1ms);
+        EXPECT_TRUE(scheduler.Cancel(running));
+        EXPECT_EQ(log.WaitFor(2)[running].status, FakeBatchRecognizer::cancelled);
+    }
+
+    TEST_F(TranscriptionSchedulerTest, StopCancelsQueuedJobs)
+    {
+        FakeBatchRecognizer::decodingPasses = 1000000000;
+
+        CompletionLog log;
+        CompletionLog stoppedLog;
+        FakeScheduler scheduler(2, log);
+
+        for (int i = 0; i < 5; i++) scheduler.Queue(LoadSpeech(1), L"");
+        scheduler.Stop();
+
+        auto completions = log.WaitFor(5);
+        ASSERT_EQ(completions.size(), 5u);
+        for (const auto& completion : completions) EXPECT_EQ(completion.second.status, FakeBatchRecognizer::cancelled);
+
+        EXPECT_EQ(scheduler.Queue(LoadSpeech(1), L"", [&stoppedLog](uint64_t jobId, int status, const std::vector<FakePhrase>& phrases) {
+            stoppedLog.Add(jobId, status, phrases);
+        }), 0u);
+        EXPECT_EQ(stoppedLog.WaitFor(1)[0].status, FakeBatchRecognizer::cancelled);
+    }
+
+}
+}
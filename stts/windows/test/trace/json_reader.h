@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace stts {
+
+	// Parsed JSON value, only what trace dumps contain.
+	struct JsonValue {
+		enum class Type { null, boolean, number, string, array, object };
+
+		Type type = Type::null;
+		bool boolean = false;
+		double number = 0;
+		std::string string;
+		std::vector<JsonValue> array;
+		std::map<std::string, JsonValue> object;
+
+		// Null value if absent.
+		const JsonValue& operator[](const std::string& key) const
+		{
+			static const JsonValue null;
+			auto it = object.find(key);
+			return it != object.end() ? it->second : null;
+		}
+	};
+
+	// Strict parser of RFC 8259 JSON, used to check that dumps are valid.
+	class JsonReader {
+	public:
+		// Returns false if text is not a single valid JSON value.
+		static bool Parse(const std::string& text, JsonValue& value)
+		{
+			JsonReader reader(text);
+			if (!reader.ReadValue(value)) return false;
+
+			reader.SkipSpaces();
+			return reader.m_position == text.size();
+		}
+
+	private:
+		const std::string& m_text;
+		size_t m_position = 0;
+
+		explicit JsonReader(const std::string& text) : m_text(text) {}
+
+		bool IsAt(char c) const { return m_position < m_text.size() && m_text[m_position] == c; }
+
+		void SkipSpaces()
+		{
+			while (m_position < m_text.size() && (m_text[m_position] == ' ' || m_text[m_position] == '\t' ||
+				m_text[m_position] == '\n' || m_text[m_position] == '\r'))
+			{
+				m_position++;
+			}
+		}
+
+		bool ReadLiteral(const char* literal)
+		{
+			for (; *literal; literal++, m_position++)
+			{
+				if (!IsAt(*literal)) return false;
+			}
+			return true;
+		}
+
+		bool ReadValue(JsonValue& value)
+		{
+			SkipSpaces();
+			if (m_position >= m_text.size()) return false;
+
+			switch (m_text[m_position])
+			{
+			case '{': return ReadObject(value);
+			case '[': return ReadArray(value);
+			case '"':
+				value.type = JsonValue::Type::string;
+				return ReadString(value.string);
+			case 't':
+				value.type = JsonValue::Type::boolean;
+				value.boolean = true;
+				return ReadLiteral("true");
+			case 'f':
+				value.type = JsonValue::Type::boolean;
+				return ReadLiteral("false");
+			case 'n':
+				return ReadLiteral("null");
+			default:
+				return ReadNumber(value);
+			}
+		}
+
+		bool ReadObject(JsonValue& value)
+		{
+			value.type = JsonValue::Type::object;
+			m_position++;
+			SkipSpaces();
+			if (IsAt('}'))
+			{
+				m_position++;
+				return true;
+			}
+
+			for (;;)
+			{
+				SkipSpaces();
+				std::string key;
+				if (!IsAt('"') || !ReadString(key)) return false;
+
+				SkipSpaces();
+				if (!IsAt(':')) return false;
+				m_position++;
+
+				if (!ReadValue(value.object[key])) return false;
+
+				SkipSpaces();
+				if (IsAt('}'))
+				{
+					m_position++;
+					return true;
+				}
+				if (!IsAt(',')) return false;
+				m_position++;
+			}
+		}
+
+		bool ReadArray(JsonValue& value)
+		{
+			value.type = JsonValue::Type::array;
+			m_position++;
+			SkipSpaces();
+			if (IsAt(']'))
+			{
+				m_position++;
+				return true;
+			}
+
+			for (;;)
+			{
+				value.array.emplace_back();
+				if (!ReadValue(value.array.back())) return false;
+
+				SkipSpaces();
+				if (IsAt(']'))
+				{
+					m_position++;
+					return true;
+				}
+				if (!IsAt(',')) return false;
+				m_position++;
+			}
+		}
+
+		// Escapes are kept as code points below 0x80 only, enough for the dumps.
+		bool ReadString(std::string& out)
+		{
+			m_position++;
+			while (m_position < m_text.size())
+			{
+				auto c = static_cast<unsigned char>(m_text[m_position++]);
+				if (c == '"') return true;
+				if (c < 0x20) return false;
+				if (c != '\\')
+				{
+					out += static_cast<char>(c);
+					continue;
+				}
+
+				if (m_position >= m_text.size()) return false;
+				switch (m_text[m_position++])
+				{
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u':
+				{
+					if (m_position + 4 > m_text.size()) return false;
+					auto hex = m_text.substr(m_position, 4);
+					char* end;
+					auto codePoint = std::strtol(hex.c_str(), &end, 16);
+					if (end != hex.c_str() + 4 || codePoint >= 0x80) return false;
+					out += static_cast<char>(codePoint);
+					m_position += 4;
+					break;
+				}
+				default:
+					return false;
+				}
+			}
+			return false;
+		}
+
+		bool ReadNumber(JsonValue& value)
+		{
+			auto start = m_position;
+			if (IsAt('-')) m_position++;
+
+			auto digits = [this]() {
+				auto first = m_position;
+				while (m_position < m_text.size() && m_text[m_position] >= '0' && m_text[m_position] <= '9') m_position++;
+				return m_position - first;
+			};
+
+			// No leading zeros.
+			if (IsAt('0')) m_position++;
+			else if (digits() == 0) return false;
+
+			if (IsAt('.'))
+			{
+				m_position++;
+				if (digits() == 0) return false;
+			}
+
+			if (IsAt('e') || IsAt('E'))
+			{
+				m_position++;
+				if (IsAt('+') || IsAt('-')) m_position++;
+				if (digits() == 0) return false;
+			}
+
+			value.type = JsonValue::Type::number;
+			value.number = std::strtod(m_text.substr(start, m_position - start).c_str(), nullptr);
+			return true;
+		}
+	};
+
+}
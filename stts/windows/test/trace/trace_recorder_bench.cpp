@@ -0,0 +1,72 @@
+#include "trace/trace_recorder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace stts {
+namespace {
+
+    // A scope without tracing, e.g. a method handler before spans were added.
+    void BM_TraceSpanNone(benchmark::State& state)
+    {
+        int calls = 0;
+        for (auto _ : state)
+        {
+            calls++;
+            benchmark::DoNotOptimize(calls);
+        }
+    }
+    BENCHMARK(BM_TraceSpanNone);
+
+    void BM_TraceSpanDisabled(benchmark::State& state)
+    {
+        TraceRecorder::SetEnabled(false);
+
+        int calls = 0;
+        for (auto _ : state)
+        {
+            TraceSpan span("bench", "disabled");
+            calls++;
+            benchmark::DoNotOptimize(calls);
+        }
+    }
+    BENCHMARK(BM_TraceSpanDisabled);
+
+    void BM_TraceSpanEnabled(benchmark::State& state)
+    {
+        TraceRecorder::SetEnabled(true);
+
+        int calls = 0;
+        for (auto _ : state)
+        {
+            TraceSpan span("bench", "enabled");
+            calls++;
+            benchmark::DoNotOptimize(calls);
+        }
+
+        TraceRecorder::SetEnabled(false);
+    }
+    BENCHMARK(BM_TraceSpanEnabled);
+
+    // Dump of a full ring of the calling thread.
+    void BM_TraceDump(benchmark::State& state)
+    {
+        TraceRecorder::SetEnabled(true);
+        for (int64_t i = 0; i < 8192; i++) TraceRecorder::Record("bench", "span", i * 1000, i * 1000 + 500);
+
+        size_t size = 0;
+        for (auto _ : state)
+        {
+            auto json = TraceRecorder::Dump();
+            size = json.size();
+            benchmark::DoNotOptimize(json);
+        }
+
+        TraceRecorder::SetEnabled(false);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_TraceDump)->Unit(benchmark::kMillisecond);
+
+}
+}
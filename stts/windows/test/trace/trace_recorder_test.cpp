@@ -0,0 +1,204 @@
+#include "trace/trace_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_reader.h"
+
+namespace stts {
+namespace {
+
+    // Parsed dump, fails the test if it is not valid JSON.
+    JsonValue DumpTrace()
+    {
+        auto text = TraceRecorder::Dump();
+        JsonValue trace;
+        EXPECT_TRUE(JsonReader::Parse(text, trace)) << text.substr(0, 1000);
+        return trace;
+    }
+
+    // Complete events of the given category.
+    std::vector<JsonValue> GetSpans(const JsonValue& trace, const std::string& category)
+    {
+        std::vector<JsonValue> spans;
+        for (const auto& event : trace["traceEvents"].array)
+        {
+            if (event["ph"].string == "X" && event["cat"].string == category) spans.push_back(event);
+        }
+        return spans;
+    }
+
+    class TraceRecorderTest : public testing::Test {
+    protected:
+        void SetUp() override
+        {
+            TraceRecorder::SetEnabled(true);
+        }
+
+        void TearDown() override
+        {
+            TraceRecorder::SetEnabled(false);
+        }
+    };
+
+    TEST_F(TraceRecorderTest, DumpsEmptyTrace)
+    {
+        auto trace = DumpTrace();
+        EXPECT_EQ(trace["traceEvents"].type, JsonValue::Type::array);
+        EXPECT_EQ(trace["displayTimeUnit"].string, "ms");
+        EXPECT_TRUE(GetSpans(trace, "test").empty());
+    }
+
+    TEST_F(TraceRecorderTest, RecordsNestedSpans)
+    {
+        {
+            TraceSpan outer("test", "outer");
+            TraceSpan inner("test", "inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto spans = GetSpans(DumpTrace(), "test");
+        ASSERT_EQ(spans.size(), 2u);
+
+        // Inner ends first.
+        const auto& inner = spans[0];
+        const auto& outer = spans[1];
+        EXPECT_EQ(inner["name"].string, "inner");
+        EXPECT_EQ(outer["name"].string, "outer");
+        EXPECT_GE(inner["dur"].number, 1000.0);
+        EXPECT_LE(outer["ts"].number, inner["ts"].number);
+        EXPECT_GE(outer["ts"].number + outer["dur"].number, inner["ts"].number + inner["dur"].number);
+        EXPECT_EQ(outer["tid"].number, inner["tid"].number);
+        EXPECT_EQ(outer["pid"].number, 1.0);
+    }
+
+    TEST_F(TraceRecorderTest, RecordsNothingWhenDisabled)
+    {
+        TraceRecorder::SetEnabled(false);
+        EXPECT_FALSE(TraceRecorder::IsEnabled());
+        {
+            TraceSpan span("test", "disabled");
+        }
+
+        EXPECT_TRUE(GetSpans(DumpTrace(), "test").empty());
+    }
+
+    TEST_F(TraceRecorderTest, EnablingStartsANewTrace)
+    {
+        TraceRecorder::Record("test", "old", 0, 1);
+        TraceRecorder::SetEnabled(true);
+        TraceRecorder::Record("test", "new", 0, 1);
+
+        auto spans = GetSpans(DumpTrace(), "test");
+        ASSERT_EQ(spans.size(), 1u);
+        EXPECT_EQ(spans[0]["name"].string, "new");
+    }
+
+    TEST_F(TraceRecorderTest, WritesMicroseconds)
+    {
+        TraceRecorder::Record("test", "span", 1234567, 1234567 + 5);
+        TraceRecorder::Record("test", "span", 42, 2042);
+
+        auto text = TraceRecorder::Dump();
+        EXPECT_NE(text.find("\"ts\":1234.567,\"dur\":0.005"), std::string::npos) << text;
+        EXPECT_NE(text.find("\"ts\":0.042,\"dur\":2.000"), std::string::npos) << text;
+    }
+
+    TEST_F(TraceRecorderTest, EscapesStrings)
+    {
+        TraceRecorder::Record("test", "quote \" backslash \\ tab \t", 0, 1);
+
+        auto spans = GetSpans(DumpTrace(), "test");
+        ASSERT_EQ(spans.size(), 1u);
+        EXPECT_EQ(spans[0]["name"].string, "quote \" backslash \\ tab \t");
+    }
+
+    TEST_F(TraceRecorderTest, KeepsLatestSpans)
+    {
+        const int64_t kCount = 20000;
+        for (int64_t i = 0; i < kCount; i++) TraceRecorder::Record("test", "span", i * 1000, i * 1000 + 1);
+
+        auto spans = GetSpans(DumpTrace(), "test");
+        ASSERT_FALSE(spans.empty());
+        EXPECT_LT(spans.size(), static_cast<size_t>(kCount));
+
+        // The newest ones, in order.
+        auto first = static_cast<double>(kCount - spans.size());
+        for (size_t i = 0; i < spans.size(); i++)
+        {
+            ASSERT_EQ(spans[i]["ts"].number, first + i);
+        }
+    }
+
+    TEST_F(TraceRecorderTest, NamesThreadsAndKeepsTheirSpans)
+    {
+        std::thread thread([]() {
+            TraceRecorder::SetThreadName("named \"worker\"");
+            TraceSpan span("test", "on thread");
+        });
+        thread.join();
+
+        auto trace = DumpTrace();
+        auto spans = GetSpans(trace, "test");
+        ASSERT_EQ(spans.size(), 1u);
+
+        size_t nameCount = 0;
+        for (const auto& event : trace["traceEvents"].array)
+        {
+            if (event["ph"].string != "M" || event["tid"].number != spans[0]["tid"].number) continue;
+
+            EXPECT_EQ(event["name"].string, "thread_name");
+            EXPECT_EQ(event["args"]["name"].string, "named \"worker\"");
+            nameCount++;
+        }
+        EXPECT_EQ(nameCount, 1u);
+    }
+
+    // Threads keep overwriting their rings while dumps read them: no torn span may be dumped.
+    TEST_F(TraceRecorderTest, DumpsWhileThreadsRecord)
+    {
+        static const char* const kCategories[] = { "stress0", "stress1", "stress2", "stress3" };
+        static const char* const kNames[] = { "span0", "span1", "span2", "span3" };
+
+        std::atomic<bool> isStopping{ false };
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < 4; t++)
+        {
+            threads.emplace_back([t, &isStopping]() {
+                // Each span has its own start and lasts 1 us, a mix of two spans would not.
+                for (int64_t i = 0; !isStopping.load(std::memory_order_relaxed); i++)
+                {
+                    TraceRecorder::Record(kCategories[t], kNames[t], i * 7000, i * 7000 + 1000);
+                    if (i % 256 == 0) std::this_thread::yield();
+                }
+            });
+        }
+
+        size_t spanCount = 0;
+        for (int dump = 0; dump < 10; dump++)
+        {
+            auto trace = DumpTrace();
+            for (size_t t = 0; t < 4; t++)
+            {
+                for (const auto& span : GetSpans(trace, kCategories[t]))
+                {
+                    ASSERT_EQ(span["name"].string, kNames[t]);
+                    ASSERT_EQ(span["dur"].number, 1.0);
+                    spanCount++;
+                }
+            }
+            std::this_thread::yield();
+        }
+
+        isStopping = true;
+        for (auto& thread : threads) thread.join();
+        EXPECT_GT(spanCount, 0u);
+    }
+
+}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include "tts/utterance_scheduler.h"
+
+namespace stts {
+
+	// Stand-in for the SAPI voice: keeps the queued chunks, played by the test.
+	// Chunks starting with "Fail" fail to queue.
+	class FakeSpeechOutput : public SpeechOutput
+	{
+	public:
+		struct Chunk {
+			uint64_t handle = 0;
+			uint64_t utteranceId = 0;
+			std::string text;
+			size_t textPosition = 0;
+			// Bookmarks written in the chunk.
+			size_t firstBookmark = 0;
+			size_t bookmarkCount = 0;
+		};
+
+		// Oldest first.
+		std::deque<Chunk> queued;
+		size_t speakCount = 0;
+		size_t purgeCount = 0;
+
+		uint64_t Speak(ScheduledUtterance& utterance, size_t end) override
+		{
+			speakCount++;
+
+			Chunk chunk;
+			chunk.utteranceId = utterance.id;
+			chunk.text = utterance.text.substr(utterance.offset, end - utterance.offset);
+			chunk.textPosition = utterance.textPosition;
+			if (chunk.text.compare(0, 4, "Fail") == 0) return 0;
+
+			chunk.firstBookmark = utterance.nextBookmark;
+			while (utterance.nextBookmark < utterance.bookmarkBytes.size() && utterance.bookmarkBytes[utterance.nextBookmark] < end)
+			{
+				utterance.nextBookmark++;
+			}
+			chunk.bookmarkCount = utterance.nextBookmark - chunk.firstBookmark;
+
+			chunk.handle = ++m_lastHandle;
+			queued.push_back(chunk);
+			return chunk.handle;
+		}
+
+		void Purge() override
+		{
+			purgeCount++;
+			queued.clear();
+		}
+
+	private:
+		uint64_t m_lastHandle = 0;
+	};
+
+}
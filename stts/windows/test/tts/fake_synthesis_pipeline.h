@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "tts/synthesis_pipeline.h"
+
+namespace stts {
+
+	struct FakeVoiceTiming {
+		// Audio of each utterance.
+		std::chrono::milliseconds duration{ 100 };
+		// Rendering is this many times faster than real time.
+		int speed = 10;
+		// Before the first samples, e.g. text analysis.
+		std::chrono::milliseconds latency{ 0 };
+	};
+
+	// Stand-in for the SAPI voice of the pipeline thread: renders silence 10 ms at a time with the given timing.
+	// Text "fail" fails, text "block" renders until cancelled.
+	class FakeSynthesisPipeline : public SynthesisPipeline
+	{
+	public:
+		FakeSynthesisPipeline(const PcmFormat& format, const SynthesisPipelineOptions& options, ReadyCallback onReady,
+			const FakeVoiceTiming& timing = FakeVoiceTiming()) :
+			SynthesisPipeline(format, options, std::move(onReady)),
+			m_timing(timing)
+		{
+		}
+
+		~FakeSynthesisPipeline() override
+		{
+			Stop();
+		}
+
+		std::atomic<int> renders{ 0 };
+		std::atomic<int> threadStarts{ 0 };
+		std::atomic<int> threadStops{ 0 };
+
+	protected:
+		void OnThreadStart() override { threadStarts++; }
+		void OnThreadStop() override { threadStops++; }
+
+		bool Render(const SynthesisRequest& request, PcmSink& sink, const CancellationToken& cancellationToken) override
+		{
+			renders++;
+			if (request.speakXml == L"fail") return false;
+
+			std::this_thread::sleep_for(m_timing.latency);
+
+			const std::chrono::milliseconds chunk(10);
+			std::vector<uint8_t> samples(static_cast<size_t>(GetFormat().GetByteRate() / 100));
+			auto isBlocking = request.speakXml == L"block";
+
+			for (auto rendered = std::chrono::milliseconds(0); isBlocking || rendered < m_timing.duration; rendered += chunk)
+			{
+				if (cancellationToken.IsCancelled()) return false;
+
+				std::this_thread::sleep_for(std::chrono::microseconds(chunk) / m_timing.speed);
+				if (!sink.Write(samples.data(), samples.size())) return false;
+			}
+
+			return true;
+		}
+
+	private:
+		FakeVoiceTiming m_timing;
+	};
+
+	// Ready utterances in the order of the callback.
+	class ReadyUtterances {
+	public:
+		SynthesisPipeline::ReadyCallback GetCallback()
+		{
+			return [this](SynthesizedUtterance utterance) {
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_utterances.push_back(std::move(utterance));
+				}
+				m_condition.notify_all();
+			};
+		}
+
+		// Returns false on timeout.
+		bool WaitFor(size_t count, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			return m_condition.wait_for(lock, timeout, [this, count] { return m_utterances.size() >= count; });
+		}
+
+		// Oldest first, removed from the list.
+		SynthesizedUtterance Take()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return !m_utterances.empty(); });
+
+			auto utterance = std::move(m_utterances.front());
+			m_utterances.erase(m_utterances.begin());
+			return utterance;
+		}
+
+		size_t GetCount()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_utterances.size();
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::vector<SynthesizedUtterance> m_utterances;
+	};
+
+}
@@ -0,0 +1,111 @@
+#include "tts/sentence_segmenter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tts/speak_xml_writer.h"
+
+namespace stts {
+namespace {
+
+    const size_t kDocumentSize = 100 << 10;
+    // Chunks queued in the voice at a time by Tts.
+    const size_t kChunksAhead = 2;
+
+    // Article prose with abbreviations, numbers and a paragraph break now and then.
+    std::string MakeDocument(size_t size)
+    {
+        static const char* const kSentences[] = {
+            "Dr. Smith arrived at 8.30 with No. 5 of the report. ",
+            "It covered the years 2019 to 2023, e.g. the drought and the floods that followed it. ",
+            "Was it enough? ",
+            "The committee, after a long debate, approved the budget; the vote was close. ",
+            "Prices rose by 3.5% in the U.S. and slightly less in Europe. ",
+            "Nobody expected it\xE2\x80\xA6 but here we are.\n\n",
+        };
+
+        std::string text;
+        text.reserve(size + 128);
+        for (size_t i = 0; text.size() < size; i++) text += kSentences[i % (sizeof(kSentences) / sizeof(kSentences[0]))];
+        return text;
+    }
+
+    // Voice analysing its whole input before the first samples, 2 us per character.
+    std::chrono::microseconds GetAnalysisTime(const std::wstring& xml)
+    {
+        return std::chrono::microseconds(2 * xml.size());
+    }
+
+    // Time from Start to the first samples on a 100 KB document, range(0) is 0 to speak it in one piece
+    // and 1 to speak it by chunks. peak_kb is the text and XML kept alive during the read: the text,
+    // and the XML of the chunks queued in the voice.
+    void BM_SentenceSegmenterFirstAudio(benchmark::State& state)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        auto document = MakeDocument(kDocumentSize);
+        auto isSegmented = state.range(0) != 0;
+        SentenceSegmenter segmenter;
+
+        for (auto _ : state)
+        {
+            auto start = Clock::now();
+
+            auto end = isSegmented ? segmenter.Next(document, 0) : document.size();
+            SpeakXmlWriter writer;
+            writer.Reset(end);
+            writer.Text(document.data(), end);
+            std::this_thread::sleep_for(GetAnalysisTime(writer.GetXml()));
+
+            state.SetIterationTime(std::chrono::duration<double>(Clock::now() - start).count());
+        }
+
+        // Largest sum of XML sizes over chunksAhead consecutive chunks.
+        std::vector<size_t> xmlSizes;
+        for (size_t offset = 0; offset < document.size();)
+        {
+            auto end = isSegmented ? segmenter.Next(document, offset) : document.size();
+            SpeakXmlWriter writer;
+            writer.Reset(end - offset);
+            writer.Text(document.data() + offset, end - offset);
+            xmlSizes.push_back(writer.GetXml().capacity() * sizeof(wchar_t));
+            offset = end;
+        }
+
+        size_t peakXml = 0;
+        for (size_t i = 0; i < xmlSizes.size(); i++)
+        {
+            size_t queued = 0;
+            for (size_t j = i; j < (std::min)(i + kChunksAhead, xmlSizes.size()); j++) queued += xmlSizes[j];
+            peakXml = (std::max)(peakXml, queued);
+        }
+
+        state.counters["chunks"] = static_cast<double>(xmlSizes.size());
+        state.counters["peak_kb"] = (document.capacity() + peakXml) / 1024.0;
+    }
+    BENCHMARK(BM_SentenceSegmenterFirstAudio)->Arg(0)->Arg(1)->Iterations(5)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+    // Splitting a whole 100 KB document.
+    void BM_SentenceSegmenterSplit(benchmark::State& state)
+    {
+        auto document = MakeDocument(kDocumentSize);
+        SentenceSegmenter segmenter;
+
+        for (auto _ : state)
+        {
+            size_t chunks = 0;
+            for (size_t offset = 0; offset < document.size(); chunks++) offset = segmenter.Next(document, offset);
+            benchmark::DoNotOptimize(chunks);
+        }
+
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * document.size()));
+    }
+    BENCHMARK(BM_SentenceSegmenterSplit)->Unit(benchmark::kMicrosecond);
+
+}
+}
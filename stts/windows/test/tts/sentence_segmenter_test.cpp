@@ -0,0 +1,243 @@
+#include "tts/sentence_segmenter.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace stts {
+
+    // Keeps test failures readable.
+    void PrintTo(const SentenceSegmenterOptions& options, std::ostream* os)
+    {
+        *os << "{ " << options.targetLength << ", " << options.maxLength << " }";
+    }
+
+namespace {
+
+    std::vector<std::string> Split(const std::string& text, const SentenceSegmenterOptions& options)
+    {
+        SentenceSegmenter segmenter(options);
+        std::vector<std::string> chunks;
+
+        for (size_t offset = 0; offset < text.size();)
+        {
+            auto end = segmenter.Next(text, offset);
+            if (end <= offset || end > text.size())
+            {
+                ADD_FAILURE() << "No progress at " << offset;
+                break;
+            }
+
+            chunks.push_back(text.substr(offset, end - offset));
+            offset = end;
+        }
+
+        return chunks;
+    }
+
+    // One sentence per chunk.
+    std::vector<std::string> SplitSentences(const std::string& text)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 0;
+        return Split(text, options);
+    }
+
+    using Chunks = std::vector<std::string>;
+
+    TEST(SentenceSegmenterTest, EndsSentencesAtTerminators)
+    {
+        EXPECT_EQ(SplitSentences("One. Two! Three? Four"), (Chunks{ "One. ", "Two! ", "Three? ", "Four" }));
+        EXPECT_EQ(SplitSentences("Wait\xE2\x80\xA6 Go."), (Chunks{ "Wait\xE2\x80\xA6 ", "Go." }));
+        EXPECT_EQ(SplitSentences("Really?! Yes..."), (Chunks{ "Really?! ", "Yes..." }));
+    }
+
+    TEST(SentenceSegmenterTest, KeepsClosingMarksWithTheSentence)
+    {
+        EXPECT_EQ(SplitSentences("He said \"Stop.\" Then left."), (Chunks{ "He said \"Stop.\" ", "Then left." }));
+        EXPECT_EQ(SplitSentences("(See below.) Next."), (Chunks{ "(See below.) ", "Next." }));
+        EXPECT_EQ(SplitSentences("\xE2\x80\x9CNo.\xE2\x80\x9D Yes."), (Chunks{ "\xE2\x80\x9CNo.\xE2\x80\x9D ", "Yes." }));
+    }
+
+    TEST(SentenceSegmenterTest, EndsCjkSentencesWithoutSpace)
+    {
+        EXPECT_EQ(SplitSentences("\xE4\xBD\xA0\xE5\xA5\xBD\xE3\x80\x82\xE4\xB8\x96\xE7\x95\x8C\xEF\xBC\x81\xE5\x90\x97\xEF\xBC\x9F"),
+            (Chunks{ "\xE4\xBD\xA0\xE5\xA5\xBD\xE3\x80\x82", "\xE4\xB8\x96\xE7\x95\x8C\xEF\xBC\x81", "\xE5\x90\x97\xEF\xBC\x9F" }));
+    }
+
+    TEST(SentenceSegmenterTest, EndsSentencesAtBlankLines)
+    {
+        EXPECT_EQ(SplitSentences("Title\n\nBody text"), (Chunks{ "Title\n\n", "Body text" }));
+        EXPECT_EQ(SplitSentences("Title\n \r\n\tBody"), (Chunks{ "Title\n \r\n\t", "Body" }));
+        EXPECT_EQ(SplitSentences("Line one\nline two"), (Chunks{ "Line one\nline two" }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsAbbreviations)
+    {
+        EXPECT_EQ(SplitSentences("Dr. Smith arrived. He left."), (Chunks{ "Dr. Smith arrived. ", "He left." }));
+        EXPECT_EQ(SplitSentences("Apples, pears etc. Are fruits."), (Chunks{ "Apples, pears etc. Are fruits." }));
+        EXPECT_EQ(SplitSentences("MR. Jones came. Bye."), (Chunks{ "MR. Jones came. ", "Bye." }));
+        // Glued to a number, so not the abbreviation.
+        EXPECT_EQ(SplitSentences("Meet on the 3rd. Then go."), (Chunks{ "Meet on the 3rd. ", "Then go." }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsInitialsAndDottedAbbreviations)
+    {
+        EXPECT_EQ(SplitSentences("J. R. R. Tolkien wrote it. Yes."), (Chunks{ "J. R. R. Tolkien wrote it. ", "Yes." }));
+        EXPECT_EQ(SplitSentences("In the U.S. Army. Next."), (Chunks{ "In the U.S. Army. ", "Next." }));
+        EXPECT_EQ(SplitSentences("Fruits, e.g. Apples. Next."), (Chunks{ "Fruits, e.g. Apples. ", "Next." }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsNumberAbbreviationsBeforeNumbers)
+    {
+        EXPECT_EQ(SplitSentences("See No. 5 here. Then I said no. Then"), (Chunks{ "See No. 5 here. ", "Then I said no. ", "Then" }));
+        EXPECT_EQ(SplitSentences("Read pp. 10 to 12. Done."), (Chunks{ "Read pp. 10 to 12. ", "Done." }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsListNumbersAtLineStart)
+    {
+        EXPECT_EQ(SplitSentences("1. Open the box.\n  2. Take it."), (Chunks{ "1. Open the box.\n  ", "2. Take it." }));
+        EXPECT_EQ(SplitSentences("I counted to 2. Then stopped."), (Chunks{ "I counted to 2. ", "Then stopped." }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsPeriodsInsideWordsAndNumbers)
+    {
+        EXPECT_EQ(SplitSentences("Pi is 3.14 today. Version 1.2.3 is out. Visit example.com now."),
+            (Chunks{ "Pi is 3.14 today. ", "Version 1.2.3 is out. ", "Visit example.com now." }));
+    }
+
+    TEST(SentenceSegmenterTest, SkipsPeriodsBeforeLowercase)
+    {
+        EXPECT_EQ(SplitSentences("Wait... and then. Go."), (Chunks{ "Wait... and then. ", "Go." }));
+        // Strong terminators end the sentence anyway.
+        EXPECT_EQ(SplitSentences("Why? because."), (Chunks{ "Why? ", "because." }));
+    }
+
+    TEST(SentenceSegmenterTest, KeepsShortTextsWhole)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 20;
+        options.maxLength = 40;
+
+        EXPECT_EQ(Split("One. Two. Three.", options), (Chunks{ "One. Two. Three." }));
+        EXPECT_EQ(Split("", options), Chunks());
+    }
+
+    TEST(SentenceSegmenterTest, StartsLongTextsWithOneSentence)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 20;
+        options.maxLength = 40;
+
+        EXPECT_EQ(Split("One. Two. Three. Four. Five. Six.", options), (Chunks{ "One. ", "Two. Three. Four. ", "Five. Six." }));
+    }
+
+    TEST(SentenceSegmenterTest, GathersSentencesUpToTarget)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 12;
+        options.maxLength = 40;
+
+        // A sentence longer than the target makes its own chunk.
+        EXPECT_EQ(Split("Go. This one is longer. Yes. No. Ok.", options),
+            (Chunks{ "Go. ", "This one is longer. ", "Yes. No. Ok." }));
+    }
+
+    TEST(SentenceSegmenterTest, CutsLongSentencesAtClauses)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 10;
+        options.maxLength = 20;
+
+        EXPECT_EQ(Split("Alpha beta, gamma; delta epsilon zeta.", options),
+            (Chunks{ "Alpha beta, gamma; ", "delta epsilon zeta." }));
+        // Not inside numbers.
+        EXPECT_EQ(Split("Count 1,000,000 then, 2,000 now", options),
+            (Chunks{ "Count 1,000,000 ", "then, 2,000 now" }));
+    }
+
+    TEST(SentenceSegmenterTest, CutsLongSentencesAtSpaces)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 5;
+        options.maxLength = 12;
+
+        EXPECT_EQ(Split("aaaa bbbb cccc dddd eeee.", options), (Chunks{ "aaaa bbbb ", "cccc dddd ", "eeee." }));
+    }
+
+    TEST(SentenceSegmenterTest, CutsBetweenUtf8Sequences)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 2;
+        options.maxLength = 5;
+
+        // 2 and 3 byte sequences.
+        std::string text;
+        for (int i = 0; i < 5; i++) text += "\xC3\xA9\xE2\x82\xAC";
+
+        auto chunks = Split(text, options);
+        std::string joined;
+        for (const auto& chunk : chunks)
+        {
+            EXPECT_LE(chunk.size(), options.maxLength);
+            EXPECT_NE(static_cast<uint8_t>(chunk[0]) & 0xC0, 0x80u);
+            joined += chunk;
+        }
+        EXPECT_EQ(joined, text);
+    }
+
+    TEST(SentenceSegmenterTest, ZeroMaxLengthStillProgresses)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 0;
+        options.maxLength = 0;
+
+        EXPECT_EQ(Split("ab c", options), (Chunks{ "a", "b", " ", "c" }));
+    }
+
+    class SentenceSegmenterCoverageTest : public testing::TestWithParam<SentenceSegmenterOptions> {};
+
+    // Chunks cover the text in order, within the cap, on UTF-8 boundaries.
+    TEST_P(SentenceSegmenterCoverageTest, CoversRandomTexts)
+    {
+        static const char* const kPieces[] = {
+            "word", "Word", " ", "  ", ". ", ".", "!", "?", "...", "\xE2\x80\xA6", ", ", ";", "\n", "\n\n",
+            "Dr.", "e.g.", "3.14", "No. 7", "\"", ")", "\xC3\xA9", "\xE3\x80\x82", "\xE4\xBD\xA0", "\xF0\x9F\x98\x80",
+        };
+
+        const auto& options = GetParam();
+        std::mt19937 random(42);
+        std::uniform_int_distribution<size_t> pieceDistribution(0, sizeof(kPieces) / sizeof(kPieces[0]) - 1);
+        std::uniform_int_distribution<int> lengthDistribution(0, 300);
+
+        for (int i = 0; i < 500; i++)
+        {
+            std::string text;
+            auto pieceCount = lengthDistribution(random);
+            for (int j = 0; j < pieceCount; j++) text += kPieces[pieceDistribution(random)];
+
+            auto chunks = Split(text, options);
+            std::string joined;
+            for (size_t j = 0; j < chunks.size(); j++)
+            {
+                if (text.size() > options.targetLength)
+                {
+                    ASSERT_LE(chunks[j].size(), options.maxLength) << text;
+                }
+                ASSERT_NE(static_cast<uint8_t>(chunks[j][0]) & 0xC0, 0x80u) << text;
+                joined += chunks[j];
+            }
+            ASSERT_EQ(joined, text);
+        }
+    }
+
+    INSTANTIATE_TEST_SUITE_P(Options, SentenceSegmenterCoverageTest, testing::Values(
+        SentenceSegmenterOptions{ 0, 8 },
+        SentenceSegmenterOptions{ 20, 40 },
+        SentenceSegmenterOptions{ 400, 1000 }));
+
+}
+}
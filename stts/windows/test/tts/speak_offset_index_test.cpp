@@ -0,0 +1,213 @@
+#include "tts/speak_offset_index.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "tts/speak_xml_writer.h"
+
+namespace stts {
+namespace {
+
+    // Expected text position of each XML position written by SpeakXmlWriter, read back from the XML itself:
+    // tags stand where they are, entities at the character they escape. One more entry for the end.
+    std::vector<size_t> GetReferencePositions(const std::wstring& xml)
+    {
+        std::vector<size_t> positions;
+        size_t textPosition = 0;
+
+        for (size_t i = 0; i < xml.size();)
+        {
+            if (xml[i] == L'<' || xml[i] == L'&')
+            {
+                // Attribute values are escaped, the first closing character ends the markup.
+                auto end = xml.find(xml[i] == L'<' ? L'>' : L';', i) + 1;
+                positions.insert(positions.end(), end - i, textPosition);
+                if (xml[i] == L'&') textPosition++;
+                i = end;
+                continue;
+            }
+
+            positions.push_back(textPosition++);
+            i++;
+        }
+
+        positions.push_back(textPosition);
+        return positions;
+    }
+
+    class SpeakOffsetIndexTest : public testing::Test {
+    protected:
+        SpeakXmlWriter writer;
+        SpeakOffsetIndex index;
+
+        void Reset()
+        {
+            writer.Reset(0, &index);
+        }
+
+        const std::wstring& Finish()
+        {
+            index.Finish(writer.GetXml().size());
+            return writer.GetXml();
+        }
+
+        // Every position of the XML and the one past the end.
+        void ExpectReferencePositions()
+        {
+            const auto& xml = writer.GetXml();
+            auto expected = GetReferencePositions(xml);
+            for (size_t i = 0; i <= xml.size(); i++)
+            {
+                ASSERT_EQ(index.ToTextPosition(i), expected[i]) << "at " << i << " of " << xml.size();
+            }
+        }
+    };
+
+    TEST_F(SpeakOffsetIndexTest, MapsPlainTextOneToOne)
+    {
+        Reset();
+        writer.Text("Hello world.");
+        const auto& xml = Finish();
+
+        ASSERT_EQ(xml, L"Hello world.");
+        for (size_t i = 0; i <= xml.size(); i++) EXPECT_EQ(index.ToTextPosition(i), i);
+    }
+
+    TEST_F(SpeakOffsetIndexTest, MapsEntitiesToTheCharacterTheyEscape)
+    {
+        Reset();
+        writer.Text("a&b \"c\" <d>");
+        const auto& xml = Finish();
+        ASSERT_EQ(xml, L"a&amp;b &quot;c&quot; &lt;d&gt;");
+
+        // Inside "&amp;".
+        for (size_t i = 1; i < 6; i++) EXPECT_EQ(index.ToTextPosition(i), 1u) << i;
+        EXPECT_EQ(index.ToTextPosition(6), 2u);
+
+        // Inside the first "&quot;", then 'c'.
+        for (size_t i = 8; i < 14; i++) EXPECT_EQ(index.ToTextPosition(i), 4u) << i;
+        EXPECT_EQ(index.ToTextPosition(14), 5u);
+
+        // Inside "&lt;", 'd', inside "&gt;".
+        for (size_t i = 22; i < 26; i++) EXPECT_EQ(index.ToTextPosition(i), 8u) << i;
+        EXPECT_EQ(index.ToTextPosition(26), 9u);
+        for (size_t i = 27; i < 31; i++) EXPECT_EQ(index.ToTextPosition(i), 10u) << i;
+
+        ExpectReferencePositions();
+    }
+
+    TEST_F(SpeakOffsetIndexTest, MapsTagsToWhereTheyStand)
+    {
+        Reset();
+        writer.Rate(2);
+        writer.Pitch(-3);
+        writer.Text("Hello ");
+        writer.Bookmark("one & \"two\"");
+        writer.Text("world");
+        writer.Silence(200);
+        const auto& xml = Finish();
+
+        // Leading tags stand at the start of the text.
+        auto hello = xml.find(L"Hello");
+        for (size_t i = 0; i < hello; i++) EXPECT_EQ(index.ToTextPosition(i), 0u) << i;
+        EXPECT_EQ(index.ToTextPosition(hello + 1), 1u);
+
+        // Entities of the mark belong to its tag.
+        auto bookmark = xml.find(L"<bookmark");
+        auto world = xml.find(L"world");
+        for (size_t i = bookmark; i < world; i++) EXPECT_EQ(index.ToTextPosition(i), 6u) << i;
+        EXPECT_EQ(index.ToTextPosition(world + 4), 10u);
+
+        // Trailing tag stands at the end.
+        for (size_t i = world + 5; i <= xml.size(); i++) EXPECT_EQ(index.ToTextPosition(i), 11u) << i;
+
+        ExpectReferencePositions();
+    }
+
+    TEST_F(SpeakOffsetIndexTest, CountsSurrogatePairsAsTwoUnits)
+    {
+        // U+1F600 then U+00E9, positions are UTF-16 code units like Dart string indices.
+        Reset();
+        writer.Volume(80);
+        writer.Text("a\xF0\x9F\x98\x80&\xC3\xA9");
+        const auto& xml = Finish();
+
+        auto start = xml.find(L'a');
+        ASSERT_EQ(xml.substr(start), L"a\xD83D\xDE00&amp;\x00E9");
+        EXPECT_EQ(index.ToTextPosition(start + 1), 1u);
+        EXPECT_EQ(index.ToTextPosition(start + 2), 2u);
+        EXPECT_EQ(index.ToTextPosition(start + 3), 3u);
+        EXPECT_EQ(index.ToTextPosition(start + 8), 4u);
+        EXPECT_EQ(index.ToTextPosition(xml.size()), 5u);
+
+        ExpectReferencePositions();
+    }
+
+    // Anchors on both sides of block starts, blocks without any anchor and blocks with many.
+    TEST_F(SpeakOffsetIndexTest, FindsAnchorsAcrossBlockBoundaries)
+    {
+        Reset();
+        writer.Rate(0);
+
+        std::string text;
+        for (size_t i = 0; text.size() < 40000; i++)
+        {
+            text += i % 7 == 0 ? "Tom & Jerry. " : i % 11 == 0 ? std::string(150, 'x') + " " : i % 5 == 0 ? "<<>> " : "word ";
+        }
+
+        for (size_t offset = 0; offset < text.size(); offset += 997)
+        {
+            writer.Text(text.substr(offset, 997));
+            writer.Bookmark(std::to_string(offset));
+        }
+        const auto& xml = Finish();
+        ASSERT_GT(xml.size(), 40000u);
+
+        ExpectReferencePositions();
+    }
+
+    TEST_F(SpeakOffsetIndexTest, ClampsPositionsPastTheEnd)
+    {
+        Reset();
+        writer.Text("a < b");
+        const auto& xml = Finish();
+
+        EXPECT_EQ(index.ToTextPosition(xml.size()), 5u);
+        EXPECT_EQ(index.ToTextPosition(xml.size() + 1), 5u);
+        EXPECT_EQ(index.ToTextPosition(xml.size() + 1000), 5u);
+
+        // Ending with markup.
+        Reset();
+        writer.Text("a <");
+        const auto& escaped = Finish();
+        EXPECT_EQ(index.ToTextPosition(escaped.size() - 1), 2u);
+        EXPECT_EQ(index.ToTextPosition(escaped.size() + 64), 3u);
+    }
+
+    TEST_F(SpeakOffsetIndexTest, MapsEverythingToZeroWithoutAnchors)
+    {
+        index.Finish(0);
+        EXPECT_EQ(index.ToTextPosition(0), 0u);
+        EXPECT_EQ(index.ToTextPosition(100), 0u);
+    }
+
+    TEST_F(SpeakOffsetIndexTest, StartsOverAfterReset)
+    {
+        Reset();
+        writer.Pitch(1);
+        writer.Text("first & longer document");
+        Finish();
+
+        Reset();
+        writer.Text("<second>");
+        const auto& xml = Finish();
+        ASSERT_EQ(xml, L"&lt;second&gt;");
+
+        ExpectReferencePositions();
+        EXPECT_EQ(index.ToTextPosition(100), 8u);
+    }
+
+}
+}
@@ -0,0 +1,96 @@
+#include "tts/speak_xml_writer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+namespace stts {
+namespace {
+
+    // Prose with a few accents and an ampersand now and then.
+    std::string MakeText(size_t size)
+    {
+        static const std::string sentence = "The caf\xC3\xA9 opens at 8 & closes at 6, \"Monday\" through Friday. ";
+
+        std::string text;
+        text.reserve(size + sentence.size());
+        while (text.size() < size) text += sentence;
+        text.resize(size);
+
+        // Not cut in the middle of a sequence.
+        while (!text.empty() && (static_cast<uint8_t>(text.back()) & 0x80) != 0) text.pop_back();
+        return text;
+    }
+
+    // Previous request building: tags and text concatenated in UTF-8, then converted with a counting
+    // pass and a converting pass like MultiByteToWideChar. Text was not escaped.
+    std::wstring BuildConcatenated(const std::string& text, int pitch, int silence)
+    {
+        auto utf8 = "<pitch absmiddle=\"" + std::to_string(pitch) + "\"/>" + "<silence msec=\"" + std::to_string(silence) + "\"/>" + text;
+
+        auto decode = [&utf8](wchar_t* out) {
+            size_t count = 0;
+            for (size_t i = 0; i < utf8.size(); count++)
+            {
+                auto c = static_cast<uint8_t>(utf8[i]);
+                uint32_t codePoint;
+                if (c < 0x80) { codePoint = c; i += 1; }
+                else if (c < 0xE0) { codePoint = ((c & 0x1F) << 6) | (utf8[i + 1] & 0x3F); i += 2; }
+                else { codePoint = ((c & 0x0F) << 12) | ((utf8[i + 1] & 0x3F) << 6) | (utf8[i + 2] & 0x3F); i += 3; }
+                if (out) out[count] = static_cast<wchar_t>(codePoint);
+            }
+            return count;
+        };
+
+        std::wstring xml(decode(nullptr), L'\0');
+        decode(&xml[0]);
+        return xml;
+    }
+
+    void BM_SpeakXmlConcatenated(benchmark::State& state)
+    {
+        auto text = MakeText(static_cast<size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(BuildConcatenated(text, 0, 200));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_SpeakXmlConcatenated)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+    void BM_SpeakXmlWriter(benchmark::State& state)
+    {
+        auto text = MakeText(static_cast<size_t>(state.range(0)));
+        SpeakXmlWriter writer;
+
+        for (auto _ : state)
+        {
+            writer.Reset(text.size());
+            writer.Pitch(0);
+            writer.Silence(200);
+            writer.Text(text);
+            benchmark::DoNotOptimize(writer.GetXml().data());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_SpeakXmlWriter)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+    // Without markup nor accents, the vectorized path only.
+    void BM_SpeakXmlWriterAscii(benchmark::State& state)
+    {
+        std::string text(static_cast<size_t>(state.range(0)), 'a');
+        SpeakXmlWriter writer;
+
+        for (auto _ : state)
+        {
+            writer.Reset(text.size());
+            writer.Text(text);
+            benchmark::DoNotOptimize(writer.GetXml().data());
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_SpeakXmlWriterAscii)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+}
+}
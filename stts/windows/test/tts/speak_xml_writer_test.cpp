@@ -0,0 +1,224 @@
+#include "tts/speak_xml_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+namespace stts {
+namespace {
+
+    std::wstring WriteText(const std::string& text)
+    {
+        SpeakXmlWriter writer;
+        writer.Reset(text.size());
+        writer.Text(text);
+        return writer.GetXml();
+    }
+
+    // Code point by code point, as the XML parser of SAPI reads it.
+    std::wstring EscapeReference(const std::string& text)
+    {
+        std::u32string codePoints;
+        for (size_t i = 0; i < text.size();)
+        {
+            auto c = static_cast<uint8_t>(text[i]);
+            size_t length = c < 0x80 ? 1 : c >= 0xC2 && c <= 0xDF ? 2 : c >= 0xE0 && c <= 0xEF ? 3 : c >= 0xF0 && c <= 0xF4 ? 4 : 0;
+            uint32_t codePoint = length == 1 ? c : length == 2 ? c & 0x1F : length == 3 ? c & 0x0F : c & 0x07;
+
+            bool isValid = length != 0 && i + length <= text.size();
+            for (size_t j = 1; isValid && j < length; j++)
+            {
+                auto next = static_cast<uint8_t>(text[i + j]);
+                isValid = (next & 0xC0) == 0x80;
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+            if (isValid && length > 1)
+            {
+                static const uint32_t minimums[] = { 0, 0, 0x80, 0x800, 0x10000 };
+                isValid = codePoint >= minimums[length] && (codePoint < 0xD800 || codePoint > 0xDFFF) && codePoint <= 0x10FFFF;
+            }
+
+            codePoints.push_back(isValid ? codePoint : 0xFFFD);
+            i += isValid ? length : 1;
+        }
+
+        std::wstring xml;
+        for (auto codePoint : codePoints)
+        {
+            switch (codePoint)
+            {
+            case '&': xml += L"&amp;"; break;
+            case '<': xml += L"&lt;"; break;
+            case '>': xml += L"&gt;"; break;
+            case '"': xml += L"&quot;"; break;
+            case '\t': case '\n': case '\r': xml += static_cast<wchar_t>(codePoint); break;
+            default:
+                if (codePoint < 0x20)
+                {
+                    xml += L' ';
+                }
+                else if (codePoint >= 0x10000)
+                {
+                    xml += static_cast<wchar_t>(0xD800 + ((codePoint - 0x10000) >> 10));
+                    xml += static_cast<wchar_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+                }
+                else
+                {
+                    xml += static_cast<wchar_t>(codePoint >= 0xFFFE ? 0xFFFD : codePoint);
+                }
+            }
+        }
+        return xml;
+    }
+
+    TEST(SpeakXmlWriterTest, WritesTags)
+    {
+        SpeakXmlWriter writer;
+        writer.Reset();
+        writer.Pitch(-5);
+        writer.Rate(10);
+        writer.Volume(0);
+        writer.Silence(0);
+        writer.Silence(250);
+        writer.Bookmark("mark");
+        writer.BeginVoice("Gender=Female", "Language=409");
+        writer.Text("Hi");
+        writer.EndVoice();
+        writer.BeginVoice("Name=Zira");
+        writer.EndVoice();
+
+        EXPECT_EQ(writer.GetXml(),
+            L"<pitch absmiddle=\"-5\"/><rate absspeed=\"10\"/><volume level=\"0\"/><silence msec=\"250\"/>"
+            L"<bookmark mark=\"mark\"/><voice required=\"Gender=Female\" optional=\"Language=409\">Hi</voice>"
+            L"<voice required=\"Name=Zira\"></voice>");
+    }
+
+    TEST(SpeakXmlWriterTest, WritesExtremeIntegers)
+    {
+        SpeakXmlWriter writer;
+        writer.Reset();
+        writer.Pitch(INT32_MIN);
+        writer.Rate(INT32_MAX);
+
+        EXPECT_EQ(writer.GetXml(), L"<pitch absmiddle=\"-2147483648\"/><rate absspeed=\"2147483647\"/>");
+    }
+
+    TEST(SpeakXmlWriterTest, EscapesMarkup)
+    {
+        EXPECT_EQ(WriteText("Tom & Jerry <b>\"quoted\"</b>"), L"Tom &amp; Jerry &lt;b&gt;&quot;quoted&quot;&lt;/b&gt;");
+        EXPECT_EQ(WriteText("'apostrophes' stay"), L"'apostrophes' stay");
+    }
+
+    TEST(SpeakXmlWriterTest, EscapesAttributes)
+    {
+        SpeakXmlWriter writer;
+        writer.Reset();
+        writer.Bookmark("a\"/><silence msec=\"9999");
+        writer.BeginVoice("Name=<&>");
+
+        EXPECT_EQ(writer.GetXml(), L"<bookmark mark=\"a&quot;/&gt;&lt;silence msec=&quot;9999\"/><voice required=\"Name=&lt;&amp;&gt;\">");
+    }
+
+    TEST(SpeakXmlWriterTest, ReplacesControlCharacters)
+    {
+        EXPECT_EQ(WriteText(std::string("a\0b\x01\x1F\t\n\r", 8)), L"a b  \t\n\r");
+    }
+
+    TEST(SpeakXmlWriterTest, DecodesUtf8)
+    {
+        EXPECT_EQ(WriteText("\xC3\xA9t\xC3\xA9"), L"été");
+        EXPECT_EQ(WriteText("\xE2\x82\xAC 5"), L"€ 5");
+        // Outside of the BMP, as a surrogate pair.
+        EXPECT_EQ(WriteText("\xF0\x9F\x98\x80"), std::wstring({ wchar_t(0xD83D), wchar_t(0xDE00) }));
+    }
+
+    TEST(SpeakXmlWriterTest, ReplacesInvalidUtf8)
+    {
+        const std::wstring replacement(1, wchar_t(0xFFFD));
+
+        // Lone continuation, overlong, truncated, surrogate, above U+10FFFF, lead byte out of range.
+        EXPECT_EQ(WriteText("a\x80" "b"), L"a" + replacement + L"b");
+        EXPECT_EQ(WriteText("\xC0\xAF"), replacement + replacement);
+        EXPECT_EQ(WriteText("\xE0\x80\xAF"), replacement + replacement + replacement);
+        EXPECT_EQ(WriteText("\xE2\x82"), replacement + replacement);
+        EXPECT_EQ(WriteText("\xE2\x82" "a"), replacement + replacement + L"a");
+        EXPECT_EQ(WriteText("\xED\xA0\x80"), replacement + replacement + replacement);
+        EXPECT_EQ(WriteText("\xF4\x90\x80\x80"), replacement + replacement + replacement + replacement);
+        EXPECT_EQ(WriteText("\xFF"), replacement);
+        // Noncharacters not allowed in XML.
+        EXPECT_EQ(WriteText("\xEF\xBF\xBE\xEF\xBF\xBF"), replacement + replacement);
+    }
+
+    TEST(SpeakXmlWriterTest, EscapesAtEveryVectorPosition)
+    {
+        // Special characters before, across and after each 16-byte block.
+        for (auto special : { std::string("&"), std::string("\""), std::string("\x01"), std::string("\xC3\xA9"), std::string("\xF0\x9F\x98\x80"), std::string("\xE2\x82") })
+        {
+            for (size_t position = 0; position < 48; position++)
+            {
+                std::string text(48, 'x');
+                text.insert(position, special);
+                EXPECT_EQ(WriteText(text), EscapeReference(text)) << "at " << position;
+            }
+        }
+    }
+
+    TEST(SpeakXmlWriterTest, MatchesReferenceOnRandomText)
+    {
+        // Mostly ASCII with markup, controls, valid and broken multi-byte sequences.
+        const std::string pieces[] = { "a", "b", " ", ".", "&", "<", ">", "\"", "\n", "\x02", "\xC3\xA9", "\xE2\x82\xAC",
+            "\xF0\x9F\x98\x80", "\x80", "\xC3", "\xE2\x82", "\xED\xA0\x80", "\xEF\xBF\xBF" };
+        std::mt19937 random(42);
+        std::uniform_int_distribution<size_t> pick(0, sizeof(pieces) / sizeof(pieces[0]) - 1);
+        std::uniform_int_distribution<size_t> plain(0, 3);
+
+        for (int round = 0; round < 2000; round++)
+        {
+            std::string text;
+            auto length = random() % 200;
+            for (size_t i = 0; i < length; i++)
+            {
+                text += plain(random) != 0 ? pieces[0] : pieces[pick(random)];
+            }
+            ASSERT_EQ(WriteText(text), EscapeReference(text)) << "round " << round;
+        }
+    }
+
+    TEST(SpeakXmlWriterTest, ReusesBuffer)
+    {
+        SpeakXmlWriter writer;
+        std::string text(4096, 'a');
+        text += "&<>\"";
+
+        writer.Reset(text.size());
+        writer.Pitch(0);
+        writer.Text(text);
+        auto data = writer.GetXml().data();
+        auto capacity = writer.GetXml().capacity();
+
+        // Next utterance of the same size is written in place.
+        writer.Reset(text.size());
+        EXPECT_TRUE(writer.GetXml().empty());
+        writer.Pitch(0);
+        writer.Text(text);
+        EXPECT_EQ(writer.GetXml().data(), data);
+        EXPECT_EQ(writer.GetXml().capacity(), capacity);
+    }
+
+    TEST(SpeakXmlWriterTest, ExpectedSizeAvoidsGrowth)
+    {
+        SpeakXmlWriter writer;
+        std::string text(10000, 'a');
+
+        writer.Reset(text.size());
+        auto data = writer.GetXml().data();
+        writer.Silence(100);
+        writer.Text(text);
+        writer.Bookmark("end");
+
+        EXPECT_EQ(writer.GetXml().data(), data);
+    }
+
+}
+}
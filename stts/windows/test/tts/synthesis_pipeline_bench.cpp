@@ -0,0 +1,75 @@
+#include "tts/synthesis_pipeline.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "fake_synthesis_pipeline.h"
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+    const int kUtteranceCount = 8;
+
+    // Plays queued prompts as the voice would, each for its audio duration, and measures the silence
+    // between the end of one and the start of the next. range(0) is the lookahead, 0 plays each
+    // utterance once rendered like SAPI does.
+    void BM_SynthesisPipelineGap(benchmark::State& state)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // A voice 5 times faster than real time, with 20 ms before the first samples.
+        FakeVoiceTiming timing;
+        timing.duration = std::chrono::milliseconds(100);
+        timing.speed = 5;
+        timing.latency = std::chrono::milliseconds(20);
+
+        SynthesisPipelineOptions options;
+        options.lookahead = static_cast<size_t>(state.range(0));
+
+        double totalGap = 0;
+        double maxGap = 0;
+        int gapCount = 0;
+
+        for (auto _ : state)
+        {
+            ReadyUtterances ready;
+            FakeSynthesisPipeline pipeline(kFormat, options, ready.GetCallback(), timing);
+            pipeline.Start();
+
+            for (int i = 0; i < kUtteranceCount; i++)
+            {
+                SynthesisRequest request;
+                request.speakXml = std::to_wstring(i);
+                pipeline.Submit(std::move(request));
+            }
+
+            Clock::time_point previousEnd;
+            for (int i = 0; i < kUtteranceCount; i++)
+            {
+                auto utterance = ready.Take();
+                auto start = Clock::now();
+                if (i > 0)
+                {
+                    auto gap = std::chrono::duration<double, std::milli>(start - previousEnd).count();
+                    totalGap += gap;
+                    maxGap = (std::max)(maxGap, gap);
+                    gapCount++;
+                }
+
+                std::this_thread::sleep_for(utterance.source->GetTime(utterance.source->GetSize()));
+                previousEnd = Clock::now();
+                pipeline.OnPlayed();
+            }
+        }
+
+        state.counters["gap_ms"] = totalGap / gapCount;
+        state.counters["max_gap_ms"] = maxGap;
+    }
+    BENCHMARK(BM_SynthesisPipelineGap)->Arg(0)->Arg(1)->Arg(2)->Iterations(3)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
+}
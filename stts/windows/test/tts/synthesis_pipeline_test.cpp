@@ -0,0 +1,218 @@
+#include "tts/synthesis_pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "fake_synthesis_pipeline.h"
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+
+    SynthesisRequest MakeRequest(const std::wstring& text)
+    {
+        SynthesisRequest request;
+        request.speakXml = text;
+        return request;
+    }
+
+    SynthesisPipelineOptions MakeOptions(size_t lookahead, size_t maxBytes = 32 << 20)
+    {
+        SynthesisPipelineOptions options;
+        options.lookahead = lookahead;
+        options.maxBytes = maxBytes;
+        return options;
+    }
+
+    // Gives the pipeline time to render past its limit if it would.
+    void Settle()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    TEST(SynthesisPipelineTest, HandsOverInSubmissionOrder)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(4), ready.GetCallback());
+        pipeline.Start();
+
+        for (int i = 0; i < 3; i++) pipeline.Submit(MakeRequest(std::to_wstring(i)));
+
+        for (int i = 0; i < 3; i++)
+        {
+            auto utterance = ready.Take();
+            EXPECT_EQ(utterance.id, static_cast<uint64_t>(i + 1));
+            EXPECT_EQ(utterance.request.speakXml, std::to_wstring(i));
+            ASSERT_NE(utterance.rendered, nullptr);
+            ASSERT_NE(utterance.source, nullptr);
+            // 100 ms of audio.
+            EXPECT_EQ(utterance.rendered->size(), 10u * kFormat.GetByteRate() / 100);
+            EXPECT_EQ(utterance.source->GetSize(), utterance.rendered->size());
+            pipeline.OnPlayed();
+        }
+
+        EXPECT_EQ(pipeline.GetStats().submitted, 3u);
+        EXPECT_EQ(pipeline.GetStats().rendered, 3u);
+    }
+
+    TEST(SynthesisPipelineTest, KeepsGivenSourcesInPlace)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(4), ready.GetCallback());
+        pipeline.Start();
+
+        auto cached = std::make_shared<PcmSource>(std::make_shared<const std::vector<uint8_t>>(100), kFormat);
+        pipeline.Submit(MakeRequest(L"0"));
+        pipeline.Submit(MakeRequest(L"1"), cached);
+        pipeline.Submit(MakeRequest(L"2"));
+
+        ASSERT_TRUE(ready.WaitFor(3));
+        ready.Take();
+        auto utterance = ready.Take();
+        EXPECT_EQ(utterance.request.speakXml, L"1");
+        EXPECT_EQ(utterance.source, cached);
+        EXPECT_EQ(utterance.rendered, nullptr);
+        EXPECT_EQ(ready.Take().request.speakXml, L"2");
+
+        EXPECT_EQ(pipeline.renders, 2);
+        EXPECT_EQ(pipeline.GetStats().rendered, 2u);
+    }
+
+    TEST(SynthesisPipelineTest, RendersLookaheadPastPlayingUtterance)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(2), ready.GetCallback());
+        pipeline.Start();
+
+        for (int i = 0; i < 6; i++) pipeline.Submit(MakeRequest(std::to_wstring(i)));
+
+        // The playing one and 2 ahead.
+        ASSERT_TRUE(ready.WaitFor(3));
+        Settle();
+        EXPECT_EQ(ready.GetCount(), 3u);
+
+        pipeline.OnPlayed();
+        ASSERT_TRUE(ready.WaitFor(4));
+        Settle();
+        EXPECT_EQ(ready.GetCount(), 4u);
+    }
+
+    TEST(SynthesisPipelineTest, WithoutLookaheadRendersAfterPlayback)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(0), ready.GetCallback());
+        pipeline.Start();
+
+        pipeline.Submit(MakeRequest(L"0"));
+        pipeline.Submit(MakeRequest(L"1"));
+
+        ASSERT_TRUE(ready.WaitFor(1));
+        Settle();
+        EXPECT_EQ(ready.GetCount(), 1u);
+
+        pipeline.OnPlayed();
+        EXPECT_TRUE(ready.WaitFor(2));
+    }
+
+    TEST(SynthesisPipelineTest, WaitingBytesLimitRendering)
+    {
+        // Below one utterance, only the next one is rendered while one is waiting.
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(4, 1000), ready.GetCallback());
+        pipeline.Start();
+
+        for (int i = 0; i < 4; i++) pipeline.Submit(MakeRequest(std::to_wstring(i)));
+
+        ASSERT_TRUE(ready.WaitFor(1));
+        Settle();
+        EXPECT_EQ(ready.GetCount(), 1u);
+
+        pipeline.OnPlayed();
+        ASSERT_TRUE(ready.WaitFor(2));
+
+        // Raised while waiting.
+        pipeline.SetOptions(MakeOptions(4));
+        EXPECT_TRUE(ready.WaitFor(4));
+    }
+
+    TEST(SynthesisPipelineTest, ReportsFailures)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(0), ready.GetCallback());
+        pipeline.Start();
+
+        pipeline.Submit(MakeRequest(L"fail"));
+        pipeline.Submit(MakeRequest(L"1"));
+
+        // Failures are not waiting to be played, the next one follows.
+        auto failed = ready.Take();
+        EXPECT_EQ(failed.request.speakXml, L"fail");
+        EXPECT_EQ(failed.source, nullptr);
+        EXPECT_EQ(failed.rendered, nullptr);
+        EXPECT_NE(ready.Take().source, nullptr);
+
+        EXPECT_EQ(pipeline.GetStats().failed, 1u);
+        EXPECT_EQ(pipeline.GetStats().rendered, 1u);
+    }
+
+    TEST(SynthesisPipelineTest, CancelStopsRunningRenderAndDropsPending)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(4), ready.GetCallback());
+        pipeline.Start();
+
+        pipeline.Submit(MakeRequest(L"block"));
+        pipeline.Submit(MakeRequest(L"1"));
+        pipeline.Submit(MakeRequest(L"2"));
+        while (pipeline.renders == 0) std::this_thread::yield();
+
+        EXPECT_EQ(pipeline.Cancel(), 3u);
+        Settle();
+        EXPECT_EQ(ready.GetCount(), 0u);
+        EXPECT_EQ(pipeline.renders, 1);
+        EXPECT_EQ(pipeline.GetStats().cancelled, 3u);
+
+        // Rendering resumes with the next submission.
+        auto id = pipeline.Submit(MakeRequest(L"3"));
+        auto utterance = ready.Take();
+        EXPECT_EQ(utterance.id, id);
+        EXPECT_NE(utterance.source, nullptr);
+    }
+
+    TEST(SynthesisPipelineTest, CancelForgetsWaitingUtterances)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(0), ready.GetCallback());
+        pipeline.Start();
+
+        pipeline.Submit(MakeRequest(L"0"));
+        ASSERT_TRUE(ready.WaitFor(1));
+        pipeline.Cancel();
+
+        // Not blocked by the utterance dropped by the player.
+        pipeline.Submit(MakeRequest(L"1"));
+        EXPECT_TRUE(ready.WaitFor(2));
+    }
+
+    TEST(SynthesisPipelineTest, StopCancelsAndRefusesSubmissions)
+    {
+        ReadyUtterances ready;
+        FakeSynthesisPipeline pipeline(kFormat, MakeOptions(1), ready.GetCallback());
+        pipeline.Start();
+
+        pipeline.Submit(MakeRequest(L"block"));
+        pipeline.Submit(MakeRequest(L"1"));
+        while (pipeline.renders == 0) std::this_thread::yield();
+
+        pipeline.Stop();
+        EXPECT_EQ(pipeline.threadStarts, 1);
+        EXPECT_EQ(pipeline.threadStops, 1);
+        EXPECT_EQ(ready.GetCount(), 0u);
+        EXPECT_EQ(pipeline.Submit(MakeRequest(L"2")), 0u);
+    }
+
+}
+}
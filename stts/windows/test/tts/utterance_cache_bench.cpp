@@ -0,0 +1,112 @@
+#include "tts/utterance_cache.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+    const size_t kEntryCount = 100000;
+    // Samples are shared, only the keys cost memory.
+    const size_t kSampleSize = 1024;
+
+    std::vector<UtteranceKey> MakeKeys(size_t count, size_t first = 0)
+    {
+        std::vector<UtteranceKey> keys;
+        keys.reserve(count);
+        for (size_t i = first; i < first + count; i++)
+        {
+            auto text = L"<speak><pitch absmiddle=\"0\">Prompt number " + std::to_wstring(i) + L" is ready.</pitch></speak>";
+            keys.push_back(UtteranceKey::Create("HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Speech\\Voices\\Tokens\\TTS_MS_EN-US_ZIRA_11.0", 0, 0, 100, text));
+        }
+        return keys;
+    }
+
+    // Full cache of kEntryCount entries.
+    void Fill(UtteranceCache& cache, const std::vector<UtteranceKey>& keys, const std::shared_ptr<const std::vector<uint8_t>>& samples)
+    {
+        size_t budget = 0;
+        for (const auto& key : keys) budget += kSampleSize + key.identity.size();
+
+        cache.SetBudget(budget);
+        for (const auto& key : keys) cache.Insert(key, kFormat, samples);
+    }
+
+    void BM_UtteranceCacheFindHit(benchmark::State& state)
+    {
+        auto keys = MakeKeys(kEntryCount);
+        auto samples = std::make_shared<const std::vector<uint8_t>>(kSampleSize);
+        UtteranceCache cache;
+        Fill(cache, keys, samples);
+
+        size_t i = 0;
+        CachedUtterance utterance;
+        for (auto _ : state)
+        {
+            // Spread over the whole list, recency changes on every hit.
+            benchmark::DoNotOptimize(cache.Find(keys[i], utterance));
+            i = (i + 7919) % keys.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UtteranceCacheFindHit);
+
+    void BM_UtteranceCacheFindMiss(benchmark::State& state)
+    {
+        auto keys = MakeKeys(kEntryCount);
+        auto missing = MakeKeys(1024, kEntryCount);
+        auto samples = std::make_shared<const std::vector<uint8_t>>(kSampleSize);
+        UtteranceCache cache;
+        Fill(cache, keys, samples);
+
+        size_t i = 0;
+        CachedUtterance utterance;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(cache.Find(missing[i], utterance));
+            i = (i + 1) % missing.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UtteranceCacheFindMiss);
+
+    // Each insertion evicts the least recently used entry.
+    void BM_UtteranceCacheInsertEvict(benchmark::State& state)
+    {
+        auto keys = MakeKeys(kEntryCount * 2);
+        auto samples = std::make_shared<const std::vector<uint8_t>>(kSampleSize);
+        UtteranceCache cache;
+        Fill(cache, std::vector<UtteranceKey>(keys.begin(), keys.begin() + kEntryCount), samples);
+
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            cache.Insert(keys[i], kFormat, samples);
+            i = (i + 1) % keys.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["evictions"] = static_cast<double>(cache.GetStats().evictions);
+    }
+    BENCHMARK(BM_UtteranceCacheInsertEvict);
+
+    // Includes building the identity and hashing the SAPI XML.
+    void BM_UtteranceKeyCreate(benchmark::State& state)
+    {
+        std::wstring text = L"<speak><pitch absmiddle=\"0\">";
+        text.append(static_cast<size_t>(state.range(0)), L'a');
+        text += L"</pitch></speak>";
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(UtteranceKey::Create("voice", 0, 0, 100, text));
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size() * sizeof(wchar_t)));
+    }
+    BENCHMARK(BM_UtteranceKeyCreate)->Arg(64)->Arg(4096);
+
+}
+}
@@ -0,0 +1,195 @@
+#include "tts/utterance_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+
+    UtteranceKey MakeKey(const std::wstring& text)
+    {
+        return UtteranceKey::Create("voice", 0, 0, 100, text);
+    }
+
+    std::shared_ptr<const std::vector<uint8_t>> MakeSamples(size_t size, uint8_t value = 0)
+    {
+        return std::make_shared<const std::vector<uint8_t>>(size, value);
+    }
+
+    // Budget for count entries of the given sample size, keys of MakeKey(L"n") with n < 10.
+    size_t GetBudget(size_t count, size_t sampleSize)
+    {
+        return count * (sampleSize + MakeKey(L"0").identity.size());
+    }
+
+    TEST(UtteranceKeyTest, DependsOnEverySetting)
+    {
+        auto key = UtteranceKey::Create("voice", 0, 0, 100, L"text");
+
+        EXPECT_EQ(UtteranceKey::Create("voice", 0, 0, 100, L"text").hash, key.hash);
+        EXPECT_NE(UtteranceKey::Create("other", 0, 0, 100, L"text").hash, key.hash);
+        EXPECT_NE(UtteranceKey::Create("voice", 1, 0, 100, L"text").hash, key.hash);
+        EXPECT_NE(UtteranceKey::Create("voice", 0, -1, 100, L"text").hash, key.hash);
+        EXPECT_NE(UtteranceKey::Create("voice", 0, 0, 50, L"text").hash, key.hash);
+        EXPECT_NE(UtteranceKey::Create("voice", 0, 0, 100, L"Text").hash, key.hash);
+    }
+
+    TEST(UtteranceKeyTest, SeparatesFields)
+    {
+        // Same characters, split differently between the fields.
+        EXPECT_NE(UtteranceKey::Create("voice1", 0, 0, 100, L"text").identity,
+            UtteranceKey::Create("voice", 10, 0, 100, L"text").identity);
+        EXPECT_NE(UtteranceKey::Create("voice", 1, 10, 100, L"text").identity,
+            UtteranceKey::Create("voice", 11, 0, 100, L"text").identity);
+    }
+
+    TEST(UtteranceCacheTest, IsDisabledWithoutBudget)
+    {
+        UtteranceCache cache;
+        EXPECT_FALSE(cache.IsEnabled());
+
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(10));
+
+        CachedUtterance utterance;
+        EXPECT_FALSE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_EQ(cache.GetStats().entries, 0u);
+    }
+
+    TEST(UtteranceCacheTest, FindsInsertedSamples)
+    {
+        UtteranceCache cache(1 << 20);
+        auto samples = MakeSamples(100, 7);
+        cache.Insert(MakeKey(L"1"), kFormat, samples);
+
+        CachedUtterance utterance;
+        ASSERT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_EQ(utterance.samples, samples);
+        EXPECT_EQ(utterance.format.sampleRate, kFormat.sampleRate);
+
+        EXPECT_FALSE(cache.Find(MakeKey(L"2"), utterance));
+
+        const auto& stats = cache.GetStats();
+        EXPECT_EQ(stats.hits, 1u);
+        EXPECT_EQ(stats.misses, 1u);
+        EXPECT_EQ(stats.insertions, 1u);
+        EXPECT_EQ(stats.entries, 1u);
+        EXPECT_EQ(stats.bytes, 100 + MakeKey(L"1").identity.size());
+    }
+
+    TEST(UtteranceCacheTest, ReplacesExistingEntry)
+    {
+        UtteranceCache cache(1 << 20);
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100, 1));
+        auto replacement = MakeSamples(50, 2);
+        cache.Insert(MakeKey(L"1"), kFormat, replacement);
+
+        CachedUtterance utterance;
+        ASSERT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_EQ(utterance.samples, replacement);
+        EXPECT_EQ(cache.GetStats().entries, 1u);
+        EXPECT_EQ(cache.GetStats().bytes, 50 + MakeKey(L"1").identity.size());
+        EXPECT_EQ(cache.GetStats().evictions, 0u);
+    }
+
+    TEST(UtteranceCacheTest, EvictsLeastRecentlyUsed)
+    {
+        UtteranceCache cache(GetBudget(3, 100));
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100));
+        cache.Insert(MakeKey(L"2"), kFormat, MakeSamples(100));
+        cache.Insert(MakeKey(L"3"), kFormat, MakeSamples(100));
+
+        // 1 becomes the most recently used, 2 goes first.
+        CachedUtterance utterance;
+        ASSERT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        cache.Insert(MakeKey(L"4"), kFormat, MakeSamples(100));
+
+        EXPECT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_FALSE(cache.Find(MakeKey(L"2"), utterance));
+        EXPECT_TRUE(cache.Find(MakeKey(L"3"), utterance));
+        EXPECT_TRUE(cache.Find(MakeKey(L"4"), utterance));
+        EXPECT_EQ(cache.GetStats().evictions, 1u);
+        EXPECT_EQ(cache.GetStats().entries, 3u);
+    }
+
+    TEST(UtteranceCacheTest, DropsEntriesLargerThanBudget)
+    {
+        UtteranceCache cache(GetBudget(1, 100));
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100));
+        cache.Insert(MakeKey(L"2"), kFormat, MakeSamples(101));
+
+        CachedUtterance utterance;
+        EXPECT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_FALSE(cache.Find(MakeKey(L"2"), utterance));
+        EXPECT_EQ(cache.GetStats().evictions, 0u);
+    }
+
+    TEST(UtteranceCacheTest, ShrinkingBudgetEvicts)
+    {
+        UtteranceCache cache(GetBudget(4, 100));
+        for (auto text : { L"1", L"2", L"3", L"4" })
+        {
+            cache.Insert(MakeKey(text), kFormat, MakeSamples(100));
+        }
+
+        cache.SetBudget(GetBudget(2, 100));
+
+        CachedUtterance utterance;
+        EXPECT_FALSE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_FALSE(cache.Find(MakeKey(L"2"), utterance));
+        EXPECT_TRUE(cache.Find(MakeKey(L"3"), utterance));
+        EXPECT_TRUE(cache.Find(MakeKey(L"4"), utterance));
+        EXPECT_EQ(cache.GetStats().evictions, 2u);
+
+        cache.SetBudget(0);
+        EXPECT_FALSE(cache.IsEnabled());
+        EXPECT_EQ(cache.GetStats().entries, 0u);
+        EXPECT_EQ(cache.GetStats().bytes, 0u);
+    }
+
+    TEST(UtteranceCacheTest, HashCollisionIsMiss)
+    {
+        UtteranceCache cache(1 << 20);
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100));
+
+        auto colliding = MakeKey(L"2");
+        colliding.hash = MakeKey(L"1").hash;
+
+        CachedUtterance utterance;
+        EXPECT_FALSE(cache.Find(colliding, utterance));
+        EXPECT_EQ(cache.GetStats().misses, 1u);
+    }
+
+    TEST(UtteranceCacheTest, EvictedSamplesStayValid)
+    {
+        UtteranceCache cache(GetBudget(1, 100));
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100, 9));
+
+        CachedUtterance utterance;
+        ASSERT_TRUE(cache.Find(MakeKey(L"1"), utterance));
+        cache.Insert(MakeKey(L"2"), kFormat, MakeSamples(100));
+
+        // Still played by the voice.
+        ASSERT_EQ(utterance.samples->size(), 100u);
+        EXPECT_EQ(utterance.samples->front(), 9);
+    }
+
+    TEST(UtteranceCacheTest, ClearKeepsCounters)
+    {
+        UtteranceCache cache(1 << 20);
+        cache.Insert(MakeKey(L"1"), kFormat, MakeSamples(100));
+        cache.Clear();
+
+        CachedUtterance utterance;
+        EXPECT_FALSE(cache.Find(MakeKey(L"1"), utterance));
+        EXPECT_EQ(cache.GetStats().entries, 0u);
+        EXPECT_EQ(cache.GetStats().bytes, 0u);
+        EXPECT_EQ(cache.GetStats().insertions, 1u);
+    }
+
+}
+}
@@ -0,0 +1,99 @@
+#include "tts/utterance_scheduler.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "fake_speech_output.h"
+
+namespace stts {
+namespace {
+
+    // Plays the oldest queued chunk to the end.
+    void PlayNext(UtteranceScheduler& scheduler, FakeSpeechOutput& output, UtteranceScheduler::Clock::time_point now)
+    {
+        auto handle = output.queued.front().handle;
+        scheduler.OnChunkStarted(handle);
+        if (output.queued.empty() || output.queued.front().handle != handle)
+        {
+            scheduler.Pump(now);
+            return;
+        }
+
+        output.queued.pop_front();
+        scheduler.OnChunkEnded(handle);
+        scheduler.Pump(now);
+    }
+
+    // Prompts queued behind range(0) others, from Add to the finished event.
+    void BM_UtteranceSchedulerPrompt(benchmark::State& state)
+    {
+        FakeSpeechOutput output;
+        uint64_t finished = 0;
+        UtteranceScheduler scheduler(&output, [&finished](uint64_t, UtteranceEvent event) {
+            if (event == UtteranceEvent::finished) finished++;
+        });
+        auto now = UtteranceScheduler::Clock::now();
+
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            ScheduledUtterance utterance;
+            utterance.text = "Queued prompt.";
+            scheduler.Add(std::move(utterance));
+        }
+        scheduler.Pump(now);
+
+        for (auto _ : state)
+        {
+            ScheduledUtterance utterance;
+            utterance.text = "You have a new message.";
+            scheduler.Add(std::move(utterance));
+            PlayNext(scheduler, output, now);
+        }
+
+        benchmark::DoNotOptimize(finished);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UtteranceSchedulerPrompt)->Arg(0)->Arg(1000);
+
+    // An alert interrupting a long read and the read resuming, range(0) prompts waiting behind it.
+    void BM_UtteranceSchedulerPreemption(benchmark::State& state)
+    {
+        FakeSpeechOutput output;
+        UtteranceScheduler scheduler(&output, [](uint64_t, UtteranceEvent) {});
+        auto now = UtteranceScheduler::Clock::now();
+
+        std::string article;
+        for (int i = 0; i < 1000; i++) article += "This sentence belongs to a long article. ";
+
+        ScheduledUtterance read;
+        read.text = article;
+        scheduler.Add(std::move(read));
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            ScheduledUtterance utterance;
+            utterance.text = "Queued prompt.";
+            scheduler.Add(std::move(utterance));
+        }
+        scheduler.Pump(now);
+        scheduler.OnChunkStarted(output.queued.front().handle);
+
+        for (auto _ : state)
+        {
+            ScheduledUtterance alert;
+            alert.text = "Battery low.";
+            alert.priority = 1;
+            scheduler.Add(std::move(alert));
+            scheduler.Pump(now);
+
+            // Alert, then the interrupted chunk starts again.
+            PlayNext(scheduler, output, now);
+            scheduler.OnChunkStarted(output.queued.front().handle);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UtteranceSchedulerPreemption)->Arg(0)->Arg(1000);
+
+}
+}
@@ -0,0 +1,424 @@
+#include "tts/utterance_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fake_speech_output.h"
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    using Event = std::pair<uint64_t, UtteranceEvent>;
+    using Events = std::vector<Event>;
+    using Texts = std::vector<std::string>;
+
+    class UtteranceSchedulerTest : public testing::Test {
+    protected:
+        using Clock = UtteranceScheduler::Clock;
+
+        FakeSpeechOutput output;
+        Events events;
+        Clock::time_point now = Clock::time_point() + 1h;
+        std::unique_ptr<UtteranceScheduler> scheduler;
+
+        void SetUp() override
+        {
+            // One sentence per chunk.
+            SentenceSegmenterOptions options;
+            options.targetLength = 0;
+            Create(options);
+        }
+
+        void Create(const SentenceSegmenterOptions& options)
+        {
+            scheduler = std::make_unique<UtteranceScheduler>(&output, [this](uint64_t id, UtteranceEvent event) {
+                events.emplace_back(id, event);
+            }, options);
+        }
+
+        uint64_t Add(const std::string& text, int priority = 0, Clock::time_point deadline = Clock::time_point::max())
+        {
+            ScheduledUtterance utterance;
+            utterance.text = text;
+            utterance.priority = priority;
+            utterance.deadline = deadline;
+            return scheduler->Add(std::move(utterance));
+        }
+
+        // Starts the oldest queued chunk and returns its text. Empty if the chunk was purged when it started,
+        // the next ones are queued then.
+        std::string Start()
+        {
+            auto chunk = output.queued.front();
+            scheduler->OnChunkStarted(chunk.handle);
+            if (output.queued.empty() || output.queued.front().handle != chunk.handle)
+            {
+                scheduler->Pump(now);
+                return std::string();
+            }
+            return chunk.text;
+        }
+
+        // Ends the started chunk and queues the next ones.
+        void End()
+        {
+            auto handle = output.queued.front().handle;
+            output.queued.pop_front();
+            scheduler->OnChunkEnded(handle);
+            scheduler->Pump(now);
+        }
+
+        // Plays queued chunks until none is left, returns the texts played.
+        Texts PlayAll()
+        {
+            Texts played;
+            while (!output.queued.empty())
+            {
+                auto text = Start();
+                if (text.empty()) continue;
+
+                played.push_back(text);
+                End();
+            }
+            return played;
+        }
+    };
+
+    TEST_F(UtteranceSchedulerTest, SpeaksInOrder)
+    {
+        auto first = Add("One.");
+        auto second = Add("Two.");
+        EXPECT_EQ(first, 1u);
+        EXPECT_EQ(second, 2u);
+        EXPECT_TRUE(output.queued.empty());
+
+        EXPECT_TRUE(scheduler->Pump(now));
+        EXPECT_EQ(PlayAll(), (Texts{ "One.", "Two." }));
+        EXPECT_EQ(events, (Events{
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::finished },
+            { second, UtteranceEvent::started }, { second, UtteranceEvent::finished } }));
+        EXPECT_TRUE(scheduler->IsEmpty());
+        EXPECT_EQ(output.purgeCount, 0u);
+    }
+
+    TEST_F(UtteranceSchedulerTest, KeepsChunksAheadQueued)
+    {
+        Add("One.");
+        Add("Two.");
+        Add("Three.");
+
+        scheduler->SetChunksAhead(1);
+        scheduler->Pump(now);
+        EXPECT_EQ(output.queued.size(), 1u);
+
+        scheduler->SetChunksAhead(2);
+        scheduler->Pump(now);
+        EXPECT_EQ(output.queued.size(), 2u);
+
+        // The next one is queued when a chunk ends.
+        Start();
+        End();
+        EXPECT_EQ(output.queued.size(), 2u);
+        EXPECT_EQ(output.queued.back().text, "Three.");
+
+        scheduler->SetChunksAhead(0);
+        EXPECT_EQ(PlayAll(), (Texts{ "Two.", "Three." }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, ReportsChunkedTextAsOneUtterance)
+    {
+        // Text positions are in UTF-16 code units.
+        auto id = Add("Caf\xC3\xA9 ouvert. Th\xC3\xA9 chaud. Cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e. Fin.");
+        scheduler->Pump(now);
+
+        std::string joined;
+        size_t textPosition = 0;
+        while (!output.queued.empty())
+        {
+            EXPECT_EQ(output.queued.front().textPosition, textPosition);
+
+            auto text = Start();
+            joined += text;
+            for (auto c : text) textPosition += (static_cast<uint8_t>(c) & 0xC0) != 0x80 ? 1 : 0;
+            End();
+        }
+
+        EXPECT_EQ(output.speakCount, 4u);
+        EXPECT_EQ(joined, "Caf\xC3\xA9 ouvert. Th\xC3\xA9 chaud. Cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e. Fin.");
+        EXPECT_EQ(events, (Events{ { id, UtteranceEvent::started }, { id, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, GathersSentencesUpToTarget)
+    {
+        SentenceSegmenterOptions options;
+        options.targetLength = 12;
+        options.maxLength = 40;
+        Create(options);
+
+        Add("Go. Two. Three. Four. Five.");
+        scheduler->SetChunksAhead(1);
+        scheduler->Pump(now);
+        EXPECT_EQ(PlayAll(), (Texts{ "Go. ", "Two. Three. ", "Four. Five." }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, HigherPriorityJumpsTheQueue)
+    {
+        scheduler->SetChunksAhead(1);
+        auto first = Add("Low one.");
+        auto second = Add("Low two.");
+        scheduler->Pump(now);
+
+        // Not started yet, the queued chunk is purged without interruption.
+        auto urgent = Add("Urgent.", 1);
+        EXPECT_EQ(output.purgeCount, 1u);
+        scheduler->Pump(now);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "Urgent.", "Low one.", "Low two." }));
+        EXPECT_EQ(events, (Events{
+            { urgent, UtteranceEvent::started }, { urgent, UtteranceEvent::finished },
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::finished },
+            { second, UtteranceEvent::started }, { second, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, SamePriorityWaitsItsTurn)
+    {
+        auto first = Add("First.", 1);
+        auto low = Add("Low.");
+        auto second = Add("Second.", 1);
+        scheduler->Pump(now);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "First.", "Second.", "Low." }));
+        EXPECT_EQ(events.front(), Event(first, UtteranceEvent::started));
+        EXPECT_EQ(events[2], Event(second, UtteranceEvent::started));
+        EXPECT_EQ(events[4], Event(low, UtteranceEvent::started));
+    }
+
+    TEST_F(UtteranceSchedulerTest, PreemptsLowerPriorityAndResumes)
+    {
+        auto story = Add("First sentence. Second sentence. Third sentence.");
+        scheduler->Pump(now);
+        EXPECT_EQ(Start(), "First sentence. ");
+        End();
+        EXPECT_EQ(Start(), "Second sentence. ");
+
+        auto alert = Add("Alert.", 1);
+        EXPECT_EQ(output.purgeCount, 1u);
+        EXPECT_TRUE(output.queued.empty());
+        scheduler->Pump(now);
+
+        // Resumes from the interrupted chunk.
+        EXPECT_EQ(PlayAll(), (Texts{ "Alert.", "Second sentence. ", "Third sentence." }));
+        EXPECT_EQ(events, (Events{
+            { story, UtteranceEvent::started }, { story, UtteranceEvent::interrupted },
+            { alert, UtteranceEvent::started }, { alert, UtteranceEvent::finished },
+            { story, UtteranceEvent::started }, { story, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, RewindsBookmarksWhenPreempted)
+    {
+        ScheduledUtterance utterance;
+        utterance.text = "One. Two. Three.";
+        utterance.bookmarks = { { 0, "a" }, { 5, "b" }, { 10, "c" } };
+        utterance.bookmarkBytes = { 0, 5, 10 };
+        scheduler->Add(std::move(utterance));
+        scheduler->Pump(now);
+
+        Start();
+        End();
+        Start();
+        ASSERT_EQ(output.queued.size(), 2u);
+        EXPECT_EQ(output.queued.back().firstBookmark, 2u);
+
+        Add("Alert.", 1);
+        scheduler->Pump(now);
+
+        ASSERT_EQ(output.queued.size(), 2u);
+        EXPECT_EQ(output.queued.back().text, "Two. ");
+        EXPECT_EQ(output.queued.back().textPosition, 5u);
+        EXPECT_EQ(output.queued.back().firstBookmark, 1u);
+        EXPECT_EQ(output.queued.back().bookmarkCount, 1u);
+    }
+
+    TEST_F(UtteranceSchedulerTest, DoesNotCutHigherPriorityChunk)
+    {
+        auto first = Add("Alert one.", 1);
+        auto low = Add("Low.");
+        scheduler->Pump(now);
+        EXPECT_EQ(Start(), "Alert one.");
+
+        // The low chunk queued behind the playing one is dropped when it starts.
+        auto second = Add("Alert two.", 1);
+        EXPECT_EQ(output.purgeCount, 0u);
+        scheduler->Pump(now);
+        EXPECT_EQ(output.queued.size(), 2u);
+
+        End();
+        EXPECT_EQ(Start(), "");
+        EXPECT_EQ(output.purgeCount, 1u);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "Alert two.", "Low." }));
+        EXPECT_EQ(events, (Events{
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::finished },
+            { second, UtteranceEvent::started }, { second, UtteranceEvent::finished },
+            { low, UtteranceEvent::started }, { low, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, DroppedChunksSkippedWithoutStarting)
+    {
+        Add("Alert one.", 1);
+        auto low = Add("Low.");
+        scheduler->Pump(now);
+        Start();
+        Add("Alert two.", 1);
+
+        // The voice may skip the stale chunk, e.g. once purged by another application.
+        End();
+        auto handle = output.queued.front().handle;
+        output.queued.pop_front();
+        scheduler->OnChunkEnded(handle);
+        EXPECT_EQ(output.purgeCount, 1u);
+        scheduler->Pump(now);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "Alert two.", "Low." }));
+        EXPECT_EQ(events.back(), Event(low, UtteranceEvent::finished));
+    }
+
+    TEST_F(UtteranceSchedulerTest, CancelsById)
+    {
+        auto first = Add("A.");
+        auto second = Add("B.");
+        auto third = Add("C.");
+        auto fourth = Add("D.");
+        scheduler->Pump(now);
+
+        EXPECT_TRUE(scheduler->Cancel(second));
+        EXPECT_TRUE(scheduler->Cancel(third));
+        EXPECT_FALSE(scheduler->Cancel(second));
+        EXPECT_FALSE(scheduler->Cancel(42));
+        EXPECT_FALSE(scheduler->Contains(second));
+        EXPECT_TRUE(scheduler->Contains(fourth));
+        EXPECT_EQ(scheduler->GetCount(), 2u);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "A.", "D." }));
+        EXPECT_EQ(events, (Events{
+            { second, UtteranceEvent::cancelled }, { third, UtteranceEvent::cancelled },
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::finished },
+            { fourth, UtteranceEvent::started }, { fourth, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, CancelStopsTheUtteranceSpeaking)
+    {
+        auto first = Add("First. Still first.");
+        auto second = Add("Second.");
+        scheduler->Pump(now);
+        Start();
+
+        EXPECT_TRUE(scheduler->Cancel(first));
+        EXPECT_EQ(output.purgeCount, 1u);
+        scheduler->Pump(now);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "Second." }));
+        EXPECT_EQ(events, (Events{
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::cancelled },
+            { second, UtteranceEvent::started }, { second, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, CancelAllPurgesOnce)
+    {
+        scheduler->CancelAll();
+        EXPECT_EQ(output.purgeCount, 0u);
+
+        auto first = Add("One.");
+        auto second = Add("Two.");
+        auto third = Add("Three.");
+        scheduler->Pump(now);
+        Start();
+
+        scheduler->CancelAll();
+        EXPECT_EQ(output.purgeCount, 1u);
+        EXPECT_TRUE(scheduler->IsEmpty());
+        EXPECT_EQ(events, (Events{
+            { first, UtteranceEvent::started }, { first, UtteranceEvent::cancelled },
+            { second, UtteranceEvent::cancelled }, { third, UtteranceEvent::cancelled } }));
+
+        // Chunks purged before the cancellation are not reported.
+        scheduler->OnChunkEnded(1);
+        EXPECT_EQ(events.size(), 4u);
+    }
+
+    TEST_F(UtteranceSchedulerTest, DropsExpiredUtterances)
+    {
+        auto first = Add("Now.");
+        auto late = Add("Late.", 0, now + 1s);
+        auto expired = Add("Expired.", 0, now);
+        EXPECT_EQ(scheduler->GetNextDeadline(), now);
+
+        scheduler->Pump(now);
+        EXPECT_EQ(events, (Events{ { expired, UtteranceEvent::expired } }));
+        EXPECT_EQ(scheduler->GetNextDeadline(), now + 1s);
+        Start();
+
+        now += 2s;
+        scheduler->Pump(now);
+        EXPECT_EQ(PlayAll(), (Texts{ "Now." }));
+        EXPECT_EQ(events, (Events{
+            { expired, UtteranceEvent::expired }, { first, UtteranceEvent::started },
+            { late, UtteranceEvent::expired }, { first, UtteranceEvent::finished } }));
+        EXPECT_EQ(scheduler->GetNextDeadline(), UtteranceScheduler::Clock::time_point::max());
+    }
+
+    TEST_F(UtteranceSchedulerTest, StartedUtterancesDoNotExpire)
+    {
+        auto id = Add("One. Two.", 0, now + 1s);
+        scheduler->Pump(now);
+        Start();
+        EXPECT_EQ(scheduler->GetNextDeadline(), UtteranceScheduler::Clock::time_point::max());
+
+        // Not even when interrupted.
+        Add("Alert.", 1);
+        now += 2s;
+        scheduler->Pump(now);
+
+        EXPECT_EQ(PlayAll(), (Texts{ "Alert.", "One. ", "Two." }));
+        EXPECT_EQ(events.back(), Event(id, UtteranceEvent::finished));
+    }
+
+    TEST_F(UtteranceSchedulerTest, CancelsUtteranceWhoseFirstChunkFails)
+    {
+        auto failed = Add("Fail.");
+        auto next = Add("Next.");
+
+        EXPECT_FALSE(scheduler->Pump(now));
+        EXPECT_EQ(PlayAll(), (Texts{ "Next." }));
+        EXPECT_EQ(events, (Events{
+            { failed, UtteranceEvent::cancelled },
+            { next, UtteranceEvent::started }, { next, UtteranceEvent::finished } }));
+    }
+
+    TEST_F(UtteranceSchedulerTest, EndsUtteranceAtLastQueuedChunkOnFailure)
+    {
+        auto id = Add("Works. Fail here. Never spoken.");
+
+        EXPECT_FALSE(scheduler->Pump(now));
+        EXPECT_EQ(PlayAll(), (Texts{ "Works. " }));
+        EXPECT_EQ(events, (Events{ { id, UtteranceEvent::started }, { id, UtteranceEvent::finished } }));
+        EXPECT_TRUE(scheduler->IsEmpty());
+    }
+
+    TEST_F(UtteranceSchedulerTest, IgnoresUnknownChunks)
+    {
+        scheduler->OnChunkStarted(42);
+        scheduler->OnChunkEnded(42);
+        EXPECT_TRUE(events.empty());
+        EXPECT_EQ(output.purgeCount, 0u);
+    }
+
+}
+}
@@ -0,0 +1,139 @@
+#include "tts/utterance_store.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+
+    UtteranceKey MakeKey(int number)
+    {
+        return UtteranceKey::Create("voice", 0, 0, 100, L"<speak>Prompt number " + std::to_wstring(number) + L" is ready.</speak>");
+    }
+
+    // Empty directory removed with the instance.
+    class StoreDirectory {
+    public:
+        StoreDirectory() { Clear(); }
+
+        ~StoreDirectory() { std::filesystem::remove_all(m_path); }
+
+        std::string GetBasePath() const { return (m_path / "store").u8string(); }
+
+        void Clear()
+        {
+            std::filesystem::remove_all(m_path);
+            std::filesystem::create_directories(m_path);
+        }
+
+    private:
+        std::filesystem::path m_path = std::filesystem::temp_directory_path() / "stts_utterance_store_bench";
+    };
+
+    // Replay of a stored prompt, range(0) bytes of samples, 1000 prompts.
+    void BM_UtteranceStoreFind(benchmark::State& state)
+    {
+        const int count = 1000;
+        auto size = static_cast<size_t>(state.range(0));
+        StoreDirectory directory;
+        UtteranceStoreOptions options;
+        options.maxBytes = 1ULL << 30;
+        auto store = UtteranceStore::Open(directory.GetBasePath(), options);
+
+        std::vector<UtteranceKey> keys;
+        std::vector<uint8_t> samples(size, 1);
+        for (int i = 0; i < count; i++)
+        {
+            keys.push_back(MakeKey(i));
+            store->Put(keys.back(), kFormat, samples.data(), samples.size());
+        }
+
+        size_t i = 0;
+        uint64_t checksum = 0;
+        for (auto _ : state)
+        {
+            StoredUtterance utterance;
+            store->Find(keys[i], utterance);
+            // Touches the samples as the voice would.
+            for (size_t offset = 0; offset < utterance.size; offset += 4096) checksum += utterance.samples.get()[offset];
+            i = (i + 1) % keys.size();
+        }
+        benchmark::DoNotOptimize(checksum);
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_UtteranceStoreFind)->Arg(4 << 10)->Arg(256 << 10);
+
+    void BM_UtteranceStoreFindMiss(benchmark::State& state)
+    {
+        StoreDirectory directory;
+        auto store = UtteranceStore::Open(directory.GetBasePath(), UtteranceStoreOptions());
+        std::vector<uint8_t> samples(1024, 1);
+        for (int i = 0; i < 1000; i++) store->Put(MakeKey(i), kFormat, samples.data(), samples.size());
+
+        auto key = MakeKey(-1);
+        for (auto _ : state)
+        {
+            StoredUtterance utterance;
+            benchmark::DoNotOptimize(store->Find(key, utterance));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UtteranceStoreFindMiss);
+
+    // Each put is on disk before returning, range(0) bytes of samples.
+    // The store is recreated when full, outside of the measure.
+    void BM_UtteranceStorePut(benchmark::State& state)
+    {
+        auto size = static_cast<size_t>(state.range(0));
+        StoreDirectory directory;
+        UtteranceStoreOptions options;
+        options.maxBytes = 64ULL << 20;
+        options.indexCapacity = 1 << 16;
+
+        std::unique_ptr<UtteranceStore> store;
+        int number = 0;
+        std::vector<uint8_t> samples(size, 1);
+        for (auto _ : state)
+        {
+            auto key = MakeKey(number++);
+            if (!store || !store->Put(key, kFormat, samples.data(), samples.size()))
+            {
+                state.PauseTiming();
+                store.reset();
+                directory.Clear();
+                store = UtteranceStore::Open(directory.GetBasePath(), options);
+                state.ResumeTiming();
+
+                store->Put(key, kFormat, samples.data(), samples.size());
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_UtteranceStorePut)->Arg(4 << 10)->Arg(256 << 10);
+
+    // Session start with 1000 stored prompts.
+    void BM_UtteranceStoreOpen(benchmark::State& state)
+    {
+        StoreDirectory directory;
+        {
+            auto store = UtteranceStore::Open(directory.GetBasePath(), UtteranceStoreOptions());
+            std::vector<uint8_t> samples(16 << 10, 1);
+            for (int i = 0; i < 1000; i++) store->Put(MakeKey(i), kFormat, samples.data(), samples.size());
+        }
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(UtteranceStore::Open(directory.GetBasePath(), UtteranceStoreOptions()));
+        }
+    }
+    BENCHMARK(BM_UtteranceStoreOpen);
+
+}
+}
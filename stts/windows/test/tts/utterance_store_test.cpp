@@ -0,0 +1,369 @@
+#include "tts/utterance_store.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    const PcmFormat kFormat{ 1, 22050, 16 };
+
+    UtteranceKey MakeKey(int number)
+    {
+        return UtteranceKey::Create("voice", 0, 0, 100, L"Prompt " + std::to_wstring(number));
+    }
+
+    // Content depends on the key, mixed up records are detected.
+    std::vector<uint8_t> MakeSamples(int number, size_t size)
+    {
+        std::vector<uint8_t> samples(size);
+        for (size_t i = 0; i < size; i++) samples[i] = static_cast<uint8_t>(number * 31 + i);
+        return samples;
+    }
+
+    std::vector<uint8_t> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    class UtteranceStoreTest : public testing::Test {
+    protected:
+        std::filesystem::path m_directory = std::filesystem::temp_directory_path() / "stts_utterance_store_test";
+        UtteranceStoreOptions m_options;
+
+        void SetUp() override
+        {
+            std::filesystem::remove_all(m_directory);
+            std::filesystem::create_directories(m_directory);
+        }
+
+        void TearDown() override { std::filesystem::remove_all(m_directory); }
+
+        std::string GetBasePath() const { return (m_directory / "store").u8string(); }
+        std::filesystem::path GetFilePath(uint64_t generation, const char* extension) const
+        {
+            return m_directory / ("store-" + std::to_string(generation) + extension);
+        }
+
+        std::unique_ptr<UtteranceStore> Open()
+        {
+            auto store = UtteranceStore::Open(GetBasePath(), m_options);
+            EXPECT_NE(store, nullptr);
+            return store;
+        }
+
+        static bool Put(UtteranceStore& store, int number, size_t size = 256)
+        {
+            auto samples = MakeSamples(number, size);
+            return store.Put(MakeKey(number), kFormat, samples.data(), samples.size());
+        }
+
+        // Finds the utterance and checks its samples.
+        static bool Contains(UtteranceStore& store, int number, size_t size = 256)
+        {
+            StoredUtterance utterance;
+            if (!store.Find(MakeKey(number), utterance)) return false;
+
+            auto expected = MakeSamples(number, size);
+            EXPECT_EQ(utterance.size, size);
+            EXPECT_EQ(utterance.format.sampleRate, kFormat.sampleRate);
+            EXPECT_EQ(std::vector<uint8_t>(utterance.samples.get(), utterance.samples.get() + utterance.size), expected);
+            return true;
+        }
+    };
+
+    TEST_F(UtteranceStoreTest, FindsPutUtterances)
+    {
+        auto store = Open();
+        ASSERT_TRUE(Put(*store, 1));
+        ASSERT_TRUE(Put(*store, 2, 1000));
+
+        EXPECT_TRUE(Contains(*store, 1));
+        EXPECT_TRUE(Contains(*store, 2, 1000));
+        EXPECT_FALSE(Contains(*store, 3));
+
+        auto stats = store->GetStats();
+        EXPECT_EQ(stats.puts, 2u);
+        EXPECT_EQ(stats.hits, 2u);
+        EXPECT_EQ(stats.misses, 1u);
+        EXPECT_EQ(stats.entries, 2u);
+    }
+
+    TEST_F(UtteranceStoreTest, ReplacesUtteranceWithSameKey)
+    {
+        auto store = Open();
+        ASSERT_TRUE(Put(*store, 1, 100));
+        ASSERT_TRUE(Put(*store, 1, 300));
+
+        EXPECT_TRUE(Contains(*store, 1, 300));
+        EXPECT_EQ(store->GetStats().entries, 1u);
+    }
+
+    TEST_F(UtteranceStoreTest, SeparatesKeysWithSameHash)
+    {
+        auto store = Open();
+        auto first = MakeKey(1);
+        auto second = MakeKey(2);
+        second.hash = first.hash;
+
+        auto firstSamples = MakeSamples(1, 64);
+        auto secondSamples = MakeSamples(2, 64);
+        ASSERT_TRUE(store->Put(first, kFormat, firstSamples.data(), firstSamples.size()));
+        ASSERT_TRUE(store->Put(second, kFormat, secondSamples.data(), secondSamples.size()));
+
+        StoredUtterance utterance;
+        ASSERT_TRUE(store->Find(first, utterance));
+        EXPECT_EQ(utterance.samples.get()[0], firstSamples[0]);
+        ASSERT_TRUE(store->Find(second, utterance));
+        EXPECT_EQ(utterance.samples.get()[0], secondSamples[0]);
+    }
+
+    TEST_F(UtteranceStoreTest, KeepsUtterancesAcrossSessions)
+    {
+        {
+            auto store = Open();
+            for (int i = 0; i < 10; i++) ASSERT_TRUE(Put(*store, i));
+        }
+
+        auto store = Open();
+        for (int i = 0; i < 10; i++) EXPECT_TRUE(Contains(*store, i));
+        EXPECT_EQ(store->GetStats().entries, 10u);
+    }
+
+    TEST_F(UtteranceStoreTest, SamplesOutliveStore)
+    {
+        StoredUtterance utterance;
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 1));
+            ASSERT_TRUE(store->Find(MakeKey(1), utterance));
+        }
+
+        EXPECT_EQ(std::vector<uint8_t>(utterance.samples.get(), utterance.samples.get() + utterance.size), MakeSamples(1, 256));
+    }
+
+    TEST_F(UtteranceStoreTest, RecoversFromCrashBeforeCommit)
+    {
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 1));
+        }
+
+        // Record written to the data file but the index never reached the disk.
+        auto index = ReadFile(GetFilePath(1, ".idx"));
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 2));
+        }
+        WriteFile(GetFilePath(1, ".idx"), index);
+
+        auto store = Open();
+        EXPECT_TRUE(Contains(*store, 1));
+        EXPECT_FALSE(Contains(*store, 2));
+
+        // The partial record is overwritten.
+        ASSERT_TRUE(Put(*store, 3, 512));
+        EXPECT_TRUE(Contains(*store, 3, 512));
+        EXPECT_TRUE(Contains(*store, 1));
+        EXPECT_EQ(store->GetStats().corrupted, 0u);
+    }
+
+    TEST_F(UtteranceStoreTest, DetectsTornRecord)
+    {
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 1));
+        }
+
+        // First sample of the first record, e.g. a page lost by the disk.
+        auto data = ReadFile(GetFilePath(1, ".dat"));
+        data[32 + MakeKey(1).identity.size()] ^= 0xFF;
+        WriteFile(GetFilePath(1, ".dat"), data);
+
+        auto store = Open();
+        EXPECT_FALSE(Contains(*store, 1));
+        EXPECT_EQ(store->GetStats().corrupted, 1u);
+
+        // Rendered again and replaced.
+        ASSERT_TRUE(Put(*store, 1));
+        EXPECT_TRUE(Contains(*store, 1));
+    }
+
+    TEST_F(UtteranceStoreTest, ReplacesUnreadableFiles)
+    {
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 1));
+        }
+
+        auto index = ReadFile(GetFilePath(1, ".idx"));
+        index[0] ^= 0xFF;
+        WriteFile(GetFilePath(1, ".idx"), index);
+
+        auto store = Open();
+        EXPECT_FALSE(Contains(*store, 1));
+        EXPECT_EQ(store->GetStats().entries, 0u);
+        ASSERT_TRUE(Put(*store, 2));
+        EXPECT_TRUE(Contains(*store, 2));
+
+        // The broken generation is removed.
+        EXPECT_FALSE(std::filesystem::exists(GetFilePath(1, ".idx")));
+        EXPECT_FALSE(std::filesystem::exists(GetFilePath(1, ".dat")));
+    }
+
+    TEST_F(UtteranceStoreTest, IgnoresInterruptedCompaction)
+    {
+        {
+            auto store = Open();
+            ASSERT_TRUE(Put(*store, 1));
+        }
+
+        // Next generation partially written, the current one was never switched.
+        WriteFile(GetFilePath(2, ".idx"), std::vector<uint8_t>(100, 0xAB));
+        WriteFile(GetFilePath(2, ".dat"), std::vector<uint8_t>(100, 0xCD));
+
+        auto store = Open();
+        EXPECT_TRUE(Contains(*store, 1));
+        EXPECT_FALSE(std::filesystem::exists(GetFilePath(2, ".idx")));
+        EXPECT_FALSE(std::filesystem::exists(GetFilePath(2, ".dat")));
+    }
+
+    TEST_F(UtteranceStoreTest, CompactionDropsOldestAboveCap)
+    {
+        m_options.maxBytes = 64 << 10;
+        auto store = Open();
+
+        // About 4 KB per record.
+        const size_t size = 4000;
+        int count = 0;
+        while (Put(*store, count, size)) count++;
+        ASSERT_GT(count, 10);
+        EXPECT_EQ(store->GetStats().rejected, 1u);
+
+        store->WaitForCompaction();
+        auto stats = store->GetStats();
+        EXPECT_EQ(stats.compactions, 1u);
+        EXPECT_LE(stats.bytes, m_options.maxBytes / 4 * 3);
+
+        // Newest are kept, in age order.
+        EXPECT_FALSE(Contains(*store, 0, size));
+        EXPECT_TRUE(Contains(*store, count - 1, size));
+        int kept = 0;
+        for (int i = 0; i < count; i++)
+        {
+            if (Contains(*store, i, size))
+            {
+                kept++;
+            }
+            else
+            {
+                EXPECT_EQ(kept, 0) << "utterance " << i << " dropped after a newer one was kept";
+            }
+        }
+        EXPECT_EQ(static_cast<uint64_t>(kept), stats.entries);
+
+        // Room was made and the new generation survives a restart.
+        ASSERT_TRUE(Put(*store, count, size));
+        store.reset();
+        store = Open();
+        EXPECT_TRUE(Contains(*store, count, size));
+        EXPECT_FALSE(std::filesystem::exists(GetFilePath(1, ".dat")));
+    }
+
+    TEST_F(UtteranceStoreTest, CompactionGrowsIndex)
+    {
+        m_options.indexCapacity = 16;
+        auto store = Open();
+
+        // Compaction starts at 3/4 of the slots, puts continue meanwhile.
+        for (int i = 0; i < 14; i++) ASSERT_TRUE(Put(*store, i)) << i;
+        store->WaitForCompaction();
+
+        for (int i = 14; i < 40; i++)
+        {
+            if (!Put(*store, i))
+            {
+                store->WaitForCompaction();
+                ASSERT_TRUE(Put(*store, i)) << i;
+            }
+        }
+        store->WaitForCompaction();
+
+        for (int i = 0; i < 40; i++) EXPECT_TRUE(Contains(*store, i)) << i;
+        EXPECT_EQ(store->GetStats().entries, 40u);
+        EXPECT_GE(store->GetStats().compactions, 2u);
+    }
+
+    TEST_F(UtteranceStoreTest, RejectsUtteranceLargerThanCap)
+    {
+        m_options.maxBytes = 4096;
+        auto store = Open();
+
+        EXPECT_FALSE(Put(*store, 1, 8192));
+        store->WaitForCompaction();
+        EXPECT_EQ(store->GetStats().compactions, 0u);
+        EXPECT_TRUE(Put(*store, 2, 1024));
+    }
+
+    TEST_F(UtteranceStoreTest, ReadersSeeCompleteUtterancesWhileWriting)
+    {
+        m_options.maxBytes = 256 << 10;
+        m_options.indexCapacity = 64;
+        auto store = Open();
+        const int count = 200;
+        const size_t size = 2000;
+
+        std::atomic<bool> isDone{ false };
+        std::atomic<int> found{ 0 };
+        std::vector<std::thread> readers;
+        for (int reader = 0; reader < 2; reader++)
+        {
+            readers.emplace_back([&, reader]() {
+                while (!isDone)
+                {
+                    for (int i = reader; i < count; i += 2)
+                    {
+                        // Samples are checked by Contains.
+                        if (Contains(*store, i, size)) found++;
+                    }
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        // Generations switch and utterances are dropped meanwhile.
+        for (int i = 0; i < count; i++)
+        {
+            if (!Put(*store, i, size))
+            {
+                store->WaitForCompaction();
+                Put(*store, i, size);
+            }
+            std::this_thread::yield();
+        }
+        store->WaitForCompaction();
+
+        isDone = true;
+        for (auto& reader : readers) reader.join();
+
+        EXPECT_GT(found.load(), 0);
+        EXPECT_GE(store->GetStats().compactions, 1u);
+        EXPECT_EQ(store->GetStats().corrupted, 0u);
+        EXPECT_TRUE(Contains(*store, count - 1, size));
+    }
+
+}
+}
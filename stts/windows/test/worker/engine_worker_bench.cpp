@@ -0,0 +1,61 @@
+#include "worker/engine_worker.h"
+
+#include <benchmark/benchmark.h>
+
+#include <future>
+
+namespace stts {
+namespace {
+
+    // Stand-in for an engine call (e.g. CoCreateInstance, LoadDictation) taking the given time.
+    void CallFakeEngine(std::chrono::microseconds duration)
+    {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {}
+    }
+
+    // Previous behavior: the method handler called the engine on the platform thread.
+    void BM_PlatformBlockingSynchronousCall(benchmark::State& state)
+    {
+        std::chrono::microseconds duration(state.range(0));
+
+        for (auto _ : state)
+        {
+            CallFakeEngine(duration);
+        }
+    }
+    BENCHMARK(BM_PlatformBlockingSynchronousCall)->Arg(100)->Arg(1000)->Arg(10000)->UseRealTime();
+
+    // The platform thread only blocks for Post, the engine call runs on the worker.
+    void BM_PlatformBlockingEngineWorker(benchmark::State& state)
+    {
+        std::chrono::microseconds duration(state.range(0));
+        EngineWorker worker(64);
+        worker.Start();
+
+        for (auto _ : state)
+        {
+            std::promise<void> done;
+
+            EngineCommand command;
+            command.group = "stt";
+            command.run = [&done, duration](const CancellationToken&) {
+                CallFakeEngine(duration);
+                done.set_value();
+            };
+
+            auto start = std::chrono::steady_clock::now();
+            worker.Post(std::move(command));
+            auto blocked = std::chrono::steady_clock::now() - start;
+
+            done.get_future().wait();
+            state.SetIterationTime(std::chrono::duration<double>(blocked).count());
+        }
+
+        worker.Stop();
+    }
+    // Iterations are bounded: only the short Post is timed while each one also waits for the engine call.
+    BENCHMARK(BM_PlatformBlockingEngineWorker)->Arg(100)->Arg(1000)->Arg(10000)->UseManualTime()->Iterations(200);
+
+}
+}
@@ -0,0 +1,230 @@
+#include "worker/engine_worker.h"
+
+#include <gtest/gtest.h>
+
+#include <future>
+
+namespace stts {
+namespace {
+
+    using namespace std::chrono_literals;
+
+    // Engine worker recording its hooks, as the COM worker initializes its apartment.
+    class FakeEngineWorker : public EngineWorker {
+    public:
+        explicit FakeEngineWorker(size_t capacity) : EngineWorker(capacity) {}
+
+        ~FakeEngineWorker() override { Stop(); }
+
+        std::thread::id startThread;
+        std::thread::id stopThread;
+
+    protected:
+        void OnStart() override { startThread = std::this_thread::get_id(); }
+        void OnStop() override { stopThread = std::this_thread::get_id(); }
+    };
+
+    // Command completing a promise with the rejection, if any.
+    struct Outcome {
+        std::promise<bool> ran;
+        std::promise<CommandRejection> rejected;
+    };
+
+    EngineCommand MakeCommand(Outcome& outcome, std::function<void(const CancellationToken&)> run = nullptr,
+        std::string group = "stt", std::chrono::milliseconds timeout = 0ms)
+    {
+        EngineCommand command;
+        command.group = std::move(group);
+        command.timeout = timeout;
+        command.run = [&outcome, run](const CancellationToken& token) {
+            if (run) run(token);
+            outcome.ran.set_value(true);
+        };
+        command.reject = [&outcome](CommandRejection rejection) { outcome.rejected.set_value(rejection); };
+        return command;
+    }
+
+    // Keeps the worker busy until released.
+    struct Blocker {
+        std::promise<void> started;
+        std::promise<void> release;
+        std::shared_future<void> released{ release.get_future().share() };
+
+        std::function<void(const CancellationToken&)> Run()
+        {
+            return [this](const CancellationToken&) {
+                started.set_value();
+                released.wait();
+            };
+        }
+    };
+
+    TEST(EngineWorkerTest, RunsCommandsInOrderOnTheWorkerThread)
+    {
+        FakeEngineWorker worker(8);
+        worker.Start();
+
+        std::vector<int> order;
+        std::thread::id commandThread;
+        Outcome outcomes[3];
+        for (int i = 0; i < 3; i++)
+        {
+            worker.Post(MakeCommand(outcomes[i], [&order, &commandThread, &worker, i](const CancellationToken&) {
+                EXPECT_TRUE(worker.IsWorkerThread());
+                commandThread = std::this_thread::get_id();
+                order.push_back(i);
+            }));
+        }
+
+        for (auto& outcome : outcomes) EXPECT_TRUE(outcome.ran.get_future().get());
+        worker.Stop();
+
+        EXPECT_EQ(order, (std::vector<int>{ 0, 1, 2 }));
+        EXPECT_FALSE(worker.IsWorkerThread());
+        EXPECT_EQ(worker.startThread, commandThread);
+        EXPECT_EQ(worker.stopThread, commandThread);
+    }
+
+    TEST(EngineWorkerTest, RejectsCommandsOverCapacity)
+    {
+        FakeEngineWorker worker(1);
+        worker.Start();
+
+        Blocker blocker;
+        Outcome running, pending, overflow;
+        EXPECT_NE(worker.Post(MakeCommand(running, blocker.Run())), 0u);
+        blocker.started.get_future().wait();
+
+        EXPECT_NE(worker.Post(MakeCommand(pending)), 0u);
+        EXPECT_EQ(worker.Post(MakeCommand(overflow)), 0u);
+        EXPECT_EQ(overflow.rejected.get_future().get(), CommandRejection::queueFull);
+        EXPECT_EQ(worker.GetPendingCount(), 1u);
+
+        blocker.release.set_value();
+        EXPECT_TRUE(pending.ran.get_future().get());
+    }
+
+    TEST(EngineWorkerTest, RejectsCommandsExpiredInQueue)
+    {
+        FakeEngineWorker worker(4);
+        worker.Start();
+
+        Blocker blocker;
+        Outcome running, late;
+        worker.Post(MakeCommand(running, blocker.Run()));
+        blocker.started.get_future().wait();
+
+        worker.Post(MakeCommand(late, nullptr, "tts", 20ms));
+        auto rejected = late.rejected.get_future();
+
+        // Dropped without running once the worker gets to it past the deadline.
+        std::this_thread::sleep_for(40ms);
+        blocker.release.set_value();
+        EXPECT_EQ(rejected.get(), CommandRejection::timeout);
+    }
+
+    TEST(EngineWorkerTest, RunningCommandSeesItsDeadline)
+    {
+        FakeEngineWorker worker(4);
+        worker.Start();
+
+        Outcome outcome;
+        bool expired = false;
+        worker.Post(MakeCommand(outcome, [&expired](const CancellationToken& token) {
+            while (!token.ShouldStop()) std::this_thread::sleep_for(1ms);
+            expired = token.IsExpired() && !token.IsCancelled();
+        }, "stt", 20ms));
+
+        EXPECT_TRUE(outcome.ran.get_future().get());
+        EXPECT_TRUE(expired);
+    }
+
+    TEST(EngineWorkerTest, CancelsGroupPendingAndRunningCommands)
+    {
+        FakeEngineWorker worker(8);
+        worker.Start();
+
+        std::promise<void> started;
+        Outcome running, pendingStt, pendingTts;
+        bool cancelled = false;
+        worker.Post(MakeCommand(running, [&started, &cancelled](const CancellationToken& token) {
+            started.set_value();
+            while (!token.ShouldStop()) std::this_thread::sleep_for(1ms);
+            cancelled = token.IsCancelled();
+        }));
+        started.get_future().wait();
+
+        worker.Post(MakeCommand(pendingStt));
+        worker.Post(MakeCommand(pendingTts, nullptr, "tts"));
+
+        EXPECT_EQ(worker.Cancel("stt"), 2u);
+        EXPECT_EQ(pendingStt.rejected.get_future().get(), CommandRejection::cancelled);
+        EXPECT_TRUE(running.ran.get_future().get());
+        EXPECT_TRUE(cancelled);
+        EXPECT_TRUE(pendingTts.ran.get_future().get());
+    }
+
+    TEST(EngineWorkerTest, CancelsCommandById)
+    {
+        FakeEngineWorker worker(8);
+        worker.Start();
+
+        Blocker blocker;
+        Outcome running, pending;
+        worker.Post(MakeCommand(running, blocker.Run()));
+        blocker.started.get_future().wait();
+
+        auto id = worker.Post(MakeCommand(pending));
+        EXPECT_TRUE(worker.Cancel(id));
+        EXPECT_FALSE(worker.Cancel(id));
+        EXPECT_EQ(pending.rejected.get_future().get(), CommandRejection::cancelled);
+
+        blocker.release.set_value();
+    }
+
+    TEST(EngineWorkerTest, StopRejectsPendingCommandsAndRunsFinalTask)
+    {
+        FakeEngineWorker worker(8);
+        worker.Start();
+
+        Blocker blocker;
+        Outcome running, pending, afterStop;
+        worker.Post(MakeCommand(running, blocker.Run()));
+        blocker.started.get_future().wait();
+        worker.Post(MakeCommand(pending));
+
+        std::thread::id finalThread;
+        auto releaser = std::thread([&blocker] {
+            std::this_thread::sleep_for(10ms);
+            blocker.release.set_value();
+        });
+        worker.Stop([&finalThread] { finalThread = std::this_thread::get_id(); });
+        releaser.join();
+
+        EXPECT_EQ(pending.rejected.get_future().get(), CommandRejection::shutdown);
+        EXPECT_EQ(finalThread, worker.startThread);
+        EXPECT_EQ(worker.Post(MakeCommand(afterStop)), 0u);
+        EXPECT_EQ(afterStop.rejected.get_future().get(), CommandRejection::shutdown);
+    }
+
+    TEST(EngineWorkerTest, RunsScheduledTasksByDueTime)
+    {
+        FakeEngineWorker worker(8);
+        worker.Start();
+
+        std::vector<int> order;
+        std::promise<void> done;
+        worker.Schedule(30ms, [&order, &done] { order.push_back(3); done.set_value(); });
+        worker.Schedule(10ms, [&order] { order.push_back(1); });
+        auto removed = worker.Schedule(15ms, [&order] { order.push_back(2); });
+        worker.Unschedule(removed);
+
+        done.get_future().wait();
+        worker.Stop();
+
+        EXPECT_EQ(order, (std::vector<int>{ 1, 3 }));
+        EXPECT_EQ(worker.Schedule(1ms, [] {}), 0u);
+    }
+
+}
+}
@@ -0,0 +1,143 @@
+#include "worker/mpsc_queue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    const uint64_t kItemsPerProducer = 20000;
+
+    // Previous style of synchronization: a mutex around a deque.
+    class LockedQueue {
+    public:
+        bool TryPush(uint64_t& item)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_items.push_back(item);
+            return true;
+        }
+
+        bool TryPop(uint64_t& item)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_items.empty()) return false;
+
+            item = m_items.front();
+            m_items.pop_front();
+            return true;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::deque<uint64_t> m_items;
+    };
+
+    // range(0) producers push events while the consumer drains them, like callbacks posting to the
+    // platform thread. Only the transfer is timed, not starting the threads.
+    template <typename Queue>
+    void RunTransfer(benchmark::State& state, Queue& queue)
+    {
+        auto producerCount = static_cast<size_t>(state.range(0));
+
+        for (auto _ : state)
+        {
+            std::atomic<size_t> readyCount{ 0 };
+            std::atomic<bool> isStarted{ false };
+
+            std::vector<std::thread> producers;
+            for (size_t producer = 0; producer < producerCount; producer++)
+            {
+                producers.emplace_back([&queue, &readyCount, &isStarted]() {
+                    readyCount++;
+                    while (!isStarted.load()) std::this_thread::yield();
+
+                    for (uint64_t i = 0; i < kItemsPerProducer; i++)
+                    {
+                        auto item = i;
+                        while (!queue.TryPush(item)) std::this_thread::yield();
+                    }
+                });
+            }
+            while (readyCount.load() < producerCount) std::this_thread::yield();
+
+            auto start = std::chrono::steady_clock::now();
+            isStarted = true;
+
+            uint64_t total = producerCount * kItemsPerProducer;
+            uint64_t sum = 0;
+            for (uint64_t popped = 0; popped < total;)
+            {
+                uint64_t item;
+                if (!queue.TryPop(item))
+                {
+                    // The platform thread would wait for the next drain message.
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                sum += item;
+                popped++;
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            for (auto& thread : producers) thread.join();
+            benchmark::DoNotOptimize(sum);
+            state.SetIterationTime(std::chrono::duration<double>(elapsed).count());
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * producerCount * kItemsPerProducer));
+    }
+
+    void BM_EventQueueLocked(benchmark::State& state)
+    {
+        LockedQueue queue;
+        RunTransfer(state, queue);
+    }
+    BENCHMARK(BM_EventQueueLocked)->Arg(1)->Arg(4)->Arg(16)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+    void BM_EventQueueMpsc(benchmark::State& state)
+    {
+        MpscQueue<uint64_t> queue(4096);
+        RunTransfer(state, queue);
+    }
+    BENCHMARK(BM_EventQueueMpsc)->Arg(1)->Arg(4)->Arg(16)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+    // Uncontended push and pop, e.g. one recognition callback at a time.
+    void BM_EventQueueMpscPushPop(benchmark::State& state)
+    {
+        MpscQueue<uint64_t> queue(4096);
+        uint64_t item = 0;
+
+        for (auto _ : state)
+        {
+            auto pushed = item;
+            queue.TryPush(pushed);
+            queue.TryPop(item);
+            benchmark::DoNotOptimize(item);
+        }
+    }
+    BENCHMARK(BM_EventQueueMpscPushPop);
+
+    void BM_EventQueueLockedPushPop(benchmark::State& state)
+    {
+        LockedQueue queue;
+        uint64_t item = 0;
+
+        for (auto _ : state)
+        {
+            auto pushed = item;
+            queue.TryPush(pushed);
+            queue.TryPop(item);
+            benchmark::DoNotOptimize(item);
+        }
+    }
+    BENCHMARK(BM_EventQueueLockedPushPop);
+
+}
+}
@@ -0,0 +1,169 @@
+#include "worker/mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stts {
+namespace {
+
+    TEST(MpscQueueTest, RoundsCapacityUp)
+    {
+        EXPECT_EQ(MpscQueue<int>(0).GetCapacity(), 2u);
+        EXPECT_EQ(MpscQueue<int>(2).GetCapacity(), 2u);
+        EXPECT_EQ(MpscQueue<int>(5).GetCapacity(), 8u);
+        EXPECT_EQ(MpscQueue<int>(1024).GetCapacity(), 1024u);
+    }
+
+    TEST(MpscQueueTest, PopsInPushOrder)
+    {
+        MpscQueue<int> queue(8);
+        int item = 0;
+        EXPECT_FALSE(queue.TryPop(item));
+
+        for (int i = 1; i <= 5; i++)
+        {
+            auto pushed = i;
+            ASSERT_TRUE(queue.TryPush(pushed));
+        }
+        EXPECT_EQ(queue.GetSize(), 5u);
+
+        for (int i = 1; i <= 5; i++)
+        {
+            ASSERT_TRUE(queue.TryPop(item));
+            EXPECT_EQ(item, i);
+        }
+        EXPECT_FALSE(queue.TryPop(item));
+        EXPECT_EQ(queue.GetSize(), 0u);
+    }
+
+    TEST(MpscQueueTest, RejectsWhenFullWithoutTakingItem)
+    {
+        MpscQueue<std::string> queue(4);
+        for (int i = 0; i < 4; i++)
+        {
+            std::string item = "item";
+            ASSERT_TRUE(queue.TryPush(item));
+        }
+
+        std::string rejected = "rejected";
+        EXPECT_FALSE(queue.TryPush(rejected));
+        EXPECT_EQ(rejected, "rejected");
+        EXPECT_EQ(queue.GetSize(), 4u);
+
+        // Room again once one is popped.
+        std::string item;
+        ASSERT_TRUE(queue.TryPop(item));
+        EXPECT_TRUE(queue.TryPush(rejected));
+    }
+
+    TEST(MpscQueueTest, WrapsAround)
+    {
+        // Three items queued at all times, slots are reused every lap.
+        MpscQueue<int> queue(4);
+        int next = 0;
+        for (; next < 3; next++)
+        {
+            auto pushed = next;
+            ASSERT_TRUE(queue.TryPush(pushed));
+        }
+
+        for (int expected = 0; expected < 1000; expected++, next++)
+        {
+            auto pushed = next;
+            ASSERT_TRUE(queue.TryPush(pushed));
+
+            int item;
+            ASSERT_TRUE(queue.TryPop(item));
+            EXPECT_EQ(item, expected);
+        }
+        EXPECT_EQ(queue.GetSize(), 3u);
+    }
+
+    TEST(MpscQueueTest, ReleasesPoppedValues)
+    {
+        MpscQueue<std::shared_ptr<int>> queue(4);
+        auto value = std::make_shared<int>(1);
+
+        auto pushed = value;
+        ASSERT_TRUE(queue.TryPush(pushed));
+        EXPECT_EQ(pushed, nullptr);
+        EXPECT_EQ(value.use_count(), 2);
+
+        std::shared_ptr<int> popped;
+        ASSERT_TRUE(queue.TryPop(popped));
+        popped.reset();
+        EXPECT_EQ(value.use_count(), 1);
+    }
+
+    // Producers retry when the queue is full. Each producer's items must come out once, in order.
+    void RunStress(size_t producerCount, size_t capacity, uint32_t itemsPerProducer)
+    {
+        MpscQueue<uint64_t> queue(capacity);
+        std::atomic<bool> isStarted{ false };
+        std::atomic<uint64_t> fullCount{ 0 };
+
+        std::vector<std::thread> producers;
+        for (size_t producer = 0; producer < producerCount; producer++)
+        {
+            producers.emplace_back([&, producer]() {
+                while (!isStarted.load()) std::this_thread::yield();
+
+                for (uint32_t i = 0; i < itemsPerProducer; i++)
+                {
+                    uint64_t item = (static_cast<uint64_t>(producer) << 32) | i;
+                    while (!queue.TryPush(item))
+                    {
+                        fullCount++;
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        std::vector<uint32_t> nextItems(producerCount, 0);
+        uint64_t total = static_cast<uint64_t>(producerCount) * itemsPerProducer;
+        isStarted = true;
+
+        for (uint64_t popped = 0; popped < total;)
+        {
+            uint64_t item;
+            if (!queue.TryPop(item))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            auto producer = static_cast<size_t>(item >> 32);
+            auto index = static_cast<uint32_t>(item);
+            ASSERT_LT(producer, producerCount);
+            ASSERT_EQ(index, nextItems[producer]) << "producer " << producer;
+            nextItems[producer]++;
+            popped++;
+        }
+
+        for (auto& thread : producers) thread.join();
+
+        uint64_t item;
+        EXPECT_FALSE(queue.TryPop(item));
+        EXPECT_EQ(queue.GetSize(), 0u);
+        for (auto next : nextItems) EXPECT_EQ(next, itemsPerProducer);
+    }
+
+    TEST(MpscQueueTest, ManyProducersKeepTheirOrder)
+    {
+        RunStress(8, 1024, 50000);
+    }
+
+    TEST(MpscQueueTest, ManyProducersOnASmallQueue)
+    {
+        // Mostly full, producers keep racing for the few free slots.
+        RunStress(16, 8, 10000);
+    }
+
+}
+}
@@ -0,0 +1,228 @@
+#include "trace_recorder.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace stts {
+
+    // Latest spans kept per thread.
+    static const uint64_t kSpanCapacity = 8192;
+
+    namespace {
+
+        // Fields are atomics: a dump may read a span being overwritten, it is then discarded.
+        struct SpanRecord {
+            std::atomic<const char*> category{ nullptr };
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<int64_t> start{ 0 };
+            std::atomic<int64_t> end{ 0 };
+        };
+
+        struct TraceBuffer {
+            uint32_t threadId = 0;
+            std::atomic<const char*> threadName{ nullptr };
+
+            SpanRecord spans[kSpanCapacity];
+            // Index of the span being written, then count of written spans.
+            std::atomic<uint64_t> writing{ 0 };
+            std::atomic<uint64_t> written{ 0 };
+            // Count of written spans when the trace started.
+            std::atomic<uint64_t> origin{ 0 };
+        };
+
+        struct TraceRegistry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<TraceBuffer>> buffers;
+        };
+
+        // Never destroyed, threads may record while the process exits.
+        TraceRegistry& GetRegistry()
+        {
+            static auto registry = new TraceRegistry();
+            return *registry;
+        }
+
+        const auto kEpoch = std::chrono::steady_clock::now();
+
+        thread_local TraceBuffer* t_buffer = nullptr;
+
+        // Buffers are kept after their thread exits, so that its spans are still dumped.
+        TraceBuffer* GetThreadBuffer()
+        {
+            if (!t_buffer)
+            {
+                auto buffer = std::make_unique<TraceBuffer>();
+                auto& registry = GetRegistry();
+
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                buffer->threadId = static_cast<uint32_t>(registry.buffers.size() + 1);
+                t_buffer = buffer.get();
+                registry.buffers.push_back(std::move(buffer));
+            }
+
+            return t_buffer;
+        }
+
+        void AppendString(std::string& json, const char* value)
+        {
+            json += '"';
+            for (auto p = value ? value : ""; *p; p++)
+            {
+                auto c = static_cast<unsigned char>(*p);
+                if (c == '"' || c == '\\')
+                {
+                    json += '\\';
+                    json += static_cast<char>(c);
+                }
+                else if (c < 0x20)
+                {
+                    static const char kHex[] = "0123456789abcdef";
+                    json += "\\u00";
+                    json += kHex[c >> 4];
+                    json += kHex[c & 0xF];
+                }
+                else
+                {
+                    json += static_cast<char>(c);
+                }
+            }
+            json += '"';
+        }
+
+        // Trace events are in microseconds.
+        void AppendMicroseconds(std::string& json, int64_t nanoseconds)
+        {
+            auto fraction = std::to_string(nanoseconds % 1000);
+
+            json += std::to_string(nanoseconds / 1000);
+            json += '.';
+            json.append(3 - fraction.size(), '0');
+            json += fraction;
+        }
+
+    }
+
+    std::atomic<bool> TraceRecorder::s_isEnabled{ false };
+
+    void TraceRecorder::SetEnabled(bool enabled)
+    {
+        if (enabled)
+        {
+            auto& registry = GetRegistry();
+
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            for (auto& buffer : registry.buffers)
+            {
+                buffer->origin.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+            }
+        }
+
+        s_isEnabled.store(enabled);
+    }
+
+    void TraceRecorder::SetThreadName(const char* name)
+    {
+        GetThreadBuffer()->threadName.store(name, std::memory_order_relaxed);
+    }
+
+    int64_t TraceRecorder::GetTimestamp()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kEpoch).count();
+    }
+
+    void TraceRecorder::Record(const char* category, const char* name, int64_t start, int64_t end)
+    {
+        auto buffer = GetThreadBuffer();
+        auto index = buffer->written.load(std::memory_order_relaxed);
+        auto& span = buffer->spans[index % kSpanCapacity];
+
+        // Announced before overwriting, see Dump.
+        buffer->writing.store(index, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        span.category.store(category, std::memory_order_relaxed);
+        span.name.store(name, std::memory_order_relaxed);
+        span.start.store(start, std::memory_order_relaxed);
+        span.end.store(end, std::memory_order_relaxed);
+
+        buffer->written.store(index + 1, std::memory_order_release);
+    }
+
+    std::string TraceRecorder::Dump()
+    {
+        std::string json = "{\"traceEvents\":[";
+        bool isFirst = true;
+
+        auto& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        struct Span {
+            const char* category;
+            const char* name;
+            int64_t start;
+            int64_t end;
+        };
+        std::vector<Span> spans;
+
+        for (auto& buffer : registry.buffers)
+        {
+            auto threadId = std::to_string(buffer->threadId);
+
+            if (auto threadName = buffer->threadName.load(std::memory_order_relaxed))
+            {
+                if (!isFirst) json += ',';
+                isFirst = false;
+
+                json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + threadId + ",\"args\":{\"name\":";
+                AppendString(json, threadName);
+                json += "}}";
+            }
+
+            auto written = buffer->written.load(std::memory_order_acquire);
+            auto origin = buffer->origin.load(std::memory_order_relaxed);
+            auto first = written > kSpanCapacity ? written - kSpanCapacity : 0;
+            if (first < origin) first = origin;
+
+            spans.clear();
+            for (auto index = first; index < written; index++)
+            {
+                const auto& span = buffer->spans[index % kSpanCapacity];
+                spans.push_back({
+                    span.category.load(std::memory_order_relaxed),
+                    span.name.load(std::memory_order_relaxed),
+                    span.start.load(std::memory_order_relaxed),
+                    span.end.load(std::memory_order_relaxed) });
+            }
+
+            // Spans whose slot was reused by the thread while copying are incomplete.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto writing = buffer->writing.load(std::memory_order_relaxed);
+            auto valid = writing >= kSpanCapacity ? writing - kSpanCapacity + 1 : 0;
+
+            for (auto index = first; index < written; index++)
+            {
+                if (index < valid) continue;
+
+                const auto& span = spans[index - first];
+                if (!isFirst) json += ',';
+                isFirst = false;
+
+                json += "{\"name\":";
+                AppendString(json, span.name);
+                json += ",\"cat\":";
+                AppendString(json, span.category);
+                json += ",\"ph\":\"X\",\"ts\":";
+                AppendMicroseconds(json, span.start);
+                json += ",\"dur\":";
+                AppendMicroseconds(json, span.end - span.start);
+                json += ",\"pid\":1,\"tid\":" + threadId + "}";
+            }
+        }
+
+        json += "],\"displayTimeUnit\":\"ms\"}";
+        return json;
+    }
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace stts {
+
+	// Spans of the threads of the plugin, dumped as Chrome trace events (chrome://tracing, Perfetto).
+	//
+	// Each thread records to its own ring of latest spans without locking, a dump reads all rings while they are written.
+	// When disabled, a span costs one relaxed load. Names and categories must be string literals.
+	class TraceRecorder {
+	public:
+		// Enabling starts a new trace, spans recorded before are not dumped anymore.
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled() { return s_isEnabled.load(std::memory_order_relaxed); }
+
+		// Names the calling thread in dumps.
+		static void SetThreadName(const char* name);
+
+		// Trace event JSON of the spans kept by all threads since the trace started.
+		static std::string Dump();
+
+		// Nanoseconds since process start.
+		static int64_t GetTimestamp();
+
+		static void Record(const char* category, const char* name, int64_t start, int64_t end);
+
+	private:
+		static std::atomic<bool> s_isEnabled;
+	};
+
+	// Records the lifetime of the scope it is declared in.
+	class TraceSpan {
+	public:
+		TraceSpan(const char* category, const char* name) :
+			m_category(category),
+			m_name(name),
+			m_start(TraceRecorder::IsEnabled() ? TraceRecorder::GetTimestamp() : -1)
+		{
+		}
+
+		~TraceSpan()
+		{
+			if (m_start >= 0) TraceRecorder::Record(m_category, m_name, m_start, TraceRecorder::GetTimestamp());
+		}
+
+		// Disallow copy and assign.
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+
+	private:
+		const char* m_category;
+		const char* m_name;
+		int64_t m_start;
+	};
+
+}
@@ -0,0 +1,35 @@
+#include "sapi_synthesis_pipeline.h"
+
+#include "../trace/trace_recorder.h"
+
+namespace stts {
+
+    SapiSynthesisPipeline::SapiSynthesisPipeline(const PcmFormat& format, const SynthesisPipelineOptions& options, ReadyCallback onReady) :
+        SynthesisPipeline(format, options, std::move(onReady))
+    {
+    }
+
+    SapiSynthesisPipeline::~SapiSynthesisPipeline()
+    {
+        Stop();
+    }
+
+    void SapiSynthesisPipeline::OnThreadStart()
+    {
+        // No window on this thread, rendering waits on the voice instead of messages.
+        CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    }
+
+    void SapiSynthesisPipeline::OnThreadStop()
+    {
+        m_renderer.Release();
+        CoUninitialize();
+    }
+
+    bool SapiSynthesisPipeline::Render(const SynthesisRequest& request, PcmSink& sink, const CancellationToken& cancellationToken)
+    {
+        TraceSpan span("sapi", "UtteranceRenderer::Render");
+        return SUCCEEDED(m_renderer.Render(request, GetFormat(), sink, cancellationToken));
+    }
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "synthesis_pipeline.h"
+#include "utterance_renderer.h"
+
+namespace stts {
+
+	// Synthesis pipeline rendering with a SAPI voice owned by the pipeline thread.
+	class SapiSynthesisPipeline : public SynthesisPipeline
+	{
+	public:
+		SapiSynthesisPipeline(const PcmFormat& format, const SynthesisPipelineOptions& options, ReadyCallback onReady);
+		~SapiSynthesisPipeline() override;
+
+	protected:
+		void OnThreadStart() override;
+		void OnThreadStop() override;
+		bool Render(const SynthesisRequest& request, PcmSink& sink, const CancellationToken& cancellationToken) override;
+
+	private:
+		UtteranceRenderer m_renderer;
+	};
+
+}
@@ -0,0 +1,280 @@
+#include "sentence_segmenter.h"
+
+#include <cstring>
+
+namespace stts {
+
+    // Lowercase, compared with the word before a period.
+    static const char* const kAbbreviations[] = {
+        "mr", "mrs", "ms", "dr", "prof", "sr", "jr", "st", "mt", "vs", "etc", "approx", "dept", "est",
+        "inc", "ltd", "co", "corp", "ed", "eds", "cf", "al", "ave", "jan", "feb", "mar", "apr", "jun",
+        "jul", "aug", "sep", "sept", "oct", "nov", "dec", "mme", "mlle", "bzw", "usw",
+    };
+
+    // Abbreviations only when a number follows, e.g. "No. 5" but not "I said no. Then".
+    static const char* const kNumberAbbreviations[] = {
+        "no", "nos", "nr", "fig", "figs", "vol", "p", "pp", "art", "ch", "sec", "ca",
+    };
+
+    static const char* const kClosings[] = {
+        "\"", "'", ")", "]", "}", "\xE2\x80\x9D", "\xE2\x80\x99", "\xC2\xBB", "\xE3\x80\x8D", "\xE3\x80\x8F", "\xEF\xBC\x89",
+    };
+
+    static const char* const kClauseEnds[] = {
+        ",", ";", ":", "\xE2\x80\x94", "\xE2\x80\x93", "\xEF\xBC\x8C", "\xEF\xBC\x9B", "\xEF\xBC\x9A", "\xE3\x80\x81",
+    };
+
+    static bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+    }
+
+    static bool IsLetter(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    static bool IsDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static char ToLower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    static bool StartsWith(const std::string& text, size_t i, const char* prefix)
+    {
+        auto length = strlen(prefix);
+        return i + length <= text.size() && text.compare(i, length, prefix) == 0;
+    }
+
+    template <size_t N>
+    static size_t MatchAny(const std::string& text, size_t i, const char* const (&candidates)[N])
+    {
+        for (auto candidate : candidates)
+        {
+            if (StartsWith(text, i, candidate)) return strlen(candidate);
+        }
+        return 0;
+    }
+
+    template <size_t N>
+    static bool ContainsWord(const std::string& text, size_t start, size_t end, const char* const (&words)[N])
+    {
+        for (auto word : words)
+        {
+            if (strlen(word) != end - start) continue;
+
+            size_t i = 0;
+            while (start + i < end && ToLower(text[start + i]) == word[i]) i++;
+            if (start + i == end) return true;
+        }
+        return false;
+    }
+
+    // Returns the length of the sentence terminator at i, 0 if none.
+    // Weak terminators (period, ellipsis) do not end a sentence before a lowercase word.
+    // CJK full stops end it even without a following space.
+    static size_t MatchTerminator(const std::string& text, size_t i, bool& weak, bool& cjk)
+    {
+        weak = false;
+        cjk = false;
+
+        switch (text[i])
+        {
+        case '.': weak = true; return 1;
+        case '!':
+        case '?': return 1;
+        }
+
+        // Other terminators are 3 byte sequences, most text is ASCII.
+        if (static_cast<unsigned char>(text[i]) < 0x80) return 0;
+
+        if (StartsWith(text, i, "\xE2\x80\xA6")) { weak = true; return 3; }
+        if (StartsWith(text, i, "\xE3\x80\x82") || StartsWith(text, i, "\xEF\xBC\x81") || StartsWith(text, i, "\xEF\xBC\x9F"))
+        {
+            cjk = true;
+            return 3;
+        }
+
+        return 0;
+    }
+
+    static size_t SkipSpaces(const std::string& text, size_t i, size_t limit)
+    {
+        while (i < limit && IsSpace(text[i])) i++;
+        return i;
+    }
+
+    SentenceSegmenter::SentenceSegmenter(const SentenceSegmenterOptions& options) :
+        m_options(options)
+    {
+    }
+
+    size_t SentenceSegmenter::Next(const std::string& text, size_t offset) const
+    {
+        auto size = text.size();
+        if (offset >= size) return size;
+
+        auto target = m_options.targetLength;
+        if (offset == 0 && size > target) target = 0;
+        if (size - offset <= target) return size;
+
+        auto maxLength = m_options.maxLength > 0 ? m_options.maxLength : 1;
+        auto limit = size - offset > maxLength ? offset + maxLength : size;
+
+        // Whole sentences while they fit.
+        auto end = offset;
+        while (end < limit)
+        {
+            auto next = FindSentenceEnd(text, end, limit);
+            if (next == std::string::npos) break;
+            if (end > offset && next - offset > target) break;
+
+            end = next;
+            if (end - offset >= target) break;
+        }
+
+        if (end > offset) return end;
+        if (limit == size) return size;
+
+        // Sentence longer than maxLength.
+        auto clauseEnd = FindClauseEnd(text, offset, limit);
+        if (clauseEnd != std::string::npos) return clauseEnd;
+
+        for (auto i = limit; i > offset + 1; i--)
+        {
+            if (IsSpace(text[i - 1])) return i;
+        }
+
+        // No space at all, cut between UTF-8 sequences.
+        auto cut = limit;
+        while (cut > offset + 1 && (static_cast<unsigned char>(text[cut]) & 0xC0) == 0x80) cut--;
+        return cut;
+    }
+
+    size_t SentenceSegmenter::FindSentenceEnd(const std::string& text, size_t from, size_t limit) const
+    {
+        auto size = text.size();
+
+        for (auto i = from; i < limit; i++)
+        {
+            // Blank line, e.g. end of a title or paragraph.
+            if (text[i] == '\n')
+            {
+                auto j = i + 1;
+                while (j < size && (text[j] == ' ' || text[j] == '\t' || text[j] == '\r')) j++;
+                if (j < size && text[j] == '\n') return SkipSpaces(text, j, limit);
+                continue;
+            }
+
+            bool weak;
+            bool cjk;
+            auto length = MatchTerminator(text, i, weak, cjk);
+            if (length == 0) continue;
+
+            // Whole run, e.g. "?!" or "...".
+            auto j = i + length;
+            auto allWeak = weak;
+            auto anyCjk = cjk;
+            while (j < size)
+            {
+                length = MatchTerminator(text, j, weak, cjk);
+                if (length == 0) break;
+                allWeak = allWeak && weak;
+                anyCjk = anyCjk || cjk;
+                j += length;
+            }
+
+            while (j < size)
+            {
+                length = MatchAny(text, j, kClosings);
+                if (length == 0) break;
+                j += length;
+            }
+
+            if (j > limit) return std::string::npos;
+
+            if (!anyCjk)
+            {
+                // Decimal numbers, URLs, "e.g" inside a word.
+                if (j < size && !IsSpace(text[j]))
+                {
+                    i = j - 1;
+                    continue;
+                }
+
+                if (allWeak)
+                {
+                    auto next = SkipSpaces(text, j, size);
+                    if (next < size && text[next] >= 'a' && text[next] <= 'z')
+                    {
+                        i = j - 1;
+                        continue;
+                    }
+
+                    if (text[i] == '.' && j == i + 1 && IsAbbreviation(text, i))
+                    {
+                        continue;
+                    }
+                }
+            }
+
+            return SkipSpaces(text, j, limit);
+        }
+
+        return std::string::npos;
+    }
+
+    size_t SentenceSegmenter::FindClauseEnd(const std::string& text, size_t from, size_t limit) const
+    {
+        auto clauseEnd = std::string::npos;
+
+        for (auto i = from; i < limit; i++)
+        {
+            auto length = MatchAny(text, i, kClauseEnds);
+            if (length == 0) continue;
+
+            auto j = i + length;
+            if (j > limit) break;
+
+            if (j == text.size() || IsSpace(text[j]))
+            {
+                clauseEnd = SkipSpaces(text, j, limit);
+            }
+            i = j - 1;
+        }
+
+        return clauseEnd;
+    }
+
+    bool SentenceSegmenter::IsAbbreviation(const std::string& text, size_t period) const
+    {
+        auto start = period;
+        while (start > 0 && (IsLetter(text[start - 1]) || text[start - 1] == '.')) start--;
+
+        if (start == period)
+        {
+            // List number at the start of a line, e.g. "1. First".
+            while (start > 0 && IsDigit(text[start - 1])) start--;
+            if (start == period) return false;
+
+            while (start > 0 && (text[start - 1] == ' ' || text[start - 1] == '\t')) start--;
+            return start == 0 || text[start - 1] == '\n';
+        }
+
+        // Word glued to something else, e.g. "3rd." or "café.".
+        if (start > 0 && !IsSpace(text[start - 1]) && text[start - 1] != '(' && text[start - 1] != '"') return false;
+
+        // Initial, e.g. "J. Smith", or dotted abbreviation, e.g. "e.g." or "U.S.".
+        if (period - start == 1 || text.find('.', start) < period) return true;
+
+        if (ContainsWord(text, start, period, kAbbreviations)) return true;
+
+        auto next = SkipSpaces(text, period + 1, text.size());
+        return next < text.size() && IsDigit(text[next]) && ContainsWord(text, start, period, kNumberAbbreviations);
+    }
+
+}
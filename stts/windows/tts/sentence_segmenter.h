@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace stts {
+
+	struct SentenceSegmenterOptions {
+		// Chunks gather whole sentences up to this size, in UTF-8 bytes.
+		size_t targetLength = 400;
+		// Longer sentences are cut at a clause boundary, else at a space, else between characters.
+		size_t maxLength = 1000;
+	};
+
+	// Splits UTF-8 text in chunks of whole sentences, so long texts can be spoken piece by piece.
+	//
+	// Sentences end with . ! ? or … followed by a space, with CJK full stops, or at blank lines.
+	// Periods of abbreviations (e.g. "Dr.", "e.g."), initials, list numbers and periods followed
+	// by a lowercase word do not end a sentence. Decimal numbers never do since no space follows.
+	class SentenceSegmenter {
+	public:
+		explicit SentenceSegmenter(const SentenceSegmenterOptions& options = SentenceSegmenterOptions());
+
+		// Returns the end of the chunk starting at offset, trailing spaces included.
+		// The first chunk of a text longer than targetLength is a single sentence, to start speaking early.
+		// Text up to targetLength is a single chunk.
+		size_t Next(const std::string& text, size_t offset) const;
+
+		const SentenceSegmenterOptions& GetOptions() const { return m_options; }
+
+	private:
+		SentenceSegmenterOptions m_options;
+
+		// Returns the position after the first sentence end in [from, limit) and its trailing spaces,
+		// or std::string::npos.
+		size_t FindSentenceEnd(const std::string& text, size_t from, size_t limit) const;
+		// Returns the position after the last clause end in (from, limit], or std::string::npos.
+		size_t FindClauseEnd(const std::string& text, size_t from, size_t limit) const;
+		bool IsAbbreviation(const std::string& text, size_t period) const;
+	};
+
+}
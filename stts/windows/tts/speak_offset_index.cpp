@@ -0,0 +1,73 @@
+#include "speak_offset_index.h"
+
+namespace stts {
+
+    static const size_t kBlockShift = 6;
+
+    void SpeakOffsetIndex::Clear()
+    {
+        m_anchors.clear();
+        m_blocks.clear();
+        m_xmlLength = 0;
+    }
+
+    void SpeakOffsetIndex::AddMarkup(size_t xmlPosition, size_t textPosition)
+    {
+        Add(xmlPosition, textPosition, false);
+    }
+
+    void SpeakOffsetIndex::AddText(size_t xmlPosition, size_t textPosition)
+    {
+        Add(xmlPosition, textPosition, true);
+    }
+
+    void SpeakOffsetIndex::Add(size_t xmlPosition, size_t textPosition, bool isText)
+    {
+        Anchor anchor{ static_cast<uint32_t>(xmlPosition), static_cast<uint32_t>(textPosition), isText };
+
+        // Empty runs, e.g. text right after a tag, are replaced so anchors keep increasing.
+        if (!m_anchors.empty() && m_anchors.back().xml == anchor.xml)
+        {
+            m_anchors.back() = anchor;
+            return;
+        }
+
+        // Same kind of run going on.
+        if (!m_anchors.empty() && !isText && !m_anchors.back().isText && m_anchors.back().text == anchor.text)
+        {
+            return;
+        }
+
+        m_anchors.push_back(anchor);
+    }
+
+    void SpeakOffsetIndex::Finish(size_t xmlLength)
+    {
+        m_xmlLength = xmlLength;
+        m_blocks.assign((xmlLength >> kBlockShift) + 1, 0);
+
+        uint32_t anchor = 0;
+        for (size_t block = 0; block < m_blocks.size(); block++)
+        {
+            auto start = block << kBlockShift;
+            while (anchor + 1 < m_anchors.size() && m_anchors[anchor + 1].xml <= start) anchor++;
+            m_blocks[block] = anchor;
+        }
+    }
+
+    size_t SpeakOffsetIndex::ToTextPosition(size_t xmlPosition) const
+    {
+        if (m_anchors.empty() || xmlPosition < m_anchors.front().xml) return 0;
+        if (xmlPosition > m_xmlLength) xmlPosition = m_xmlLength;
+
+        auto block = xmlPosition >> kBlockShift;
+        size_t anchor = block < m_blocks.size() ? m_blocks[block] : m_blocks.empty() ? 0 : m_blocks.back();
+
+        // Anchors are at distinct positions, at most one block of them is read.
+        while (anchor + 1 < m_anchors.size() && m_anchors[anchor + 1].xml <= xmlPosition) anchor++;
+
+        const auto& found = m_anchors[anchor];
+        return found.isText ? found.text + (xmlPosition - found.xml) : found.text;
+    }
+
+}
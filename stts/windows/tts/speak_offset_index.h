@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stts {
+
+	// Maps positions in generated SAPI XML back to the text it was built from, both in UTF-16 code units.
+	//
+	// XML is made of text copied 1:1 and of markup (tags, entities of escaped characters). Each change
+	// between the two is an anchor. Anchors are found from a table of the first one of each 64 XML units block,
+	// so a lookup reads at most 64 anchors whatever the document size.
+	class SpeakOffsetIndex {
+	public:
+		void Clear();
+
+		// XML from xmlPosition is markup standing at textPosition in the text.
+		void AddMarkup(size_t xmlPosition, size_t textPosition);
+		// XML from xmlPosition is a copy of the text from textPosition.
+		void AddText(size_t xmlPosition, size_t textPosition);
+
+		// Builds the lookup table, no anchor can be added afterwards.
+		void Finish(size_t xmlLength);
+
+		// Positions inside markup give the text position where the markup stands.
+		// Positions past the end of the XML give the text length.
+		size_t ToTextPosition(size_t xmlPosition) const;
+
+	private:
+		struct Anchor {
+			uint32_t xml;
+			uint32_t text;
+			bool isText;
+		};
+
+		std::vector<Anchor> m_anchors;
+		// Index of the last anchor at or before the start of each block.
+		std::vector<uint32_t> m_blocks;
+		size_t m_xmlLength = 0;
+
+		void Add(size_t xmlPosition, size_t textPosition, bool isText);
+	};
+
+}
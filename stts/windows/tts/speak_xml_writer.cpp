@@ -0,0 +1,315 @@
+#include "speak_xml_writer.h"
+
+#include <bitset>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
+#define STTS_XML_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace stts {
+
+    // Escaped characters take up to 6 code units ("&quot;") instead of 1.
+    static const size_t kMaxEscapeGrowth = 5;
+    // Room left for the tags around the text.
+    static const size_t kTagReserve = 128;
+
+#ifdef STTS_XML_SSE2
+    // Bit set for each byte which cannot be copied as is: markup characters, controls and non ASCII.
+    static inline int GetSpecialMask(__m128i bytes)
+    {
+        // Bytes from 0x80 are negative, below 0x20 as well.
+        auto special = _mm_cmplt_epi8(bytes, _mm_set1_epi8(0x20));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('&')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('<')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('>')));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')));
+        return _mm_movemask_epi8(special);
+    }
+
+    static inline int GetMarkupMask(__m128i bytes)
+    {
+        auto markup = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('&'));
+        markup = _mm_or_si128(markup, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('<')));
+        markup = _mm_or_si128(markup, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('>')));
+        markup = _mm_or_si128(markup, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')));
+        return _mm_movemask_epi8(markup);
+    }
+
+    static inline int CountTrailingZeros(int mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, static_cast<unsigned long>(mask));
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+    }
+#endif
+
+    static inline bool IsMarkup(uint8_t c)
+    {
+        return c == '&' || c == '<' || c == '>' || c == '"';
+    }
+
+    static size_t CountMarkup(const uint8_t* text, size_t size)
+    {
+        size_t count = 0;
+        size_t i = 0;
+
+#ifdef STTS_XML_SSE2
+        for (; i + 16 <= size; i += 16)
+        {
+            auto mask = GetMarkupMask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)));
+            if (mask != 0) count += std::bitset<16>(static_cast<unsigned>(mask)).count();
+        }
+#endif
+
+        for (; i < size; i++)
+        {
+            if (IsMarkup(text[i])) count++;
+        }
+
+        return count;
+    }
+
+    // Returns the length of the sequence, code point is U+FFFD when invalid.
+    static inline size_t DecodeUtf8(const uint8_t* text, size_t size, uint32_t& codePoint)
+    {
+        auto c = text[0];
+        size_t length;
+        uint32_t minimum;
+
+        if (c >= 0xC2 && c <= 0xDF) { length = 2; codePoint = c & 0x1F; minimum = 0x80; }
+        else if (c >= 0xE0 && c <= 0xEF) { length = 3; codePoint = c & 0x0F; minimum = 0x800; }
+        else if (c >= 0xF0 && c <= 0xF4) { length = 4; codePoint = c & 0x07; minimum = 0x10000; }
+        else { codePoint = 0xFFFD; return 1; }
+
+        if (length > size) { codePoint = 0xFFFD; return 1; }
+
+        for (size_t i = 1; i < length; i++)
+        {
+            if ((text[i] & 0xC0) != 0x80) { codePoint = 0xFFFD; return 1; }
+            codePoint = (codePoint << 6) | (text[i] & 0x3F);
+        }
+
+        // Overlong forms, surrogates and out of range values.
+        if (codePoint < minimum || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+        {
+            codePoint = 0xFFFD;
+            return 1;
+        }
+
+        return length;
+    }
+
+    void SpeakXmlWriter::Reset(size_t expectedSize, SpeakOffsetIndex* index)
+    {
+        m_xml.clear();
+        m_xml.reserve(expectedSize + kTagReserve);
+
+        m_index = index;
+        m_textLength = 0;
+        if (m_index) m_index->Clear();
+    }
+
+    void SpeakXmlWriter::Pitch(int absMiddle)
+    {
+        AppendLiteral(L"<pitch absmiddle=\"");
+        AppendInt(absMiddle);
+        AppendLiteral(L"\"/>");
+    }
+
+    void SpeakXmlWriter::Rate(int absSpeed)
+    {
+        AppendLiteral(L"<rate absspeed=\"");
+        AppendInt(absSpeed);
+        AppendLiteral(L"\"/>");
+    }
+
+    void SpeakXmlWriter::Volume(int level)
+    {
+        AppendLiteral(L"<volume level=\"");
+        AppendInt(level);
+        AppendLiteral(L"\"/>");
+    }
+
+    void SpeakXmlWriter::Silence(int milliseconds)
+    {
+        if (milliseconds == 0) return;
+
+        AppendLiteral(L"<silence msec=\"");
+        AppendInt(milliseconds);
+        AppendLiteral(L"\"/>");
+    }
+
+    void SpeakXmlWriter::Bookmark(const std::string& mark)
+    {
+        AppendLiteral(L"<bookmark mark=\"");
+        AppendEscaped(mark.data(), mark.size());
+        AppendLiteral(L"\"/>");
+    }
+
+    void SpeakXmlWriter::BeginVoice(const std::string& required, const std::string& optional)
+    {
+        AppendLiteral(L"<voice required=\"");
+        AppendEscaped(required.data(), required.size());
+
+        if (!optional.empty())
+        {
+            AppendLiteral(L"\" optional=\"");
+            AppendEscaped(optional.data(), optional.size());
+        }
+
+        AppendLiteral(L"\">");
+    }
+
+    void SpeakXmlWriter::EndVoice()
+    {
+        AppendLiteral(L"</voice>");
+    }
+
+    void SpeakXmlWriter::Text(const std::string& utf8Text)
+    {
+        AppendEscaped(utf8Text.data(), utf8Text.size(), true);
+    }
+
+    void SpeakXmlWriter::Text(const char* utf8Text, size_t size)
+    {
+        AppendEscaped(utf8Text, size, true);
+    }
+
+    // Tags always start with a literal.
+    void SpeakXmlWriter::AppendLiteral(const wchar_t* literal)
+    {
+        if (m_index) m_index->AddMarkup(m_xml.size(), m_textLength);
+
+        m_xml.append(literal);
+    }
+
+    void SpeakXmlWriter::AppendInt(int value)
+    {
+        wchar_t digits[12];
+        size_t count = 0;
+
+        auto magnitude = value < 0 ? 0u - static_cast<unsigned>(value) : static_cast<unsigned>(value);
+        do
+        {
+            digits[count++] = static_cast<wchar_t>(L'0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude != 0);
+
+        if (value < 0) m_xml.push_back(L'-');
+        while (count > 0) m_xml.push_back(digits[--count]);
+    }
+
+    void SpeakXmlWriter::AppendEscaped(const char* utf8Text, size_t size, bool isText)
+    {
+        auto text = reinterpret_cast<const uint8_t*>(utf8Text);
+
+        // A UTF-8 byte never gives more than one UTF-16 code unit, the bound is exact without markup.
+        auto start = m_xml.size();
+        // Room reserved by Reset is shared with the tags already written.
+        auto bound = size + CountMarkup(text, size) * kMaxEscapeGrowth;
+        if (m_xml.capacity() < start + bound)
+        {
+            m_xml.reserve(start + bound + kTagReserve);
+        }
+        m_xml.resize(start + bound);
+
+        auto out = &m_xml[start];
+        size_t i = 0;
+
+        // Entities replacing text characters are markup for the index.
+        auto index = isText ? m_index : nullptr;
+        size_t growth = 0;
+        if (index) index->AddText(start, m_textLength);
+
+        while (i < size)
+        {
+#ifdef STTS_XML_SSE2
+            // Plain ASCII runs are widened 16 bytes at a time.
+            while (i + 16 <= size)
+            {
+                auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+                auto mask = GetSpecialMask(bytes);
+                size_t count = mask == 0 ? 16 : static_cast<size_t>(CountTrailingZeros(mask));
+
+                if (sizeof(wchar_t) == 2 && count == 16)
+                {
+                    auto zero = _mm_setzero_si128();
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(bytes, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(bytes, zero));
+                }
+                else
+                {
+                    for (size_t j = 0; j < count; j++) out[j] = static_cast<wchar_t>(text[i + j]);
+                }
+
+                out += count;
+                i += count;
+                if (count < 16) break;
+            }
+
+            if (i >= size) break;
+#endif
+
+            auto c = text[i];
+            if (c >= 0x80)
+            {
+                uint32_t codePoint;
+                i += DecodeUtf8(text + i, size - i, codePoint);
+
+                if (codePoint >= 0x10000)
+                {
+                    codePoint -= 0x10000;
+                    *out++ = static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+                    *out++ = static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+                }
+                else
+                {
+                    // U+FFFE and U+FFFF are not allowed in XML either.
+                    *out++ = static_cast<wchar_t>(codePoint >= 0xFFFE ? 0xFFFD : codePoint);
+                }
+                continue;
+            }
+
+            if (index && IsMarkup(c))
+            {
+                auto xmlPosition = static_cast<size_t>(out - m_xml.data());
+                auto textPosition = m_textLength + (xmlPosition - start) - growth;
+                index->AddMarkup(xmlPosition, textPosition);
+
+                auto length = c == '&' ? 5 : c == '"' ? 6 : 4;
+                index->AddText(xmlPosition + length, textPosition + 1);
+                growth += length - 1;
+            }
+
+            switch (c)
+            {
+            case '&': std::memcpy(out, L"&amp;", 5 * sizeof(wchar_t)); out += 5; break;
+            case '<': std::memcpy(out, L"&lt;", 4 * sizeof(wchar_t)); out += 4; break;
+            case '>': std::memcpy(out, L"&gt;", 4 * sizeof(wchar_t)); out += 4; break;
+            case '"': std::memcpy(out, L"&quot;", 6 * sizeof(wchar_t)); out += 6; break;
+            case '\t':
+            case '\n':
+            case '\r':
+                *out++ = c;
+                break;
+            default:
+                *out++ = c < 0x20 ? L' ' : static_cast<wchar_t>(c);
+                break;
+            }
+            i++;
+        }
+
+        m_xml.resize(static_cast<size_t>(out - m_xml.data()));
+        if (index) m_textLength += m_xml.size() - start - growth;
+    }
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "speak_offset_index.h"
+
+namespace stts {
+
+	// Builds SAPI XML directly in UTF-16, in a buffer reused from one utterance to the next.
+	//
+	// Text and attribute values are given in UTF-8 and escaped, so they are always spoken as is.
+	// Characters not allowed in XML are replaced by a space, invalid UTF-8 by U+FFFD.
+	// Once the buffer has grown to the usual utterance size, writing does not allocate.
+	class SpeakXmlWriter {
+	public:
+		// Starts a new document. Room is reserved for expectedSize UTF-8 bytes of text and a few tags.
+		// When given, index is filled to map XML positions to text positions until the next Reset.
+		void Reset(size_t expectedSize = 0, SpeakOffsetIndex* index = nullptr);
+
+		// https://learn.microsoft.com/en-us/previous-versions/windows/desktop/ms717077(v=vs.85)
+		void Pitch(int absMiddle);
+		void Rate(int absSpeed);
+		void Volume(int level);
+		// Nothing is written for 0.
+		void Silence(int milliseconds);
+		void Bookmark(const std::string& mark);
+		// Text up to EndVoice is spoken by the best voice matching the attributes, e.g. "Gender=Female".
+		void BeginVoice(const std::string& required, const std::string& optional = std::string());
+		void EndVoice();
+
+		void Text(const std::string& utf8Text);
+		void Text(const char* utf8Text, size_t size);
+
+		const std::wstring& GetXml() const { return m_xml; }
+
+	private:
+		std::wstring m_xml;
+		SpeakOffsetIndex* m_index = nullptr;
+		// UTF-16 code units of text written.
+		size_t m_textLength = 0;
+
+		void AppendLiteral(const wchar_t* literal);
+		void AppendInt(int value);
+		void AppendEscaped(const char* text, size_t size, bool isText = false);
+	};
+
+}
@@ -0,0 +1,199 @@
+#include "synthesis_pipeline.h"
+
+#include "../audio/pcm_buffer.h"
+#include "../trace/trace_recorder.h"
+
+namespace stts {
+
+    SynthesisPipeline::SynthesisPipeline(const PcmFormat& format, const SynthesisPipelineOptions& options, ReadyCallback onReady) :
+        m_format(format),
+        m_onReady(std::move(onReady)),
+        m_options(options)
+    {
+    }
+
+    SynthesisPipeline::~SynthesisPipeline()
+    {
+        Stop();
+    }
+
+    void SynthesisPipeline::Start()
+    {
+        if (m_thread.joinable()) return;
+
+        m_thread = std::thread(&SynthesisPipeline::Run, this);
+    }
+
+    void SynthesisPipeline::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_isStopping = true;
+            m_stats.cancelled += m_pending.size();
+            m_pending.clear();
+
+            if (m_currentToken) m_currentToken->Cancel();
+        }
+
+        m_condition.notify_all();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    uint64_t SynthesisPipeline::Submit(SynthesisRequest request, std::shared_ptr<PcmSource> source)
+    {
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_isStopping) return 0;
+
+            id = m_nextId++;
+            m_pending.push_back({ id, std::move(request), std::move(source) });
+            m_stats.submitted++;
+        }
+
+        m_condition.notify_all();
+        return id;
+    }
+
+    size_t SynthesisPipeline::Cancel()
+    {
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            count = m_pending.size();
+            m_stats.cancelled += m_pending.size();
+            m_pending.clear();
+
+            if (m_currentToken)
+            {
+                m_currentToken->Cancel();
+                count++;
+            }
+
+            m_waitingSizes.clear();
+            m_waitingBytes = 0;
+        }
+
+        m_condition.notify_all();
+        return count;
+    }
+
+    void SynthesisPipeline::OnPlayed()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // Utterances cancelled meanwhile are not tracked anymore.
+            if (m_waitingSizes.empty()) return;
+
+            m_waitingBytes -= m_waitingSizes.front();
+            m_waitingSizes.pop_front();
+        }
+
+        m_condition.notify_all();
+    }
+
+    void SynthesisPipeline::SetOptions(const SynthesisPipelineOptions& options)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_options = options;
+        }
+
+        m_condition.notify_all();
+    }
+
+    SynthesisPipelineStats SynthesisPipeline::GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    bool SynthesisPipeline::CanRender() const
+    {
+        if (m_pending.empty()) return false;
+
+        // The playing utterance is waiting as well.
+        return m_waitingSizes.empty() ||
+            (m_waitingSizes.size() <= m_options.lookahead && m_waitingBytes < m_options.maxBytes);
+    }
+
+    void SynthesisPipeline::Run()
+    {
+        OnThreadStart();
+        TraceRecorder::SetThreadName("synthesis pipeline");
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_condition.wait(lock, [this] { return m_isStopping || CanRender(); });
+            if (m_isStopping) break;
+
+            auto queued = std::move(m_pending.front());
+            m_pending.pop_front();
+
+            auto token = std::make_shared<CancellationToken>();
+            m_currentToken = token;
+            lock.unlock();
+
+            SynthesizedUtterance utterance;
+            utterance.id = queued.id;
+            utterance.source = std::move(queued.source);
+
+            bool hasFailed = false;
+            if (!utterance.source)
+            {
+                PcmBuffer buffer(m_format);
+                if (Render(queued.request, buffer, *token))
+                {
+                    utterance.rendered = std::make_shared<const std::vector<uint8_t>>(buffer.TakeSamples());
+                    utterance.source = std::make_shared<PcmSource>(utterance.rendered, m_format);
+                }
+                else
+                {
+                    hasFailed = true;
+                }
+            }
+            utterance.request = std::move(queued.request);
+
+            lock.lock();
+            m_currentToken.reset();
+
+            if (token->IsCancelled())
+            {
+                m_stats.cancelled++;
+                continue;
+            }
+
+            if (hasFailed)
+            {
+                m_stats.failed++;
+            }
+            else
+            {
+                if (utterance.rendered) m_stats.rendered++;
+
+                m_waitingSizes.push_back(static_cast<size_t>(utterance.source->GetSize()));
+                m_waitingBytes += m_waitingSizes.back();
+            }
+
+            // Cancel may run meanwhile, the player drops stale utterances.
+            lock.unlock();
+            m_onReady(std::move(utterance));
+            lock.lock();
+        }
+
+        lock.unlock();
+
+        OnThreadStop();
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../audio/pcm_sink.h"
+#include "../audio/pcm_source.h"
+#include "../worker/engine_worker.h"
+
+namespace stts {
+
+	// Utterance to render with the voice settings at the time it was queued.
+	struct SynthesisRequest {
+		std::string voiceId;
+		long rate = 0;
+		unsigned volume = 100;
+		std::wstring speakXml;
+	};
+
+	struct SynthesisPipelineOptions {
+		// Utterances rendered ahead of the one playing. 0 disables the pipeline.
+		size_t lookahead = 0;
+		// Rendered samples waiting to be played, in bytes. The next utterance is always rendered when none is waiting.
+		size_t maxBytes = 32 << 20;
+	};
+
+	struct SynthesisPipelineStats {
+		uint64_t submitted = 0;
+		uint64_t rendered = 0;
+		uint64_t failed = 0;
+		uint64_t cancelled = 0;
+	};
+
+	struct SynthesizedUtterance {
+		uint64_t id = 0;
+		SynthesisRequest request;
+		// Samples rendered by the pipeline. Null when given at submission or on failure.
+		std::shared_ptr<const std::vector<uint8_t>> rendered;
+		// Samples to play. Null on failure.
+		std::shared_ptr<PcmSource> source;
+	};
+
+	// Renders queued utterances on a dedicated thread while previous ones play.
+	//
+	// Utterances are rendered one at a time and handed to the ready callback in submission order.
+	// Rendering pauses while lookahead utterances or maxBytes are waiting to be played, the player
+	// reports each finished utterance with OnPlayed.
+	// Thread resources (e.g. COM apartment, voice) are managed by overriding the protected hooks.
+	// Start must be called once the instance is fully constructed, and derived classes must call Stop
+	// in their destructor.
+	class SynthesisPipeline {
+	public:
+		// Called on the pipeline thread.
+		using ReadyCallback = std::function<void(SynthesizedUtterance utterance)>;
+
+		SynthesisPipeline(const PcmFormat& format, const SynthesisPipelineOptions& options, ReadyCallback onReady);
+		virtual ~SynthesisPipeline();
+
+		SynthesisPipeline(const SynthesisPipeline&) = delete;
+		SynthesisPipeline& operator=(const SynthesisPipeline&) = delete;
+
+		void Start();
+
+		// Cancels all utterances and joins the thread.
+		void Stop();
+
+		// Utterances already rendered (e.g. cached) are given as source, they keep their place in the queue.
+		// Returns the utterance ID, IDs increase with submission. Returns 0 if the pipeline is stopped.
+		uint64_t Submit(SynthesisRequest request, std::shared_ptr<PcmSource> source = nullptr);
+
+		// Drops pending utterances and stops the running render. Waiting ones are forgotten, the player
+		// is expected to drop them too. Returns the number of utterances not handed to the callback.
+		size_t Cancel();
+
+		// Oldest waiting utterance finished playing.
+		void OnPlayed();
+
+		void SetOptions(const SynthesisPipelineOptions& options);
+		const PcmFormat& GetFormat() const { return m_format; }
+		SynthesisPipelineStats GetStats() const;
+
+	protected:
+		virtual void OnThreadStart() {}
+		virtual void OnThreadStop() {}
+
+		// Returns false on failure. Called on the pipeline thread.
+		virtual bool Render(const SynthesisRequest& request, PcmSink& sink, const CancellationToken& cancellationToken) = 0;
+
+	private:
+		struct QueuedUtterance {
+			uint64_t id;
+			SynthesisRequest request;
+			std::shared_ptr<PcmSource> source;
+		};
+
+		const PcmFormat m_format;
+		ReadyCallback m_onReady;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		SynthesisPipelineOptions m_options;
+		std::deque<QueuedUtterance> m_pending;
+		std::shared_ptr<CancellationToken> m_currentToken;
+		// Sizes of utterances handed to the callback and not played yet, oldest first.
+		std::deque<size_t> m_waitingSizes;
+		size_t m_waitingBytes = 0;
+		bool m_isStopping = false;
+		uint64_t m_nextId = 1;
+		SynthesisPipelineStats m_stats;
+
+		std::thread m_thread;
+
+		bool CanRender() const;
+		void Run();
+	};
+
+}
@@ -1,14 +1,86 @@
 #include "tts.h"
+
+#include <algorithm>
 #include "../utils.h"
+#include "../catalog/sapi_token_source.h"
+#include "../sapi_event_pump.h"
+#include "../audio/pcm_buffer.h"
+#include "../audio/pcm_sink_stream.h"
+#include "../audio/pcm_source_stream.h"
+#include "../trace/trace_recorder.h"
 
 namespace stts {
 
-    Tts::Tts(EventStreamHandler* stateEventHandler) :
+    // Format of cached and pipelined utterances, the native output of most SAPI voices.
+    static const PcmFormat kCacheFormat{ 1, 22050, 16 };
+
+    static const DWORD kSpeakFlags = SPDF_PRONUNCIATION | SPF_ASYNC | SPF_IS_XML;
+
+    // Chunks are matched to utterances by their stream number.
+    static const ULONGLONG kStreamEvents = SPFEI(SPEI_START_INPUT_STREAM) | SPFEI(SPEI_END_INPUT_STREAM);
+
+    // Chunks queued to the voice, the next one is ready when the current one ends.
+    static const size_t kStreamsAhead = 2;
+
+    // Cache misses rendered in the background and not kept yet.
+    static const size_t kCacheFillAhead = 2;
+
+    // Supported values range from -10 to 10. Incoming values are 0 - 2.
+    static int ToSapiPitch(double pitch)
+    {
+        auto fixedPitch = min(max(pitch, 0.0), 2.0);
+        auto adjustedPitch = ((fixedPitch - 1) * 20) / 2;
+
+        return static_cast<int>(round(adjustedPitch));
+    }
+
+    // Supported values range from -10 to 10. Incoming values are 0.1 - 10.
+    static long ToSapiRate(double rate)
+    {
+        auto fixedRate = min(max(rate, 0.1), 10);
+        return (fixedRate < 1) ? static_cast<long>(-1 / fixedRate) : static_cast<long>(fixedRate);
+    }
+
+    // The default base volume for all voices is 100 (full volume).
+    static USHORT ToSapiVolume(double volume)
+    {
+        return static_cast<USHORT>(min(max(volume * 100, 0), 100));
+    }
+
+    // Bookmark offsets are UTF-16 positions, as in Dart strings.
+    static std::vector<size_t> ToByteOffsets(const std::string& text, const std::vector<TtsBookmark>& bookmarks)
+    {
+        std::vector<size_t> offsets;
+        offsets.reserve(bookmarks.size());
+
+        size_t i = 0;
+        size_t units = 0;
+        for (const auto& bookmark : bookmarks)
+        {
+            while (i < text.size() && units < bookmark.offset)
+            {
+                auto c = static_cast<uint8_t>(text[i]);
+                size_t length = c < 0xC0 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+                units += length == 4 ? 2 : 1;
+                i = min(i + length, text.size());
+            }
+            offsets.push_back(i);
+        }
+
+        return offsets;
+    }
+
+    Tts::Tts(EventStreamHandler* stateEventHandler, EventStreamHandler* progressEventHandler,
+        EventStreamHandler* utteranceEventHandler, TaskScheduler* scheduler) :
         m_stateEventHandler(stateEventHandler),
+        m_progressEventHandler(progressEventHandler),
+        m_utteranceEventHandler(utteranceEventHandler),
+        m_scheduler(scheduler),
         m_pVoice(NULL),
         m_pitch(0),
         m_isPaused(false),
-        m_utteranceQueued(0)
+        m_voiceCatalog(std::make_unique<SapiTokenSource>(SPCAT_VOICES)),
+        m_utterances(this, [this](uint64_t id, UtteranceEvent event) { OnUtteranceEvent(id, event); })
     {
     }
 
@@ -18,90 +90,156 @@ namespace stts {
 
     bool Tts::IsSupported()
     {
-        return CreateVoice() == S_OK;
+        try
+        {
+            return !m_voiceCatalog.GetTokens().empty();
+        }
+        catch (HRESULT)
+        {
+            return false;
+        }
+    }
+
+    uint64_t Tts::GetEnginesGeneration()
+    {
+        try
+        {
+            return m_voiceCatalog.GetGeneration();
+        }
+        catch (HRESULT)
+        {
+            return 0;
+        }
     }
 
     // static
     void __stdcall Tts::SpeakEndNotifyCallback(WPARAM wParam, LPARAM lParam) {
         auto pThis = (Tts*)wParam;
+        TraceSpan span("sapi", "Tts::SpeakEndNotifyCallback");
 
-        CSpEvent event;
-        while (event.GetFrom(pThis->m_pVoice) == S_OK)
-        {
-            if (SPEI_END_INPUT_STREAM == event.eEventId)
+        auto wasEmpty = pThis->m_utterances.IsEmpty();
+        PumpEvents(pThis->m_pVoice, [pThis](CSpEvent& event) {
+            if (SPEI_START_INPUT_STREAM == event.eEventId)
             {
-                pThis->m_utteranceQueued = max(0, pThis->m_utteranceQueued - 1);
-                if (pThis->m_utteranceQueued == 0)
-                {
-                    pThis->m_stateEventHandler->Success(flutter::EncodableValue(0));
-                }
+                pThis->OnStreamStarted(event.ulStreamNum);
             }
+            else if (SPEI_END_INPUT_STREAM == event.eEventId)
+            {
+                pThis->OnStreamEnded(event.ulStreamNum);
+            }
+            else
+            {
+                pThis->OnProgress(event);
+            }
+        });
 
-            event.Clear();
+        if (!pThis->m_progressEncoder.IsEmpty())
+        {
+            pThis->m_progressEventHandler->Success(flutter::EncodableValue(pThis->m_progressEncoder.GetBuffer()));
+            pThis->m_progressEncoder.Clear();
         }
+
+        // At most one state change per notification.
+        pThis->QueueChunks();
+        pThis->NotifyQueueState(wasEmpty);
     }
 
-    inline std::string GetPitchTag(int pitch) {
-        return "<pitch absmiddle=\"" + std::to_string(pitch) + "\"/>";
+    // Text is escaped, it is never interpreted as markup.
+    const std::wstring& Tts::GetSpeakXml(const std::string& text, const TtsOptions& options)
+    {
+        m_xmlWriter.Reset(text.size());
+        auto hasVoice = BeginVoiceSettings(options.voice);
+        m_xmlWriter.Silence(options.preSilenceMs);
+        m_xmlWriter.Text(text);
+        m_xmlWriter.Silence(options.postSilenceMs);
+        if (hasVoice) m_xmlWriter.EndVoice();
+
+        return m_xmlWriter.GetXml();
     }
 
-    inline std::string GetSilenceTag(int silenceMs) {
-        if (silenceMs != NULL)
-        {
-            return "<silence msec=\"" + std::to_string(silenceMs) + "\"/>";
-        }
+    // Written as absolute values in the markup, the voice itself is not changed.
+    bool Tts::BeginVoiceSettings(const TtsVoiceSettings& settings)
+    {
+        const EngineToken* voice = settings.voiceId ? m_voiceCatalog.FindById(*settings.voiceId) : nullptr;
+        if (voice) m_xmlWriter.BeginVoice("Name=" + voice->name);
+
+        m_xmlWriter.Pitch(settings.pitch ? ToSapiPitch(*settings.pitch) : m_pitch);
+        if (settings.rate) m_xmlWriter.Rate(ToSapiRate(*settings.rate));
+        if (settings.volume) m_xmlWriter.Volume(ToSapiVolume(*settings.volume));
 
-        return "";
+        return voice != nullptr;
     }
 
-    void Tts::Start(std::string text, std::unique_ptr<TtsOptions> options)
+    void Tts::CheckVoiceSettings(const TtsVoiceSettings& settings)
+    {
+        if (settings.voiceId && !m_voiceCatalog.FindById(*settings.voiceId)) ThrowIfFailed(SPERR_NOT_FOUND);
+    }
+
+    uint64_t Tts::Start(std::string text, std::unique_ptr<TtsOptions> options)
     {
         ThrowIfFailed(CreateVoice());
+        CheckVoiceSettings(options->voice);
 
-        DWORD flags = SPDF_PRONUNCIATION | SPF_ASYNC | SPF_IS_XML;
-        if (options->mode.compare("flush") == 0)
+        auto wasEmpty = m_utterances.IsEmpty();
+        if (options->mode.compare("flush") == 0) m_utterances.CancelAll();
+
+        ScheduledUtterance utterance;
+        utterance.priority = options->priority;
+        if (options->deadlineMs > 0)
         {
-            flags |= SPF_PURGEBEFORESPEAK;
+            utterance.deadline = ScheduledUtterance::Clock::now() + std::chrono::milliseconds(options->deadlineMs);
         }
+        utterance.text = std::move(text);
+        utterance.preSilenceMs = options->preSilenceMs;
+        utterance.postSilenceMs = options->postSilenceMs;
+        utterance.bookmarks = std::move(options->bookmarks);
+        utterance.bookmarkBytes = ToByteOffsets(utterance.text, utterance.bookmarks);
+        utterance.voice = std::move(options->voice);
+        auto id = m_utterances.Add(std::move(utterance));
+
+        // A failed first chunk drops the utterance.
+        HRESULT hr = QueueChunks();
+        NotifyQueueState(wasEmpty);
+
+        if (!m_utterances.Contains(id)) ThrowIfFailed(hr);
+        return id;
+    }
 
-        text = 
-            GetPitchTag(m_pitch)
-            +
-            GetSilenceTag(options->preSilenceMs)
-            +
-            text
-            +
-            GetSilenceTag(options->postSilenceMs);
-
-        ThrowIfFailed(m_pVoice->Speak(Utf16FromUtf8(text).c_str(), flags, NULL));
+    bool Tts::Cancel(uint64_t id)
+    {
+        auto wasEmpty = m_utterances.IsEmpty();
+        auto cancelled = m_utterances.Cancel(id);
 
-        m_utteranceQueued++;
+        QueueChunks();
+        NotifyQueueState(wasEmpty);
 
-        if (m_utteranceQueued == 1)
-        {
-            m_stateEventHandler->Success(flutter::EncodableValue(1));
-        }
+        return cancelled;
     }
 
     void Tts::Stop()
     {
-        m_utteranceQueued = 0;
+        auto wasEmpty = m_utterances.IsEmpty();
+        m_utterances.CancelAll();
+        Purge();
+        CancelCacheFill();
 
         if (m_pVoice)
         {
-            m_pVoice->Speak(L"", SPF_PURGEBEFORESPEAK, NULL);
             if (m_isPaused)
             {
                 m_pVoice->Resume();
                 m_isPaused = false;
             }
         }
+
+        NotifyQueueState(wasEmpty);
     }
 
     void Tts::Pause()
     {
         if (m_pVoice && !m_isPaused)
         {
+            TraceSpan span("sapi", "ISpVoice::Pause");
             ThrowIfFailed(m_pVoice->Pause());
             m_isPaused = true;
 
@@ -113,6 +251,7 @@ namespace stts {
     {
         if (m_pVoice && m_isPaused)
         {
+            TraceSpan span("sapi", "ISpVoice::Resume");
             ThrowIfFailed(m_pVoice->Resume());
             m_isPaused = false;
 
@@ -120,163 +259,565 @@ namespace stts {
         }
     }
 
-    std::string Tts::GetLanguage()
+    SynthesisRequest Tts::GetSynthesisRequest(std::string text, const TtsOptions& options)
     {
-        std::string language = "";
-
         ThrowIfFailed(CreateVoice());
+        CheckVoiceSettings(options.voice);
 
-        ISpObjectToken* pToken = NULL;
-        ThrowIfFailed(m_pVoice->GetVoice(&pToken));
-        
-        ISpDataKey* cpAttribKey;
-        ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
-
-        LPWSTR wValue;
-        ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
+        SynthesisRequest request;
+        ThrowIfFailed(GetSynthesisRequest(GetSpeakXml(text, options), request));
+        return request;
+    }
 
-        // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-        wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-        LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-        CoTaskMemFree(wValue);
+    void Tts::SetCacheBudget(size_t budget)
+    {
+        m_cache.SetBudget(budget);
+    }
 
-        language = (std::string)CW2A(locale);
+    const UtteranceCacheStats& Tts::GetCacheStats() const
+    {
+        return m_cache.GetStats();
+    }
 
-        cpAttribKey->Release();
-        pToken->Release();
+    void Tts::OpenStore(const std::string& utf8BasePath, uint64_t maxBytes)
+    {
+        UtteranceStoreOptions options;
+        options.maxBytes = maxBytes;
 
-        return language;
+        // Previous files are released first, the same store may be opened again.
+        m_store.reset();
+        m_store = UtteranceStore::Open(utf8BasePath, options);
+        if (!m_store) ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_OPEN_FAILED));
     }
 
-    void Tts::SetLanguage(std::string language)
+    void Tts::CloseStore()
     {
-        if (GetLanguage() == language) { return; }
+        m_store.reset();
+    }
 
-        auto voices = GetVoicesByLanguage(language);
+    UtteranceStoreStats Tts::GetStoreStats() const
+    {
+        return m_store ? m_store->GetStats() : UtteranceStoreStats();
+    }
 
-        // Set first matching voice
-        for (TtsVoice voice : voices)
+    void Tts::SetPipelineOptions(const SynthesisPipelineOptions& options)
+    {
+        if (options.lookahead == 0)
         {
-            if (voice.language == language)
+            if (m_pipeline)
             {
-                SetVoice(voice.id);
+                Stop();
+                m_pipeline.reset();
             }
+            m_pipelineLookahead = 0;
+            return;
         }
+
+        m_pipelineLookahead = options.lookahead;
+
+        if (m_pipeline)
+        {
+            m_pipeline->SetOptions(options);
+            return;
+        }
+
+        // IDs restart with the new pipeline, results of a previous one must not match.
+        auto generation = ++m_pipelineGeneration;
+        m_pipelineCancelledId = 0;
+        m_pipelineLastId = 0;
+        m_pipelineInFlight = 0;
+
+        // Results are played on this thread, in order.
+        m_pipeline = std::make_unique<SapiSynthesisPipeline>(kCacheFormat, options, [this, generation](SynthesizedUtterance utterance) {
+            auto shared = std::make_shared<SynthesizedUtterance>(std::move(utterance));
+            m_scheduler->Schedule(std::chrono::milliseconds(0), [this, generation, shared]() {
+                if (generation == m_pipelineGeneration) OnPipelineReady(*shared);
+            });
+        });
+        m_pipeline->Start();
     }
 
-    // https://learn.microsoft.com/en-us/previous-versions/windows/desktop/ee431801(v=vs.85)#62-category-recognizers
-    std::vector<std::string> Tts::GetLanguages()
+    SynthesisPipelineStats Tts::GetPipelineStats() const
     {
-        std::vector<std::string> languages;
+        return m_pipeline ? m_pipeline->GetStats() : SynthesisPipelineStats();
+    }
 
-        IEnumSpObjectTokens* cpEnum = NULL;
-        ThrowIfFailed(SpEnumTokens(SPCAT_VOICES, NULL, NULL, &cpEnum));
+    HRESULT Tts::QueueChunks()
+    {
+        // Enough for the pipeline to render ahead.
+        m_utterances.SetChunksAhead(m_pipeline ? m_pipelineLookahead + 1 : kStreamsAhead);
 
-        ISpObjectToken* pToken = NULL;
-        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
+        m_speakError = S_OK;
+        m_utterances.Pump(UtteranceScheduler::Clock::now());
+        ScheduleDeadline();
+
+        return m_speakError;
+    }
+
+    void Tts::NotifyQueueState(bool wasEmpty)
+    {
+        auto isEmpty = m_utterances.IsEmpty();
+        if (wasEmpty == isEmpty) return;
+
+        m_stateEventHandler->Success(flutter::EncodableValue(isEmpty ? 0 : 1));
+    }
+
+    void Tts::OnUtteranceEvent(uint64_t id, UtteranceEvent event)
+    {
+        m_utteranceEventHandler->Success(flutter::EncodableValue(flutter::EncodableMap{
+            {flutter::EncodableValue("id"), flutter::EncodableValue(static_cast<int64_t>(id))},
+            {flutter::EncodableValue("state"), flutter::EncodableValue(static_cast<int>(event))}
+        }));
+    }
+
+    void Tts::ScheduleDeadline()
+    {
+        if (m_deadlineTaskId != 0)
         {
-            ISpDataKey* cpAttribKey;
-            ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
+            m_scheduler->Unschedule(m_deadlineTaskId);
+            m_deadlineTaskId = 0;
+        }
 
-            LPWSTR wValue;
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
+        auto deadline = m_utterances.GetNextDeadline();
+        if (deadline == (UtteranceScheduler::Clock::time_point::max)()) return;
 
-            // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-            wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-            LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-            CoTaskMemFree(wValue);
+        auto delay = std::chrono::ceil<std::chrono::milliseconds>(deadline - UtteranceScheduler::Clock::now());
+        m_deadlineTaskId = m_scheduler->Schedule(max(delay, std::chrono::milliseconds(0)), [this]() {
+            m_deadlineTaskId = 0;
 
-            std::string language((std::string)CW2A(locale));
+            auto wasEmpty = m_utterances.IsEmpty();
+            QueueChunks();
+            NotifyQueueState(wasEmpty);
+        });
+    }
 
-            // Don't duplicate results
-            if (std::find(languages.begin(), languages.end(), language) == languages.end()) {
-                languages.push_back(language);
-            }
+    uint64_t Tts::Speak(ScheduledUtterance& utterance, size_t end)
+    {
+        QueuedStream stream;
+        stream.handle = ++m_lastStreamHandle;
+        stream.utteranceId = utterance.id;
+        stream.textPosition = utterance.textPosition;
 
-            cpAttribKey->Release();
-            pToken->Release();
+        HRESULT hr = SpeakChunk(GetChunkXml(utterance, end, stream), stream);
+        if (FAILED(hr))
+        {
+            if (SUCCEEDED(m_speakError)) m_speakError = hr;
+            return 0;
         }
 
-        cpEnum->Release();
+        m_queuedStreams.push_back(std::move(stream));
+        return m_queuedStreams.back().handle;
+    }
 
-        return languages;
+    void Tts::Purge()
+    {
+        CancelPipeline();
+        m_queuedStreams.clear();
+
+        // Late events of purged streams match no queued stream.
+        if (m_pVoice)
+        {
+            TraceSpan span("sapi", "ISpVoice::Speak(purge)");
+            m_pVoice->Speak(NULL, SPF_PURGEBEFORESPEAK, NULL);
+        }
     }
 
-    void Tts::SetVoice(std::string voiceId)
+    // Bookmarks are written where they stand, those at the very end in the last chunk.
+    const std::wstring& Tts::GetChunkXml(ScheduledUtterance& utterance, size_t end, QueuedStream& stream)
     {
-        ThrowIfFailed(CreateVoice());
+        auto isFirst = utterance.offset == 0;
+        auto isLast = end == utterance.text.size();
+
+        // Positions are only mapped for events the voice reports.
+        if (IsSpokenDirectly() && (m_progressInterest & (SPFEI(SPEI_WORD_BOUNDARY) | SPFEI(SPEI_SENTENCE_BOUNDARY))) != 0)
+        {
+            stream.index = std::make_shared<SpeakOffsetIndex>();
+        }
 
-        IEnumSpObjectTokens* cpEnum = NULL;
-        ThrowIfFailed(SpEnumTokens(SPCAT_VOICES, NULL, NULL, &cpEnum));
+        m_xmlWriter.Reset(end - utterance.offset, stream.index.get());
+        auto hasVoice = BeginVoiceSettings(utterance.voice);
+        if (isFirst) m_xmlWriter.Silence(utterance.preSilenceMs);
 
-        ISpObjectToken* pToken = NULL;
-        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
+        auto position = utterance.offset;
+        while (utterance.nextBookmark < utterance.bookmarks.size())
         {
-            LPWSTR wValue;
-            ThrowIfFailed(pToken->GetStringValue(L"CLSID", &wValue));
+            auto bookmarkByte = utterance.bookmarkBytes[utterance.nextBookmark];
+            if (bookmarkByte > end || (bookmarkByte == end && !isLast)) break;
 
-            if (voiceId == (std::string)CW2A(wValue))
-            {
-                m_pVoice->SetVoice(pToken);
+            m_xmlWriter.Text(utterance.text.data() + position, bookmarkByte - position);
+            position = bookmarkByte;
 
-                CoTaskMemFree(wValue);
-                pToken->Release();
-                cpEnum->Release();
-                return;
+            const auto& bookmark = utterance.bookmarks[utterance.nextBookmark++];
+            m_xmlWriter.Bookmark(bookmark.name);
+            stream.bookmarks.push_back(bookmark);
+        }
+
+        m_xmlWriter.Text(utterance.text.data() + position, end - position);
+        if (isLast) m_xmlWriter.Silence(utterance.postSilenceMs);
+        if (hasVoice) m_xmlWriter.EndVoice();
+
+        const auto& speakXml = m_xmlWriter.GetXml();
+        if (stream.index) stream.index->Finish(speakXml.size());
+
+        return speakXml;
+    }
+
+    HRESULT Tts::SpeakChunk(const std::wstring& speakXml, QueuedStream& stream)
+    {
+        if (m_pipeline)
+        {
+            stream.isPipelined = true;
+            return SpeakPipelined(speakXml);
+        }
+        if (m_cache.IsEnabled() || m_store) return SpeakCached(speakXml, stream.streamNumber);
+
+        TraceSpan span("sapi", "ISpVoice::Speak");
+        return m_pVoice->Speak(speakXml.c_str(), kSpeakFlags, &stream.streamNumber);
+    }
+
+    bool Tts::IsSpokenDirectly() const
+    {
+        return !m_pipeline && !m_cache.IsEnabled() && !m_store;
+    }
+
+    std::deque<Tts::QueuedStream>::iterator Tts::FindStream(ULONG streamNumber)
+    {
+        if (streamNumber == 0) return m_queuedStreams.end();
+
+        return std::find_if(m_queuedStreams.begin(), m_queuedStreams.end(), [streamNumber](const QueuedStream& stream) {
+            return stream.streamNumber == streamNumber;
+        });
+    }
+
+    void Tts::OnStreamStarted(ULONG streamNumber)
+    {
+        auto stream = FindStream(streamNumber);
+        if (stream != m_queuedStreams.end()) m_utterances.OnChunkStarted(stream->handle);
+    }
+
+    void Tts::OnStreamEnded(ULONG streamNumber)
+    {
+        // Purged streams are not queued anymore.
+        auto stream = FindStream(streamNumber);
+        if (stream == m_queuedStreams.end()) return;
+
+        auto handle = stream->handle;
+        auto isPipelined = stream->isPipelined;
+        m_queuedStreams.erase(stream);
+
+        // Next one may be rendered.
+        if (isPipelined && m_pipeline) m_pipeline->OnPlayed();
+
+        m_utterances.OnChunkEnded(handle);
+    }
+
+    void Tts::OnProgress(CSpEvent& event)
+    {
+        auto stream = FindStream(event.ulStreamNum);
+        if (stream == m_queuedStreams.end()) return;
+
+        EventRecord record;
+        record.type = EventType::progress;
+        record.sequence = static_cast<uint32_t>(stream->utteranceId);
+
+        if (SPEI_TTS_BOOKMARK == event.eEventId)
+        {
+            // Reported in the order they were written.
+            if (stream->nextBookmark >= stream->bookmarks.size()) return;
+
+            const auto& bookmark = stream->bookmarks[stream->nextBookmark++];
+            record.flags = eventFlagBookmark;
+            record.arg0 = static_cast<uint32_t>(bookmark.offset);
+            record.payload = bookmark.name;
+        }
+        else if (SPEI_WORD_BOUNDARY == event.eEventId || SPEI_SENTENCE_BOUNDARY == event.eEventId)
+        {
+            if (!stream->index) return;
+
+            // Position and length in the XML.
+            auto start = static_cast<size_t>(event.lParam);
+            auto textStart = stream->index->ToTextPosition(start);
+            auto textEnd = stream->index->ToTextPosition(start + static_cast<size_t>(event.wParam));
+
+            record.flags = SPEI_SENTENCE_BOUNDARY == event.eEventId ? eventFlagSentence : 0;
+            record.arg0 = static_cast<uint32_t>(stream->textPosition + textStart);
+            record.arg1 = static_cast<uint32_t>(textEnd - textStart);
+        }
+        else
+        {
+            return;
+        }
+
+        m_progressEncoder.Write(record);
+    }
+
+    // Misses are spoken by the voice while the cache filler renders them for next time.
+    HRESULT Tts::SpeakCached(const std::wstring& speakXml, ULONG& streamNumber)
+    {
+        SynthesisRequest request;
+        HRESULT hr = GetSynthesisRequest(speakXml, request);
+        if (FAILED(hr)) return hr;
+
+        auto key = GetUtteranceKey(request);
+        auto source = FindRendered(key);
+        if (!source)
+        {
+            FillCache(key, std::move(request));
+
+            TraceSpan span("sapi", "ISpVoice::Speak");
+            return m_pVoice->Speak(speakXml.c_str(), kSpeakFlags, &streamNumber);
+        }
+
+        ISpStream* pStream = NULL;
+        hr = PcmSourceStream::CreateSpStream(source, &pStream);
+        if (FAILED(hr)) return hr;
+
+        // Queued with spoken utterances, end of stream events are the same.
+        {
+            TraceSpan span("sapi", "ISpVoice::SpeakStream");
+            hr = m_pVoice->SpeakStream(pStream, SPF_ASYNC, &streamNumber);
+        }
+        pStream->Release();
+
+        return hr;
+    }
+
+    // Rendered on the pipeline thread, then played from OnPipelineReady.
+    HRESULT Tts::SpeakPipelined(const std::wstring& speakXml)
+    {
+        SynthesisRequest request;
+        HRESULT hr = GetSynthesisRequest(speakXml, request);
+        if (FAILED(hr)) return hr;
+
+        // Cached utterances wait for the ones queued before.
+        auto source = FindRendered(GetUtteranceKey(request));
+
+        auto id = m_pipeline->Submit(std::move(request), source);
+        if (id == 0) return E_ABORT;
+
+        m_pipelineLastId = id;
+        m_pipelineInFlight++;
+        return S_OK;
+    }
+
+    void Tts::OnPipelineReady(SynthesizedUtterance& utterance)
+    {
+        if (!m_pipeline || !m_pVoice || utterance.id <= m_pipelineCancelledId) return;
+
+        // Oldest stream not handed to the voice yet, results come in order.
+        auto stream = std::find_if(m_queuedStreams.begin(), m_queuedStreams.end(), [](const QueuedStream& queued) {
+            return queued.isPipelined && queued.streamNumber == 0;
+        });
+        if (stream == m_queuedStreams.end()) return;
+        m_pipelineInFlight--;
+
+        HRESULT hr = E_FAIL;
+        if (utterance.source)
+        {
+            if (utterance.rendered) KeepRendered(GetUtteranceKey(utterance.request), utterance.rendered);
+
+            ISpStream* pStream = NULL;
+            hr = PcmSourceStream::CreateSpStream(utterance.source, &pStream);
+            if (SUCCEEDED(hr))
+            {
+                TraceSpan span("sapi", "ISpVoice::SpeakStream");
+                hr = m_pVoice->SpeakStream(pStream, SPF_ASYNC, &stream->streamNumber);
+                pStream->Release();
             }
 
-            CoTaskMemFree(wValue);
-            pToken->Release();
+            if (FAILED(hr)) m_pipeline->OnPlayed();
+        }
+
+        // Skipped, as if it ended.
+        if (FAILED(hr))
+        {
+            auto wasEmpty = m_utterances.IsEmpty();
+            auto handle = stream->handle;
+            m_queuedStreams.erase(stream);
+
+            m_utterances.OnChunkEnded(handle);
+            QueueChunks();
+            NotifyQueueState(wasEmpty);
         }
+    }
+
+    void Tts::CancelPipeline()
+    {
+        if (!m_pipeline) return;
 
-        cpEnum->Release();
+        m_pipeline->Cancel();
+        m_pipelineCancelledId = m_pipelineLastId;
+        m_pipelineInFlight = 0;
     }
 
-    std::vector<TtsVoice> Tts::GetVoices()
+    void Tts::FillCache(const UtteranceKey& key, SynthesisRequest request)
     {
-        std::vector<TtsVoice> voices;
+        if (!m_fillingHashes.insert(key.hash).second) return;
+
+        if (!m_cacheFiller)
+        {
+            SynthesisPipelineOptions options;
+            options.lookahead = kCacheFillAhead;
+
+            // Results are kept on this thread. IDs restart with the new filler.
+            auto generation = ++m_cacheFillerGeneration;
+            m_cacheFillerCancelledId = 0;
+            m_cacheFillerLastId = 0;
+            m_cacheFiller = std::make_unique<SapiSynthesisPipeline>(kCacheFormat, options, [this, generation](SynthesizedUtterance utterance) {
+                auto shared = std::make_shared<SynthesizedUtterance>(std::move(utterance));
+                m_scheduler->Schedule(std::chrono::milliseconds(0), [this, generation, shared]() {
+                    if (generation == m_cacheFillerGeneration) OnCacheFilled(*shared);
+                });
+            });
+            m_cacheFiller->Start();
+        }
 
-        IEnumSpObjectTokens* cpEnum = NULL;
-        ThrowIfFailed(SpEnumTokens(SPCAT_VOICES, NULL, NULL, &cpEnum));
+        auto id = m_cacheFiller->Submit(std::move(request));
+        if (id == 0)
+        {
+            m_fillingHashes.erase(key.hash);
+            return;
+        }
+
+        m_cacheFillerLastId = id;
+    }
+
+    void Tts::OnCacheFilled(SynthesizedUtterance& utterance)
+    {
+        if (!m_cacheFiller || utterance.id <= m_cacheFillerCancelledId) return;
+
+        auto key = GetUtteranceKey(utterance.request);
+        m_fillingHashes.erase(key.hash);
+
+        // Failures are spoken again next time.
+        if (!utterance.rendered) return;
+
+        KeepRendered(key, utterance.rendered);
+        m_cacheFiller->OnPlayed();
+    }
+
+    void Tts::CancelCacheFill()
+    {
+        if (!m_cacheFiller) return;
+
+        // Results handed over meanwhile are dropped, the filler forgot them.
+        m_cacheFiller->Cancel();
+        m_cacheFillerCancelledId = m_cacheFillerLastId;
+        m_fillingHashes.clear();
+    }
+
+    std::shared_ptr<PcmSource> Tts::FindRendered(const UtteranceKey& key)
+    {
+        CachedUtterance cached;
+        if (m_cache.IsEnabled() && m_cache.Find(key, cached))
+        {
+            return std::make_shared<PcmSource>(cached.samples, cached.format);
+        }
+
+        // Played from the file mapping.
+        StoredUtterance stored;
+        if (m_store && m_store->Find(key, stored))
+        {
+            return std::make_shared<PcmSource>(stored.samples, stored.size, stored.format);
+        }
+
+        return nullptr;
+    }
+
+    void Tts::KeepRendered(const UtteranceKey& key, std::shared_ptr<const std::vector<uint8_t>> samples)
+    {
+        // A full store is compacted meanwhile, the utterance is stored next time.
+        if (m_store) m_store->Put(key, kCacheFormat, samples->data(), samples->size());
+        if (m_cache.IsEnabled()) m_cache.Insert(key, kCacheFormat, std::move(samples));
+    }
 
+    HRESULT Tts::GetSynthesisRequest(const std::wstring& speakXml, SynthesisRequest& request)
+    {
         ISpObjectToken* pToken = NULL;
+        HRESULT hr = m_pVoice->GetVoice(&pToken);
+        if (FAILED(hr)) return hr;
+
+        LPWSTR wTokenId;
+        hr = pToken->GetId(&wTokenId);
+        pToken->Release();
+        if (FAILED(hr)) return hr;
+
+        request.voiceId = Utf8FromUtf16(wTokenId);
+        CoTaskMemFree(wTokenId);
 
-        while (cpEnum->Next(1, &pToken, NULL) == S_OK)
-        {            
-            TtsVoice voice;
-            LPWSTR wValue;
+        hr = m_pVoice->GetRate(&request.rate);
+        if (FAILED(hr)) return hr;
+
+        USHORT volume = 100;
+        hr = m_pVoice->GetVolume(&volume);
+        if (FAILED(hr)) return hr;
+
+        request.volume = volume;
+        request.speakXml = speakXml;
+        return S_OK;
+    }
+
+    UtteranceKey Tts::GetUtteranceKey(const SynthesisRequest& request)
+    {
+        return UtteranceKey::Create(request.voiceId, request.rate, m_pitch, request.volume, request.speakXml);
+    }
+
+    std::string Tts::GetLanguage()
+    {
+        ThrowIfFailed(CreateVoice());
 
-            ThrowIfFailed(pToken->GetStringValue(L"CLSID", &wValue));
-            voice.id = (std::string)CW2A(wValue);
-            CoTaskMemFree(wValue);
+        ISpObjectToken* pToken = NULL;
+        ThrowIfFailed(m_pVoice->GetVoice(&pToken));
 
-            ISpDataKey* cpAttribKey;
-            ThrowIfFailed(pToken->OpenKey(L"Attributes", &cpAttribKey));
-            pToken->Release();
+        LPWSTR wTokenId;
+        HRESULT hr = pToken->GetId(&wTokenId);
+        pToken->Release();
+        ThrowIfFailed(hr);
 
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Language", &wValue));
+        auto voice = m_voiceCatalog.FindByTokenId(wTokenId);
+        CoTaskMemFree(wTokenId);
 
-            // We get value as locale identifier (e.g. 0x40C as String...). We need to convert it to ISO code.
-            wchar_t locale[LOCALE_NAME_MAX_LENGTH];
-            LCIDToLocaleName((LCID)std::strtol(CW2A(wValue), NULL, 16), locale, LOCALE_NAME_MAX_LENGTH, 0);
-            voice.language = (std::string)CW2A(locale);
-            CoTaskMemFree(wValue);
+        return voice ? voice->language : "";
+    }
 
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Name", &wValue));
-            voice.name = (std::string)CW2A(wValue);
-            CoTaskMemFree(wValue);
+    void Tts::SetLanguage(std::string language)
+    {
+        if (GetLanguage() == language) { return; }
 
-            ThrowIfFailed(cpAttribKey->GetStringValue(L"Gender", &wValue));
-            std::string gender((std::string)CW2A(wValue));
-            voice.gender = (gender == "Male") ? TtsVoiceGender::male : TtsVoiceGender::female;
-            CoTaskMemFree(wValue);
+        // Set first matching voice
+        auto voice = m_voiceCatalog.FindByLanguage(language);
+        if (voice)
+        {
+            SelectVoice(*voice);
+        }
+    }
 
-            voices.push_back(voice);
+    // https://learn.microsoft.com/en-us/previous-versions/windows/desktop/ee431801(v=vs.85)#62-category-recognizers
+    std::vector<std::string> Tts::GetLanguages()
+    {
+        return m_voiceCatalog.GetLanguages();
+    }
 
-            cpAttribKey->Release();
+    void Tts::SetVoice(std::string voiceId)
+    {
+        auto voice = m_voiceCatalog.FindById(voiceId);
+        if (voice)
+        {
+            SelectVoice(*voice);
         }
+    }
 
-        cpEnum->Release();
+    std::vector<TtsVoice> Tts::GetVoices()
+    {
+        std::vector<TtsVoice> voices;
+
+        const auto& tokens = m_voiceCatalog.GetTokens();
+        voices.reserve(tokens.size());
+
+        for (const auto& token : tokens)
+        {
+            voices.push_back(ToTtsVoice(token));
+        }
 
         return voices;
     }
@@ -284,44 +825,90 @@ namespace stts {
     std::vector<TtsVoice> Tts::GetVoicesByLanguage(std::string language)
     {
         std::vector<TtsVoice> voices;
-        auto allVoices = GetVoices();
 
-        for (TtsVoice voice : allVoices)
+        for (auto token : m_voiceCatalog.GetByLanguage(language))
         {
-            if (voice.language == language)
-            {
-                voices.push_back(voice);
-            }
+            voices.push_back(ToTtsVoice(*token));
         }
 
         return voices;
     }
 
-    void Tts::SetPitch(double pitch)
+    void Tts::SetProgressEvents(bool words, bool sentences, bool bookmarks)
     {
-        // Supported values range from -10 to 10. Incoming values are 0 - 2.
-        auto fixedPitch = min(max(pitch, 0.0), 2.0);
-        auto adjustedPitch = ((fixedPitch - 1) * 20) / 2;
+        ThrowIfFailed(CreateVoice());
+
+        ULONGLONG interest = 0;
+        if (words) interest |= SPFEI(SPEI_WORD_BOUNDARY);
+        if (sentences) interest |= SPFEI(SPEI_SENTENCE_BOUNDARY);
+        if (bookmarks) interest |= SPFEI(SPEI_TTS_BOOKMARK);
+
+        auto events = kStreamEvents | interest;
+        ThrowIfFailed(m_pVoice->SetInterest(events, events));
 
-        m_pitch = static_cast<int>(round(adjustedPitch));
+        m_progressInterest = interest;
+    }
+
+    void Tts::SetPitch(double pitch)
+    {
+        m_pitch = ToSapiPitch(pitch);
     }
     void Tts::SetRate(double rate)
     {
         ThrowIfFailed(CreateVoice());
 
-        // Supported values range from -10 to 10. Incoming values are 0.1 - 10.
-        auto fixedRate = min(max(rate, 0.1), 10);
-        long adjustedRate = (fixedRate < 1) ? static_cast<long>(-1 / fixedRate) : static_cast<long>(fixedRate);
-
-        ThrowIfFailed(m_pVoice->SetRate(adjustedRate));
+        TraceSpan span("sapi", "ISpVoice::SetRate");
+        ThrowIfFailed(m_pVoice->SetRate(ToSapiRate(rate)));
     }
     void Tts::SetVolume(double volume)
     {
         ThrowIfFailed(CreateVoice());
 
-        // The default base volume for all voices is 100 (full volume).
-        auto adjustedVolume = static_cast<USHORT>(min(max(volume * 100, 0), 100));
-        ThrowIfFailed(m_pVoice->SetVolume(adjustedVolume));
+        TraceSpan span("sapi", "ISpVoice::SetVolume");
+        ThrowIfFailed(m_pVoice->SetVolume(ToSapiVolume(volume)));
+    }
+
+    void Tts::Configure(const TtsVoiceSettings& settings)
+    {
+        TraceSpan span("sapi", "Tts::Configure");
+        ThrowIfFailed(CreateVoice());
+        CheckVoiceSettings(settings);
+
+        // Restored if one of the settings fails.
+        ISpObjectToken* pPreviousToken = NULL;
+        ThrowIfFailed(m_pVoice->GetVoice(&pPreviousToken));
+        long previousRate = 0;
+        USHORT previousVolume = 100;
+
+        HRESULT hr = m_pVoice->GetRate(&previousRate);
+        if (SUCCEEDED(hr)) hr = m_pVoice->GetVolume(&previousVolume);
+
+        if (SUCCEEDED(hr) && settings.voiceId)
+        {
+            ISpObjectToken* pToken = NULL;
+            hr = SpGetTokenFromId(m_voiceCatalog.FindById(*settings.voiceId)->tokenId.c_str(), &pToken);
+            if (SUCCEEDED(hr))
+            {
+                hr = m_pVoice->SetVoice(pToken);
+                pToken->Release();
+            }
+        }
+        if (SUCCEEDED(hr) && settings.rate) hr = m_pVoice->SetRate(ToSapiRate(*settings.rate));
+        if (SUCCEEDED(hr) && settings.volume) hr = m_pVoice->SetVolume(ToSapiVolume(*settings.volume));
+
+        if (FAILED(hr))
+        {
+            m_pVoice->SetVoice(pPreviousToken);
+            m_pVoice->SetRate(previousRate);
+            m_pVoice->SetVolume(previousVolume);
+        }
+        else if (settings.pitch)
+        {
+            m_pitch = ToSapiPitch(*settings.pitch);
+        }
+
+        pPreviousToken->Release();
+        ThrowIfFailed(hr);
     }
 
     void Tts::Dispose()
@@ -334,20 +921,34 @@ namespace stts {
             m_pVoice = NULL;
         }
 
+        m_pipeline.reset();
+        m_cacheFiller.reset();
+
+        m_cache.Clear();
+        m_store.reset();
+
+        if (m_deadlineTaskId != 0)
+        {
+            m_scheduler->Unschedule(m_deadlineTaskId);
+            m_deadlineTaskId = 0;
+        }
+
         m_pitch = 0;
         m_isPaused = false;
-        m_utteranceQueued = 0;
+        m_progressInterest = 0;
+        m_progressEncoder.Clear();
     }
 
     HRESULT Tts::CreateVoice()
     {
         if (m_pVoice == NULL)
         {
+            TraceSpan span("sapi", "CoCreateInstance(SpVoice)");
             HRESULT hr = CoCreateInstance(CLSID_SpVoice, NULL, CLSCTX_ALL, IID_ISpVoice, (void**)&m_pVoice);
             if (FAILED(hr)) return hr;
 
-            // Set the notification type to receive end of speech notifications
-            hr = m_pVoice->SetInterest(SPFEI(SPEI_END_INPUT_STREAM), SPFEI(SPEI_END_INPUT_STREAM));
+            // Set the notification type to receive start and end of speech notifications
+            hr = m_pVoice->SetInterest(kStreamEvents, kStreamEvents);
             if (FAILED(hr)) return hr;
 
             hr = m_pVoice->SetNotifyCallbackFunction((SPNOTIFYCALLBACK*)Tts::SpeakEndNotifyCallback, (WPARAM)this, 0);
@@ -357,6 +958,34 @@ namespace stts {
         return S_OK;
     }
 
+    void Tts::SelectVoice(const EngineToken& voice)
+    {
+        ThrowIfFailed(CreateVoice());
+
+        ISpObjectToken* pToken = NULL;
+        ThrowIfFailed(SpGetTokenFromId(voice.tokenId.c_str(), &pToken));
+
+        {
+            TraceSpan span("sapi", "ISpVoice::SetVoice");
+            m_pVoice->SetVoice(pToken);
+        }
+        pToken->Release();
+    }
+
+    // static
+    TtsVoice Tts::ToTtsVoice(const EngineToken& token)
+    {
+        TtsVoice voice;
+        voice.id = token.id;
+        voice.language = token.language;
+        voice.name = token.name;
+
+        if (token.gender == "Male") voice.gender = TtsVoiceGender::male;
+        else if (token.gender == "Female") voice.gender = TtsVoiceGender::female;
+
+        return voice;
+    }
+
     void Tts::ThrowIfFailed(HRESULT code)
     {
         if (FAILED(code))
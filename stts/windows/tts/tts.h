@@ -1,8 +1,21 @@
+#include <deque>
 #include <iostream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "../event_stream_handler.h"
 #include "tts_options.h"
+#include "../catalog/engine_catalog.h"
+#include "../audio/pcm_sink.h"
+#include "utterance_cache.h"
+#include "utterance_store.h"
+#include "sapi_synthesis_pipeline.h"
+#include "speak_xml_writer.h"
+#include "speak_offset_index.h"
+#include "utterance_scheduler.h"
+#include "../codec/event_codec.h"
+#include "../audio/wav_reader.h"
+#include "../worker/engine_worker.h"
 
 #include <sapi.h>
 #pragma warning(disable:4996)
@@ -26,20 +39,48 @@ namespace stts {
 		TtsVoiceGender gender = unspecified;
 	};
 
-	class Tts
+	class Tts : private SpeechOutput
 	{
 	public:
-		Tts(EventStreamHandler* stateEventHandler);
+		Tts(EventStreamHandler* stateEventHandler, EventStreamHandler* progressEventHandler,
+			EventStreamHandler* utteranceEventHandler, TaskScheduler* scheduler);
 		~Tts();
 
+		// Checks that a voice is registered, no engine is created.
 		bool IsSupported();
+		// Changes when voices are installed or removed, 0 if they cannot be enumerated.
+		uint64_t GetEnginesGeneration();
 
-		void Start(std::string text, std::unique_ptr<TtsOptions> options);
+		// Long texts are spoken sentence by sentence, the first one starts while the rest is queued.
+		// State events report the whole queue. Higher priorities interrupt lower ones, which resume afterwards.
+		// Voice settings of options apply to this utterance only. Returns the ID reported by utterance events.
+		uint64_t Start(std::string text, std::unique_ptr<TtsOptions> options);
+		// Returns false if the utterance already ended.
+		bool Cancel(uint64_t id);
 		void Stop();
 		void Pause();
 		void Resume();
 		void Dispose();
 
+		// Request rendering text without playing it, for an UtteranceRenderer on another thread.
+		// Uses the current voice, pitch, rate and volume unless options override them.
+		SynthesisRequest GetSynthesisRequest(std::string text, const TtsOptions& options);
+
+		// Utterances are rendered once and replayed from memory while the budget allows. 0 disables the cache.
+		void SetCacheBudget(size_t budget);
+		const UtteranceCacheStats& GetCacheStats() const;
+
+		// Rendered utterances are also kept in files at utf8BasePath and replayed across sessions.
+		// Oldest ones are dropped above maxBytes. Throws if the files cannot be created.
+		void OpenStore(const std::string& utf8BasePath, uint64_t maxBytes);
+		void CloseStore();
+		UtteranceStoreStats GetStoreStats() const;
+
+		// Queued utterances are rendered on a separate thread while the previous ones play, without gaps.
+		// Lookahead of 0 disables the pipeline, queued utterances are then stopped.
+		void SetPipelineOptions(const SynthesisPipelineOptions& options);
+		SynthesisPipelineStats GetPipelineStats() const;
+
 		std::string GetLanguage();
 		void SetLanguage(std::string language);
 		std::vector<std::string> GetLanguages();
@@ -48,21 +89,114 @@ namespace stts {
 		std::vector<TtsVoice> GetVoices();
 		std::vector<TtsVoice> GetVoicesByLanguage(std::string language);
 
+		// Word, sentence and bookmark events of spoken utterances, sent in one batch per notification.
+		// Utterances played from the cache, store or pipeline have none.
+		void SetProgressEvents(bool words, bool sentences, bool bookmarks);
+
 		void SetPitch(double pitch);
 		void SetRate(double rate);
 		void SetVolume(double volume);
+		// Applies all given settings or none of them. Throws SPERR_NOT_FOUND for an unknown voice.
+		void Configure(const TtsVoiceSettings& settings);
 
 		static void SpeakEndNotifyCallback(WPARAM wParam, LPARAM lParam);
 
 	private:
+		// Chunk handed to the voice or to the pipeline.
+		struct QueuedStream {
+			// Handle known by the utterance scheduler.
+			uint64_t handle = 0;
+			// SAPI stream number, 0 until a pipelined chunk is handed to the voice.
+			ULONG streamNumber = 0;
+			bool isPipelined = false;
+			uint64_t utteranceId = 0;
+			// Offset of the chunk in the utterance text, in UTF-16 code units.
+			size_t textPosition = 0;
+			// Null when words and sentences are not reported.
+			std::shared_ptr<SpeakOffsetIndex> index;
+			std::vector<TtsBookmark> bookmarks;
+			size_t nextBookmark = 0;
+		};
+
 		ISpVoice* m_pVoice;
 		int m_pitch;
 		bool m_isPaused;
-		int m_utteranceQueued = 0;
 
 		EventStreamHandler* m_stateEventHandler;
+		EventStreamHandler* m_progressEventHandler;
+		EventStreamHandler* m_utteranceEventHandler;
+		ULONGLONG m_progressInterest = 0;
+		EventEncoder m_progressEncoder;
+		TaskScheduler* m_scheduler;
+
+		EngineCatalog m_voiceCatalog;
+		SpeakXmlWriter m_xmlWriter;
+		UtteranceScheduler m_utterances;
+		// Oldest first.
+		std::deque<QueuedStream> m_queuedStreams;
+		uint64_t m_lastStreamHandle = 0;
+		// First error of the chunks queued by QueueChunks.
+		HRESULT m_speakError = S_OK;
+		uint64_t m_deadlineTaskId = 0;
+		UtteranceCache m_cache;
+		std::unique_ptr<UtteranceStore> m_store;
+
+		std::unique_ptr<SapiSynthesisPipeline> m_pipeline;
+		uint64_t m_pipelineGeneration = 0;
+		// Utterances up to this ID were cancelled, their late results are dropped.
+		uint64_t m_pipelineCancelledId = 0;
+		uint64_t m_pipelineLastId = 0;
+		// Submitted and not handed to the voice yet.
+		int m_pipelineInFlight = 0;
+		size_t m_pipelineLookahead = 0;
+
+		// Renders cache misses on a separate thread while they are spoken directly.
+		std::unique_ptr<SapiSynthesisPipeline> m_cacheFiller;
+		uint64_t m_cacheFillerGeneration = 0;
+		// Renderings up to this ID were cancelled, their late results are dropped.
+		uint64_t m_cacheFillerCancelledId = 0;
+		uint64_t m_cacheFillerLastId = 0;
+		// Key hashes of the utterances submitted to the cache filler, each is rendered once.
+		std::unordered_set<uint64_t> m_fillingHashes;
 
 		HRESULT CreateVoice();
+		// Valid until the next call.
+		const std::wstring& GetSpeakXml(const std::string& text, const TtsOptions& options);
+		// Opens a voice tag when the voice is overridden, returns true if it must be closed.
+		bool BeginVoiceSettings(const TtsVoiceSettings& settings);
+		void CheckVoiceSettings(const TtsVoiceSettings& settings);
+		// Queues chunks while fewer streams than needed to play without gaps are queued.
+		// Failed utterances are dropped, the first error is returned.
+		HRESULT QueueChunks();
+		// Sends the state change after utterances were added or ended.
+		void NotifyQueueState(bool wasEmpty);
+		void OnUtteranceEvent(uint64_t id, UtteranceEvent event);
+		// Expired utterances are dropped on time, even while others play.
+		void ScheduleDeadline();
+		uint64_t Speak(ScheduledUtterance& utterance, size_t end) override;
+		void Purge() override;
+		const std::wstring& GetChunkXml(ScheduledUtterance& utterance, size_t end, QueuedStream& stream);
+		HRESULT SpeakChunk(const std::wstring& speakXml, QueuedStream& stream);
+		bool IsSpokenDirectly() const;
+		std::deque<QueuedStream>::iterator FindStream(ULONG streamNumber);
+		void OnStreamStarted(ULONG streamNumber);
+		void OnStreamEnded(ULONG streamNumber);
+		void OnProgress(CSpEvent& event);
+		HRESULT SpeakCached(const std::wstring& speakXml, ULONG& streamNumber);
+		HRESULT SpeakPipelined(const std::wstring& speakXml);
+		void OnPipelineReady(SynthesizedUtterance& utterance);
+		void CancelPipeline();
+		void FillCache(const UtteranceKey& key, SynthesisRequest request);
+		void OnCacheFilled(SynthesizedUtterance& utterance);
+		void CancelCacheFill();
+		// Samples already rendered, in memory or in the store.
+		std::shared_ptr<PcmSource> FindRendered(const UtteranceKey& key);
+		void KeepRendered(const UtteranceKey& key, std::shared_ptr<const std::vector<uint8_t>> samples);
+		// Current voice settings applied to the text.
+		HRESULT GetSynthesisRequest(const std::wstring& speakXml, SynthesisRequest& request);
+		UtteranceKey GetUtteranceKey(const SynthesisRequest& request);
+		void SelectVoice(const EngineToken& voice);
+		static TtsVoice ToTtsVoice(const EngineToken& token);
 		void ThrowIfFailed(HRESULT code);		
 	};
 
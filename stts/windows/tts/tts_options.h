@@ -1,14 +1,41 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace stts
 {
+	struct TtsBookmark
+	{
+		// Position in the text, in UTF-16 code units.
+		size_t offset = 0;
+		std::string name;
+	};
+
+	// Absent settings are left as they are.
+	struct TtsVoiceSettings
+	{
+		std::optional<std::string> voiceId;
+		// Same ranges as Tts::SetPitch, SetRate and SetVolume.
+		std::optional<double> pitch;
+		std::optional<double> rate;
+		std::optional<double> volume;
+	};
+
 	struct TtsOptions
 	{
 		std::string mode = "add";
-		int preSilenceMs = NULL;
-		int postSilenceMs = NULL;
+		int preSilenceMs = 0;
+		int postSilenceMs = 0;
+		// Sorted by offset.
+		std::vector<TtsBookmark> bookmarks;
+		// Higher priorities are spoken first and interrupt lower ones.
+		int priority = 0;
+		// Dropped if not started within this delay. 0 means no deadline.
+		int deadlineMs = 0;
+		// Applied to this utterance only.
+		TtsVoiceSettings voice;
 
 		TtsOptions(
 			const std::string& mode,
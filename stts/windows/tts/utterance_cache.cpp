@@ -0,0 +1,122 @@
+#include "utterance_cache.h"
+
+namespace stts {
+
+    // FNV-1a, 64 bits.
+    static uint64_t HashIdentity(const std::string& identity)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : identity)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // static
+    UtteranceKey UtteranceKey::Create(const std::string& voiceId, long rate, int pitch, unsigned volume, const std::wstring& text)
+    {
+        UtteranceKey key;
+        auto textSize = text.size() * sizeof(wchar_t);
+
+        // Fields are separated by NUL, which cannot be part of the voice ID.
+        // The text comes last as raw code units, its NUL bytes are not ambiguous.
+        key.identity.reserve(voiceId.size() + textSize + 16);
+        key.identity += voiceId;
+        key.identity += '\0';
+        key.identity += std::to_string(rate);
+        key.identity += '\0';
+        key.identity += std::to_string(pitch);
+        key.identity += '\0';
+        key.identity += std::to_string(volume);
+        key.identity += '\0';
+        key.identity.append(reinterpret_cast<const char*>(text.data()), textSize);
+
+        key.hash = HashIdentity(key.identity);
+        return key;
+    }
+
+    UtteranceCache::UtteranceCache(size_t budget) :
+        m_budget(budget)
+    {
+    }
+
+    void UtteranceCache::SetBudget(size_t budget)
+    {
+        m_budget = budget;
+        EvictToBudget();
+    }
+
+    bool UtteranceCache::Find(const UtteranceKey& key, CachedUtterance& utterance)
+    {
+        auto found = m_index.find(key.hash);
+
+        // Hash collisions are misses.
+        if (found == m_index.end() || found->second->key.identity != key.identity)
+        {
+            m_stats.misses++;
+            return false;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        utterance = found->second->utterance;
+
+        m_stats.hits++;
+        return true;
+    }
+
+    void UtteranceCache::Insert(const UtteranceKey& key, const PcmFormat& format, std::shared_ptr<const std::vector<uint8_t>> samples)
+    {
+        auto found = m_index.find(key.hash);
+        if (found != m_index.end())
+        {
+            Remove(found->second);
+        }
+
+        auto cost = samples->size() + key.identity.size();
+        if (cost > m_budget) return;
+
+        Entry entry;
+        entry.key = key;
+        entry.utterance.format = format;
+        entry.utterance.samples = std::move(samples);
+        entry.cost = cost;
+
+        m_entries.push_front(std::move(entry));
+        m_index[key.hash] = m_entries.begin();
+
+        m_stats.bytes += cost;
+        m_stats.entries++;
+        m_stats.insertions++;
+
+        EvictToBudget();
+    }
+
+    void UtteranceCache::Clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+        m_stats.entries = 0;
+        m_stats.bytes = 0;
+    }
+
+    void UtteranceCache::Remove(std::list<Entry>::iterator it)
+    {
+        m_stats.bytes -= it->cost;
+        m_stats.entries--;
+
+        m_index.erase(it->key.hash);
+        m_entries.erase(it);
+    }
+
+    void UtteranceCache::EvictToBudget()
+    {
+        while (m_stats.bytes > m_budget && !m_entries.empty())
+        {
+            Remove(std::prev(m_entries.end()));
+            m_stats.evictions++;
+        }
+    }
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../audio/wav_reader.h"
+
+namespace stts {
+
+	// Everything that changes the rendered audio of an utterance.
+	struct UtteranceKey {
+		std::string identity;
+		uint64_t hash = 0;
+
+		// Text is the final SAPI XML, including pitch and silence tags.
+		static UtteranceKey Create(const std::string& voiceId, long rate, int pitch, unsigned volume, const std::wstring& text);
+	};
+
+	struct CachedUtterance {
+		PcmFormat format;
+		std::shared_ptr<const std::vector<uint8_t>> samples;
+	};
+
+	struct UtteranceCacheStats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t insertions = 0;
+		uint64_t evictions = 0;
+		size_t entries = 0;
+		size_t bytes = 0;
+	};
+
+	// Rendered utterances kept in memory under a byte budget, least recently used evicted first.
+	// Entry cost is its samples plus its key. A budget of 0 disables the cache.
+	// Not thread safe, samples can be shared with other threads once returned.
+	class UtteranceCache {
+	public:
+		explicit UtteranceCache(size_t budget = 0);
+
+		bool IsEnabled() const { return m_budget > 0; }
+
+		// Evicts entries until the new budget is met.
+		void SetBudget(size_t budget);
+		size_t GetBudget() const { return m_budget; }
+
+		// Returns false on miss. A hit becomes the most recently used entry.
+		bool Find(const UtteranceKey& key, CachedUtterance& utterance);
+
+		// Replaces an existing entry. Entries larger than the budget are not kept.
+		void Insert(const UtteranceKey& key, const PcmFormat& format, std::shared_ptr<const std::vector<uint8_t>> samples);
+
+		void Clear();
+
+		const UtteranceCacheStats& GetStats() const { return m_stats; }
+
+	private:
+		struct Entry {
+			UtteranceKey key;
+			CachedUtterance utterance;
+			size_t cost;
+		};
+
+		size_t m_budget;
+		// Most recently used first.
+		std::list<Entry> m_entries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+		UtteranceCacheStats m_stats;
+
+		void Remove(std::list<Entry>::iterator it);
+		void EvictToBudget();
+	};
+
+}
@@ -0,0 +1,124 @@
+#include "utterance_renderer.h"
+#include "../utils.h"
+#include "../audio/pcm_sink_stream.h"
+
+#pragma warning(disable:4996)
+#include <sphelper.h>
+#pragma warning(default: 4996)
+
+namespace stts {
+
+    UtteranceRenderer::~UtteranceRenderer()
+    {
+        Release();
+    }
+
+    HRESULT UtteranceRenderer::Render(const SynthesisRequest& request, const PcmFormat& format, PcmSink& sink,
+        const CancellationToken& cancellationToken)
+    {
+        HRESULT hr = ApplySettings(request);
+        if (FAILED(hr)) return hr;
+
+        WAVEFORMATEX waveFormat{};
+        waveFormat.wFormatTag = WAVE_FORMAT_PCM;
+        waveFormat.nChannels = format.channels;
+        waveFormat.nSamplesPerSec = format.sampleRate;
+        waveFormat.wBitsPerSample = format.bitsPerSample;
+        waveFormat.nBlockAlign = format.GetBlockAlign();
+        waveFormat.nAvgBytesPerSec = format.GetByteRate();
+
+        IStream* pBaseStream = NULL;
+        hr = PcmSinkStream::Create(&sink, &pBaseStream);
+        if (FAILED(hr)) return hr;
+
+        ISpStream* pStream = NULL;
+        hr = CoCreateInstance(CLSID_SpStream, NULL, CLSCTX_ALL, IID_ISpStream, (void**)&pStream);
+        if (SUCCEEDED(hr))
+        {
+            hr = pStream->SetBaseStream(pBaseStream, SPDFID_WaveFormatEx, &waveFormat);
+        }
+        pBaseStream->Release();
+
+        // Format is fixed, the engine output is converted when needed.
+        if (SUCCEEDED(hr))
+        {
+            hr = m_pVoice->SetOutput(pStream, FALSE);
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            hr = m_pVoice->Speak(request.speakXml.c_str(), SPDF_PRONUNCIATION | SPF_ASYNC | SPF_IS_XML, NULL);
+        }
+
+        // No audio device to pace the engine, this is not real time.
+        while (SUCCEEDED(hr))
+        {
+            hr = m_pVoice->WaitUntilDone(100);
+            if (hr != S_FALSE) break;
+
+            if (cancellationToken.ShouldStop())
+            {
+                m_pVoice->Speak(NULL, SPF_PURGEBEFORESPEAK, NULL);
+                hr = E_ABORT;
+            }
+        }
+
+        // Stream write errors (e.g. disk full) are only reported here.
+        SPVOICESTATUS status;
+        if (SUCCEEDED(hr) && SUCCEEDED(m_pVoice->GetStatus(&status, NULL)) && FAILED(status.hrLastResult))
+        {
+            hr = status.hrLastResult;
+        }
+
+        m_pVoice->SetOutput(NULL, TRUE);
+
+        if (pStream)
+        {
+            pStream->Close();
+            pStream->Release();
+        }
+
+        return hr;
+    }
+
+    void UtteranceRenderer::Release()
+    {
+        if (m_pVoice)
+        {
+            m_pVoice->Release();
+            m_pVoice = NULL;
+        }
+
+        m_voiceId.clear();
+    }
+
+    // Pitch is part of the text.
+    HRESULT UtteranceRenderer::ApplySettings(const SynthesisRequest& request)
+    {
+        HRESULT hr = S_OK;
+        if (m_pVoice == NULL)
+        {
+            hr = CoCreateInstance(CLSID_SpVoice, NULL, CLSCTX_ALL, IID_ISpVoice, (void**)&m_pVoice);
+            if (FAILED(hr)) return hr;
+        }
+
+        if (!request.voiceId.empty() && request.voiceId != m_voiceId)
+        {
+            ISpObjectToken* pToken = NULL;
+            hr = SpGetTokenFromId(Utf16FromUtf8(request.voiceId).c_str(), &pToken);
+            if (FAILED(hr)) return hr;
+
+            hr = m_pVoice->SetVoice(pToken);
+            pToken->Release();
+            if (FAILED(hr)) return hr;
+
+            m_voiceId = request.voiceId;
+        }
+
+        hr = m_pVoice->SetRate(request.rate);
+        if (FAILED(hr)) return hr;
+
+        return m_pVoice->SetVolume(static_cast<USHORT>(request.volume));
+    }
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include "synthesis_pipeline.h"
+#include "../audio/pcm_sink.h"
+#include "../worker/engine_worker.h"
+
+#include <sapi.h>
+
+namespace stts {
+
+	// Voice bound to a stream, rendering utterances faster than real time.
+	// Must be used and released on the thread which created it.
+	class UtteranceRenderer
+	{
+	public:
+		~UtteranceRenderer();
+
+		// Applies voice, rate and volume of the request then renders its text to sink.
+		// Returns E_ABORT if the cancellation token stops first.
+		HRESULT Render(const SynthesisRequest& request, const PcmFormat& format, PcmSink& sink,
+			const CancellationToken& cancellationToken);
+
+		void Release();
+
+	private:
+		ISpVoice* m_pVoice = NULL;
+		// Changing the voice may reload the engine, it is set only when it differs.
+		std::string m_voiceId;
+
+		HRESULT ApplySettings(const SynthesisRequest& request);
+	};
+
+}
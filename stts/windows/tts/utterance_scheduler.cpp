@@ -0,0 +1,292 @@
+#include "utterance_scheduler.h"
+
+#include <algorithm>
+#include "../codec/utf_transcoder.h"
+
+namespace stts {
+
+    UtteranceScheduler::UtteranceScheduler(SpeechOutput* output, EventCallback onEvent,
+        const SentenceSegmenterOptions& segmenterOptions) :
+        m_output(output),
+        m_onEvent(std::move(onEvent)),
+        m_segmenter(segmenterOptions)
+    {
+    }
+
+    uint64_t UtteranceScheduler::Add(ScheduledUtterance utterance)
+    {
+        utterance.id = ++m_lastId;
+        utterance.offset = 0;
+        utterance.textPosition = 0;
+        utterance.nextBookmark = 0;
+        utterance.isQueued = false;
+        utterance.isSpeaking = false;
+        utterance.hasStarted = false;
+
+        // Behind all utterances of the same or a higher priority.
+        auto priority = utterance.priority;
+        auto position = std::find_if(m_utterances.begin(), m_utterances.end(), [priority](const auto& queued) {
+            return queued->priority < priority;
+        });
+
+        // Lower priorities already queued must wait.
+        auto firstLower = m_chunks.size();
+        for (auto it = position; it != m_utterances.end(); ++it)
+        {
+            auto id = (*it)->id;
+            auto chunk = std::find_if(m_chunks.begin(), m_chunks.end(), [id](const QueuedChunk& queued) {
+                return queued.utteranceId == id;
+            });
+            firstLower = (std::min)(firstLower, static_cast<size_t>(chunk - m_chunks.begin()));
+        }
+
+        auto id = utterance.id;
+        m_utterances.insert(position, std::make_unique<ScheduledUtterance>(std::move(utterance)));
+
+        if (firstLower < m_chunks.size()) DropChunksFrom(firstLower);
+        return id;
+    }
+
+    bool UtteranceScheduler::Cancel(uint64_t id)
+    {
+        if (!Find(id)) return false;
+
+        Drop(id, UtteranceEvent::cancelled);
+        return true;
+    }
+
+    void UtteranceScheduler::CancelAll()
+    {
+        auto utterances = std::move(m_utterances);
+        m_utterances.clear();
+
+        if (!m_chunks.empty())
+        {
+            m_output->Purge();
+            m_chunks.clear();
+            m_staleChunks = 0;
+        }
+
+        for (const auto& utterance : utterances)
+        {
+            m_onEvent(utterance->id, UtteranceEvent::cancelled);
+        }
+    }
+
+    void UtteranceScheduler::OnChunkStarted(uint64_t handle)
+    {
+        auto chunk = FindChunk(handle);
+        if (chunk == m_chunks.end()) return;
+
+        // Nothing before it is cut anymore.
+        if (chunk->isStale)
+        {
+            PurgeAndRewind();
+            return;
+        }
+
+        auto utterance = Find(chunk->utteranceId);
+        if (!utterance || utterance->isSpeaking) return;
+
+        utterance->isSpeaking = true;
+        utterance->hasStarted = true;
+        m_onEvent(utterance->id, UtteranceEvent::started);
+    }
+
+    void UtteranceScheduler::OnChunkEnded(uint64_t handle)
+    {
+        auto chunk = FindChunk(handle);
+        if (chunk == m_chunks.end()) return;
+
+        // Skipped without starting, the next ones are not wanted either.
+        if (chunk->isStale)
+        {
+            PurgeAndRewind();
+            return;
+        }
+
+        auto utteranceId = chunk->utteranceId;
+        auto isLast = chunk->isLast;
+        m_chunks.erase(chunk);
+
+        if (isLast) Remove(utteranceId, UtteranceEvent::finished);
+    }
+
+    bool UtteranceScheduler::Pump(Clock::time_point now)
+    {
+        DropExpired(now);
+
+        bool succeeded = true;
+
+        // Stale chunks are purged first, queuing behind them would be lost.
+        while (m_staleChunks == 0 && m_chunks.size() < m_chunksAhead)
+        {
+            auto next = std::find_if(m_utterances.begin(), m_utterances.end(), [](const auto& queued) {
+                return !queued->isQueued;
+            });
+            if (next == m_utterances.end()) break;
+
+            auto& utterance = **next;
+            auto end = m_segmenter.Next(utterance.text, utterance.offset);
+
+            QueuedChunk chunk;
+            chunk.utteranceId = utterance.id;
+            chunk.offset = utterance.offset;
+            chunk.textPosition = utterance.textPosition;
+            chunk.nextBookmark = utterance.nextBookmark;
+            chunk.isLast = end == utterance.text.size();
+            chunk.handle = m_output->Speak(utterance, end);
+
+            if (chunk.handle == 0)
+            {
+                succeeded = false;
+
+                // Queued chunks end the utterance early.
+                auto id = utterance.id;
+                auto last = std::find_if(m_chunks.rbegin(), m_chunks.rend(), [id](const QueuedChunk& queued) {
+                    return queued.utteranceId == id;
+                });
+
+                if (last != m_chunks.rend())
+                {
+                    last->isLast = true;
+                    utterance.isQueued = true;
+                }
+                else
+                {
+                    Remove(id, UtteranceEvent::cancelled);
+                }
+                continue;
+            }
+
+            m_chunks.push_back(chunk);
+
+            if (chunk.isLast)
+            {
+                utterance.isQueued = true;
+            }
+            else
+            {
+                utterance.textPosition += UtfTranscoder::GetUtf16Length(utterance.text.data() + utterance.offset, end - utterance.offset);
+                utterance.offset = end;
+            }
+        }
+
+        return succeeded;
+    }
+
+    bool UtteranceScheduler::Contains(uint64_t id) const
+    {
+        return Find(id) != nullptr;
+    }
+
+    UtteranceScheduler::Clock::time_point UtteranceScheduler::GetNextDeadline() const
+    {
+        auto deadline = (Clock::time_point::max)();
+        for (const auto& utterance : m_utterances)
+        {
+            if (!utterance->hasStarted) deadline = (std::min)(deadline, utterance->deadline);
+        }
+        return deadline;
+    }
+
+    ScheduledUtterance* UtteranceScheduler::Find(uint64_t id) const
+    {
+        for (const auto& utterance : m_utterances)
+        {
+            if (utterance->id == id) return utterance.get();
+        }
+        return nullptr;
+    }
+
+    std::deque<UtteranceScheduler::QueuedChunk>::iterator UtteranceScheduler::FindChunk(uint64_t handle)
+    {
+        return std::find_if(m_chunks.begin(), m_chunks.end(), [handle](const QueuedChunk& chunk) {
+            return chunk.handle == handle;
+        });
+    }
+
+    void UtteranceScheduler::Remove(uint64_t id, UtteranceEvent event)
+    {
+        auto it = std::find_if(m_utterances.begin(), m_utterances.end(), [id](const auto& utterance) {
+            return utterance->id == id;
+        });
+        if (it == m_utterances.end()) return;
+
+        m_utterances.erase(it);
+        m_onEvent(id, event);
+    }
+
+    void UtteranceScheduler::Drop(uint64_t id, UtteranceEvent event)
+    {
+        auto chunk = std::find_if(m_chunks.begin(), m_chunks.end(), [id](const QueuedChunk& queued) {
+            return queued.utteranceId == id;
+        });
+        auto first = static_cast<size_t>(chunk - m_chunks.begin());
+
+        Remove(id, event);
+        if (first < m_chunks.size()) DropChunksFrom(first);
+    }
+
+    void UtteranceScheduler::DropChunksFrom(size_t first)
+    {
+        // The chunk playing is cut only when it is not wanted.
+        if (first == 0)
+        {
+            PurgeAndRewind();
+            return;
+        }
+
+        for (auto i = first; i < m_chunks.size(); i++)
+        {
+            if (!m_chunks[i].isStale)
+            {
+                m_chunks[i].isStale = true;
+                m_staleChunks++;
+            }
+        }
+    }
+
+    void UtteranceScheduler::PurgeAndRewind()
+    {
+        m_output->Purge();
+
+        // Newest first, the oldest chunk of each utterance is restored last.
+        for (auto it = m_chunks.rbegin(); it != m_chunks.rend(); ++it)
+        {
+            auto utterance = Find(it->utteranceId);
+            if (!utterance) continue;
+
+            utterance->offset = it->offset;
+            utterance->textPosition = it->textPosition;
+            utterance->nextBookmark = it->nextBookmark;
+            utterance->isQueued = false;
+        }
+
+        m_chunks.clear();
+        m_staleChunks = 0;
+
+        for (const auto& utterance : m_utterances)
+        {
+            if (!utterance->isSpeaking) continue;
+
+            utterance->isSpeaking = false;
+            m_onEvent(utterance->id, UtteranceEvent::interrupted);
+        }
+    }
+
+    void UtteranceScheduler::DropExpired(Clock::time_point now)
+    {
+        std::vector<uint64_t> expired;
+        for (const auto& utterance : m_utterances)
+        {
+            if (!utterance->hasStarted && utterance->deadline <= now) expired.push_back(utterance->id);
+        }
+
+        for (auto id : expired)
+        {
+            Drop(id, UtteranceEvent::expired);
+        }
+    }
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sentence_segmenter.h"
+#include "tts_options.h"
+
+namespace stts {
+
+	enum class UtteranceEvent {
+		started,
+		// Preempted by a higher priority, started again later from the interrupted chunk.
+		interrupted,
+		finished,
+		cancelled,
+		// Not started before its deadline.
+		expired,
+	};
+
+	struct ScheduledUtterance {
+		using Clock = std::chrono::steady_clock;
+
+		uint64_t id = 0;
+		// Higher first.
+		int priority = 0;
+		// Dropped if not started by then. Default is no deadline.
+		Clock::time_point deadline = (Clock::time_point::max)();
+
+		std::string text;
+		int preSilenceMs = 0;
+		int postSilenceMs = 0;
+		std::vector<TtsBookmark> bookmarks;
+		// Bookmark offsets in the UTF-8 text.
+		std::vector<size_t> bookmarkBytes;
+		// Overrides of the current voice settings.
+		TtsVoiceSettings voice;
+
+		// Start of the next chunk, in bytes and in UTF-16 code units.
+		size_t offset = 0;
+		size_t textPosition = 0;
+		// First bookmark of the next chunk, written ones are passed by the output.
+		size_t nextBookmark = 0;
+
+		// All chunks are queued.
+		bool isQueued = false;
+		bool isSpeaking = false;
+		// Started once, it does not expire anymore.
+		bool hasStarted = false;
+	};
+
+	// Where chunks are spoken, a SAPI voice on Windows.
+	class SpeechOutput {
+	public:
+		virtual ~SpeechOutput() = default;
+
+		// Queues the text from utterance.offset to end behind queued chunks, nextBookmark is advanced
+		// past the written bookmarks. Returns a handle identifying the chunk in later reports, 0 on failure.
+		virtual uint64_t Speak(ScheduledUtterance& utterance, size_t end) = 0;
+
+		// Stops speaking and drops all queued chunks. They are not reported afterwards.
+		virtual void Purge() = 0;
+	};
+
+	// Orders utterances by priority and feeds them chunk by chunk to the output.
+	//
+	// Utterances are spoken by decreasing priority, in order of addition for the same priority.
+	// A new utterance interrupts lower priority ones being spoken, they resume from the interrupted chunk afterwards.
+	// Chunks already queued for utterances which must not be spoken (cancelled, expired, behind a new higher priority)
+	// are dropped when they start, so the chunk playing is not cut.
+	//
+	// Not thread safe: the output reports chunks on the thread using the scheduler, no locking is needed.
+	class UtteranceScheduler {
+	public:
+		using Clock = std::chrono::steady_clock;
+		using EventCallback = std::function<void(uint64_t id, UtteranceEvent event)>;
+
+		UtteranceScheduler(SpeechOutput* output, EventCallback onEvent,
+			const SentenceSegmenterOptions& segmenterOptions = SentenceSegmenterOptions());
+
+		UtteranceScheduler(const UtteranceScheduler&) = delete;
+		UtteranceScheduler& operator=(const UtteranceScheduler&) = delete;
+
+		// Returns the utterance ID, IDs increase from 1. Chunks are queued by Pump.
+		uint64_t Add(ScheduledUtterance utterance);
+
+		// Returns false if the utterance is unknown or ended.
+		bool Cancel(uint64_t id);
+		void CancelAll();
+
+		// Started events are sent again when interrupted utterances resume.
+		void OnChunkStarted(uint64_t handle);
+		// Played, or skipped when it could not be played.
+		void OnChunkEnded(uint64_t handle);
+
+		// Drops expired utterances and queues chunks while fewer than chunksAhead are queued.
+		// Utterances whose first chunk fails are cancelled. Returns false if a chunk failed.
+		bool Pump(Clock::time_point now);
+
+		// Chunks kept queued in the output, the next one is ready when the current one ends.
+		void SetChunksAhead(size_t count) { m_chunksAhead = count > 0 ? count : 1; }
+
+		bool IsEmpty() const { return m_utterances.empty(); }
+		size_t GetCount() const { return m_utterances.size(); }
+		bool Contains(uint64_t id) const;
+		// Earliest deadline of utterances not started, (Clock::time_point::max)() if none.
+		Clock::time_point GetNextDeadline() const;
+
+	private:
+		struct QueuedChunk {
+			uint64_t handle = 0;
+			uint64_t utteranceId = 0;
+			// State of the utterance before the chunk, restored when the chunk is lost.
+			size_t offset = 0;
+			size_t textPosition = 0;
+			size_t nextBookmark = 0;
+			bool isLast = false;
+			// Dropped when it starts.
+			bool isStale = false;
+		};
+
+		SpeechOutput* m_output;
+		EventCallback m_onEvent;
+		SentenceSegmenter m_segmenter;
+		size_t m_chunksAhead = 2;
+		uint64_t m_lastId = 0;
+
+		// By decreasing priority, then ID.
+		std::deque<std::unique_ptr<ScheduledUtterance>> m_utterances;
+		// Oldest first.
+		std::deque<QueuedChunk> m_chunks;
+		size_t m_staleChunks = 0;
+
+		ScheduledUtterance* Find(uint64_t id) const;
+		std::deque<QueuedChunk>::iterator FindChunk(uint64_t handle);
+		void Remove(uint64_t id, UtteranceEvent event);
+		// Removes the utterance, its chunks and the following ones are dropped.
+		void Drop(uint64_t id, UtteranceEvent event);
+		// Purged now if the first one is playing, else marked stale and purged when they start.
+		void DropChunksFrom(size_t first);
+		// Chunks are lost, their utterances are spoken again from the first lost chunk.
+		void PurgeAndRewind();
+		void DropExpired(Clock::time_point now);
+	};
+
+}
@@ -0,0 +1,595 @@
+#include "utterance_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace stts {
+
+    static const uint32_t kIndexMagic = 0x58495453; // STIX
+    static const uint32_t kRecordMagic = 0x52555453; // STUR
+    static const uint32_t kVersion = 1;
+
+    // Data file is preallocated by this size at least, then doubled.
+    static const uint64_t kInitialDataSize = 1 << 20;
+
+    // Files are read in the native byte order, little endian on all supported platforms.
+    struct IndexHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        // Records are complete and on disk below this offset.
+        std::atomic<uint64_t> dataEnd;
+        std::atomic<uint64_t> count;
+        uint64_t reserved[4];
+    };
+
+    // Empty while hash is 0. Offset is written before hash when a slot is taken.
+    struct IndexSlot {
+        std::atomic<uint64_t> hash;
+        std::atomic<uint64_t> offset;
+    };
+
+    // Followed by the key identity and the samples, padded to 8 bytes.
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t identitySize;
+        uint64_t hash;
+        uint32_t sampleRate;
+        uint16_t channels;
+        uint16_t bitsPerSample;
+        uint32_t sampleSize;
+        // Of identity then samples.
+        uint32_t checksum;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Index slots are shared through a file mapping");
+    static_assert(sizeof(IndexHeader) == 64, "Index header layout");
+    static_assert(sizeof(IndexSlot) == 16, "Index slot layout");
+    static_assert(sizeof(RecordHeader) == 32, "Record header layout");
+
+    static IndexHeader* GetHeader(const MappedFile& index)
+    {
+        return reinterpret_cast<IndexHeader*>(index.GetData());
+    }
+
+    static IndexSlot* GetSlots(const MappedFile& index)
+    {
+        return reinterpret_cast<IndexSlot*>(index.GetData() + sizeof(IndexHeader));
+    }
+
+    static uint64_t GetIndexSize(uint64_t capacity)
+    {
+        return sizeof(IndexHeader) + capacity * sizeof(IndexSlot);
+    }
+
+    static uint64_t GetRecordSize(uint64_t identitySize, uint64_t sampleSize)
+    {
+        return (sizeof(RecordHeader) + identitySize + sampleSize + 7) & ~static_cast<uint64_t>(7);
+    }
+
+    // 0 marks empty slots.
+    static uint64_t GetSlotHash(const UtteranceKey& key)
+    {
+        return key.hash != 0 ? key.hash : 1;
+    }
+
+    // FNV-1a over 64-bit words, folded to 32 bits.
+    static uint64_t Checksum(const uint8_t* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+    {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        for (; i < size; i++)
+        {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static uint32_t GetRecordChecksum(const uint8_t* identity, size_t identitySize, const uint8_t* samples, size_t sampleSize)
+    {
+        auto hash = Checksum(samples, sampleSize, Checksum(identity, identitySize));
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+    // Record at offset if it is complete below end.
+    static const RecordHeader* GetRecord(const MappedFile& data, uint64_t offset, uint64_t end)
+    {
+        if (offset % 8 != 0 || end > data.GetSize() || offset > end || end - offset < sizeof(RecordHeader)) return nullptr;
+
+        auto record = reinterpret_cast<const RecordHeader*>(data.GetData() + offset);
+        if (record->magic != kRecordMagic) return nullptr;
+        if (GetRecordSize(record->identitySize, record->sampleSize) > end - offset) return nullptr;
+
+        return record;
+    }
+
+    static const uint8_t* GetIdentity(const RecordHeader* record)
+    {
+        return reinterpret_cast<const uint8_t*>(record + 1);
+    }
+
+    static const uint8_t* GetSamples(const RecordHeader* record)
+    {
+        return GetIdentity(record) + record->identitySize;
+    }
+
+    static bool HasIdentity(const RecordHeader* record, const uint8_t* identity, size_t identitySize)
+    {
+        return record->identitySize == identitySize && std::memcmp(GetIdentity(record), identity, identitySize) == 0;
+    }
+
+    static bool IsIntact(const RecordHeader* record)
+    {
+        return record->checksum == GetRecordChecksum(GetIdentity(record), record->identitySize, GetSamples(record), record->sampleSize);
+    }
+
+    // Writer only. Points the slot of the identity to offset, taking an empty slot if needed.
+    // Returns false if the index is full.
+    static bool PublishSlot(const MappedFile& index, const MappedFile& data, uint64_t hash,
+        const uint8_t* identity, size_t identitySize, uint64_t offset)
+    {
+        auto header = GetHeader(index);
+        auto slots = GetSlots(index);
+        auto mask = header->capacity - 1;
+        auto end = header->dataEnd.load(std::memory_order_relaxed);
+
+        for (uint64_t i = 0; i < header->capacity; i++)
+        {
+            auto position = (hash + i) & mask;
+            auto& slot = slots[position];
+            auto slotHash = slot.hash.load(std::memory_order_relaxed);
+
+            if (slotHash == hash)
+            {
+                // Unreadable records are replaced as well.
+                auto record = GetRecord(data, slot.offset.load(std::memory_order_relaxed), end);
+                if (record && !HasIdentity(record, identity, identitySize)) continue;
+
+                slot.offset.store(offset, std::memory_order_release);
+            }
+            else if (slotHash == 0)
+            {
+                slot.offset.store(offset, std::memory_order_relaxed);
+                slot.hash.store(hash, std::memory_order_release);
+                header->count.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                continue;
+            }
+
+            index.Flush(sizeof(IndexHeader) + position * sizeof(IndexSlot), sizeof(IndexSlot));
+            index.Flush(0, sizeof(IndexHeader));
+            return true;
+        }
+
+        return false;
+    }
+
+    UtteranceStore::UtteranceStore(const std::string& basePath, const UtteranceStoreOptions& options) :
+        m_basePath(basePath),
+        m_options(options)
+    {
+        uint64_t capacity = 16;
+        while (capacity < m_options.indexCapacity) capacity <<= 1;
+        m_options.indexCapacity = capacity;
+    }
+
+    UtteranceStore::~UtteranceStore()
+    {
+        WaitForCompaction();
+    }
+
+    // static
+    std::unique_ptr<UtteranceStore> UtteranceStore::Open(const std::string& utf8BasePath, const UtteranceStoreOptions& options)
+    {
+        std::unique_ptr<UtteranceStore> store(new UtteranceStore(utf8BasePath, options));
+
+        uint64_t current = 0;
+        std::ifstream currentFile(std::filesystem::u8path(utf8BasePath + ".cur"));
+        if (!(currentFile >> current)) current = 0;
+        currentFile.close();
+
+        auto generation = current != 0 ? store->OpenGeneration(current) : nullptr;
+        if (!generation)
+        {
+            generation = store->CreateGeneration(current + 1, store->m_options.indexCapacity, kInitialDataSize);
+            if (!generation || !store->WriteCurrent(generation->number)) return nullptr;
+        }
+
+        store->m_generation = generation;
+        store->RemoveGenerations(generation->number);
+
+        return store;
+    }
+
+    bool UtteranceStore::Find(const UtteranceKey& key, StoredUtterance& utterance)
+    {
+        auto generation = std::atomic_load(&m_generation);
+        auto header = GetHeader(*generation->index);
+        auto slots = GetSlots(*generation->index);
+        auto mask = header->capacity - 1;
+        auto end = header->dataEnd.load(std::memory_order_acquire);
+        auto hash = GetSlotHash(key);
+        auto identity = reinterpret_cast<const uint8_t*>(key.identity.data());
+
+        for (uint64_t i = 0; i < header->capacity; i++)
+        {
+            auto& slot = slots[(hash + i) & mask];
+            auto slotHash = slot.hash.load(std::memory_order_acquire);
+            if (slotHash == 0) break;
+            if (slotHash != hash) continue;
+
+            auto record = GetRecord(*generation->data, slot.offset.load(std::memory_order_acquire), end);
+            if (!record || !HasIdentity(record, identity, key.identity.size())) continue;
+
+            if (!IsIntact(record))
+            {
+                m_corrupted++;
+                break;
+            }
+
+            utterance.format.sampleRate = record->sampleRate;
+            utterance.format.channels = record->channels;
+            utterance.format.bitsPerSample = record->bitsPerSample;
+            // Shares ownership of the mapping.
+            utterance.samples = std::shared_ptr<const uint8_t>(generation->data, GetSamples(record));
+            utterance.size = record->sampleSize;
+
+            m_hits++;
+            return true;
+        }
+
+        m_misses++;
+        return false;
+    }
+
+    bool UtteranceStore::Put(const UtteranceKey& key, const PcmFormat& format, const uint8_t* samples, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+
+        auto generation = std::atomic_load(&m_generation);
+        auto header = GetHeader(*generation->index);
+        auto recordSize = GetRecordSize(key.identity.size(), size);
+        auto end = header->dataEnd.load(std::memory_order_relaxed);
+
+        if (size > UINT32_MAX || key.identity.size() > UINT32_MAX || end + recordSize > m_options.maxBytes)
+        {
+            m_rejected++;
+            if (recordSize <= m_options.maxBytes) Compact();
+            return false;
+        }
+
+        // Keeps probing short.
+        auto count = header->count.load(std::memory_order_relaxed);
+        if (count + 1 > header->capacity * 3 / 4)
+        {
+            Compact();
+            if (count + 1 >= header->capacity)
+            {
+                m_rejected++;
+                return false;
+            }
+        }
+
+        RecordHeader record{};
+        record.magic = kRecordMagic;
+        record.identitySize = static_cast<uint32_t>(key.identity.size());
+        record.hash = GetSlotHash(key);
+        record.sampleRate = format.sampleRate;
+        record.channels = format.channels;
+        record.bitsPerSample = format.bitsPerSample;
+        record.sampleSize = static_cast<uint32_t>(size);
+        record.checksum = GetRecordChecksum(reinterpret_cast<const uint8_t*>(key.identity.data()), key.identity.size(), samples, size);
+
+        std::vector<uint8_t> bytes(static_cast<size_t>(recordSize));
+        std::memcpy(bytes.data(), &record, sizeof(record));
+        std::memcpy(bytes.data() + sizeof(record), key.identity.data(), key.identity.size());
+        if (size > 0) std::memcpy(bytes.data() + sizeof(record) + key.identity.size(), samples, size);
+
+        auto previous = generation;
+        auto offset = Append(generation, bytes.data(), recordSize);
+        if (generation != previous)
+        {
+            std::atomic_store(&m_generation, generation);
+        }
+
+        if (offset == UINT64_MAX ||
+            !PublishSlot(*generation->index, *generation->data, record.hash, bytes.data() + sizeof(record), key.identity.size(), offset))
+        {
+            m_rejected++;
+            return false;
+        }
+
+        m_puts++;
+        return true;
+    }
+
+    void UtteranceStore::Compact()
+    {
+        bool expected = false;
+        if (!m_isCompacting.compare_exchange_strong(expected, true)) return;
+
+        // Previous compaction is over.
+        if (m_compactionThread.joinable()) m_compactionThread.join();
+
+        m_compactionThread = std::thread(&UtteranceStore::RunCompaction, this);
+    }
+
+    void UtteranceStore::WaitForCompaction()
+    {
+        std::thread thread;
+        {
+            // Not joined under the lock, compaction takes it to switch generations.
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            thread = std::move(m_compactionThread);
+        }
+
+        if (thread.joinable()) thread.join();
+    }
+
+    UtteranceStoreStats UtteranceStore::GetStats() const
+    {
+        auto generation = std::atomic_load(&m_generation);
+        auto header = GetHeader(*generation->index);
+
+        UtteranceStoreStats stats;
+        stats.hits = m_hits.load();
+        stats.misses = m_misses.load();
+        stats.puts = m_puts.load();
+        stats.rejected = m_rejected.load();
+        stats.corrupted = m_corrupted.load();
+        stats.compactions = m_compactions.load();
+        stats.entries = header->count.load(std::memory_order_relaxed);
+        stats.bytes = header->dataEnd.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::string UtteranceStore::GetFilePath(uint64_t generation, const char* extension) const
+    {
+        return m_basePath + "-" + std::to_string(generation) + extension;
+    }
+
+    std::shared_ptr<UtteranceStore::Generation> UtteranceStore::OpenGeneration(uint64_t number)
+    {
+        auto indexPath = GetFilePath(number, ".idx");
+        auto dataPath = GetFilePath(number, ".dat");
+
+        std::error_code error;
+        if (!std::filesystem::exists(std::filesystem::u8path(indexPath), error) ||
+            !std::filesystem::exists(std::filesystem::u8path(dataPath), error))
+        {
+            return nullptr;
+        }
+
+        auto generation = std::make_shared<Generation>();
+        generation->number = number;
+        generation->index = MappedFile::Open(indexPath, 0);
+        generation->data = MappedFile::Open(dataPath, 0);
+        if (!generation->index || !generation->data) return nullptr;
+        if (generation->index->GetSize() < sizeof(IndexHeader)) return nullptr;
+
+        auto header = GetHeader(*generation->index);
+        auto capacity = header->capacity;
+        if (header->magic != kIndexMagic || header->version != kVersion) return nullptr;
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || GetIndexSize(capacity) > generation->index->GetSize()) return nullptr;
+        if (header->dataEnd.load() > generation->data->GetSize()) return nullptr;
+
+        return generation;
+    }
+
+    std::shared_ptr<UtteranceStore::Generation> UtteranceStore::CreateGeneration(uint64_t number, uint64_t indexCapacity, uint64_t dataSize)
+    {
+        auto indexPath = GetFilePath(number, ".idx");
+        auto dataPath = GetFilePath(number, ".dat");
+
+        // Left over by an interrupted compaction.
+        std::error_code error;
+        std::filesystem::remove(std::filesystem::u8path(indexPath), error);
+        std::filesystem::remove(std::filesystem::u8path(dataPath), error);
+
+        auto generation = std::make_shared<Generation>();
+        generation->number = number;
+        generation->index = MappedFile::Open(indexPath, GetIndexSize(indexCapacity));
+        generation->data = MappedFile::Open(dataPath, dataSize);
+        if (!generation->index || !generation->data) return nullptr;
+
+        // New files are zero filled.
+        auto header = GetHeader(*generation->index);
+        header->magic = kIndexMagic;
+        header->version = kVersion;
+        header->capacity = indexCapacity;
+
+        if (!generation->index->Flush(0, generation->index->GetSize())) return nullptr;
+
+        return generation;
+    }
+
+    bool UtteranceStore::GrowData(std::shared_ptr<Generation>& generation, uint64_t size)
+    {
+        auto newSize = (std::max)(size, generation->data->GetSize() * 2);
+        if (newSize > m_options.maxBytes) newSize = (std::max)(size, m_options.maxBytes);
+
+        std::shared_ptr<MappedFile> data = MappedFile::Open(GetFilePath(generation->number, ".dat"), newSize);
+        if (!data) return false;
+
+        // Readers of the previous view are not affected.
+        auto grown = std::make_shared<Generation>(*generation);
+        grown->data = data;
+        generation = grown;
+        return true;
+    }
+
+    bool UtteranceStore::WriteCurrent(uint64_t number)
+    {
+        auto path = std::filesystem::u8path(m_basePath + ".cur");
+        auto tempPath = std::filesystem::u8path(m_basePath + ".cur.tmp");
+
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!(file << number) || !file.flush()) return false;
+        }
+
+        // Replaced at once, a reader never sees a partial number.
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    void UtteranceStore::RemoveGenerations(uint64_t keep)
+    {
+        auto base = std::filesystem::u8path(m_basePath);
+        auto directory = base.has_parent_path() ? base.parent_path() : std::filesystem::path(".");
+        auto prefix = base.filename().u8string() + "-";
+
+        std::error_code error;
+        std::vector<std::filesystem::path> stale;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            auto name = entry.path().filename().u8string();
+            auto extension = entry.path().extension().u8string();
+            if (name.compare(0, prefix.size(), prefix) != 0 || (extension != ".idx" && extension != ".dat")) continue;
+
+            auto number = name.substr(prefix.size(), name.size() - prefix.size() - extension.size());
+            if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) continue;
+            if (std::stoull(number) == keep) continue;
+
+            stale.push_back(entry.path());
+        }
+
+        // Files still mapped by readers may not be removed on every platform, next open retries.
+        for (const auto& path : stale)
+        {
+            std::filesystem::remove(path, error);
+        }
+    }
+
+    uint64_t UtteranceStore::Append(std::shared_ptr<Generation>& generation, const uint8_t* record, uint64_t size)
+    {
+        auto header = GetHeader(*generation->index);
+        auto end = header->dataEnd.load(std::memory_order_relaxed);
+
+        if (end + size > generation->data->GetSize() && !GrowData(generation, end + size)) return UINT64_MAX;
+
+        // Readers ignore bytes past dataEnd, the record is not visible until committed.
+        std::memcpy(generation->data->GetData() + end, record, static_cast<size_t>(size));
+        if (!generation->data->Flush(end, size)) return UINT64_MAX;
+
+        header->dataEnd.store(end + size, std::memory_order_release);
+        generation->index->Flush(0, sizeof(IndexHeader));
+
+        return end;
+    }
+
+    void UtteranceStore::RunCompaction()
+    {
+        struct LiveRecord {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        std::shared_ptr<Generation> source;
+        uint64_t snapshotEnd;
+        {
+            // Puts publish their slot after the data end, a snapshot in between would miss the record.
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            source = std::atomic_load(&m_generation);
+            snapshotEnd = GetHeader(*source->index)->dataEnd.load(std::memory_order_acquire);
+        }
+
+        auto sourceHeader = GetHeader(*source->index);
+        auto sourceSlots = GetSlots(*source->index);
+
+        // Live records of the snapshot, newest first.
+        std::vector<LiveRecord> live;
+        for (uint64_t i = 0; i < sourceHeader->capacity; i++)
+        {
+            if (sourceSlots[i].hash.load(std::memory_order_acquire) == 0) continue;
+
+            auto offset = sourceSlots[i].offset.load(std::memory_order_acquire);
+            auto record = GetRecord(*source->data, offset, snapshotEnd);
+            if (!record || !IsIntact(record)) continue;
+
+            live.push_back({ offset, GetRecordSize(record->identitySize, record->sampleSize) });
+        }
+        std::sort(live.begin(), live.end(), [](const LiveRecord& a, const LiveRecord& b) { return a.offset > b.offset; });
+
+        // Room is left for new records.
+        uint64_t target = m_options.maxBytes / 4 * 3;
+        uint64_t total = 0;
+        size_t kept = 0;
+        while (kept < live.size() && total + live[kept].size <= target)
+        {
+            total += live[kept++].size;
+        }
+        live.resize(kept);
+        std::reverse(live.begin(), live.end());
+
+        auto capacity = sourceHeader->capacity;
+        while (kept * 2 > capacity) capacity <<= 1;
+
+        auto generation = CreateGeneration(source->number + 1, capacity, (std::max)(total, kInitialDataSize));
+        bool succeeded = generation != nullptr;
+
+        // Copied oldest first, age order is kept.
+        for (size_t i = 0; succeeded && i < live.size(); i++)
+        {
+            auto record = reinterpret_cast<const RecordHeader*>(source->data->GetData() + live[i].offset);
+            auto offset = Append(generation, source->data->GetData() + live[i].offset, live[i].size);
+
+            succeeded = offset != UINT64_MAX &&
+                PublishSlot(*generation->index, *generation->data, record->hash, GetIdentity(record), record->identitySize, offset);
+        }
+
+        if (succeeded)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+
+            // Catch up with records written meanwhile.
+            auto current = std::atomic_load(&m_generation);
+            auto currentHeader = GetHeader(*current->index);
+            auto currentSlots = GetSlots(*current->index);
+            auto end = currentHeader->dataEnd.load(std::memory_order_relaxed);
+
+            for (uint64_t i = 0; succeeded && i < currentHeader->capacity; i++)
+            {
+                if (currentSlots[i].hash.load(std::memory_order_relaxed) == 0) continue;
+
+                auto sourceOffset = currentSlots[i].offset.load(std::memory_order_relaxed);
+                if (sourceOffset < snapshotEnd) continue;
+
+                auto record = GetRecord(*current->data, sourceOffset, end);
+                if (!record) continue;
+
+                auto offset = Append(generation, current->data->GetData() + sourceOffset, GetRecordSize(record->identitySize, record->sampleSize));
+                succeeded = offset != UINT64_MAX &&
+                    PublishSlot(*generation->index, *generation->data, record->hash, GetIdentity(record), record->identitySize, offset);
+            }
+
+            if (succeeded && WriteCurrent(generation->number))
+            {
+                std::atomic_store(&m_generation, generation);
+                m_compactions++;
+            }
+            else
+            {
+                succeeded = false;
+            }
+        }
+
+        // Either the previous generation or the failed one.
+        generation.reset();
+        RemoveGenerations(succeeded ? source->number + 1 : source->number);
+
+        m_isCompacting = false;
+    }
+
+}
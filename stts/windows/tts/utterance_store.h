@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "utterance_cache.h"
+#include "../storage/mapped_file.h"
+
+namespace stts {
+
+	struct UtteranceStoreOptions {
+		// Data size above which compaction removes the oldest utterances.
+		uint64_t maxBytes = 256ULL << 20;
+		// Index slots of a new store, rounded to a power of 2. Doubled by compaction as needed.
+		uint64_t indexCapacity = 4096;
+	};
+
+	// Samples mapped from the store file. The mapping is kept while samples are referenced.
+	struct StoredUtterance {
+		PcmFormat format;
+		std::shared_ptr<const uint8_t> samples;
+		size_t size = 0;
+	};
+
+	struct UtteranceStoreStats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t puts = 0;
+		// Puts refused until compaction makes room.
+		uint64_t rejected = 0;
+		// Records failing validation, e.g. after a crash.
+		uint64_t corrupted = 0;
+		uint64_t compactions = 0;
+		uint64_t entries = 0;
+		uint64_t bytes = 0;
+	};
+
+	// Persistent store of rendered utterances.
+	//
+	// Records are appended to a memory-mapped data file and located with a memory-mapped open addressing index.
+	// Files are <base>-<generation>.dat and <base>-<generation>.idx, the current generation is named in <base>.cur.
+	//
+	// Reads are lock free. Writers are serialized and publish a record only once it is on disk,
+	// so a crash loses at most the utterance being written. Records are validated by checksum when read.
+	// Compaction rewrites live records into the next generation on a background thread,
+	// dropping the oldest ones above 3/4 of the size cap, and switches generations atomically.
+	class UtteranceStore {
+	public:
+		// Returns null if the files cannot be created. Unreadable files are replaced by an empty store.
+		static std::unique_ptr<UtteranceStore> Open(const std::string& utf8BasePath, const UtteranceStoreOptions& options);
+
+		// Waits for a running compaction.
+		~UtteranceStore();
+
+		UtteranceStore(const UtteranceStore&) = delete;
+		UtteranceStore& operator=(const UtteranceStore&) = delete;
+
+		// Thread safe, does not block on writers or compaction.
+		bool Find(const UtteranceKey& key, StoredUtterance& utterance);
+
+		// Replaces a previous utterance with the same key.
+		// Returns false if the store is full, compaction is then started and a later put may succeed.
+		bool Put(const UtteranceKey& key, const PcmFormat& format, const uint8_t* samples, size_t size);
+
+		// Starts a compaction on a background thread, unless one is running.
+		void Compact();
+		void WaitForCompaction();
+
+		UtteranceStoreStats GetStats() const;
+
+	private:
+		struct Generation {
+			uint64_t number = 0;
+			std::shared_ptr<MappedFile> index;
+			std::shared_ptr<MappedFile> data;
+		};
+
+		UtteranceStore(const std::string& basePath, const UtteranceStoreOptions& options);
+
+		std::string m_basePath;
+		UtteranceStoreOptions m_options;
+
+		// Replaced as a whole, readers keep the one they loaded.
+		std::shared_ptr<Generation> m_generation;
+
+		std::mutex m_writeMutex;
+		std::thread m_compactionThread;
+		std::atomic<bool> m_isCompacting{ false };
+
+		std::atomic<uint64_t> m_hits{ 0 };
+		std::atomic<uint64_t> m_misses{ 0 };
+		std::atomic<uint64_t> m_puts{ 0 };
+		std::atomic<uint64_t> m_rejected{ 0 };
+		std::atomic<uint64_t> m_corrupted{ 0 };
+		std::atomic<uint64_t> m_compactions{ 0 };
+
+		std::string GetFilePath(uint64_t generation, const char* extension) const;
+		std::shared_ptr<Generation> OpenGeneration(uint64_t number);
+		std::shared_ptr<Generation> CreateGeneration(uint64_t number, uint64_t indexCapacity, uint64_t dataSize);
+		bool GrowData(std::shared_ptr<Generation>& generation, uint64_t size);
+		bool WriteCurrent(uint64_t number);
+		void RemoveGenerations(uint64_t keep);
+
+		uint64_t Append(std::shared_ptr<Generation>& generation, const uint8_t* record, uint64_t size);
+		void RunCompaction();
+	};
+
+}
@@ -3,6 +3,7 @@
 #include <flutter/encodable_value.h>
 #include <flutter/method_channel.h>
 #include <comdef.h>
+#include "codec/utf_transcoder.h"
 
 using namespace flutter;
 
@@ -23,68 +24,23 @@ T GetArgument(const std::string arg, const EncodableValue* args, T fallback) {
 	return result;
 }
 
-template <typename T>
-static bool GetValueFromEncodableMap(const flutter::EncodableMap* map,
-	const char* key, T& out) {
-	auto iter = map->find(flutter::EncodableValue(key));
-	if (iter != map->end() && !iter->second.IsNull()) {
-		if (auto* value = std::get_if<T>(&iter->second)) {
-			out = *value;
-			return true;
-		}
-	}
-	return false;
-}
-
-inline std::string toString(LPCWSTR pwsz) {
-	int cch = WideCharToMultiByte(CP_UTF8, 0, pwsz, -1, 0, 0, NULL, NULL);
-
-	char* psz = new char[cch];
-
-	WideCharToMultiByte(CP_UTF8, 0, pwsz, -1, psz, cch, NULL, NULL);
-
-	std::string st(psz);
-	delete[] psz;
-
-	return st;
+// Invalid input converts to an empty string.
+inline std::string Utf8FromUtf16(const wchar_t* utf16, size_t size) {
+	std::string utf8_string;
+	stts::UtfTranscoder::Utf16ToUtf8(utf16, size, utf8_string);
+	return utf8_string;
 }
 
 inline std::string Utf8FromUtf16(const std::wstring& utf16_string) {
-	if (utf16_string.empty()) {
-		return std::string();
-	}
-	int target_length = ::WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string.data(), static_cast<int>(utf16_string.length()), nullptr, 0, nullptr, nullptr);
-
-	std::string utf8_string;
-	if (target_length == 0 || target_length > utf8_string.max_size()) {
-		return utf8_string;
-	}
-
-	utf8_string.resize(target_length);
-	int converted_length = ::WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, utf16_string.data(), static_cast<int>(utf16_string.length()), utf8_string.data(), target_length, nullptr, nullptr);
-	if (converted_length == 0) {
-		return std::string();
-	}
+	return Utf8FromUtf16(utf16_string.data(), utf16_string.length());
+}
 
-	return utf8_string;
+inline std::string toString(LPCWSTR pwsz) {
+	return Utf8FromUtf16(pwsz, wcslen(pwsz));
 }
 
 inline std::wstring Utf16FromUtf8(const std::string& utf8_string) {
-	if (utf8_string.empty()) {
-		return std::wstring();
-	}
-
-	int target_length = ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(), static_cast<int>(utf8_string.length()), nullptr, 0);
 	std::wstring utf16_string;
-	if (target_length == 0 || target_length > utf16_string.max_size()) {
-		return utf16_string;
-	}
-
-	utf16_string.resize(target_length);
-	int converted_length = ::MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8_string.data(), static_cast<int>(utf8_string.length()), utf16_string.data(), target_length);
-	if (converted_length == 0) {
-		return std::wstring();
-	}
-
+	stts::UtfTranscoder::Utf8ToUtf16(utf8_string.data(), utf8_string.length(), utf16_string);
 	return utf16_string;
-}
\ No newline at end of file
+}
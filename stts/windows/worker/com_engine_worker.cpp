@@ -0,0 +1,62 @@
+#include "com_engine_worker.h"
+
+#include <objbase.h>
+
+namespace stts {
+
+    ComEngineWorker::ComEngineWorker(size_t capacity) :
+        EngineWorker(capacity),
+        // Auto reset, one wake up per signal.
+        m_wakeEvent(CreateEventW(NULL, FALSE, FALSE, NULL))
+    {
+    }
+
+    ComEngineWorker::~ComEngineWorker()
+    {
+        // Must be stopped while overrides are still available.
+        Stop();
+
+        if (m_wakeEvent)
+        {
+            CloseHandle(m_wakeEvent);
+        }
+    }
+
+    void ComEngineWorker::OnStart()
+    {
+        m_comInitResult = CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
+
+        // Force creation of the thread message queue before any notification is registered.
+        MSG msg;
+        PeekMessageW(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+    }
+
+    void ComEngineWorker::OnStop()
+    {
+        if (SUCCEEDED(m_comInitResult))
+        {
+            CoUninitialize();
+        }
+    }
+
+    void ComEngineWorker::WaitForWork(std::chrono::milliseconds timeout)
+    {
+        auto count = static_cast<long long>(timeout.count());
+        auto waitMs = count <= 0 ? 0 : static_cast<DWORD>(min(count, 60000LL));
+
+        MsgWaitForMultipleObjectsEx(1, &m_wakeEvent, waitMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+
+        MSG msg;
+        while (PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+    }
+
+    void ComEngineWorker::Wake()
+    {
+        SetEvent(m_wakeEvent);
+    }
+
+}
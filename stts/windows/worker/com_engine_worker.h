@@ -0,0 +1,28 @@
+#pragma once
+
+#include "engine_worker.h"
+
+#include <windows.h>
+
+namespace stts {
+
+	// Engine worker running in its own single threaded COM apartment.
+	// SAPI delivers notify callbacks through window messages of the thread which registered them,
+	// so messages are pumped while waiting for commands.
+	class ComEngineWorker : public EngineWorker {
+	public:
+		explicit ComEngineWorker(size_t capacity);
+		~ComEngineWorker();
+
+	protected:
+		void OnStart() override;
+		void OnStop() override;
+		void WaitForWork(std::chrono::milliseconds timeout) override;
+		void Wake() override;
+
+	private:
+		HANDLE m_wakeEvent;
+		HRESULT m_comInitResult = E_FAIL;
+	};
+
+}
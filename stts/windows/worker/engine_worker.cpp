@@ -0,0 +1,353 @@
+#include "engine_worker.h"
+
+#include <algorithm>
+#include <vector>
+#include "../trace/trace_recorder.h"
+
+namespace stts {
+
+    EngineWorker::EngineWorker(size_t capacity) :
+        m_capacity(capacity)
+    {
+    }
+
+    EngineWorker::~EngineWorker()
+    {
+        Stop();
+    }
+
+    void EngineWorker::Start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_thread.joinable()) return;
+
+        m_thread = std::thread(&EngineWorker::Run, this);
+        m_threadId = m_thread.get_id();
+    }
+
+    void EngineWorker::Stop(std::function<void()> finalTask)
+    {
+        std::deque<QueuedCommand> pending;
+        std::deque<ScheduledTask> scheduledTasks;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_isStopping) return;
+
+            m_isStopping = true;
+            m_finalTask = std::move(finalTask);
+            pending.swap(m_queue);
+            scheduledTasks.swap(m_scheduledTasks);
+
+            if (m_currentToken) m_currentToken->Cancel();
+        }
+
+        for (auto& queued : pending)
+        {
+            Reject(queued, CommandRejection::shutdown);
+        }
+
+        Wake();
+
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    uint64_t EngineWorker::Post(EngineCommand command)
+    {
+        QueuedCommand queued{ 0, std::move(command), nullptr };
+        CommandRejection rejection = CommandRejection::shutdown;
+        uint64_t id = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_isStopping)
+            {
+                rejection = CommandRejection::shutdown;
+            }
+            else if (m_queue.size() >= m_capacity)
+            {
+                rejection = CommandRejection::queueFull;
+            }
+            else
+            {
+                auto deadline = queued.command.timeout.count() > 0
+                    ? Clock::now() + queued.command.timeout
+                    : (Clock::time_point::max)();
+
+                queued.id = m_nextId++;
+                queued.token = std::make_shared<CancellationToken>(deadline);
+                id = queued.id;
+
+                m_queue.push_back(std::move(queued));
+            }
+        }
+
+        if (id == 0)
+        {
+            Reject(queued, rejection);
+            return 0;
+        }
+
+        Wake();
+        return id;
+    }
+
+    bool EngineWorker::Cancel(uint64_t id)
+    {
+        QueuedCommand cancelled{};
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_currentToken && m_currentId == id)
+            {
+                m_currentToken->Cancel();
+                return true;
+            }
+
+            auto it = std::find_if(m_queue.begin(), m_queue.end(), [id](const QueuedCommand& queued) {
+                return queued.id == id;
+            });
+            if (it == m_queue.end()) return false;
+
+            cancelled = std::move(*it);
+            m_queue.erase(it);
+        }
+
+        Reject(cancelled, CommandRejection::cancelled);
+        return true;
+    }
+
+    size_t EngineWorker::Cancel(const std::string& group)
+    {
+        std::vector<QueuedCommand> cancelled;
+        size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_currentToken && m_currentGroup == group)
+            {
+                m_currentToken->Cancel();
+                count++;
+            }
+
+            for (auto it = m_queue.begin(); it != m_queue.end();)
+            {
+                if (it->command.group == group)
+                {
+                    cancelled.push_back(std::move(*it));
+                    it = m_queue.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        for (auto& queued : cancelled)
+        {
+            Reject(queued, CommandRejection::cancelled);
+        }
+
+        return count + cancelled.size();
+    }
+
+    size_t EngineWorker::GetPendingCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queue.size();
+    }
+
+    bool EngineWorker::IsWorkerThread() const
+    {
+        return std::this_thread::get_id() == m_threadId;
+    }
+
+    uint64_t EngineWorker::Schedule(std::chrono::milliseconds delay, std::function<void()> task)
+    {
+        uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_isStopping) return 0;
+
+            id = m_nextId++;
+            ScheduledTask scheduled{ id, Clock::now() + delay, std::move(task) };
+
+            auto it = std::upper_bound(m_scheduledTasks.begin(), m_scheduledTasks.end(), scheduled.dueTime,
+                [](const Clock::time_point& dueTime, const ScheduledTask& other) { return dueTime < other.dueTime; });
+            m_scheduledTasks.insert(it, std::move(scheduled));
+        }
+
+        // Wait time may need to be shortened.
+        Wake();
+        return id;
+    }
+
+    void EngineWorker::Unschedule(uint64_t id)
+    {
+        std::function<void()> removed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto it = std::find_if(m_scheduledTasks.begin(), m_scheduledTasks.end(), [id](const ScheduledTask& scheduled) {
+                return scheduled.id == id;
+            });
+            if (it == m_scheduledTasks.end()) return;
+
+            // Destroyed outside of the lock.
+            removed = std::move(it->task);
+            m_scheduledTasks.erase(it);
+        }
+    }
+
+    void EngineWorker::WaitForWork(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait_for(lock, timeout, [this] { return m_wakeRequested; });
+        m_wakeRequested = false;
+    }
+
+    void EngineWorker::Wake()
+    {
+        // Default implementation relies on the condition variable notified by callers.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeRequested = true;
+        m_condition.notify_one();
+    }
+
+    void EngineWorker::Run()
+    {
+        OnStart();
+        TraceRecorder::SetThreadName("engine worker");
+
+        while (true)
+        {
+            QueuedCommand next{};
+            std::chrono::milliseconds wait{ 0 };
+
+            if (RunDueTask()) continue;
+
+            if (TakeNext(next, wait))
+            {
+                if (next.token->ShouldStop())
+                {
+                    Reject(next, next.token->IsCancelled() ? CommandRejection::cancelled : CommandRejection::timeout);
+                }
+                else
+                {
+                    TraceSpan span("engine", "EngineCommand");
+                    next.command.run(*next.token);
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_currentToken.reset();
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_isStopping) break;
+            }
+
+            WaitForWork(wait);
+        }
+
+        if (m_finalTask)
+        {
+            m_finalTask();
+            m_finalTask = nullptr;
+        }
+
+        OnStop();
+    }
+
+    bool EngineWorker::TakeNext(QueuedCommand& next, std::chrono::milliseconds& wait)
+    {
+        std::vector<QueuedCommand> expired;
+        bool hasNext = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // Drop commands which expired while waiting, they would be answered too late anyway.
+            auto now = Clock::now();
+            for (auto it = m_queue.begin(); it != m_queue.end();)
+            {
+                if (it->token->IsExpired())
+                {
+                    expired.push_back(std::move(*it));
+                    it = m_queue.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            if (!m_queue.empty() && !m_isStopping)
+            {
+                next = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_currentId = next.id;
+                m_currentGroup = next.command.group;
+                m_currentToken = next.token;
+                hasNext = true;
+            }
+            else
+            {
+                // Wake up at the next deadline to reject expired commands or run scheduled tasks in time.
+                auto nextDeadline = m_scheduledTasks.empty() ? (Clock::time_point::max)() : m_scheduledTasks.front().dueTime;
+                for (const auto& queued : m_queue)
+                {
+                    nextDeadline = (std::min)(nextDeadline, queued.token->GetDeadline());
+                }
+
+                wait = nextDeadline == (Clock::time_point::max)()
+                    ? std::chrono::milliseconds(1000)
+                    : (std::min)(std::chrono::milliseconds(1000),
+                        std::chrono::duration_cast<std::chrono::milliseconds>(nextDeadline - now) + std::chrono::milliseconds(1));
+            }
+        }
+
+        for (auto& queued : expired)
+        {
+            Reject(queued, CommandRejection::timeout);
+        }
+
+        return hasNext;
+    }
+
+    bool EngineWorker::RunDueTask()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_isStopping || m_scheduledTasks.empty() || m_scheduledTasks.front().dueTime > Clock::now())
+            {
+                return false;
+            }
+
+            task = std::move(m_scheduledTasks.front().task);
+            m_scheduledTasks.pop_front();
+        }
+
+        TraceSpan span("engine", "ScheduledTask");
+        task();
+        return true;
+    }
+
+    // static
+    void EngineWorker::Reject(QueuedCommand& queued, CommandRejection rejection)
+    {
+        if (queued.command.reject)
+        {
+            queued.command.reject(rejection);
+        }
+    }
+
+}
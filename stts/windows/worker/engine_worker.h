@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stts {
+
+	// Cancellation state shared between the worker and a running command.
+	class CancellationToken {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit CancellationToken(Clock::time_point deadline = (Clock::time_point::max)()) :
+			m_deadline(deadline)
+		{
+		}
+
+		void Cancel() { m_isCancelled.store(true, std::memory_order_relaxed); }
+
+		bool IsCancelled() const { return m_isCancelled.load(std::memory_order_relaxed); }
+
+		bool IsExpired() const { return Clock::now() >= m_deadline; }
+
+		// Long running commands should poll this at safe points and bail out.
+		bool ShouldStop() const { return IsCancelled() || IsExpired(); }
+
+		Clock::time_point GetDeadline() const { return m_deadline; }
+
+	private:
+		std::atomic<bool> m_isCancelled{ false };
+		const Clock::time_point m_deadline;
+	};
+
+	enum class CommandRejection {
+		// Queue is at capacity.
+		queueFull,
+		// Deadline reached before the command could run.
+		timeout,
+		// Cancelled before the command could run.
+		cancelled,
+		// Worker is stopping.
+		shutdown,
+	};
+
+	struct EngineCommand {
+		// Used to cancel a set of pending commands at once (e.g. stt, tts).
+		std::string group;
+		// Executed on the worker thread.
+		std::function<void(const CancellationToken& token)> run;
+		// Executed instead of run when the command is dropped. May be called from any thread.
+		std::function<void(CommandRejection rejection)> reject;
+		// Maximum time the command can wait in the queue and run. Zero means no timeout.
+		std::chrono::milliseconds timeout{ 0 };
+	};
+
+	// Schedules delayed tasks on an engine thread.
+	class TaskScheduler {
+	public:
+		virtual ~TaskScheduler() = default;
+
+		// Runs task on the engine thread after delay. Returns an ID usable to unschedule it.
+		virtual uint64_t Schedule(std::chrono::milliseconds delay, std::function<void()> task) = 0;
+
+		// Removes a task not executed yet.
+		virtual void Unschedule(uint64_t id) = 0;
+	};
+
+	// Single thread actor executing commands in submission order from a bounded queue.
+	//
+	// Thread specific behaviour (e.g. COM apartment initialization, message pumping) is provided
+	// by overriding the protected hooks. Start must be called once the instance is fully constructed
+	// and Stop before the derived instance is destroyed.
+	class EngineWorker : public TaskScheduler {
+	public:
+		using Clock = CancellationToken::Clock;
+
+		explicit EngineWorker(size_t capacity);
+		virtual ~EngineWorker();
+
+		// Disallow copy and assign.
+		EngineWorker(const EngineWorker&) = delete;
+		EngineWorker& operator=(const EngineWorker&) = delete;
+
+		void Start();
+
+		// Rejects pending commands and joins the worker thread after the current command completes.
+		// finalTask, if any, is executed on the worker thread before hooks are torn down.
+		void Stop(std::function<void()> finalTask = nullptr);
+
+		// Enqueues a command. Returns 0 and rejects the command if the queue is full or stopped.
+		uint64_t Post(EngineCommand command);
+
+		// Cancels a command. Pending commands are rejected, a running command sees its token cancelled.
+		bool Cancel(uint64_t id);
+
+		// Cancels all pending and running commands of the group.
+		size_t Cancel(const std::string& group);
+
+		// Number of pending commands.
+		size_t GetPendingCount();
+
+		bool IsWorkerThread() const;
+
+		uint64_t Schedule(std::chrono::milliseconds delay, std::function<void()> task) override;
+		void Unschedule(uint64_t id) override;
+
+	protected:
+		// Called on the worker thread before processing commands.
+		virtual void OnStart() {}
+
+		// Called on the worker thread after the last command.
+		virtual void OnStop() {}
+
+		// Blocks until Wake is called or timeout elapsed.
+		// Overrides must return promptly when woken up.
+		virtual void WaitForWork(std::chrono::milliseconds timeout);
+
+		// Wakes up WaitForWork. May be called from any thread.
+		virtual void Wake();
+
+	private:
+		struct QueuedCommand {
+			uint64_t id;
+			EngineCommand command;
+			std::shared_ptr<CancellationToken> token;
+		};
+
+		struct ScheduledTask {
+			uint64_t id;
+			Clock::time_point dueTime;
+			std::function<void()> task;
+		};
+
+		const size_t m_capacity;
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_wakeRequested = false;
+		std::deque<QueuedCommand> m_queue;
+		// Sorted by due time.
+		std::deque<ScheduledTask> m_scheduledTasks;
+		uint64_t m_currentId = 0;
+		std::string m_currentGroup;
+		std::shared_ptr<CancellationToken> m_currentToken;
+		bool m_isStopping = false;
+		std::function<void()> m_finalTask;
+		uint64_t m_nextId = 1;
+
+		std::thread m_thread;
+		std::thread::id m_threadId;
+
+		void Run();
+		bool TakeNext(QueuedCommand& next, std::chrono::milliseconds& wait);
+		bool RunDueTask();
+		static void Reject(QueuedCommand& queued, CommandRejection rejection);
+	};
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace stts {
+
+#ifdef _MSC_VER
+#pragma warning(push)
+// Structure padded due to alignment specifier, this is the point.
+#pragma warning(disable: 4324)
+#endif
+
+	// Bounded lock-free queue for many producer threads and one consumer thread.
+	// TryPush may be called from any thread, TryPop only by the consumer.
+	//
+	// Each slot carries a sequence number telling whether it is free for the producer claiming that position
+	// or filled for the consumer, so producers only contend on the enqueue position.
+	// A producer preempted between claiming and filling its slot delays the consumer at that slot only.
+	template <typename T>
+	class MpscQueue {
+	public:
+		// Capacity is rounded up to a power of two.
+		explicit MpscQueue(size_t capacity)
+		{
+			size_t size = 2;
+			while (size < capacity) size <<= 1;
+
+			m_slots = std::make_unique<Slot[]>(size);
+			m_mask = size - 1;
+
+			for (size_t i = 0; i < size; i++)
+			{
+				m_slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		// Returns false if the queue is full, item is then left untouched.
+		bool TryPush(T& item)
+		{
+			auto position = m_enqueuePosition.load(std::memory_order_relaxed);
+			Slot* slot;
+
+			for (;;)
+			{
+				slot = &m_slots[position & m_mask];
+				auto sequence = slot->sequence.load(std::memory_order_acquire);
+				auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+				if (difference == 0)
+				{
+					if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+				}
+				else if (difference < 0)
+				{
+					// Not consumed yet since the previous lap.
+					return false;
+				}
+				else
+				{
+					position = m_enqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->value = std::move(item);
+			slot->sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Returns false if the queue is empty or the next item is not written yet.
+		bool TryPop(T& item)
+		{
+			auto position = m_dequeuePosition.load(std::memory_order_relaxed);
+			auto& slot = m_slots[position & m_mask];
+
+			if (slot.sequence.load(std::memory_order_acquire) != position + 1) return false;
+
+			item = std::move(slot.value);
+			slot.value = T();
+			slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+			m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Items claimed by producers and not popped yet. Approximate while other threads use the queue.
+		size_t GetSize() const
+		{
+			auto dequeued = m_dequeuePosition.load(std::memory_order_relaxed);
+			auto enqueued = m_enqueuePosition.load(std::memory_order_relaxed);
+			return enqueued > dequeued ? enqueued - dequeued : 0;
+		}
+
+		size_t GetCapacity() const { return m_mask + 1; }
+
+	private:
+		struct Slot {
+			// Position + 1 once filled, position + capacity once consumed.
+			std::atomic<size_t> sequence{ 0 };
+			T value{};
+		};
+
+		std::unique_ptr<Slot[]> m_slots;
+		size_t m_mask = 0;
+
+		// Kept on separate cache lines to avoid false sharing between producers and the consumer.
+		alignas(64) std::atomic<size_t> m_enqueuePosition{ 0 };
+		alignas(64) std::atomic<size_t> m_dequeuePosition{ 0 };
+	};
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+}
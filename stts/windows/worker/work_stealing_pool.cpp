@@ -0,0 +1,224 @@
+#include "work_stealing_pool.h"
+
+#include "../trace/trace_recorder.h"
+
+namespace stts {
+
+    WorkStealingPool::WorkStealingPool(size_t workerCount)
+    {
+        if (workerCount == 0) workerCount = 1;
+
+        for (size_t i = 0; i < workerCount; i++)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        Stop();
+    }
+
+    void WorkStealingPool::Start()
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+
+        if (m_isStarted || m_isStopping) return;
+        m_isStarted = true;
+
+        for (size_t i = 0; i < m_workers.size(); i++)
+        {
+            m_workers[i]->thread = std::thread(&WorkStealingPool::Run, this, i);
+        }
+    }
+
+    void WorkStealingPool::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            if (m_isStopping.exchange(true)) return;
+        }
+
+        std::vector<QueuedJob> pending;
+        for (auto& worker : m_workers)
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+
+            for (auto& queued : worker->queue)
+            {
+                pending.push_back(std::move(queued));
+            }
+            worker->queue.clear();
+
+            if (worker->currentToken) worker->currentToken->Cancel();
+        }
+        m_pendingCount.store(0);
+
+        for (auto& queued : pending)
+        {
+            if (queued.job.cancel) queued.job.cancel(queued.id);
+        }
+
+        m_wakeCondition.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->thread.joinable()) worker->thread.join();
+        }
+    }
+
+    uint64_t WorkStealingPool::Submit(PoolJob job)
+    {
+        if (m_isStopping)
+        {
+            if (job.cancel) job.cancel(0);
+            return 0;
+        }
+
+        auto id = m_nextId++;
+        auto& worker = *m_workers[m_nextWorker++ % m_workers.size()];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.queue.push_back({ id, std::move(job) });
+        }
+
+        m_submitted++;
+        {
+            // Pairs with the wait predicate, a worker about to sleep can't miss this job.
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_pendingCount++;
+        }
+        m_wakeCondition.notify_one();
+
+        return id;
+    }
+
+    bool WorkStealingPool::Cancel(uint64_t id)
+    {
+        for (auto& worker : m_workers)
+        {
+            QueuedJob cancelled{ 0, {} };
+            {
+                std::lock_guard<std::mutex> lock(worker->mutex);
+
+                if (worker->currentId == id && worker->currentToken)
+                {
+                    worker->currentToken->Cancel();
+                    return true;
+                }
+
+                for (auto it = worker->queue.begin(); it != worker->queue.end(); ++it)
+                {
+                    if (it->id == id)
+                    {
+                        cancelled = std::move(*it);
+                        worker->queue.erase(it);
+                        m_pendingCount--;
+                        break;
+                    }
+                }
+            }
+
+            if (cancelled.id != 0)
+            {
+                if (cancelled.job.cancel) cancelled.job.cancel(cancelled.id);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    PoolStats WorkStealingPool::GetStats() const
+    {
+        PoolStats stats;
+        stats.submitted = m_submitted.load();
+        stats.completed = m_completed.load();
+        stats.stolen = m_stolen.load();
+        return stats;
+    }
+
+    void WorkStealingPool::Run(size_t workerIndex)
+    {
+        OnWorkerStart(workerIndex);
+        TraceRecorder::SetThreadName("pool worker");
+
+        while (!m_isStopping)
+        {
+            QueuedJob queued;
+            if (TakeNext(workerIndex, queued))
+            {
+                Execute(workerIndex, queued);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wakeCondition.wait(lock, [this]() { return m_isStopping || m_pendingCount > 0; });
+        }
+
+        OnWorkerStop(workerIndex);
+    }
+
+    bool WorkStealingPool::TakeNext(size_t workerIndex, QueuedJob& queued)
+    {
+        auto count = m_workers.size();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto& worker = *m_workers[(workerIndex + i) % count];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+
+            if (worker.queue.empty()) continue;
+
+            // Own jobs in order, stolen ones from the back.
+            if (i == 0)
+            {
+                queued = std::move(worker.queue.front());
+                worker.queue.pop_front();
+            }
+            else
+            {
+                queued = std::move(worker.queue.back());
+                worker.queue.pop_back();
+                m_stolen++;
+            }
+
+            m_pendingCount--;
+            return true;
+        }
+
+        return false;
+    }
+
+    void WorkStealingPool::Execute(size_t workerIndex, QueuedJob& queued)
+    {
+        auto& worker = *m_workers[workerIndex];
+
+        auto token = std::make_shared<CancellationToken>();
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.currentId = queued.id;
+            worker.currentToken = token;
+        }
+
+        // Stop may have run before the token was published.
+        if (m_isStopping)
+        {
+            token->Cancel();
+        }
+
+        {
+            TraceSpan span("engine", "PoolJob");
+            queued.job.run(queued.id, *token, workerIndex);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.currentId = 0;
+            worker.currentToken = nullptr;
+        }
+
+        m_completed++;
+    }
+
+}
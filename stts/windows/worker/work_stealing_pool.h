@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "engine_worker.h"
+
+namespace stts {
+
+	struct PoolJob {
+		// Executed on one of the pool threads, with the job ID and the index of this thread.
+		std::function<void(uint64_t id, const CancellationToken& token, size_t workerIndex)> run;
+		// Executed instead of run when the job is cancelled before it starts or the pool stops.
+		std::function<void(uint64_t id)> cancel;
+	};
+
+	struct PoolStats {
+		uint64_t submitted = 0;
+		uint64_t completed = 0;
+		// Jobs run by another worker than the one they were queued to.
+		uint64_t stolen = 0;
+	};
+
+	// Fixed set of worker threads, each with its own job queue.
+	//
+	// Jobs are spread over the queues. A worker runs its own jobs in submission order
+	// and steals from the back of other queues when it runs out, so long jobs do not leave threads idle.
+	// Per thread resources (e.g. COM apartment, engines) are managed by overriding the protected hooks.
+	// Start must be called once the instance is fully constructed, and derived classes must call Stop
+	// in their destructor.
+	class WorkStealingPool {
+	public:
+		explicit WorkStealingPool(size_t workerCount);
+		virtual ~WorkStealingPool();
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		void Start();
+
+		// Cancels running jobs, cancels pending ones and joins the threads.
+		void Stop();
+
+		// Returns the job ID, or 0 if the pool is stopped.
+		uint64_t Submit(PoolJob job);
+
+		// Pending job is removed and cancelled, running job sees its token cancelled.
+		bool Cancel(uint64_t id);
+
+		size_t GetWorkerCount() const { return m_workers.size(); }
+		size_t GetPendingCount() const { return m_pendingCount.load(); }
+		PoolStats GetStats() const;
+
+	protected:
+		virtual void OnWorkerStart(size_t /*workerIndex*/) {}
+		virtual void OnWorkerStop(size_t /*workerIndex*/) {}
+
+	private:
+		struct QueuedJob {
+			uint64_t id;
+			PoolJob job;
+		};
+
+		struct Worker {
+			std::mutex mutex;
+			std::deque<QueuedJob> queue;
+			// Running job, guarded by mutex.
+			uint64_t currentId = 0;
+			std::shared_ptr<CancellationToken> currentToken;
+			std::thread thread;
+		};
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeCondition;
+		std::atomic<size_t> m_pendingCount{ 0 };
+		std::atomic<bool> m_isStopping{ false };
+		bool m_isStarted = false;
+
+		std::atomic<uint64_t> m_nextId{ 1 };
+		std::atomic<size_t> m_nextWorker{ 0 };
+
+		std::atomic<uint64_t> m_submitted{ 0 };
+		std::atomic<uint64_t> m_completed{ 0 };
+		std::atomic<uint64_t> m_stolen{ 0 };
+
+		void Run(size_t workerIndex);
+		bool TakeNext(size_t workerIndex, QueuedJob& queued);
+		void Execute(size_t workerIndex, QueuedJob& queued);
+	};
+
+}
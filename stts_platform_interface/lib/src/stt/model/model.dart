@@ -2,3 +2,7 @@ export 'ios_audio_session.dart';
 export 'stt_recognition.dart';
 export 'stt_recognition_options.dart';
 export 'stt_state.dart';
+export 'stt_windows_audio_level.dart';
+export 'stt_windows_pcm_format.dart';
+export 'stt_windows_session_stats.dart';
+export 'stt_windows_transcription.dart';
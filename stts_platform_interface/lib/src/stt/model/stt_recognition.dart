@@ -1,10 +1,31 @@
 /// Speech recognition representation.
 class SttRecognition {
-  const SttRecognition(this.text, this.isFinal);
+  const SttRecognition(
+    this.text,
+    this.isFinal, {
+    this.sequence,
+    this.audioOffset,
+    this.audioDuration,
+  });
 
   /// The recognized text.
   final String text;
 
   /// [true], if final recognition. Otherwise, it's an interim result.
   final bool isFinal;
+
+  /// Index of the final result in the current recognition session.
+  ///
+  /// *Windows only.*
+  final int? sequence;
+
+  /// Position of the phrase from the start of the recognition session.
+  ///
+  /// *Windows only.*
+  final Duration? audioOffset;
+
+  /// Length of the phrase audio.
+  ///
+  /// *Windows only.*
+  final Duration? audioDuration;
 }
@@ -42,6 +42,9 @@ class SttRecognitionOptions {
   /// macOS specific options.
   final SttRecognitionMacosOptions macos;
 
+  /// Windows specific options.
+  final SttRecognitionWindowsOptions windows;
+
   const SttRecognitionOptions({
     this.contextualStrings = const [],
     this.punctuation = false,
@@ -49,6 +52,7 @@ class SttRecognitionOptions {
     this.android = const SttRecognitionAndroidOptions(),
     this.ios = const SttRecognitionIosOptions(),
     this.macos = const SttRecognitionMacosOptions(),
+    this.windows = const SttRecognitionWindowsOptions(),
   });
 
   Map<String, dynamic> toMap() {
@@ -59,6 +63,7 @@ class SttRecognitionOptions {
       'android': android.toMap(),
       'ios': ios.toMap(),
       'macos': macos.toMap(),
+      'windows': windows.toMap(),
     };
   }
 }
@@ -113,6 +118,75 @@ class SttRecognitionMacosOptions {
   }
 }
 
+/// Windows specific options.
+class SttRecognitionWindowsOptions {
+  /// Delay before releasing the recognition engine once stopped.
+  ///
+  /// The engine is kept warm in between to start listening faster.
+  /// [Duration.zero] releases the engine as soon as recognition stops.
+  final Duration idleTimeout;
+
+  /// Maximum memory footprint in bytes allowed to keep the engine warm.
+  ///
+  /// If the engine allocated more when created, it is released as soon as recognition stops.
+  /// `null` means no limit.
+  final int? memoryBudget;
+
+  /// Keeps listening after each final result until stopped.
+  ///
+  /// Final results are then numbered with [SttRecognition.sequence].
+  final bool continuous;
+
+  /// Stops recognition after this duration. `null` means no limit.
+  final Duration? maxDuration;
+
+  /// Stops recognition when nothing is heard for this duration. `null` means no limit.
+  final Duration? silenceTimeout;
+
+  /// Minimum delay between two intermediate results.
+  ///
+  /// Intermediate results received in between are merged.
+  /// [Duration.zero] sends all of them.
+  final Duration hypothesisInterval;
+
+  /// Sends results as packed binary records instead of maps.
+  ///
+  /// This reduces the encoding cost of frequent intermediate results.
+  final bool compactEvents;
+
+  /// Interval of audio levels sent to `SttWindows.onAudioLevelChanged`.
+  ///
+  /// `null` disables audio levels.
+  final Duration? levelInterval;
+
+  const SttRecognitionWindowsOptions({
+    this.idleTimeout = const Duration(minutes: 1),
+    this.memoryBudget,
+    this.continuous = false,
+    this.maxDuration,
+    this.silenceTimeout,
+    this.hypothesisInterval = const Duration(milliseconds: 100),
+    this.compactEvents = false,
+    this.levelInterval,
+  });
+
+  Map<String, dynamic> toMap() {
+    return <String, dynamic>{
+      'idleTimeout': idleTimeout.inMilliseconds,
+      if (memoryBudget case final budget?) 'memoryBudget': budget,
+      'continuous': continuous,
+      if (maxDuration case final duration?)
+        'maxDuration': duration.inMilliseconds,
+      if (silenceTimeout case final timeout?)
+        'silenceTimeout': timeout.inMilliseconds,
+      'hypothesisInterval': hypothesisInterval.inMilliseconds,
+      'compactEvents': compactEvents,
+      if (levelInterval case final interval?)
+        'levelInterval': interval.inMilliseconds,
+    };
+  }
+}
+
 /// Informs the recognizer which speech task to prefer.
 ///
 /// SFSpeechRecognitionTaskHint
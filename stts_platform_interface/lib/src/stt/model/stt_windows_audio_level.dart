@@ -0,0 +1,26 @@
+/// Level of the audio heard by the Windows recognition engine.
+class SttWindowsAudioLevel {
+  /// Root mean square of the loudest frame since the previous level, from 0 to 1.
+  final double rms;
+
+  /// Absolute peak since the previous level, from 0 to 1.
+  final double peak;
+
+  /// Whether voice was detected since the previous level.
+  final bool voiceDetected;
+
+  const SttWindowsAudioLevel({
+    required this.rms,
+    required this.peak,
+    required this.voiceDetected,
+  });
+
+  /// Map level from platform value.
+  factory SttWindowsAudioLevel.fromMap(Map map) {
+    return SttWindowsAudioLevel(
+      rms: map['rms'] as double,
+      peak: map['peak'] as double,
+      voiceDetected: map['voice'] as bool,
+    );
+  }
+}
@@ -0,0 +1,25 @@
+/// Format of raw PCM samples given to `SttWindows.transcribeBuffer`.
+class SttWindowsPcmFormat {
+  /// Samples per second.
+  final int sampleRate;
+
+  /// Number of interleaved channels.
+  final int channels;
+
+  /// Bits per sample, 8 or 16.
+  final int bitsPerSample;
+
+  const SttWindowsPcmFormat({
+    this.sampleRate = 16000,
+    this.channels = 1,
+    this.bitsPerSample = 16,
+  });
+
+  Map<String, dynamic> toMap() {
+    return <String, dynamic>{
+      'sampleRate': sampleRate,
+      'channels': channels,
+      'bitsPerSample': bitsPerSample,
+    };
+  }
+}
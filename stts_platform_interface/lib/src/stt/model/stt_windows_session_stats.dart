@@ -0,0 +1,66 @@
+/// Windows recognition engine statistics.
+class SttWindowsSessionStats {
+  /// Number of recognition starts.
+  final int starts;
+
+  /// Number of recognition starts which reused a warm engine.
+  final int warmStarts;
+
+  /// Time from start request to listening for the last recognition.
+  final Duration lastStartLatency;
+
+  /// Whether the last recognition reused a warm engine.
+  final bool lastStartWarm;
+
+  /// Memory allocated by the engine when it was created, in bytes.
+  final int engineFootprint;
+
+  /// Number of events queued for delivery, all channels included.
+  final int eventsPosted;
+
+  /// Number of events delivered to their stream.
+  final int eventsDelivered;
+
+  /// Number of hypotheses and audio levels dropped because events piled up.
+  final int eventsDropped;
+
+  /// Number of other events lost because the event queue was full.
+  final int eventsOverflowed;
+
+  /// Number of events waiting for delivery.
+  final int eventQueueDepth;
+
+  /// Highest number of events waiting for delivery.
+  final int eventQueueMaxDepth;
+
+  const SttWindowsSessionStats({
+    required this.starts,
+    required this.warmStarts,
+    required this.lastStartLatency,
+    required this.lastStartWarm,
+    required this.engineFootprint,
+    this.eventsPosted = 0,
+    this.eventsDelivered = 0,
+    this.eventsDropped = 0,
+    this.eventsOverflowed = 0,
+    this.eventQueueDepth = 0,
+    this.eventQueueMaxDepth = 0,
+  });
+
+  /// Map stats from platform value.
+  factory SttWindowsSessionStats.fromMap(Map map) {
+    return SttWindowsSessionStats(
+      starts: map['starts'] as int,
+      warmStarts: map['warmStarts'] as int,
+      lastStartLatency: Duration(microseconds: map['lastStartLatencyUs'] as int),
+      lastStartWarm: map['lastStartWarm'] as bool,
+      engineFootprint: map['engineFootprint'] as int,
+      eventsPosted: map['eventsPosted'] as int? ?? 0,
+      eventsDelivered: map['eventsDelivered'] as int? ?? 0,
+      eventsDropped: map['eventsDropped'] as int? ?? 0,
+      eventsOverflowed: map['eventsOverflowed'] as int? ?? 0,
+      eventQueueDepth: map['eventQueueDepth'] as int? ?? 0,
+      eventQueueMaxDepth: map['eventQueueMaxDepth'] as int? ?? 0,
+    );
+  }
+}
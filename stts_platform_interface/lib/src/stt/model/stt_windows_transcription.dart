@@ -0,0 +1,64 @@
+import 'stt_recognition.dart';
+
+/// State of a queued Windows transcription.
+enum SttWindowsTranscriptionState {
+  /// Audio is being recognized, see [SttWindowsTranscription.progress].
+  progress,
+
+  /// All phrases are available in [SttWindowsTranscription.phrases].
+  done,
+
+  /// Transcription failed, see [SttWindowsTranscription.errorMessage].
+  error,
+
+  /// Transcription was cancelled or the queue was disposed.
+  cancelled,
+}
+
+/// Update of a transcription queued with `SttWindows.queueTranscription`.
+class SttWindowsTranscription {
+  /// ID returned when queued.
+  final int jobId;
+
+  final SttWindowsTranscriptionState state;
+
+  /// Processed part of the audio, from 0 to 1.
+  final double progress;
+
+  /// Recognized phrases when [state] is [SttWindowsTranscriptionState.done].
+  final List<SttRecognition> phrases;
+
+  /// Platform error code when [state] is [SttWindowsTranscriptionState.error].
+  final String? errorCode;
+
+  /// Platform error message when [state] is [SttWindowsTranscriptionState.error].
+  final String? errorMessage;
+
+  const SttWindowsTranscription({
+    required this.jobId,
+    required this.state,
+    this.progress = 0,
+    this.phrases = const [],
+    this.errorCode,
+    this.errorMessage,
+  });
+
+  /// Map transcription from platform value.
+  factory SttWindowsTranscription.fromMap(
+    Map map,
+    List<SttRecognition> Function(List? phrases) toPhrases,
+  ) {
+    final state = SttWindowsTranscriptionState.values.byName(map['state']);
+
+    return SttWindowsTranscription(
+      jobId: map['jobId'] as int,
+      state: state,
+      progress: state == SttWindowsTranscriptionState.done
+          ? 1
+          : (map['progress'] as double?) ?? 0,
+      phrases: toPhrases(map['phrases'] as List?),
+      errorCode: map['code'] as String?,
+      errorMessage: map['message'] as String?,
+    );
+  }
+}
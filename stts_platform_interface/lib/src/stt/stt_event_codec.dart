@@ -0,0 +1,59 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Decodes compact events sent by Windows when
+/// `SttRecognitionWindowsOptions.compactEvents` is enabled.
+///
+/// Records are converted to the same maps as the default encoding.
+/// See `codec/event_codec.h` for the layout.
+List<Map<String, dynamic>> decodeSttEvents(Uint8List data) {
+  const headerSize = 28;
+  const typeHypothesis = 1;
+  const typeResult = 2;
+  const flagFinal = 0x1;
+  const flagHasTimes = 0x2;
+
+  final bytes = ByteData.sublistView(data);
+  final events = <Map<String, dynamic>>[];
+  var offset = 0;
+
+  while (data.length - offset >= headerSize) {
+    final type = bytes.getUint8(offset) & 0x0F;
+    final flags = bytes.getUint8(offset) >> 4;
+    final sequence = bytes.getUint32(offset + 4, Endian.little);
+    final timestamp = bytes.getInt64(offset + 8, Endian.little);
+    final arg0 = bytes.getUint32(offset + 16, Endian.little);
+    final arg1 = bytes.getUint32(offset + 20, Endian.little);
+    final length = bytes.getUint32(offset + 24, Endian.little);
+
+    final start = offset + headerSize;
+    if (data.length - start < length) break;
+
+    final payload = utf8.decode(
+      Uint8List.sublistView(data, start, start + length),
+    );
+    offset = start + length;
+
+    switch (type) {
+      case typeHypothesis:
+        events.add({
+          'isFinal': false,
+          'revision': sequence,
+          'stable': arg0,
+          'suffix': payload,
+          'position': timestamp,
+        });
+      case typeResult:
+        events.add({
+          'text': payload,
+          'isFinal': flags & flagFinal != 0,
+          'sequence': sequence,
+          'position': timestamp,
+          if (flags & flagHasTimes != 0) 'offset': arg0,
+          if (flags & flagHasTimes != 0) 'duration': arg1,
+        });
+    }
+  }
+
+  return events;
+}
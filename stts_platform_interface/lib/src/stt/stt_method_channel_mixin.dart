@@ -1,3 +1,5 @@
+import 'dart:math';
+
 import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
@@ -5,6 +7,11 @@ import 'model/ios_audio_session.dart';
 import 'model/stt_recognition.dart';
 import 'model/stt_recognition_options.dart';
 import 'model/stt_state.dart';
+import 'model/stt_windows_audio_level.dart';
+import 'model/stt_windows_pcm_format.dart';
+import 'model/stt_windows_session_stats.dart';
+import 'model/stt_windows_transcription.dart';
+import 'stt_event_codec.dart';
 import 'stt_platform_interface.dart';
 
 /// An implementation of [SttPlatform] that uses method channels.
@@ -176,6 +183,10 @@ class _SttWindowsImpl implements SttWindows {
   _SttWindowsImpl(this._methodChannel);
 
   final MethodChannel _methodChannel;
+  final _levelEventChannel = const EventChannel('com.llfbandit.stt/levels');
+  final _transcriptionEventChannel = const EventChannel(
+    'com.llfbandit.stt/transcriptions',
+  );
 
   @override
   Future<void> showTrainingUI([
@@ -185,6 +196,96 @@ class _SttWindowsImpl implements SttWindows {
       'trainingTexts': trainingTexts,
     });
   }
+
+  @override
+  Future<SttWindowsSessionStats> getSessionStats() async {
+    final result = await _methodChannel.invokeMethod<Map>(
+      'windows.getSessionStats',
+    );
+    return SttWindowsSessionStats.fromMap(result!);
+  }
+
+  @override
+  Future<void> setTracing(bool enabled) {
+    return _methodChannel.invokeMethod<void>('windows.setTracing', {
+      'enabled': enabled,
+    });
+  }
+
+  @override
+  Future<String> getTrace() async {
+    final result = await _methodChannel.invokeMethod<String>('windows.getTrace');
+    return result!;
+  }
+
+  @override
+  Stream<SttWindowsAudioLevel> get onAudioLevelChanged =>
+      _levelEventChannel.receiveBroadcastStream().map<SttWindowsAudioLevel>(
+            (dynamic level) => SttWindowsAudioLevel.fromMap(level),
+          );
+
+  @override
+  Future<List<SttRecognition>> transcribeFile(String path) async {
+    final result = await _methodChannel.invokeMethod<List>(
+      'windows.transcribeFile',
+      {'path': path},
+    );
+    return _toPhrases(result);
+  }
+
+  @override
+  Future<List<SttRecognition>> transcribeBuffer(
+    Uint8List bytes, {
+    SttWindowsPcmFormat? format,
+  }) async {
+    final result = await _methodChannel.invokeMethod<List>(
+      'windows.transcribeBuffer',
+      {'bytes': bytes, 'format': format?.toMap()},
+    );
+    return _toPhrases(result);
+  }
+
+  @override
+  Future<int> queueTranscription(String path) async {
+    final result = await _methodChannel.invokeMethod<int>(
+      'windows.queueTranscription',
+      {'path': path},
+    );
+    return result!;
+  }
+
+  @override
+  Future<bool> cancelTranscription(int jobId) async {
+    final result = await _methodChannel.invokeMethod<bool>(
+      'windows.cancelTranscription',
+      {'jobId': jobId},
+    );
+    return result ?? false;
+  }
+
+  @override
+  Stream<SttWindowsTranscription> get onTranscriptionChanged =>
+      _transcriptionEventChannel
+          .receiveBroadcastStream()
+          .map<SttWindowsTranscription>(
+            (dynamic event) => SttWindowsTranscription.fromMap(
+              event,
+              _toPhrases,
+            ),
+          );
+
+  List<SttRecognition> _toPhrases(List? result) {
+    return result
+            ?.map((dynamic phrase) => SttRecognition(
+                  phrase['text'],
+                  true,
+                  sequence: phrase['sequence'],
+                  audioOffset: Duration(milliseconds: phrase['offset']),
+                  audioDuration: Duration(milliseconds: phrase['duration']),
+                ))
+            .toList() ??
+        [];
+  }
 }
 
 mixin SttEventChannel implements SttEventChannelPlatformInterface {
@@ -202,11 +303,61 @@ mixin SttEventChannel implements SttEventChannelPlatformInterface {
           );
 
   @override
-  Stream<SttRecognition> get onResultChanged =>
-      _resultEventChannel.receiveBroadcastStream().map<SttRecognition>(
-            (dynamic result) => SttRecognition(
-              result['text'],
+  Stream<SttRecognition> get onResultChanged {
+    final hypothesis = _SttHypothesisDecoder();
+
+    return _resultEventChannel
+        .receiveBroadcastStream()
+        // Windows sends all results of a recognizer notification at once.
+        .expand((dynamic results) => switch (results) {
+              Uint8List data => decodeSttEvents(data),
+              List list => list,
+              _ => [results],
+            })
+        .expand<SttRecognition>((dynamic result) {
+          final text = result['suffix'] != null
+              ? hypothesis.decode(result)
+              : result['text'] as String;
+
+          // Partial text can't be rebuilt until the whole text is sent again.
+          if (text == null) return const [];
+
+          return [
+            SttRecognition(
+              text,
               result['isFinal'],
+              sequence: result['sequence'],
+              audioOffset: _toDuration(result['offset']),
+              audioDuration: _toDuration(result['duration']),
             ),
-          );
+          ];
+        });
+  }
+
+  Duration? _toDuration(int? milliseconds) {
+    return milliseconds != null ? Duration(milliseconds: milliseconds) : null;
+  }
+}
+
+/// Rebuilds intermediate results sent as a delta from the previous one.
+class _SttHypothesisDecoder {
+  String _text = '';
+  int _revision = 0;
+
+  /// Returns null if the previous delta is missing, dropped by the platform
+  /// or sent before listening, and [result] is not the whole text.
+  String? decode(Map result) {
+    final int revision = result['revision'];
+
+    // The same event is mapped once per listener.
+    if (revision != _revision) {
+      final int stable = result['stable'];
+      if (revision != _revision + 1 && stable > 0) return null;
+
+      _text = _text.substring(0, min(stable, _text.length)) + result['suffix'];
+      _revision = revision;
+    }
+
+    return _text;
+  }
 }
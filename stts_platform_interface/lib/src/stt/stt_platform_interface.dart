@@ -1,9 +1,15 @@
+import 'dart:typed_data';
+
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
 import 'model/ios_audio_session.dart';
 import 'model/stt_recognition.dart';
 import 'model/stt_recognition_options.dart';
 import 'model/stt_state.dart';
+import 'model/stt_windows_audio_level.dart';
+import 'model/stt_windows_pcm_format.dart';
+import 'model/stt_windows_session_stats.dart';
+import 'model/stt_windows_transcription.dart';
 import 'stt_platform.dart';
 
 /// Speech-to-Text platform interface
@@ -132,6 +138,52 @@ abstract class SttWindows {
   /// [trainingTexts]: Custom training sentences.
   /// If null, system will propose automatically training texts.
   Future<void> showTrainingUI([List<String>? trainingTexts]);
+
+  /// Returns recognition engine statistics (warm starts, start latency, ...).
+  Future<SttWindowsSessionStats> getSessionStats();
+
+  /// Starts recording a trace of method calls, engine calls and events, or stops it.
+  ///
+  /// Starting again drops the spans recorded before. The trace is shared with `TtsWindows`.
+  Future<void> setTracing(bool enabled);
+
+  /// Returns the recorded trace as Chrome trace event JSON,
+  /// to be opened in `chrome://tracing` or Perfetto.
+  Future<String> getTrace();
+
+  /// Stream of audio levels heard by the engine while listening.
+  ///
+  /// Enabled with [SttRecognitionWindowsOptions.levelInterval].
+  Stream<SttWindowsAudioLevel> get onAudioLevelChanged;
+
+  /// Recognizes all phrases of a WAV file (8 or 16-bit PCM).
+  ///
+  /// Audio is processed faster than real time, independently of live recognition.
+  /// Phrases are returned with their [SttRecognition.audioOffset] in the file.
+  Future<List<SttRecognition>> transcribeFile(String path);
+
+  /// Same as [transcribeFile] from memory.
+  ///
+  /// [bytes] is the content of a WAV file, or raw PCM samples when [format] is given.
+  Future<List<SttRecognition>> transcribeBuffer(
+    Uint8List bytes, {
+    SttWindowsPcmFormat? format,
+  });
+
+  /// Queues a WAV file to be transcribed in the background.
+  ///
+  /// Queued files are recognized in parallel, one engine per processor core,
+  /// with the engine of the current language.
+  /// Returns the job ID reported by [onTranscriptionChanged].
+  Future<int> queueTranscription(String path);
+
+  /// Cancels a queued or running transcription.
+  ///
+  /// Returns `false` if the job is unknown or already finished.
+  Future<bool> cancelTranscription(int jobId);
+
+  /// Stream of progress and results of queued transcriptions.
+  Stream<SttWindowsTranscription> get onTranscriptionChanged;
 }
 
 /// Speech-to-Text event channel platform interface
@@ -2,3 +2,9 @@ export 'tts_options.dart';
 export 'tts_queue_mode.dart';
 export 'tts_state.dart';
 export 'tts_voice.dart';
+export 'tts_windows_cache_stats.dart';
+export 'tts_windows_pcm_format.dart';
+export 'tts_windows_pipeline_stats.dart';
+export 'tts_windows_progress.dart';
+export 'tts_windows_store_stats.dart';
+export 'tts_windows_utterance.dart';
@@ -15,9 +15,41 @@ class TtsOptions {
   /// *Ignored on web platform.*
   final Duration? postSilence;
 
+  /// Names of positions in the text, keyed by index in the text.
+  ///
+  /// Reported by `TtsWindows.onProgress` when reached.
+  ///
+  /// *Windows only.*
+  final Map<int, String>? bookmarks;
+
+  /// Voice of this utterance only, the current voice otherwise.
+  ///
+  /// *Windows only.*
+  final String? voiceId;
+
+  /// Pitch of this utterance only, same range as `setPitch`.
+  ///
+  /// *Windows only.*
+  final double? pitch;
+
+  /// Rate of this utterance only, same range as `setRate`.
+  ///
+  /// *Windows only.*
+  final double? rate;
+
+  /// Volume of this utterance only, same range as `setVolume`.
+  ///
+  /// *Windows only.*
+  final double? volume;
+
   const TtsOptions({
     this.mode = TtsQueueMode.add,
     this.preSilence,
     this.postSilence,
+    this.bookmarks,
+    this.voiceId,
+    this.pitch,
+    this.rate,
+    this.volume,
   });
 }
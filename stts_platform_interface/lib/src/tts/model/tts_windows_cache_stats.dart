@@ -0,0 +1,41 @@
+/// Windows synthesized utterance cache statistics.
+class TtsWindowsCacheStats {
+  /// Number of utterances played from the cache.
+  final int hits;
+
+  /// Number of utterances rendered because they were not cached.
+  final int misses;
+
+  /// Number of utterances added to the cache.
+  final int insertions;
+
+  /// Number of utterances removed to stay under the budget.
+  final int evictions;
+
+  /// Number of cached utterances.
+  final int entries;
+
+  /// Memory used by cached utterances, in bytes.
+  final int bytes;
+
+  const TtsWindowsCacheStats({
+    required this.hits,
+    required this.misses,
+    required this.insertions,
+    required this.evictions,
+    required this.entries,
+    required this.bytes,
+  });
+
+  /// Map stats from platform value.
+  factory TtsWindowsCacheStats.fromMap(Map map) {
+    return TtsWindowsCacheStats(
+      hits: map['hits'] as int,
+      misses: map['misses'] as int,
+      insertions: map['insertions'] as int,
+      evictions: map['evictions'] as int,
+      entries: map['entries'] as int,
+      bytes: map['bytes'] as int,
+    );
+  }
+}
@@ -0,0 +1,31 @@
+/// Windows synthesis pipeline statistics.
+class TtsWindowsPipelineStats {
+  /// Number of queued utterances.
+  final int submitted;
+
+  /// Number of utterances rendered ahead of playback.
+  final int rendered;
+
+  /// Number of utterances which could not be rendered.
+  final int failed;
+
+  /// Number of utterances dropped by stop or flush.
+  final int cancelled;
+
+  const TtsWindowsPipelineStats({
+    required this.submitted,
+    required this.rendered,
+    required this.failed,
+    required this.cancelled,
+  });
+
+  /// Map stats from platform value.
+  factory TtsWindowsPipelineStats.fromMap(Map map) {
+    return TtsWindowsPipelineStats(
+      submitted: map['submitted'] as int,
+      rendered: map['rendered'] as int,
+      failed: map['failed'] as int,
+      cancelled: map['cancelled'] as int,
+    );
+  }
+}
@@ -0,0 +1,36 @@
+/// Kind of [TtsWindowsProgress].
+enum TtsWindowsProgressType {
+  /// A word starts being spoken.
+  word,
+
+  /// A sentence starts being spoken.
+  sentence,
+
+  /// A bookmark given in `TtsOptions.bookmarks` is reached.
+  bookmark,
+}
+
+/// Position reached in the text of a spoken utterance.
+class TtsWindowsProgress {
+  final TtsWindowsProgressType type;
+
+  /// ID of the utterance, as returned by `TtsWindows.enqueue`.
+  final int utteranceId;
+
+  /// Index in the utterance text, as given to `start`.
+  final int offset;
+
+  /// Number of code units of the word or sentence, 0 for bookmarks.
+  final int length;
+
+  /// Bookmark name when [type] is [TtsWindowsProgressType.bookmark].
+  final String? bookmark;
+
+  const TtsWindowsProgress({
+    required this.type,
+    required this.utteranceId,
+    required this.offset,
+    this.length = 0,
+    this.bookmark,
+  });
+}
@@ -0,0 +1,51 @@
+/// Windows persistent utterance store statistics.
+class TtsWindowsStoreStats {
+  /// Number of utterances played from the store.
+  final int hits;
+
+  /// Number of utterances not found in the store.
+  final int misses;
+
+  /// Number of utterances written to the store.
+  final int puts;
+
+  /// Number of utterances not written because the store was full.
+  final int rejected;
+
+  /// Number of utterances failing validation, e.g. after a crash.
+  final int corrupted;
+
+  /// Number of completed compactions.
+  final int compactions;
+
+  /// Number of stored utterances.
+  final int entries;
+
+  /// Size of stored utterances, in bytes.
+  final int bytes;
+
+  const TtsWindowsStoreStats({
+    required this.hits,
+    required this.misses,
+    required this.puts,
+    required this.rejected,
+    required this.corrupted,
+    required this.compactions,
+    required this.entries,
+    required this.bytes,
+  });
+
+  /// Map stats from platform value.
+  factory TtsWindowsStoreStats.fromMap(Map map) {
+    return TtsWindowsStoreStats(
+      hits: map['hits'] as int,
+      misses: map['misses'] as int,
+      puts: map['puts'] as int,
+      rejected: map['rejected'] as int,
+      corrupted: map['corrupted'] as int,
+      compactions: map['compactions'] as int,
+      entries: map['entries'] as int,
+      bytes: map['bytes'] as int,
+    );
+  }
+}
@@ -0,0 +1,47 @@
+/// Priority of utterances queued with `TtsWindows.enqueue`.
+enum TtsWindowsPriority {
+  /// Spoken after all others.
+  low,
+
+  /// Priority of utterances queued with `start`.
+  normal,
+
+  /// Spoken first, interrupting lower priorities.
+  high,
+}
+
+/// Change of a queued utterance.
+enum TtsWindowsUtteranceState {
+  /// Started to be spoken, or resumed after being interrupted.
+  started,
+
+  /// Interrupted by a higher priority, resumed later from that sentence.
+  interrupted,
+
+  /// Spoken until the end.
+  finished,
+
+  /// Cancelled, stopped, flushed or failed.
+  cancelled,
+
+  /// Not started before its deadline.
+  expired,
+}
+
+/// Utterance state reported by `TtsWindows.onUtteranceChanged`.
+class TtsWindowsUtterance {
+  /// ID returned by `TtsWindows.enqueue`.
+  final int id;
+
+  final TtsWindowsUtteranceState state;
+
+  const TtsWindowsUtterance({required this.id, required this.state});
+
+  /// Map utterance from platform value.
+  factory TtsWindowsUtterance.fromMap(Map map) {
+    return TtsWindowsUtterance(
+      id: map['id'] as int,
+      state: TtsWindowsUtteranceState.values[map['state'] as int],
+    );
+  }
+}
@@ -0,0 +1,50 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'model/model.dart';
+
+/// Decodes progress events sent by Windows in a single byte array.
+///
+/// See `codec/event_codec.h` for the layout.
+List<TtsWindowsProgress> decodeTtsProgress(Uint8List data) {
+  const headerSize = 28;
+  const typeProgress = 3;
+  const flagSentence = 0x4;
+  const flagBookmark = 0x8;
+
+  final bytes = ByteData.sublistView(data);
+  final events = <TtsWindowsProgress>[];
+  var offset = 0;
+
+  while (data.length - offset >= headerSize) {
+    final type = bytes.getUint8(offset) & 0x0F;
+    final flags = bytes.getUint8(offset) >> 4;
+    final sequence = bytes.getUint32(offset + 4, Endian.little);
+    final arg0 = bytes.getUint32(offset + 16, Endian.little);
+    final arg1 = bytes.getUint32(offset + 20, Endian.little);
+    final length = bytes.getUint32(offset + 24, Endian.little);
+
+    final start = offset + headerSize;
+    if (data.length - start < length) break;
+
+    final payload = Uint8List.sublistView(data, start, start + length);
+    offset = start + length;
+
+    if (type != typeProgress) continue;
+
+    final isBookmark = flags & flagBookmark != 0;
+    events.add(TtsWindowsProgress(
+      type: isBookmark
+          ? TtsWindowsProgressType.bookmark
+          : flags & flagSentence != 0
+              ? TtsWindowsProgressType.sentence
+              : TtsWindowsProgressType.word,
+      utteranceId: sequence,
+      offset: arg0,
+      length: arg1,
+      bookmark: isBookmark ? utf8.decode(payload) : null,
+    ));
+  }
+
+  return events;
+}
@@ -1,12 +1,15 @@
+import 'package:flutter/foundation.dart';
 import 'package:flutter/services.dart';
 
 import 'model/model.dart';
+import 'tts_event_codec.dart';
 import 'tts_platform_interface.dart';
 
 /// An implementation of [TtsPlatform] that uses method channels.
 mixin TtsMethodChannel implements TtsMethodChannelPlatformInterface {
   /// The method channel used to interact with the native platform.
   final _methodChannel = const MethodChannel('com.llfbandit.tts/methods');
+  _TtsWindowsImpl? _windows;
 
   @override
   Future<bool> isSupported() async {
@@ -21,11 +24,7 @@ mixin TtsMethodChannel implements TtsMethodChannelPlatformInterface {
   }) {
     return _methodChannel.invokeMethod<void>('start', {
       'text': text,
-      'mode': options.mode.name,
-      if (options.preSilence case final silence?)
-        'preSilence': silence.inMilliseconds,
-      if (options.postSilence case final silence?)
-        'postSilence': silence.inMilliseconds,
+      ..._optionsToMap(options),
     });
   }
 
@@ -122,6 +121,205 @@ mixin TtsMethodChannel implements TtsMethodChannelPlatformInterface {
   Future<void> dispose() {
     return _methodChannel.invokeMethod<void>('dispose');
   }
+
+  @override
+  TtsWindows? get windows {
+    if (kIsWeb || TargetPlatform.windows != defaultTargetPlatform) return null;
+
+    _windows ??= _TtsWindowsImpl(_methodChannel);
+
+    return _windows;
+  }
+}
+
+Map<String, dynamic> _optionsToMap(TtsOptions options) {
+  return <String, dynamic>{
+    'mode': options.mode.name,
+    if (options.preSilence case final silence?)
+      'preSilence': silence.inMilliseconds,
+    if (options.postSilence case final silence?)
+      'postSilence': silence.inMilliseconds,
+    if (options.bookmarks case final bookmarks?) 'bookmarks': bookmarks,
+    if (options.voiceId case final voiceId?) 'voiceId': voiceId,
+    if (options.pitch case final pitch?) 'pitch': pitch,
+    if (options.rate case final rate?) 'rate': rate,
+    if (options.volume case final volume?) 'volume': volume,
+  };
+}
+
+class _TtsWindowsImpl implements TtsWindows {
+  _TtsWindowsImpl(this._methodChannel);
+
+  final MethodChannel _methodChannel;
+  final _progressEventChannel = const EventChannel(
+    'com.llfbandit.tts/progress',
+  );
+  final _utteranceEventChannel = const EventChannel(
+    'com.llfbandit.tts/utterances',
+  );
+
+  @override
+  Future<Uint8List> synthesizeToBuffer(
+    String text, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPcmFormat format = const TtsWindowsPcmFormat(),
+  }) async {
+    final result = await _methodChannel.invokeMethod<Uint8List>(
+      'windows.synthesizeToBuffer',
+      {'text': text, 'format': format.toMap(), ..._optionsToMap(options)},
+    );
+    return result ?? Uint8List(0);
+  }
+
+  @override
+  Future<void> synthesizeToFile(
+    String text,
+    String path, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPcmFormat format = const TtsWindowsPcmFormat(),
+  }) {
+    return _methodChannel.invokeMethod<void>('windows.synthesizeToFile', {
+      'text': text,
+      'path': path,
+      'format': format.toMap(),
+      ..._optionsToMap(options),
+    });
+  }
+
+  @override
+  Future<void> configure({
+    String? voiceId,
+    double? pitch,
+    double? rate,
+    double? volume,
+  }) {
+    return _methodChannel.invokeMethod<void>('windows.configure', {
+      if (voiceId != null) 'voiceId': voiceId,
+      if (pitch != null) 'pitch': pitch,
+      if (rate != null) 'rate': rate,
+      if (volume != null) 'volume': volume,
+    });
+  }
+
+  @override
+  Future<void> setCacheBudget(int bytes) {
+    return _methodChannel.invokeMethod<void>('windows.setCacheBudget', {
+      'budget': bytes,
+    });
+  }
+
+  @override
+  Future<TtsWindowsCacheStats> getCacheStats() async {
+    final result = await _methodChannel.invokeMethod<Map>(
+      'windows.getCacheStats',
+    );
+    return TtsWindowsCacheStats.fromMap(result!);
+  }
+
+  @override
+  Future<void> setTracing(bool enabled) {
+    return _methodChannel.invokeMethod<void>('windows.setTracing', {
+      'enabled': enabled,
+    });
+  }
+
+  @override
+  Future<String> getTrace() async {
+    final result = await _methodChannel.invokeMethod<String>('windows.getTrace');
+    return result!;
+  }
+
+  @override
+  Future<void> openStore(String path, {int maxBytes = 256 * 1024 * 1024}) {
+    return _methodChannel.invokeMethod<void>('windows.openStore', {
+      'path': path,
+      'maxBytes': maxBytes,
+    });
+  }
+
+  @override
+  Future<void> closeStore() {
+    return _methodChannel.invokeMethod<void>('windows.closeStore');
+  }
+
+  @override
+  Future<TtsWindowsStoreStats> getStoreStats() async {
+    final result = await _methodChannel.invokeMethod<Map>(
+      'windows.getStoreStats',
+    );
+    return TtsWindowsStoreStats.fromMap(result!);
+  }
+
+  @override
+  Future<void> setPipeline({
+    int lookahead = 2,
+    int maxBytes = 32 * 1024 * 1024,
+  }) {
+    return _methodChannel.invokeMethod<void>('windows.setPipeline', {
+      'lookahead': lookahead,
+      'maxBytes': maxBytes,
+    });
+  }
+
+  @override
+  Future<TtsWindowsPipelineStats> getPipelineStats() async {
+    final result = await _methodChannel.invokeMethod<Map>(
+      'windows.getPipelineStats',
+    );
+    return TtsWindowsPipelineStats.fromMap(result!);
+  }
+
+  @override
+  Future<void> setProgressEvents({
+    bool words = false,
+    bool sentences = false,
+    bool bookmarks = false,
+  }) {
+    return _methodChannel.invokeMethod<void>('windows.setProgressEvents', {
+      'words': words,
+      'sentences': sentences,
+      'bookmarks': bookmarks,
+    });
+  }
+
+  @override
+  Stream<TtsWindowsProgress> get onProgress => _progressEventChannel
+      .receiveBroadcastStream()
+      .expand<TtsWindowsProgress>((dynamic data) => decodeTtsProgress(data));
+
+  @override
+  Future<int> enqueue(
+    String text, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPriority priority = TtsWindowsPriority.normal,
+    Duration? deadline,
+  }) async {
+    final result = await _methodChannel.invokeMethod<int>('start', {
+      'text': text,
+      ..._optionsToMap(options),
+      'priority': switch (priority) {
+        TtsWindowsPriority.low => -1,
+        TtsWindowsPriority.normal => 0,
+        TtsWindowsPriority.high => 1,
+      },
+      if (deadline != null) 'deadline': deadline.inMilliseconds,
+    });
+    return result!;
+  }
+
+  @override
+  Future<bool> cancel(int id) async {
+    final result = await _methodChannel.invokeMethod<bool>('windows.cancel', {
+      'id': id,
+    });
+    return result ?? false;
+  }
+
+  @override
+  Stream<TtsWindowsUtterance> get onUtteranceChanged =>
+      _utteranceEventChannel.receiveBroadcastStream().map<TtsWindowsUtterance>(
+            (dynamic data) => TtsWindowsUtterance.fromMap(data),
+          );
 }
 
 mixin TtsEventChannel implements TtsEventChannelPlatformInterface {
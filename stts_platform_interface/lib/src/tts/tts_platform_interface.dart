@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'model/model.dart';
 import 'tts_platform.dart';
 
@@ -83,6 +85,119 @@ abstract class TtsMethodChannelPlatformInterface {
 
   /// Disposes Test-to-Speech instance.
   Future<void> dispose();
+
+  /// Windows platform specific methods.
+  ///
+  /// Returns [null] when not on Windows platform.
+  TtsWindows? get windows;
+}
+
+/// Windows platform specific methods.
+abstract class TtsWindows {
+  /// Renders [text] to raw PCM samples in the given [format], without playing it.
+  ///
+  /// Current voice, pitch, rate and volume are used.
+  /// Audio is rendered faster than real time. [TtsOptions.mode] is ignored.
+  Future<Uint8List> synthesizeToBuffer(
+    String text, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPcmFormat format = const TtsWindowsPcmFormat(),
+  });
+
+  /// Same as [synthesizeToBuffer], streamed to a WAV file at [path].
+  ///
+  /// The file is replaced if it exists, and removed if rendering fails.
+  Future<void> synthesizeToFile(
+    String text,
+    String path, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPcmFormat format = const TtsWindowsPcmFormat(),
+  });
+
+  /// Sets voice, pitch, rate and volume in one call, omitted ones are left unchanged.
+  ///
+  /// Either all settings apply or none, e.g. when [voiceId] is unknown.
+  Future<void> configure({
+    String? voiceId,
+    double? pitch,
+    double? rate,
+    double? volume,
+  });
+
+  /// Sets the memory budget of the utterance cache, in bytes. `0` disables the cache (default).
+  ///
+  /// Utterances are then rendered once and replayed from memory
+  /// as long as voice, pitch, rate, volume, text and silences are the same.
+  /// Least recently played utterances are removed first to stay under the budget.
+  Future<void> setCacheBudget(int bytes);
+
+  /// Returns utterance cache statistics.
+  Future<TtsWindowsCacheStats> getCacheStats();
+
+  /// Starts recording a trace of method calls, engine calls and events, or stops it.
+  ///
+  /// Starting again drops the spans recorded before. The trace is shared with `SttWindows`.
+  Future<void> setTracing(bool enabled);
+
+  /// Returns the recorded trace as Chrome trace event JSON,
+  /// to be opened in `chrome://tracing` or Perfetto.
+  Future<String> getTrace();
+
+  /// Keeps rendered utterances in files at [path], replayed across sessions.
+  ///
+  /// Files are named after [path] with a suffix, in an existing folder.
+  /// Oldest utterances are removed in the background above [maxBytes].
+  Future<void> openStore(String path, {int maxBytes = 256 * 1024 * 1024});
+
+  /// Stops using the store. Files are kept.
+  Future<void> closeStore();
+
+  /// Returns utterance store statistics.
+  Future<TtsWindowsStoreStats> getStoreStats();
+
+  /// Renders queued utterances while the previous ones play, so they follow without gaps.
+  ///
+  /// Up to [lookahead] utterances are rendered ahead, within [maxBytes] of audio.
+  /// The first utterance starts once fully rendered.
+  /// A [lookahead] of 0 disables it (default), queued utterances are then stopped.
+  Future<void> setPipeline({int lookahead = 2, int maxBytes = 32 * 1024 * 1024});
+
+  /// Returns synthesis pipeline statistics.
+  Future<TtsWindowsPipelineStats> getPipelineStats();
+
+  /// Enables [onProgress] events, all disabled by default.
+  ///
+  /// Utterances played from the cache, the store or the pipeline have none.
+  Future<void> setProgressEvents({
+    bool words = false,
+    bool sentences = false,
+    bool bookmarks = false,
+  });
+
+  /// Stream of words, sentences and bookmarks reached while speaking.
+  ///
+  /// Offsets are indexes in the text given to `start`.
+  Stream<TtsWindowsProgress> get onProgress;
+
+  /// Queues [text] like `start` and returns its ID, reported by [onUtteranceChanged].
+  ///
+  /// Higher [priority] utterances are spoken first. They interrupt lower ones,
+  /// which resume afterwards from the interrupted sentence.
+  /// The utterance is dropped if not started within [deadline].
+  Future<int> enqueue(
+    String text, {
+    TtsOptions options = const TtsOptions(),
+    TtsWindowsPriority priority = TtsWindowsPriority.normal,
+    Duration? deadline,
+  });
+
+  /// Removes the utterance [id] from the queue, or stops it if speaking.
+  ///
+  /// Returns `false` if it already ended.
+  Future<bool> cancel(int id);
+
+  /// Stream of queued utterances changes.
+  Stream<TtsWindowsUtterance> get onUtteranceChanged;
 }
 
 /// Text-to-Speech event channel platform interface
@@ -171,6 +171,9 @@ class Tts extends TtsPlatformInterface {
     _stateStreamCtrl = null;
   }
 
+  @override
+  TtsWindows? get windows => null;
+
   @override
   Stream<TtsState> get onStateChanged {
     _stateStreamCtrl ??= StreamController.broadcast();